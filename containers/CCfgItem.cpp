@@ -1876,7 +1876,7 @@ bool CCfgItem_FilterItem::WriteToFile(QTextStream& fileStream, CfgItemSaveOption
     g_cfgItem_tempString[destIndex] = 0;
 
     QString tag = 
-        QString("    <filter enabled=\"%1\" excluding=\"%2\" color=\"%3\"  bg_color=\"%4\" type=\"matches_text\" case_sensitive=\"%5\" regex=\"%6\" adaptive_clip=\"%7\" text=\"%8\" />\n")
+        QString("    <filter enabled=\"%1\" excluding=\"%2\" color=\"%3\"  bg_color=\"%4\" type=\"%8\" case_sensitive=\"%5\" regex=\"%6\" adaptive_clip=\"%7\" text=\"%9\" />\n")
         .arg(m_filterItem_ref_p->m_enabled == true ? 'y' : 'n')
         .arg(m_filterItem_ref_p->m_exclude == true ? 'y' : 'n')
         .arg(m_filterItem_ref_p->m_color, 4, 16)
@@ -1884,6 +1884,7 @@ bool CCfgItem_FilterItem::WriteToFile(QTextStream& fileStream, CfgItemSaveOption
         .arg(m_filterItem_ref_p->m_caseSensitive == true ? 'y' : 'n')
         .arg(m_filterItem_ref_p->m_regexpr == true ? 'y' : 'n')
         .arg(m_filterItem_ref_p->m_adaptiveClipEnabled == true ? 'y' : 'n')
+        .arg(m_filterItem_ref_p->m_expression ? "expression" : "matches_text")
         .arg(g_cfgItem_tempString);
 
         
@@ -1916,6 +1917,7 @@ void CCfgItem_FilterItem::hash(QDataStream& dstream) const
     dstream << m_filterItem_ref_p->m_regexpr;
     dstream << m_filterItem_ref_p->m_adaptiveClipEnabled;
     dstream << m_filterItem_ref_p->m_caseSensitive;
+    dstream << m_filterItem_ref_p->m_expression;
     dstream << m_filterItem_ref_p->m_size;
     dstream.writeRawData(m_filterItem_ref_p->m_start_p, m_filterItem_ref_p->m_size);
 }
@@ -1937,6 +1939,7 @@ void CCfgItem_FilterItem::Serialize(QDataStream& dstream, bool pack)
         dstream << m_filterItem_ref_p->m_regexpr;
         dstream << m_filterItem_ref_p->m_adaptiveClipEnabled;
         dstream << m_filterItem_ref_p->m_caseSensitive;
+        dstream << m_filterItem_ref_p->m_expression;
         dstream << m_filterItem_ref_p->m_size;
         dstream.writeRawData(m_filterItem_ref_p->m_start_p, m_filterItem_ref_p->m_size);
     } else {
@@ -1957,6 +1960,7 @@ void CCfgItem_FilterItem::Serialize(QDataStream& dstream, bool pack)
         dstream >> m_filterItem_ref_p->m_regexpr;
         dstream >> m_filterItem_ref_p->m_adaptiveClipEnabled;
         dstream >> m_filterItem_ref_p->m_caseSensitive;
+        dstream >> m_filterItem_ref_p->m_expression;
         dstream >> m_filterItem_ref_p->m_size;
 
         Q_ASSERT(m_filterItem_ref_p->m_size > 0 && m_filterItem_ref_p->m_size < 100);
@@ -76,12 +76,13 @@ bool CFGCTRL_UnloadAll(void)
 bool CFGCTRL_LoadLogFile(void)
 {
     QStringList filters;
-    filters << "Text files (*.txt *.log)";
+    filters << "Text files (*.txt *.log)" << "Rotated log files (*.log *.log.*)";
 
     QList<RecentFile_Kind_e> kindList;
     kindList.append(RecentFile_Kind_LogFile_en);
+    /* Several files may be picked, a set of rotated log files */
     return CFGCTRL_Load_FileType(QString("Load log file"), filters, kindList,
-                                 GetTheDoc()->m_recentFiles.GetRecentPath(RecentFile_Kind_LogFile_en));
+                                 GetTheDoc()->m_recentFiles.GetRecentPath(RecentFile_Kind_LogFile_en), true);
 }
 
 /***********************************************************************************************************************
@@ -120,7 +121,8 @@ bool CFGCTRL_LoadFilterFile(void)
 bool CFGCTRL_Load_FileType(const QString& title,
                            const QStringList& filters,
                            const QList<RecentFile_Kind_e>& kindList,
-                           const QString& defaultDIR)
+                           const QString& defaultDIR,
+                           bool multiSelect)
 {
     Q_UNUSED(title)
 
@@ -128,7 +130,8 @@ bool CFGCTRL_Load_FileType(const QString& title,
                                                            QFileDialog::AcceptOpen,
                                                            filters,
                                                            kindList,
-                                                           defaultDIR);
+                                                           defaultDIR,
+                                                           multiSelect);
     if (fileNames.isEmpty()) {
         return false;
     }
@@ -142,14 +145,17 @@ QStringList CFGCTRL_GetUserPickedFileNames(const QString& proposedFileName,
                                            const QFileDialog::AcceptMode mode,
                                            const QStringList& filters,
                                            const QList<RecentFile_Kind_e>& kindList,
-                                           const QString& defaultDIR)
+                                           const QString& defaultDIR,
+                                           bool multiSelect)
 {
     CLogScrutinizerDoc *doc_p = GetTheDoc();
 
     TRACEX_D(QString("%1 proposedFileName:%2 defaultDir:%3").arg(__FUNCTION__).arg(proposedFileName).arg(defaultDIR))
 
     QFileDialog fileDialog(nullptr);
-    fileDialog.setFileMode(QFileDialog::AnyFile);
+
+    fileDialog.setFileMode(multiSelect && (mode == QFileDialog::AcceptOpen) ? QFileDialog::ExistingFiles :
+                           QFileDialog::AnyFile);
     fileDialog.setAcceptMode(mode);
 
     /* Restrict which files that might be opened */
@@ -721,6 +727,22 @@ bool CConfigurationCtrl::Save_FilterAs(const QString *originalFileName, CCfgItem
     return false;
 }
 
+/***********************************************************************************************************************
+*   isLogFileName
+***********************************************************************************************************************/
+static bool isLogFileName(const QFileInfo& fileInfo)
+{
+    /* *.txt, *.log, and rotated log files such as service.log.1 */
+    const QString ext = fileInfo.suffix();
+    if ((ext == "txt") || (ext == "log")) {
+        return true;
+    }
+
+    bool isRotation = false;
+    (void)ext.toInt(&isRotation);
+    return isRotation && QFileInfo(fileInfo.completeBaseName()).suffix() == "log";
+}
+
 /***********************************************************************************************************************
 *   LoadFileList
 ***********************************************************************************************************************/
@@ -797,6 +819,32 @@ bool CConfigurationCtrl::LoadFileList(QList<QString>& fileList)
 
     /* Step 2. */
 
+    /* Several log files are opened together as one log, e.g. service.log.40 ... service.log.1, service.log */
+    QStringList logFileNames;
+    for (auto& fileNameTemp : fileList) {
+        if (isLogFileName(QFileInfo(fileNameTemp))) {
+            doc_p->GetAbsoluteFileName(fileNameTemp, fileName);
+            logFileNames.append(fileName);
+        }
+    }
+
+    /* Files that are not rotations of one log file are only combined if merging is enabled (explicit), otherwise they
+     * are loaded one by one as before, the last one remains */
+    if ((logFileNames.count() > 1) && !g_cfg_p->m_logMergeByTimestamp && !CLogFile::IsRotatedSet(logFileNames)) {
+        TRACEX_I(QString("The %1 log files picked are not rotations of one log file, and merging is disabled")
+                     .arg(logFileNames.count()))
+        logFileNames.clear();
+    }
+
+    if (logFileNames.count() > 1) {
+        g_workspace_p->RemoveLog(); /* ensure that if the loading fails the tree will be updated with that the log
+                                     * has been cleaned out */
+        if (doc_p->LoadLogFiles(logFileNames)) {
+            doc_p->m_recentFiles.WriteToFile();
+            g_workspace_p->AddLog(doc_p->m_Log_FileName.toLatin1().data());
+        }
+    }
+
     for (auto& fileNameTemp : fileList) {
         auto cleanFileData = makeMyScopeGuard([&] () {
             if (m_memPoolItem_p != nullptr) {
@@ -813,7 +861,11 @@ bool CConfigurationCtrl::LoadFileList(QList<QString>& fileList)
         QFileInfo fileInfo(fileName);
         QString ext = fileInfo.suffix();
 
-        if ((ext == "txt") || (ext == "log")) {
+        if (isLogFileName(fileInfo)) {
+            if (logFileNames.count() > 1) {
+                continue; /* Already loaded as one log above */
+            }
+
             g_workspace_p->RemoveLog();
 
             if (CanFileBeOpenedForFileRead(fileName)) {
@@ -1720,6 +1772,9 @@ void CConfigurationCtrl::Element_Attribute_FilterItem(char *name_p, char *value_
             } else {
                 m_newFilterItem_p->m_adaptiveClipEnabled = false;
             }
+        } else if (strcmp(name_p, "type") == 0) {
+            /* matches_text, or expression for a compound filter item */
+            m_newFilterItem_p->m_expression = strcmp(value_p, "expression") == 0;
         }
     }
 
@@ -40,7 +40,7 @@ typedef enum {
  * search path rigth. */
 QStringList CFGCTRL_GetUserPickedFileNames(const QString& proposedFileName, const QFileDialog::AcceptMode mode,
                                            const QStringList& filters, const QList<RecentFile_Kind_e>& kindList,
-                                           const QString& defaultDIR);
+                                           const QString& defaultDIR, bool multiSelect = false);
 void CFGCTRL_RemoveDuplicateUrls(QList<QUrl>& urlList);
 bool CFGCTRL_LoadFiles(QList<QString>& fileList_p);
 bool CFGCTRL_UnloadAll(void);
@@ -56,7 +56,7 @@ bool CFGCTRL_SaveFilterFile(QString& fileName, CCfgItem_Filter *filter_p);
 bool CFGCTRL_SaveFilterFileAs(QString *fileName_p, CCfgItem_Filter *filterItem_p);
 bool CFGCTRL_ReloadFilterFile(QString& fileName, CCfgItem_Filter *filter_p);
 bool CFGCTRL_Load_FileType(const QString& title, const QStringList& filters, const QList<RecentFile_Kind_e>& kindList,
-                           const QString& defaultDIR);
+                           const QString& defaultDIR, bool multiSelect = false);
 QString CFGCTRL_GetWorkingDir();
 QString CFGCTRL_GetDefaultWorkspaceFilePath();
 
@@ -6,9 +6,24 @@
 #include <QFileInfo>
 
 #include "CFilter.h"
+#include "CRockScrollSummary.h"
 #include "CDebug.h"
+#include "CRegExpHybrid.h"
+#include "CFilterExpression.h"
 #include <hs/hs.h>
 
+/***********************************************************************************************************************
+*   FilterItemProfile_ToString
+***********************************************************************************************************************/
+QString FilterItemProfile_ToString(const FilterItemProfile_t& profile)
+{
+    const double selectivity = profile.evaluations == 0 ? 0.0 :
+                               100.0 * static_cast<double>(profile.matches) / profile.evaluations;
+
+    return QString("%1 evaluations, %2 matches (%3%), ~%4 ms").arg(profile.evaluations).arg(profile.matches)
+               .arg(selectivity, 0, 'f', 2).arg(FilterItemProfile_EstimatedTime(profile) / 1000000.0, 0, 'f', 1);
+}
+
 /***********************************************************************************************************************
 *   ~CFilterItem
 ***********************************************************************************************************************/
@@ -35,24 +50,28 @@ int CFilterItem::Check(QString& string)
         return -1;
     }
 
-    if (m_regexpr) {
-        hs_compile_error_t *compile_err;
+    if (m_expression) {
+        CFilterExpression expression;
+        QString error;
+
+        if (!expression.Parse(m_start_p, m_caseSensitive, &error)) {
+            string = QString("Bad filter expression, %1").arg(error);
+            return -1;
+        }
+    } else if (m_regexpr) {
         hs_database_t *database = nullptr;
+        QRegularExpression *confirm_p = nullptr;
         const unsigned int REGEXP_HYPERSCAN_FLAGS_TEST = (HS_FLAG_DOTALL | HS_FLAG_SINGLEMATCH);
+        QString error;
 
-        if (hs_compile_ext_multi(&m_start_p,
-                                 &REGEXP_HYPERSCAN_FLAGS_TEST,
-                                 nullptr, /*ids*/
-                                 nullptr, /*ext*/
-                                 1, /*elements*/
-                                 HS_MODE_BLOCK, /*mode*/
-                                 nullptr, /*platform*/
-                                 &database,
-                                 &compile_err) != HS_SUCCESS) {
-            string = QString("Bad regexp, %1").arg(compile_err->message);
-            hs_free_compile_error(compile_err);
+        /* Patterns Hyperscan doesn't support are accepted if they can be prefiltered and confirmed with PCRE */
+        if (!RegExpHybrid_Compile(m_start_p, REGEXP_HYPERSCAN_FLAGS_TEST, &database, &confirm_p, &error)) {
+            string = QString("Bad regexp, %1").arg(error);
             return -1;
         }
+
+        hs_free_database(database);
+        delete confirm_p;
     }
 
     return 1;
@@ -76,15 +95,20 @@ namespace FilterMgr
      * these entries in the packedFIR. In that case we first need to establish from where in 
      * the packedFIR we need to start and overwrite existing information.
      * 
+     * summary_p: The rock scroll summary is populated in the same pass, for the rows and packed items being written.
      */
     bool PopulatePackedFIRA(TIA_t& TIA,
                             FIRA_t& FIRA,
                             packed_FIR_t *packedFIR_base_p,
                             CFilterItem **filterItem_LUT_pp,
                             unsigned startIndex,
-                            unsigned startCount)
+                            unsigned startCount,
+                            CRockScrollSummary *summary_p)
     {
         if (FIRA.filterMatches == 0) {
+            if (summary_p != nullptr) {
+                summary_p->Clean();
+            }
             return false;
         }
 
@@ -93,6 +117,9 @@ namespace FilterMgr
         if (packedFIR_base_p == nullptr) {
             TRACEX_E("CLogScrutinizerDoc::CreatePackedFIRA    packedFIRA_p nullptr, out of memory?")
             FIRA.filterMatches = 0;
+            if (summary_p != nullptr) {
+                summary_p->Clean();
+            }
             return false;
         }
 
@@ -111,12 +138,23 @@ namespace FilterMgr
             }
         }
 
+        if (summary_p != nullptr) {
+            summary_p->BeginUpdate(FIR_Array_p, static_cast<int>(startIndex), packedFIR_base_p, packedCount);
+        }
+
         auto packedFIR_p = &packedFIR_base_p[packedCount];
         /* Note: do not pack exclude filters, these are not part of the count of m_database.FIRA.filterMatches */
         const int numOfItems = TIA.rows;
         for (int index = startIndex; index < numOfItems; ++index) {
             uint8_t LUT_Index = FIR_Array_p[index].LUT_index;
+            if ((LUT_Index != 0) && (summary_p != nullptr)) {
+                /* The rock scroll (all rows) also presents exclude matches and bookmarks */
+                summary_p->AddRow(index, LUT_Index);
+            }
             if ((LUT_Index != 0) && !filterItem_LUT_pp[LUT_Index]->m_exclude) {
+                if (summary_p != nullptr) {
+                    summary_p->AddPacked(packedCount, LUT_Index);
+                }
                 packedFIR_p->LUT_index = LUT_Index;
                 packedFIR_p->row = index;
                 if (FIR_Array_p[index].index != packedCount) {
@@ -136,9 +174,16 @@ namespace FilterMgr
                     .arg(packedFIR_p - packedFIR_base_p).arg(FIRA.filterMatches).arg(packedCount))
 #endif
             FIRA.filterMatches = 0;
+            if (summary_p != nullptr) {
+                summary_p->Clean();
+            }
             return false;
         }
 
+        if (summary_p != nullptr) {
+            summary_p->EndUpdate(numOfItems, packedCount);
+        }
+
         return true;
     }
 
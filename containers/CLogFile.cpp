@@ -0,0 +1,559 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "CLogFile.h"
+#include "CDebug.h"
+#include "CMemAccounting.h"
+
+#include <QFileInfo>
+#include <QDateTime>
+
+#include <algorithm>
+#include <string.h>
+
+/***********************************************************************************************************************
+*   ~CLogFile
+***********************************************************************************************************************/
+CLogFile::~CLogFile()
+{
+    ClearSegments();
+}
+
+/***********************************************************************************************************************
+*   open
+***********************************************************************************************************************/
+bool CLogFile::open(OpenMode mode)
+{
+    /* Unbuffered, since all reads are redirected to the segment files the QIODevice buffer would be out of sync */
+    if (!QFile::open(mode | QIODevice::Unbuffered)) {
+        return false;
+    }
+
+    m_live.setFileName(fileName());
+    if (!m_live.open(QIODevice::ReadOnly)) {
+        QFile::close();
+        return false;
+    }
+
+    m_virtualPos = 0;
+    return true;
+}
+
+/***********************************************************************************************************************
+*   close
+***********************************************************************************************************************/
+void CLogFile::close(void)
+{
+    /* Only the live file is closed, the frozen segments stay open until ClearSegments */
+    m_live.close();
+    QFile::close();
+}
+
+/***********************************************************************************************************************
+*   seek
+***********************************************************************************************************************/
+bool CLogFile::seek(qint64 pos)
+{
+    if (pos < 0) {
+        return false;
+    }
+
+    /* Only the logical position is updated, the segment files are positioned at read */
+    if (!QIODevice::seek(pos)) {
+        return false;
+    }
+    m_virtualPos = pos;
+    return true;
+}
+
+/***********************************************************************************************************************
+*   pos
+***********************************************************************************************************************/
+qint64 CLogFile::pos(void) const
+{
+    return m_virtualPos;
+}
+
+/***********************************************************************************************************************
+*   size
+***********************************************************************************************************************/
+qint64 CLogFile::size(void) const
+{
+    if (m_isMerged) {
+        return m_liveOffset;
+    }
+    return m_liveOffset + (m_live.isOpen() ? m_live.size() : QFile::size());
+}
+
+/***********************************************************************************************************************
+*   atEnd
+***********************************************************************************************************************/
+bool CLogFile::atEnd(void) const
+{
+    return m_virtualPos >= size();
+}
+
+/***********************************************************************************************************************
+*   readData
+***********************************************************************************************************************/
+qint64 CLogFile::readData(char *data, qint64 maxSize)
+{
+    qint64 total = 0;
+
+    while (total < maxSize) {
+        QFile *file_p = &m_live;
+        int64_t local = m_virtualPos - m_liveOffset;
+        int64_t toRead = maxSize - total;
+
+        if (m_isMerged) {
+            if (m_virtualPos >= m_liveOffset) {
+                break; /* no live segment */
+            }
+
+            /* The run containing m_virtualPos, i.e. the one before the first run starting after it */
+            const auto next = std::upper_bound(m_mergeRuns.begin(), m_mergeRuns.end(), m_virtualPos,
+                                               [](int64_t pos, const MergeRun_t& run) {return pos < run.offset;});
+            const MergeRun_t& run = *(next - 1);
+            const int64_t end = next != m_mergeRuns.end() ? next->offset : m_liveOffset;
+
+            local = m_virtualPos - run.offset;
+            if (toRead > end - m_virtualPos) {
+                toRead = end - m_virtualPos;
+            }
+
+            if ((run.source < 0) || (m_maps[static_cast<int>(run.source)] != nullptr)) {
+                /* Separator, or memory mapped, copy directly */
+                if (run.source < 0) {
+                    memset(data + total, 0x0a, static_cast<size_t>(toRead));
+                } else {
+                    memcpy(data + total, m_maps[static_cast<int>(run.source)] + run.fileOffset + local,
+                           static_cast<size_t>(toRead));
+                }
+                total += toRead;
+                m_virtualPos += toRead;
+                continue;
+            }
+
+            file_p = m_files[static_cast<int>(run.source)];
+            local += run.fileOffset;
+        } else if (m_virtualPos < m_liveOffset) {
+            /* Find the frozen segment containing m_virtualPos (last segment with offset <= pos) */
+            int low = 0;
+            int high = m_segments.count() - 1;
+            while (low < high) {
+                const int mid = (low + high + 1) / 2;
+                if (m_segments[mid].offset <= m_virtualPos) {
+                    low = mid;
+                } else {
+                    high = mid - 1;
+                }
+            }
+
+            const LogSegment_t& segment = m_segments[low];
+            local = m_virtualPos - segment.offset;
+            if (toRead > segment.size - local) {
+                toRead = segment.size - local;
+            }
+
+            if (segment.map_p != nullptr) {
+                /* Memory mapped, copy directly */
+                memcpy(data + total, segment.map_p + segment.fileOffset + local, static_cast<size_t>(toRead));
+                total += toRead;
+                m_virtualPos += toRead;
+                continue;
+            }
+
+            file_p = segment.file_p;
+            local += segment.fileOffset;
+        }
+
+        if ((toRead <= 0) || !file_p->seek(local)) {
+            break;
+        }
+
+        const qint64 readBytes = file_p->read(data + total, toRead);
+        if (readBytes <= 0) {
+            break;
+        }
+
+        total += readBytes;
+        m_virtualPos += readBytes;
+
+        if (file_p == &m_live) {
+            break; /* live file is the last segment */
+        }
+    }
+
+    return total;
+}
+
+/***********************************************************************************************************************
+*   FreezeLiveSegment
+***********************************************************************************************************************/
+bool CLogFile::FreezeLiveSegment(const QString& rotatedFileName)
+{
+    if (m_isMerged || !AddFrozenSegment(rotatedFileName)) {
+        return false;
+    }
+
+    TRACEX_I(QString("Log file rotated, frozen segment:%1 offset:%2 size:%3")
+                 .arg(rotatedFileName).arg(m_segments.last().offset).arg(m_segments.last().size))
+
+    /* Re-open the live file, the file name now refers to the new log file */
+    if (m_live.isOpen()) {
+        m_live.close();
+        (void)m_live.open(QIODevice::ReadOnly);
+    }
+    return true;
+}
+
+/***********************************************************************************************************************
+*   ClearSegments
+***********************************************************************************************************************/
+void CLogFile::ClearSegments(void)
+{
+    for (auto& map_p : m_maps) {
+        if (map_p != nullptr) {
+            MemAcc_Unmap(MEM_ACC_MERGE_e, map_p);
+        }
+    }
+    for (auto& file_p : m_files) {
+        file_p->close(); /* also unmaps */
+        delete file_p;
+    }
+    m_files.clear();
+    m_maps.clear();
+    m_fileSizes.clear();
+    m_segments.clear();
+    MemAcc_Add(MEM_ACC_MERGE_e, -static_cast<int64_t>(m_mergeRuns.capacity() * sizeof(MergeRun_t)));
+    std::vector<MergeRun_t>().swap(m_mergeRuns);  /* release the memory, clear() keeps it */
+    m_isMerged = false;
+    m_liveOffset = 0;
+    m_virtualPos = 0;
+    m_liveFirstRow = 0;
+}
+
+/***********************************************************************************************************************
+*   ExtendLastFrozenSegment
+***********************************************************************************************************************/
+int64_t CLogFile::ExtendLastFrozenSegment(void)
+{
+    if (m_isMerged || m_segments.isEmpty()) {
+        return 0;
+    }
+
+    LogSegment_t& last = m_segments.last();
+    const int64_t growth = last.file_p->size() - (last.fileOffset + last.size);
+
+    if (growth <= 0) {
+        return 0;
+    }
+
+    TRACEX_I(QString("Frozen log file segment %1 grew %2 bytes after the rotation")
+                 .arg(last.file_p->fileName()).arg(growth))
+
+    last.size += growth;
+    m_liveOffset += growth;
+    return growth;
+}
+
+/***********************************************************************************************************************
+*   AddFrozenSegment
+***********************************************************************************************************************/
+bool CLogFile::AddFrozenSegment(const QString& fileName)
+{
+    auto frozen_p = new QFile(fileName);
+
+    if (!frozen_p->open(QIODevice::ReadOnly)) {
+        TRACEX_QFILE(LOG_LEVEL_WARNING, "Failed to open log file segment", frozen_p)
+        delete frozen_p;
+        return false;
+    }
+
+    LogSegment_t segment = {frozen_p, nullptr, m_liveOffset, frozen_p->size(), 0, m_liveFirstRow};
+    m_files.append(frozen_p);
+    m_maps.append(nullptr);
+    m_fileSizes.append(segment.size);
+    m_segments.append(segment);
+    m_liveOffset += segment.size;
+    return true;
+}
+
+/***********************************************************************************************************************
+*   OpenCopy
+***********************************************************************************************************************/
+bool CLogFile::OpenCopy(const CLogFile& source)
+{
+    close();
+    ClearSegments();
+
+    for (int index = 0; index < source.m_files.count(); ++index) {
+        auto file_p = new QFile(source.m_files[index]->fileName());
+
+        if (!file_p->open(QIODevice::ReadOnly)) {
+            TRACEX_QFILE(LOG_LEVEL_WARNING, "Failed to open log file segment copy", file_p)
+            delete file_p;
+            ClearSegments();
+            return false;
+        }
+
+        /* Mapped as the source, the runs are within that size */
+        const int64_t mapSize = source.m_fileSizes[index];
+        const uchar *map_p = nullptr;
+        if ((source.m_maps[index] != nullptr) && (mapSize > 0) && (file_p->size() >= mapSize)) {
+            map_p = file_p->map(0, mapSize);
+        }
+        if (map_p != nullptr) {
+            MemAcc_Map(MEM_ACC_MERGE_e, map_p, mapSize);
+        }
+
+        m_files.append(file_p);
+        m_maps.append(map_p);
+        m_fileSizes.append(mapSize);
+    }
+
+    for (const auto& segment : source.m_segments) {
+        LogSegment_t copy = segment;
+        const int index = source.m_files.indexOf(segment.file_p);
+
+        copy.file_p = m_files[index];
+        copy.map_p = m_maps[index];
+
+        if (copy.fileOffset + copy.size > copy.file_p->size()) {
+            TRACEX_W(QString("Log file segment %1 changed, copy failed").arg(copy.file_p->fileName()))
+            ClearSegments();
+            return false;
+        }
+        m_segments.append(copy);
+    }
+
+    /* The merge sources are in the same order, the runs refer to them by index */
+    m_mergeRuns = source.m_mergeRuns;
+    MemAcc_Add(MEM_ACC_MERGE_e, static_cast<int64_t>(m_mergeRuns.capacity() * sizeof(MergeRun_t)));
+    for (size_t index = 0; index < m_mergeRuns.size(); ++index) {
+        const MergeRun_t& run = m_mergeRuns[index];
+        const int64_t end = index + 1 < m_mergeRuns.size() ? m_mergeRuns[index + 1].offset : source.m_liveOffset;
+
+        if ((run.source >= 0) && (run.fileOffset + end - run.offset > m_files[static_cast<int>(run.source)]->size())) {
+            TRACEX_W(QString("Merged log file %1 changed, copy failed")
+                         .arg(m_files[static_cast<int>(run.source)]->fileName()))
+            ClearSegments();
+            return false;
+        }
+    }
+
+    m_isMerged = source.m_isMerged;
+    m_liveOffset = source.m_liveOffset;
+    m_liveFirstRow = source.m_liveFirstRow;
+
+    setFileName(source.fileName());
+    if (!open(QIODevice::ReadOnly)) {
+        ClearSegments();
+        return false;
+    }
+    return true;
+}
+
+/***********************************************************************************************************************
+*   GetSegmentFileName
+***********************************************************************************************************************/
+QString CLogFile::GetSegmentFileName(int segment) const
+{
+    if (segment < m_segments.count()) {
+        return m_segments[segment].file_p != nullptr ? m_segments[segment].file_p->fileName() : QString();
+    }
+    return fileName();
+}
+
+/***********************************************************************************************************************
+*   GetSegmentOffset
+***********************************************************************************************************************/
+int64_t CLogFile::GetSegmentOffset(int segment) const
+{
+    return segment < m_segments.count() ? m_segments[segment].offset : m_liveOffset;
+}
+
+/***********************************************************************************************************************
+*   GetSegmentSize
+***********************************************************************************************************************/
+int64_t CLogFile::GetSegmentSize(int segment) const
+{
+    return segment < m_segments.count() ? m_segments[segment].size : size() - m_liveOffset;
+}
+
+/***********************************************************************************************************************
+*   SetSegmentFirstRow
+***********************************************************************************************************************/
+void CLogFile::SetSegmentFirstRow(int segment, int firstRow)
+{
+    if (segment < m_segments.count()) {
+        m_segments[segment].firstRow = firstRow;
+    } else {
+        m_liveFirstRow = firstRow;
+    }
+}
+
+/***********************************************************************************************************************
+*   GetSegmentFromRow
+***********************************************************************************************************************/
+int CLogFile::GetSegmentFromRow(int row, int *localRow_p) const
+{
+    int segment = m_segments.count();
+    int firstRow = m_liveFirstRow;
+
+    if (row < m_liveFirstRow) {
+        /* Last frozen segment with firstRow <= row */
+        int low = 0;
+        int high = m_segments.count() - 1;
+        while (low < high) {
+            const int mid = (low + high + 1) / 2;
+            if (m_segments[mid].firstRow <= row) {
+                low = mid;
+            } else {
+                high = mid - 1;
+            }
+        }
+        segment = low;
+        firstRow = m_segments[low].firstRow;
+    }
+
+    if (localRow_p != nullptr) {
+        *localRow_p = row - firstRow;
+    }
+    return segment;
+}
+
+/***********************************************************************************************************************
+*   SortRotatedFileNames
+***********************************************************************************************************************/
+void CLogFile::SortRotatedFileNames(QStringList& fileNames)
+{
+    /* Rotation number, name.N -> N, otherwise 0 (the live file) */
+    auto rotation = [](const QString& name) {
+        bool ok = false;
+        const int number = QFileInfo(name).suffix().toInt(&ok);
+        return ok ? number : 0;
+    };
+
+    std::stable_sort(fileNames.begin(), fileNames.end(), [&rotation](const QString& a, const QString& b) {
+        const int rotation_a = rotation(a);
+        const int rotation_b = rotation(b);
+        if (rotation_a != rotation_b) {
+            return rotation_a > rotation_b;    /* Higher rotation number is older */
+        }
+        return QFileInfo(a).lastModified() < QFileInfo(b).lastModified();
+    });
+}
+
+/***********************************************************************************************************************
+*   IsRotatedSet
+***********************************************************************************************************************/
+bool CLogFile::IsRotatedSet(const QStringList& fileNames)
+{
+    if (fileNames.count() < 2) {
+        return false;
+    }
+
+    /* The live file has the shortest name, the rotated files are named after it */
+    QString liveName = QFileInfo(fileNames.first()).fileName();
+    for (auto& fileName : fileNames) {
+        const QString name = QFileInfo(fileName).fileName();
+        if (name.length() < liveName.length()) {
+            liveName = name;
+        }
+    }
+
+    const QString dir = QFileInfo(fileNames.first()).absolutePath();
+    int numOfLive = 0;
+
+    for (auto& fileName : fileNames) {
+        const QFileInfo fileInfo(fileName);
+        const QString name = fileInfo.fileName();
+
+        if (fileInfo.absolutePath() != dir) {
+            return false;
+        }
+
+        if (name == liveName) {
+            ++numOfLive;
+            continue;
+        }
+
+        /* name.N or name-YYYYMMDD */
+        const QString rotation = name.mid(liveName.length());
+        if (!name.startsWith(liveName) || (rotation.length() < 2) ||
+            ((rotation[0] != QChar('.')) && (rotation[0] != QChar('-')))) {
+            return false;
+        }
+
+        bool isNumber = false;
+        (void)rotation.mid(1).toLongLong(&isNumber);
+        if (!isNumber) {
+            return false;
+        }
+    }
+    return numOfLive == 1;
+}
+
+/***********************************************************************************************************************
+*   SetMerged
+***********************************************************************************************************************/
+void CLogFile::SetMerged(void)
+{
+    ClearSegments();
+    m_isMerged = true;
+}
+
+/***********************************************************************************************************************
+*   AddMergeSource
+***********************************************************************************************************************/
+int CLogFile::AddMergeSource(const QString& fileName)
+{
+    auto source_p = new QFile(fileName);
+
+    if (!source_p->open(QIODevice::ReadOnly)) {
+        TRACEX_QFILE(LOG_LEVEL_WARNING, "Failed to open log file to merge", source_p)
+        delete source_p;
+        return -1;
+    }
+
+    /* The runs are typically small and spread out, memory mapped they are copied without any seek/read. If mapping
+     * fails the runs are read through the file */
+    const int64_t size = source_p->size();
+    const uchar *map_p = size > 0 ? source_p->map(0, size) : nullptr;
+    if (map_p != nullptr) {
+        MemAcc_Map(MEM_ACC_MERGE_e, map_p, size);
+    }
+
+    m_files.append(source_p);
+    m_maps.append(map_p);
+    m_fileSizes.append(size);
+    return m_files.count() - 1;
+}
+
+/***********************************************************************************************************************
+*   AddMergeRun
+***********************************************************************************************************************/
+void CLogFile::AddMergeRun(int source, int64_t fileOffset, int64_t size)
+{
+    if (!m_mergeRuns.empty() && (source >= 0)) {
+        const MergeRun_t& last = m_mergeRuns.back();
+        if ((last.source == source) && (last.fileOffset + (m_liveOffset - last.offset) == fileOffset)) {
+            m_liveOffset += size;  /* continues the previous run */
+            return;
+        }
+    }
+
+    MergeRun_t run;
+    run.offset = m_liveOffset;
+    run.fileOffset = fileOffset;
+    run.source = source;
+    const size_t capacity = m_mergeRuns.capacity();
+    m_mergeRuns.push_back(run);
+    if (m_mergeRuns.capacity() != capacity) {
+        MemAcc_Add(MEM_ACC_MERGE_e, static_cast<int64_t>((m_mergeRuns.capacity() - capacity) * sizeof(MergeRun_t)));
+    }
+    m_liveOffset += size;
+}
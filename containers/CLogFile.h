@@ -0,0 +1,127 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/***********************************************************************************************************************
+*   CLogFile
+*
+*   The log file as seen by the TIA, the row cache and the file processing, i.e. a virtual byte space built from
+*   segments. The last segment is the live log file (the one being tracked), earlier segments are frozen files, e.g.
+*   the content of a log file that was rotated away while being tracked. The TIA fileIndex values are offsets in the
+*   virtual byte space.
+*
+*   The frozen segments are kept open, such that they can be read even if the rotated file is renamed again. Without
+*   frozen segments the log file behaves as a plain QFile.
+*
+*   A set of rotated log files (e.g. service.log.40 ... service.log.1, service.log) may also be opened as one virtual
+*   log, the older files are then added as frozen segments in front of the live file. Each segment remembers the first
+*   (global) row it contains, giving the row -> (segment, local row) mapping.
+*
+*   A set of log files may also be merged by timestamp. Then the virtual byte space is built from runs of rows from the
+*   source files, in merged order, without any copying of the text. A merged log has no live segment, and no frozen
+*   segments, the runs are kept in a compact table of their own since interleaved logs may give a run per row.
+*
+*   Note: The device is always opened unbuffered, seek/read are translated to the segment files.
+***********************************************************************************************************************/
+class CLogFile : public QFile
+{
+public:
+    CLogFile() : QFile() {}
+    virtual ~CLogFile() override;
+
+    virtual bool open(OpenMode mode) override;
+    virtual void close(void) override;
+    virtual bool seek(qint64 pos) override;
+    virtual qint64 pos(void) const override;
+    virtual qint64 size(void) const override;
+    virtual bool atEnd(void) const override;
+
+    /* The live segment content is continued in rotatedFileName (renamed away, or copied before the live file was
+     * truncated). The rotated file becomes a frozen segment and a new, empty, live segment is started. */
+    bool FreezeLiveSegment(const QString& rotatedFileName);
+    void ClearSegments(void);
+
+    /* The rotated file may still be appended to, by a writer holding it open since before the rotation. The last
+     * frozen segment is extended with what has been appended since it was frozen, and the live segment is moved as
+     * much. Returns the number of bytes added */
+    int64_t ExtendLastFrozenSegment(void);
+
+    /* Append fileName as a frozen segment, placed before the live file. Used when opening a set of log files */
+    bool AddFrozenSegment(const QString& fileName);
+
+    /* Segment access, the segment with index GetNumOfFrozenSegments() is the live file */
+    int GetNumOfSegments(void) const {return m_segments.count() + 1;}
+    QString GetSegmentFileName(int segment) const;
+    int64_t GetSegmentOffset(int segment) const;
+    int64_t GetSegmentSize(int segment) const;
+
+    /* Row mapping, set when the TIA has been created (or extended over a rotation) */
+    void SetSegmentFirstRow(int segment, int firstRow);
+    int GetSegmentFromRow(int row, int *localRow_p = nullptr) const;
+
+    /* Sort rotated log file names oldest first, i.e. name.N ... name.2, name.1, name. Files not following the
+     * rotation naming are sorted by modification time */
+    static void SortRotatedFileNames(QStringList& fileNames);
+
+    /* True if the files are one log file and rotations of it, i.e. name, name.N or name-YYYYMMDD, in one directory */
+    static bool IsRotatedSet(const QStringList& fileNames);
+
+    /* Merged log. The sources are opened (and memory mapped) first, then the runs are appended in virtual offset
+     * order. A run with source -1 is a LF separator, used after a last row not ending with a LF */
+    void SetMerged(void);
+    bool IsMerged(void) const {return m_isMerged;}
+    int AddMergeSource(const QString& fileName);  /* Returns the source index, -1 at failure */
+    int64_t GetMergeSourceSize(int source) const {return m_fileSizes[source];} /* Size when opened and mapped */
+    void AddMergeRun(int source, int64_t fileOffset, int64_t size);
+    int GetNumOfMergeSources(void) const {return m_isMerged ? m_files.count() : 0;}
+
+    /* Open this log file as a separate, read-only, handle to the same virtual log as source. The segment files are
+     * re-opened, such that it may be read from another thread than the source. Fails if a segment file has been
+     * renamed or truncated since the source opened it. */
+    bool OpenCopy(const CLogFile& source);
+
+    /* Virtual offset where the live file starts */
+    int64_t GetLiveOffset(void) const {return m_liveOffset;}
+    int GetNumOfFrozenSegments(void) const {return m_segments.count();}
+
+protected:
+    virtual qint64 readData(char *data, qint64 maxSize) override;
+
+private:
+    typedef struct {
+        QFile *file_p;
+        const uchar *map_p;  /* Memory mapped content of file_p, nullptr if read through file_p */
+        int64_t offset;      /* Virtual offset of the first byte in the segment */
+        int64_t size;
+        int64_t fileOffset;  /* Where in file_p the segment starts */
+        int firstRow;        /* Global row index of the first row in the segment */
+    } LogSegment_t;
+
+    /* 16 bytes, the run ends where the next run starts (the last at m_liveOffset) */
+    typedef struct {
+        int64_t offset;           /* Virtual offset of the first byte in the run */
+        int64_t fileOffset : 48;  /* Where in the source file the run starts */
+        int64_t source : 16;      /* Index into m_files, -1 for a LF separator */
+    } MergeRun_t;
+
+    QVector<LogSegment_t> m_segments;  /* Frozen segments, in virtual offset order */
+    std::vector<MergeRun_t> m_mergeRuns;  /* Merged log, in virtual offset order */
+    QVector<QFile *> m_files;          /* The files referenced by the segments, or the merge sources */
+    QVector<const uchar *> m_maps;     /* Memory mapped file content, per m_files entry */
+    QVector<int64_t> m_fileSizes;      /* Size of each m_files entry when opened, the mapped size */
+    bool m_isMerged = false;
+    QFile m_live;  /* Separate handle for reading the live file, the QFile base is only positioned virtually */
+    int64_t m_liveOffset = 0;
+    int64_t m_virtualPos = 0;
+    int m_liveFirstRow = 0;
+};
@@ -4,6 +4,7 @@
 ***********************************************************************************************************************/
 
 #include <memory>
+#include <algorithm>
 #include "CLogScrutinizerDoc.h"
 #include "CProgressDlg.h"
 #include "CProgressCtrl.h"
@@ -32,8 +33,6 @@
 #include <QMessageBox>
 #include <QProcessEnvironment>
 
-const int NUM_ROWS_TO_CHECK = 10;
-const int NUM_TAIL_ROWS_TO_CHECK = 10;
 const int NUM_TAIL_ROWS_TO_RELOAD = 1; /* We only reload the last line, never more, otherwise it is not incremental. */
 static CLogScrutinizerDoc *theDoc_p = nullptr;
 CLogScrutinizerDoc *GetTheDoc(void) {return theDoc_p;}
@@ -90,13 +89,20 @@ CLogScrutinizerDoc::CLogScrutinizerDoc()
 
     InitializeFilterItem_LUT();
 
-    connect(&m_fileSysWatcher, SIGNAL(fileChanged(QString)), this, SLOT(logFileUpdated(QString)));
+    connect(&m_fileSysWatcher, SIGNAL(fileChanged(QString)), this, SLOT(logFileChanged(QString)));
     connect(&m_fileSysWatcher, SIGNAL(directoryChanged(QString)), this, SLOT(logFileDirUpdated(QString)));
 
     m_fileChangeTimer = std::make_unique<QTimer>(this);
 
     connect(m_fileChangeTimer.get(), SIGNAL(timeout()), this, SLOT(onFileChangeTimer()));
 
+    m_tailTimer = std::make_unique<QTimer>(this);
+    m_tailTimer->setSingleShot(true);
+
+    connect(m_tailTimer.get(), SIGNAL(timeout()), this, SLOT(onTailTimer()));
+    connect(&m_tailWatcher, SIGNAL(fileAppended()), this, SLOT(onTailAppended()));
+    connect(&m_tailWatcher, SIGNAL(fileReplaced()), this, SLOT(onTailReplaced()));
+
     TRACEX_I("Cache pool size: %lldMB", (m_memPool.GetTotalSize() >> 10))
 
     theDoc_p = this;
@@ -112,52 +118,26 @@ ReloadStrategy_e CLogScrutinizerDoc::decideReloadStrategy(size_t size, QTime las
         return RS_Full; // If the file has shrunk, full reload
     }
 
-    if ((m_logFileLastChanged.time() == lastModified) &&
-        (m_database.fileSize == size)) {
+    if ((m_logFileLastChanged.time() == lastModified) && (IndexedLiveFileSize() == static_cast<int64_t>(size))) {
         return RS_Skip;
     }
 
-    char text_p[1];
-    TI_t *ti_p = &m_database.TIA.textItemArray_p[0];
+    if (m_qFile_Log.IsMerged()) {
+        return RS_Full; /* New rows needs to be merged, not appended */
+    }
 
-    /* Check that some of the existing rows hasn't been changed (else RS_Full)
+    /* Check that the last indexed block, just before the row(s) that will be reloaded, hasn't been changed (else RS_Full).
+     * A log being appended to never touches this part, a log being re-written (or replaced) almost certainly does.
      * Note: Only last line, NUM_TAIL_ROWS_TO_RELOAD (1), will be reloaded */
-    const auto lastIndex = m_database.TIA.rows - NUM_TAIL_ROWS_TO_CHECK;
-
-    /* (1) Check tail of (10) last rows, exluding the last that will be reloaded */
-    auto index = lastIndex - NUM_TAIL_ROWS_TO_CHECK - NUM_TAIL_ROWS_TO_RELOAD;
-    index = index < 0 ? 0 : index;
-
-    for ( ; index < lastIndex; index++) {
-        const auto eol_size = ti_p[index].size;
-        if (!m_rowCache_p->rawFromFile(ti_p[index].fileIndex + eol_size,
-                                       1, /* one byte for End Of Line check */
-                                       text_p)) {
-            return RS_Full;
-        }
-
-        /* Check the eol marker */
-        if ((*text_p != 0x0a) && (*text_p != 0x0d)) {
-            return RS_Full;
-        }
+    uint32_t checksum;
+    if (!m_tailChecksumValid ||
+        !CTailWatcher::BlockChecksum(m_qFile_Log, m_tailChecksumStart, m_tailChecksumSize, &checksum)) {
+        return RS_Full;
     }
 
-    /* (2) Check some rows spread across the file
-     * Pick X spread points in log file and verify TIA against line endings */
-    auto rowDeltaSpread = m_database.TIA.rows / NUM_ROWS_TO_CHECK;
-    for (auto index = 0; index < NUM_ROWS_TO_CHECK; index++) {
-        const auto ti_index = index * rowDeltaSpread;
-        const auto eol_size = ti_p[ti_index].size;
-        if (!m_rowCache_p->rawFromFile(ti_p[ti_index].fileIndex + eol_size,
-                                       1, /* one byte for End Of Line check */
-                                       text_p)) {
-            return RS_Full;
-        }
-
-        /* Check the eol marker */
-        if ((*text_p != 0x0a) && (*text_p != 0x0d)) {
-            return RS_Full;
-        }
+    if (checksum != m_tailChecksum) {
+        PRINT_FILE_TRACKING(QString("Tail checksum mismatch %1 -> %2").arg(m_tailChecksum).arg(checksum))
+        return RS_Full;
     }
 
     return RS_Incremental;
@@ -236,6 +216,15 @@ void CLogScrutinizerDoc::logFileUpdated(const QString &path, bool useSavedReload
                 m_savedReloadStrategy = RS_Skip;
             }
 
+            /* A rotated (renamed, or copied and truncated) log file is kept as a frozen segment, and the new log file
+             * is loaded incrementally as a new segment */
+            bool rotated = false;
+            if ((reloadStrategy == RS_Full) && m_logFileTrackingEnabled && RotateLogFile()) {
+                PRINT_FILE_TRACKING(QString("Log file rotated, incremental load of new segment"))
+                reloadStrategy = RS_Incremental;
+                rotated = true;
+            }
+
             if (reloadStrategy == RS_Skip) {
                 PRINT_FILE_TRACKING(QString("RS_Skip"))
                 if (forceUIUpdate) {
@@ -247,6 +236,10 @@ void CLogScrutinizerDoc::logFileUpdated(const QString &path, bool useSavedReload
             if (reloadStrategy == RS_Incremental) {
                 if (loadAndFilterLogIncrement()) {
                     PRINT_FILE_TRACKING(QString("RS_Incremental"))
+                    if (rotated) {
+                        /* The watches are still on the rotated file */
+                        replaceFileSysWatcherFile(m_Log_FileName);
+                    }
                     m_logFileLastChanged = fileInfo.lastModified();
                     m_logFileSize = fileInfo.size();
 
@@ -257,6 +250,11 @@ void CLogScrutinizerDoc::logFileUpdated(const QString &path, bool useSavedReload
                 }
             }
         } else {
+            if (!fileInfo.exists() && m_logFileTrackingEnabled) {
+                /* Most likely log rotation, the log file is (re-)created soon, then loaded as a new segment */
+                PRINT_FILE_TRACKING(QString("Log file missing while tracking, wait"))
+                return;
+            }
             TRACEX_W(QString("Failed to reopen log file at file validation"))
         }
 
@@ -282,16 +280,52 @@ bool CLogScrutinizerDoc::loadAndFilterLogIncrement(void)
 
     CSZ_DB_PendingUpdate = true;
 
+    m_incrementalSearch.Reset(); /* The TIA is re-mapped */
+    m_matchEstimator.Reset();
+
     assert(m_incrementalWorkMem.GetRef() != nullptr);
     assert(m_incrementalWorkMem.GetSize() > 0);
 
     if (m_incrementalWorkMem.GetRef() != nullptr) {
         CFileCtrl fileCtrl;
-        int rows_added;
+        int rows_added = 0;
+
+        fileCtrl.SetBlockSummary(&m_blockSummary); /* Extended if it was built at the load */
 
         /* Start from the last row in the database, as this line might have been changed as well. */
         int32_t fromRowIndex = m_database.TIA.rows - NUM_TAIL_ROWS_TO_RELOAD;
         int64_t fromFileIndex = m_database.TIA.textItemArray_p[fromRowIndex].fileIndex;
+
+        /* The first row at (or after) a file index, the TIs never stretch over a segment border */
+        auto firstRowAt = [this] (int64_t fileIndex) {
+            const TI_t *TIA_p = m_database.TIA.textItemArray_p;
+            const TI_t *first_p = std::lower_bound(TIA_p, TIA_p + m_database.TIA.rows, fileIndex,
+                                                   [](const TI_t& TI, int64_t value) {return TI.fileIndex < value;});
+            return static_cast<int>(first_p - TIA_p);
+        };
+
+        /* A writer still holding the rotated log file open may have appended to it after it was frozen. The growth
+         * is added to the frozen segment, which moves the live segment, hence the live rows are indexed again from
+         * the last row of the frozen segment */
+        const int64_t liveOffset = m_qFile_Log.GetLiveOffset();
+        const int64_t growth = m_qFile_Log.ExtendLastFrozenSegment();
+        const int oldLiveFirstRow = growth > 0 ? firstRowAt(liveOffset) : 0;
+        const int64_t indexedEnd = m_database.fileSize + growth; /* Where the rows indexed so far ends, moved */
+
+        if (growth > 0) {
+            /* Check before the TIA is rewritten that all the rows that moved can be indexed again, the live log file
+             * shall not have been truncated */
+            if (m_qFile_Log.size() < indexedEnd) {
+                PRINT_FILE_TRACKING(QString("Live log file shorter than indexed, size:%1 indexed:%2")
+                                        .arg(m_qFile_Log.size()).arg(indexedEnd))
+                return false;
+            }
+            if ((oldLiveFirstRow > 0) && (oldLiveFirstRow - 1 < fromRowIndex)) {
+                fromRowIndex = oldLiveFirstRow - 1;
+                fromFileIndex = m_database.TIA.textItemArray_p[fromRowIndex].fileIndex;
+            }
+            m_searchIndex.Close(); /* The rows moved, the index is checked against the TIA when opened again */
+        }
         int64_t fileSize = 0;
         const auto oldNumRows = m_database.TIA.rows;
 
@@ -311,11 +345,21 @@ bool CLogScrutinizerDoc::loadAndFilterLogIncrement(void)
             }
         }
 
-        /* Incrementally add to the TIA file */
-        if (!fileCtrl.Search_TIA_Incremental(m_qFile_Log, m_TIA_FileName, m_incrementalWorkMem.GetRef(), m_incrementalWorkMem.GetSize(),
-            fromFileIndex, fromRowIndex, &rows_added)) {
-            return false;
-        }
+        /* Incrementally add to the TIA file. An increment larger than the work memory is indexed in batches, normally
+         * one batch per load. The rows that moved with the frozen segment must all be indexed again though, else the
+         * rows would be fewer than before, hence batches are added until the previous end is reached. */
+        int64_t batchStart = fromFileIndex;
+        int64_t batchEnd = fromFileIndex;
+        int batchRows = 0;
+        do {
+            if (!fileCtrl.Search_TIA_Incremental(m_qFile_Log, m_TIA_FileName, m_incrementalWorkMem.GetRef(),
+                                                 m_incrementalWorkMem.GetSize(), batchStart, fromRowIndex + rows_added,
+                                                 &batchRows, &batchEnd)) {
+                return false;
+            }
+            rows_added += batchRows;
+            batchStart = batchEnd;
+        } while ((growth > 0) && (batchEnd < indexedEnd) && (batchRows > 0));
 
         m_database.TIA.rows = 0;
 
@@ -331,7 +375,14 @@ bool CLogScrutinizerDoc::loadAndFilterLogIncrement(void)
                 m_rowCache_p->Update(&m_qFile_Log, &m_database.TIA, &m_database.FIRA, m_database.filterItem_LUT, m_memPool);
                 m_database.fileSize = fileSize;
 
+                if (growth > 0) {
+                    ShiftRowReferences(oldLiveFirstRow, oldNumRows, firstRowAt(m_qFile_Log.GetLiveOffset()) -
+                                       oldLiveFirstRow);
+                }
+
                 ExecuteIncrementalFiltering(fromRowIndex);
+                UpdateTailChecksum();
+                UpdateSegmentRows();
 
                 CSZ_DB_PendingUpdate = false;
 
@@ -348,6 +399,206 @@ bool CLogScrutinizerDoc::loadAndFilterLogIncrement(void)
     return false;
 }
 
+/***********************************************************************************************************************
+*   UpdateTailChecksum
+***********************************************************************************************************************/
+void CLogScrutinizerDoc::UpdateTailChecksum(void)
+{
+    m_tailChecksumValid = false;
+    m_logFileIdValid = false;
+
+    if ((m_database.TIA.rows <= NUM_TAIL_ROWS_TO_RELOAD) || (m_database.TIA.textItemArray_p == nullptr) ||
+        !m_qFile_Log.isOpen()) {
+        return;
+    }
+
+    /* The block ends where the row(s) that are always reloaded starts, and is kept within the live log file. Right
+     * after a rotation the block might be empty, any content of the new log file is then accepted. */
+    const int64_t liveOffset = m_qFile_Log.GetLiveOffset();
+    int64_t end = m_database.TIA.textItemArray_p[m_database.TIA.rows - NUM_TAIL_ROWS_TO_RELOAD].fileIndex;
+    end = end < liveOffset ? liveOffset : end;
+
+    int64_t start = end > TAIL_CHECKSUM_BLOCK_SIZE ? end - TAIL_CHECKSUM_BLOCK_SIZE : 0;
+    start = start < liveOffset ? liveOffset : start;
+
+    const int64_t headSize = end - liveOffset > TAIL_CHECKSUM_BLOCK_SIZE ? TAIL_CHECKSUM_BLOCK_SIZE : end - liveOffset;
+
+    if (CTailWatcher::BlockChecksum(m_qFile_Log, start, end - start, &m_tailChecksum) &&
+        CTailWatcher::BlockChecksum(m_qFile_Log, liveOffset, headSize, &m_headChecksum)) {
+        m_tailChecksumStart = start;
+        m_tailChecksumSize = end - start;
+        m_headChecksumSize = headSize;
+        m_tailChecksumValid = true;
+    }
+
+    m_logFileIdValid = CTailWatcher::FileId(m_Log_FileName, &m_logFileId);
+}
+
+/***********************************************************************************************************************
+*   IndexedLiveFileSize
+***********************************************************************************************************************/
+int64_t CLogScrutinizerDoc::IndexedLiveFileSize(void)
+{
+    /* m_database.fileSize is the (virtual) size indexed. For a merged log the live log file is one of the merge sources,
+     * and the size it had when merged is the size when the file watch was setup */
+    if (m_qFile_Log.IsMerged()) {
+        return static_cast<int64_t>(m_logFileSize);
+    }
+    return m_database.fileSize - m_qFile_Log.GetLiveOffset();
+}
+
+/***********************************************************************************************************************
+*   RotateLogFile
+***********************************************************************************************************************/
+bool CLogScrutinizerDoc::RotateLogFile(void)
+{
+    /* Look for the content of the live log file among the rotated files next to it, e.g. service.log.1 or
+     * service.log-20190101. The rotated file shall contain at least what has been indexed so far, and the block
+     * check-summed at the last load shall be identical. Then the indexed rows are still valid, and only the remaining
+     * part of the rotated file and the new log file needs to be indexed.
+     * A renamed log file keeps its identity, then only that file is accepted. If the log file still has its identity
+     * it was copied and truncated, the copy is then accepted if both the first and the last indexed block match. That
+     * rules out other files next to the log, e.g. compressed or backup copies made earlier. */
+    if (!m_tailChecksumValid || (m_database.TIA.rows == 0) || m_qFile_Log.IsMerged()) {
+        return false;
+    }
+
+    m_incrementalSearch.Reset();
+    m_matchEstimator.Reset();
+
+    const int64_t liveOffset = m_qFile_Log.GetLiveOffset();
+    const int64_t indexedSize = m_database.fileSize - liveOffset;
+    QFileInfo logInfo(m_Log_FileName);
+    QDir dir = logInfo.absoluteDir();
+    uint64_t liveId = 0;
+    const bool truncated = m_logFileIdValid && CTailWatcher::FileId(m_Log_FileName, &liveId) &&
+                           (liveId == m_logFileId);
+    const QStringList candidates = dir.entryList(QStringList() << logInfo.fileName() + ".*" << logInfo.fileName() + "-*",
+                                                 QDir::Files, QDir::Time /* most recent first */);
+
+    for (auto& name : candidates) {
+        const QString candidateName = dir.absoluteFilePath(name);
+        if ((candidateName == m_TIA_FileName) || (candidateName == m_FIRA_FileName)) {
+            continue;
+        }
+
+        uint64_t candidateId = 0;
+        if (m_logFileIdValid && !truncated &&
+            (!CTailWatcher::FileId(candidateName, &candidateId) || (candidateId != m_logFileId))) {
+            continue;
+        }
+
+        QFile candidate(candidateName);
+        if (!candidate.open(QIODevice::ReadOnly) || (candidate.size() < indexedSize)) {
+            continue;
+        }
+
+        uint32_t checksum;
+        uint32_t headChecksum;
+        if (CTailWatcher::BlockChecksum(candidate, m_tailChecksumStart - liveOffset, m_tailChecksumSize, &checksum) &&
+            (checksum == m_tailChecksum) &&
+            CTailWatcher::BlockChecksum(candidate, 0, m_headChecksumSize, &headChecksum) &&
+            (headChecksum == m_headChecksum)) {
+            candidate.close();
+            if (m_qFile_Log.FreezeLiveSegment(candidateName)) {
+                m_logFileSize = 0; /* new live log file */
+                return true;
+            }
+        }
+    }
+
+    PRINT_FILE_TRACKING(QString("No rotated log file found for %1").arg(m_Log_FileName))
+    return false;
+}
+
+/***********************************************************************************************************************
+*   logFileChanged
+***********************************************************************************************************************/
+void CLogScrutinizerDoc::logFileChanged(const QString &path)
+{
+    /* When the tail watcher is active it is the primary source of log file changes, the file system watcher event is
+     * then just folded into the scheduled tail update */
+    if (m_tailWatcher.isActive() && (path == m_Log_FileName)) {
+        ScheduleTailUpdate();
+        return;
+    }
+    logFileUpdated(path);
+}
+
+/***********************************************************************************************************************
+*   onTailAppended
+***********************************************************************************************************************/
+void CLogScrutinizerDoc::onTailAppended(void)
+{
+    ScheduleTailUpdate();
+}
+
+/***********************************************************************************************************************
+*   onTailReplaced
+***********************************************************************************************************************/
+void CLogScrutinizerDoc::onTailReplaced(void)
+{
+    /* The watched file was moved or removed, the watch is re-established when the file is reloaded
+     * (replaceFileSysWatcherFile), or below when the update didn't reload it */
+    PRINT_FILE_TRACKING(QString("Tail watcher, log file replaced: %1").arg(m_Log_FileName))
+    m_tailWatcher.Stop();
+    m_tailTimer->stop();
+
+    if (!QFileInfo::exists(m_Log_FileName)) {
+        /* Renamed by log rotation, the directory watch triggers the update when the new log file is created */
+        return;
+    }
+    logFileUpdated(m_Log_FileName);
+
+    if (m_logFileTrackingEnabled && !m_tailWatcher.isActive() && QFileInfo::exists(m_Log_FileName)) {
+        (void)m_tailWatcher.Start(m_Log_FileName);
+    }
+}
+
+/***********************************************************************************************************************
+*   ScheduleTailUpdate
+***********************************************************************************************************************/
+void CLogScrutinizerDoc::ScheduleTailUpdate(void)
+{
+    if (!m_logFileTrackingEnabled || m_tailTimer->isActive()) {
+        /* Already scheduled, the pending update will read everything appended until then */
+        return;
+    }
+
+    /* The first append after a quiet period is loaded right away, following appends are collapsed into one update per
+     * max latency period. */
+    int64_t delay = 0;
+    if (m_tailLastUpdate.isValid()) {
+        const int64_t elapsed = m_tailLastUpdate.elapsed();
+        delay = elapsed >= g_cfg_p->m_logFileTrackingMaxLatency ? 0 : g_cfg_p->m_logFileTrackingMaxLatency - elapsed;
+    }
+    m_tailTimer->start(static_cast<int>(delay));
+}
+
+/***********************************************************************************************************************
+*   onTailTimer
+***********************************************************************************************************************/
+void CLogScrutinizerDoc::onTailTimer(void)
+{
+    if (CSZ_DB_PendingUpdate) {
+        m_tailTimer->start(g_cfg_p->m_logFileTrackingMaxLatency);
+        return;
+    }
+
+    const int64_t prevFileSize = m_database.fileSize;
+
+    logFileUpdated(m_Log_FileName);
+    m_tailLastUpdate.restart();
+
+    /* Large increments are loaded in bounded batches (size of the incremental work memory), continue with the next
+     * batch as long as there is progress. Going through the event loop gives the UI a chance to repaint in-between. */
+    QFileInfo fileInfo(m_Log_FileName);
+    fileInfo.setCaching(false);
+    if ((m_database.fileSize > prevFileSize) && (fileInfo.size() > IndexedLiveFileSize())) {
+        m_tailTimer->start(0);
+    }
+}
+
 /***********************************************************************************************************************
 *   logFileDirUpdated
 ***********************************************************************************************************************/
@@ -392,6 +643,13 @@ void CLogScrutinizerDoc::logFileDirUpdated(const QString &path)
 
             PRINT_FILE_TRACKING(QString("Log file (dir) modified: %1").arg(path))
 
+            if (!fileInfo.exists() && m_logFileTrackingEnabled) {
+                /* Most likely log rotation, wait for the new log file to be created */
+                PRINT_FILE_TRACKING(QString("Log file removed while tracking, waiting for it to re-appear: %1")
+                                        .arg(path))
+                return;
+            }
+
             if (!fileInfo.exists()) {
                 TRACEX_W(QString("Log file removed: %1").arg(path))
 
@@ -439,7 +697,7 @@ void CLogScrutinizerDoc::onFileChangeTimer(void)
 
     if (!fileInfo.exists() ||
         (m_logFileLastChanged.time() != fileInfo.lastModified().time()) ||
-        (fileInfo.size() != m_database.fileSize)) {
+        (fileInfo.size() != IndexedLiveFileSize())) {
         PRINT_FILE_TRACKING(QString("onFileChangeTimer %1 %2 size:%3 %4")
                                 .arg(m_logFileLastChanged.time().toString())
                                 .arg(fileInfo.lastModified().time().toString())
@@ -470,9 +728,14 @@ void CLogScrutinizerDoc::enableLogFileTracking(bool enable)
             logFileUpdated(m_Log_FileName, true /* Apply save reload strategy */, true /*force UE update */);
             m_fileChangeTimer.get()->start(FILE_CHANGE_TIMER_DURATION);
 
+            if (!m_tailWatcher.isActive() && !m_Log_FileName.isEmpty()) {
+                (void)m_tailWatcher.Start(m_Log_FileName);
+            }
         } else {
             m_savedReloadStrategy = RS_Skip;
             m_fileChangeTimer.get()->stop();
+            m_tailWatcher.Stop();
+            m_tailTimer->stop();
             m_incrementalWorkMem.Operation(WORK_MEM_OPERATION_FREE);
             m_logFileTrackingEnabled = enable;
         }
@@ -495,6 +758,16 @@ void CLogScrutinizerDoc::CleanDB(bool reload, bool unloadFilters)
     m_fileChangeTimer.get()->stop();
     m_logFileLastChanged = QDateTime();
 
+    m_tailWatcher.Stop();
+    m_tailTimer->stop();
+    m_tailChecksumValid = false;
+
+    m_searchIndex.Close();
+    m_blockSummary.Clear();
+    m_searchResults.Clear();
+    m_incrementalSearch.Reset();
+    m_matchEstimator.Reset();
+
     /* Remove the files being watched */
     if (!m_fileSysWatcher.files().isEmpty()) {
         m_fileSysWatcher.removePaths(m_fileSysWatcher.files());
@@ -517,10 +790,13 @@ void CLogScrutinizerDoc::CleanDB(bool reload, bool unloadFilters)
         m_database.FIRA.FIR_Array_p = nullptr;
     }
 
+    m_rockScrollSummary.Clean();
+
     if (m_qFile_Log.isOpen()) {
         TRACEX_I("Closed Log file: %s", m_qFile_Log.fileName().toLatin1().constData())
         m_qFile_Log.close();
     }
+    m_qFile_Log.ClearSegments();
 
     if (m_inDestructor) {
         return;
@@ -529,6 +805,7 @@ void CLogScrutinizerDoc::CleanDB(bool reload, bool unloadFilters)
     m_Log_FileName = "";
     m_TIA_FileName = "";
     m_FIRA_FileName = "";
+    m_searchIndex_FileName = "";
 
     if (m_database.packedFIRA_p != nullptr) {
         VirtualMem::Free(m_database.packedFIRA_p);
@@ -583,6 +860,11 @@ void CLogScrutinizerDoc::UpdateTitleRow(void)
         QFileInfo fileInfo(m_Log_FileName);
 
         tempString.append(QString("%1  %2").arg(fileInfo.fileName()).arg(FileSizeToString(m_database.fileSize)));
+        if (m_qFile_Log.IsMerged()) {
+            tempString.append(QString("  (%1 files merged)").arg(m_qFile_Log.GetNumOfMergeSources()));
+        } else if (m_qFile_Log.GetNumOfFrozenSegments() > 0) {
+            tempString.append(QString("  (%1 files)").arg(m_qFile_Log.GetNumOfSegments()));
+        }
         if ((g_cfg_p->m_Log_rowClip_Start > CFG_CLIP_NOT_SET) || (g_cfg_p->m_Log_rowClip_End > CFG_CLIP_NOT_SET)) {
             int64_t clippedStart;
             int64_t clippedEnd;
@@ -673,6 +955,21 @@ void CLogScrutinizerDoc::UpdateFilterItem(int uniqueID, Q_COLORREF color, Q_COLO
     }
 }
 
+/***********************************************************************************************************************
+*   GetFilterItemProfile
+*   The profile from the last filtering of the filter item with the uniqueID, false if it wasn't part of it
+***********************************************************************************************************************/
+bool CLogScrutinizerDoc::GetFilterItemProfile(int uniqueID, FilterItemProfile_t *profile_p) const
+{
+    for (auto& filterItem_p : m_allEnabledFilterItems) {
+        if ((filterItem_p->m_uniqueID == uniqueID) && (filterItem_p->m_profile.evaluations > 0)) {
+            *profile_p = filterItem_p->m_profile;
+            return true;
+        }
+    }
+    return false;
+}
+
 /***********************************************************************************************************************
 *   InitializeFilterItem_LUT
 ***********************************************************************************************************************/
@@ -815,6 +1112,10 @@ void CLogScrutinizerDoc::replaceFileSysWatcherFile(QString& fileName)
     m_logFileSize = fileInfo.size();
     m_logFileLastChanged = fileInfo.lastModified();
 
+    if (m_logFileTrackingEnabled) {
+        (void)m_tailWatcher.Start(fileInfo.absoluteFilePath());
+    }
+
     /* Add the new directory watch */
     if (!m_fileSysWatcher.addPath(fileInfo.absolutePath())) {
         TRACEX_W(QString("Failed to add directory tracking: %1").arg(fileInfo.absolutePath()))
@@ -860,13 +1161,38 @@ void CLogScrutinizerDoc::logUpdated(int64_t fileSize)
     }
 
     m_rowCache_p->Update(&m_qFile_Log, &m_database.TIA, &m_database.FIRA, m_database.filterItem_LUT, m_memPool);
+    UpdateTailChecksum();
+    UpdateSegmentRows();
     replaceFileSysWatcherFile(m_Log_FileName);
 }
 
+/***********************************************************************************************************************
+*   UpdateSegmentRows
+***********************************************************************************************************************/
+void CLogScrutinizerDoc::UpdateSegmentRows(void)
+{
+    /* The TIs never stretch over a segment border, the first row of a segment is the first TI at (or after) the
+     * segment offset */
+    const TI_t *TIA_p = m_database.TIA.textItemArray_p;
+    const int rows = TIA_p != nullptr ? m_database.TIA.rows : 0;
+
+    if (m_qFile_Log.IsMerged()) {
+        return; /* The segments are the merge runs, the rows of a file are spread out */
+    }
+
+    for (int segment = 1; segment < m_qFile_Log.GetNumOfSegments(); ++segment) {
+        const int64_t offset = m_qFile_Log.GetSegmentOffset(segment);
+        const TI_t *first_p = std::lower_bound(TIA_p, TIA_p + rows, offset,
+                                               [](const TI_t& TI, int64_t value) {return TI.fileIndex < value;});
+        m_qFile_Log.SetSegmentFirstRow(segment, static_cast<int>(first_p - TIA_p));
+    }
+}
+
 /***********************************************************************************************************************
 *   LoadLogFile
 ***********************************************************************************************************************/
-bool CLogScrutinizerDoc::LoadLogFile(QString fileName /*use copy*/, bool reload)
+bool CLogScrutinizerDoc::LoadLogFile(QString fileName /*use copy*/, bool reload, const QStringList& segmentFileNames,
+                                     bool merged)
 {
     CTimeMeas execTime;
     int64_t fileSize;
@@ -894,6 +1220,11 @@ bool CLogScrutinizerDoc::LoadLogFile(QString fileName /*use copy*/, bool reload)
 
     m_Log_FileName = fileName;
 
+    if (!reload) {
+        m_Log_SegmentFileNames = segmentFileNames;
+        m_Log_Merged = merged && !segmentFileNames.isEmpty();
+    }
+
     /* Open as read-only with shared reading
      * If the log file name is relative, then replace it with the absolute */
     GetAbsoluteFileName(m_Log_FileName, m_Log_FileName);
@@ -911,6 +1242,17 @@ bool CLogScrutinizerDoc::LoadLogFile(QString fileName /*use copy*/, bool reload)
         return false;
     }
 
+    /* A merged log is setup when the files are indexed */
+    for (auto& segmentFileName : m_Log_Merged ? QStringList() : m_Log_SegmentFileNames) {
+        if (!m_qFile_Log.AddFrozenSegment(segmentFileName)) {
+            QMessageBox::information(MW_Parent(), QObject::tr("File open failed"),
+                                     QObject::tr("The file %1 couldn't be opened, please close the "
+                                                 "program using it and re-try").arg(segmentFileName), QMessageBox::Ok);
+            CleanDB(false);  /* fallback solution */
+            return false;
+        }
+    }
+
     m_TIA_FileName = m_Log_FileName + QString(".tia");
     m_FIRA_FileName = m_Log_FileName + QString(".fira");
 
@@ -940,13 +1282,16 @@ bool CLogScrutinizerDoc::LoadLogFile(QString fileName /*use copy*/, bool reload)
         return false;
     }
 
+    m_searchIndex_FileName = CSearchIndex::GetFileName(m_TIA_FileName);
+
     m_recentFiles.AddFile(m_Log_FileName);
 
     m_qFile_TIA.setFileName(m_TIA_FileName);
     m_qFile_FIRA.setFileName(m_FIRA_FileName);
 
-    /* Try QUICK LOADING of existing TIA and FIRA files, if they exists... and are valid */
-    if (FileMapping::CreateTIA_MemMapped(m_qFile_Log, m_qFile_TIA, &m_database.TIA.rows,
+    /* Try QUICK LOADING of existing TIA and FIRA files, if they exists... and are valid. Not possible for a merged log,
+     * as the TIA doesn't hold the runs of the merged files */
+    if (!m_Log_Merged && FileMapping::CreateTIA_MemMapped(m_qFile_Log, m_qFile_TIA, &m_database.TIA.rows,
                                          m_database.TIA.textItemArray_p, &fileSize, true /*check file size*/)) {
         if (FileMapping::CreateFIRA_MemMapped(m_qFile_FIRA, m_database.FIRA.FIR_Array_p, m_database.TIA.rows)) {
             logUpdated(fileSize);
@@ -1023,11 +1368,58 @@ bool CLogScrutinizerDoc::LoadLogFile(QString fileName /*use copy*/, bool reload)
     return false;
 }
 
+/***********************************************************************************************************************
+*   LoadLogFiles
+***********************************************************************************************************************/
+bool CLogScrutinizerDoc::LoadLogFiles(QStringList fileNames /*use copy*/)
+{
+    if (fileNames.isEmpty()) {
+        return false;
+    }
+
+    for (auto& fileName : fileNames) {
+        GetAbsoluteFileName(fileName, fileName);
+    }
+
+    CLogFile::SortRotatedFileNames(fileNames);
+
+    const QString liveFileName = fileNames.takeLast();
+    TRACEX_I(QString("Loading %1 log files, newest: %2 %3").arg(fileNames.count() + 1).arg(liveFileName)
+                 .arg(g_cfg_p->m_logMergeByTimestamp ? "(merged by timestamp)" : ""))
+
+    return LoadLogFile(liveFileName, false, fileNames, g_cfg_p->m_logMergeByTimestamp);
+}
+
 /***********************************************************************************************************************
 *   ExecuteLoadLog
 ***********************************************************************************************************************/
 void CLogScrutinizerDoc::ExecuteLoadLog(void)
 {
+    if (m_Log_Merged) {
+        m_pendingLoadLog_result = m_pendingFileCtrl_p->Search_TIA_Merged(
+            &m_qFile_Log,
+            QStringList(m_Log_SegmentFileNames) << m_Log_FileName,
+            m_TIA_FileName,
+            m_workMem.GetRef(),
+            m_workMem.GetSize(),
+            &m_pendingLoadLog_rows);
+        return;
+    }
+
+    if (m_qFile_Log.GetNumOfFrozenSegments() > 0) {
+        m_pendingLoadLog_result = m_pendingFileCtrl_p->Search_TIA_Segments(
+            &m_qFile_Log,
+            m_TIA_FileName,
+            m_workMem.GetRef(),
+            m_workMem.GetSize(),
+            &m_pendingLoadLog_rows);
+        return;
+    }
+
+    if (g_cfg_p->m_blockSummaryEnabled) {
+        m_pendingFileCtrl_p->SetBlockSummary(&m_blockSummary);
+    }
+
     m_pendingLoadLog_result = m_pendingFileCtrl_p->Search_TIA(
         &m_qFile_Log,
         m_TIA_FileName.toLatin1().data(),
@@ -1084,6 +1476,9 @@ void CLogScrutinizerDoc::StartFiltering(void)
 
     CSZ_DB_PendingUpdate = true;
 
+    m_incrementalSearch.Reset();
+    m_matchEstimator.Stop();
+
     CProgressDlg dlg("Filtering...", ProgressCmd_Filter_en);
     dlg.setModal(true);
     dlg.exec();
@@ -1150,6 +1545,7 @@ void CLogScrutinizerDoc::ExecuteFiltering(void)
         if (m_workMem.Operation(WORK_MEM_OPERATION_COMMIT)) {
             CFilterProcCtrl filterCtrl;
 
+            filterCtrl.SetBlockSummary(&m_blockSummary);
             filterCtrl.StartProcessing(&m_qFile_Log,
                                        m_workMem.GetRef(),
                                        m_workMem.GetSize(),
@@ -1196,17 +1592,19 @@ void CLogScrutinizerDoc::ExecuteIncrementalFiltering(int startRow)
     }
     auto oldFilterMatches = m_database.FIRA.filterMatches;
 
-    /* Check last line, since that has been reloaded, and will be refiltered, we need to 
-       remove that from previous filter match count. */
-    const auto fira_p = &m_database.FIRA.FIR_Array_p[startRow];
-    const auto lut_index = fira_p->LUT_index;
-    if (lut_index != 0) {
-        if (m_database.filterItem_LUT[lut_index]->m_exclude) {
-            --m_database.FIRA.filterExcludeMatches;
-        } else {
-            --m_database.FIRA.filterMatches;
+    /* The rows from startRow has been reloaded, and will be refiltered, we need to remove these from previous filter
+       match count. Normally just the last line, the rows added are not filtered yet. */
+    for (int row = startRow; row < m_database.TIA.rows; ++row) {
+        const auto lut_index = m_database.FIRA.FIR_Array_p[row].LUT_index;
+        if (lut_index != 0) {
+            if (m_database.filterItem_LUT[lut_index]->m_exclude) {
+                --m_database.FIRA.filterExcludeMatches;
+            } else {
+                --m_database.FIRA.filterMatches;
+            }
         }
     }
+    CWorkspace_GetBookmarks(&bookmarkList);
 
     m_incrementalFilterCtrl.ExecuteIncrementalFiltering(
         &m_qFile_Log,
@@ -1216,12 +1614,44 @@ void CLogScrutinizerDoc::ExecuteIncrementalFiltering(int startRow)
         m_database.FIRA.FIR_Array_p,
         startRow, &m_filterExecTimes, 
         &m_database.FIRA.filterMatches,
-        &m_database.FIRA.filterExcludeMatches
+        &m_database.FIRA.filterExcludeMatches,
+        &bookmarkList
     );
 
     ExtendPackedFIRA(startRow, oldFilterMatches);
 }
 
+/***********************************************************************************************************************
+*   ShiftRowReferences
+***********************************************************************************************************************/
+void CLogScrutinizerDoc::ShiftRowReferences(int fromRow, int endRow, int delta)
+{
+    /* The rows [fromRow, endRow) has moved delta rows forward, as rows were added before them. The bookmarks and the
+     * filter matches follow the rows. The find-all results and the plots refer to rows as well, these are cleared
+     * rather than re-run in the background. */
+    if (delta <= 0) {
+        return;
+    }
+
+    CWorkspace_ShiftBookmarks(fromRow, delta);
+
+    FIR_t *FIRA_p = m_database.FIRA.FIR_Array_p;
+    if ((FIRA_p != nullptr) && (endRow > fromRow) && (endRow + delta <= m_database.TIA.rows)) {
+        memmove(&FIRA_p[fromRow + delta], &FIRA_p[fromRow], sizeof(FIR_t) * static_cast<size_t>(endRow - fromRow));
+        memset(&FIRA_p[fromRow], 0, sizeof(FIR_t) * static_cast<size_t>(delta));
+        FilterMgr::ReNumerateFIRA(m_database.FIRA, m_database.TIA, m_database.filterItem_LUT);
+        CreatePackedFIRA();
+    }
+
+    m_searchResults.Clear();
+    CWorkspace_CleanAllPlots();
+
+    CPlotPane *plotPane_p = CPlotPane_GetPlotPane();
+    if (plotPane_p != nullptr) {
+        plotPane_p->cleanAllPlots();
+    }
+}
+
 /***********************************************************************************************************************
    GetFilterMatch
    Minimalistic approach
@@ -1316,6 +1746,9 @@ bool CLogScrutinizerDoc::StartSearch(const QString& searchText, int startRow, in
 #endif
     CEditorWidget_SetFocus();
 
+    m_incrementalSearch.Stop();
+    m_matchEstimator.Stop();
+
     QCursor cursor = QCursor(Qt::WaitCursor);
     CEditorWidget_SetCursor(&cursor);
 
@@ -1351,8 +1784,18 @@ bool CLogScrutinizerDoc::ExecuteSearch(void)
 
     if (m_database.TIA.rows != 0) {
         if (m_workMem.Operation(WORK_MEM_OPERATION_COMMIT)) {
+            if (g_cfg_p->m_searchIndexEnabled && ExecuteIndexedSearch(&result)) {
+                (void)m_workMem.Operation(WORK_MEM_OPERATION_FREE);
+                g_cfg_p->m_workMemSize = savedSize;
+                return result;
+            }
+
             CSearchCtrl searchCtrl;
 
+            searchCtrl.SetBlockSummary(&m_blockSummary);
+            if (m_pendingSearch_OnlyFiltered) {
+                searchCtrl.SetSparseRows(m_database.packedFIRA_p, m_database.FIRA.filterMatches);
+            }
             searchCtrl.StartProcessing(
                 &m_qFile_Log,
                 m_workMem.GetRef(),
@@ -1383,6 +1826,214 @@ bool CLogScrutinizerDoc::ExecuteSearch(void)
     return result;
 }
 
+/***********************************************************************************************************************
+*   StartFindAll
+***********************************************************************************************************************/
+bool CLogScrutinizerDoc::StartFindAll(const QString& searchText, bool onlyFiltered, bool regExp, bool caseSensitive)
+{
+    m_pendingSearch_searchText = searchText;
+    m_pendingSearch_startRow = 0;
+    m_pendingSearch_endRow = m_database.TIA.rows - 1;
+    m_pendingSearch_row_p = nullptr;
+    m_pendingSearch_backward = false;
+    m_pendingSearch_OnlyFiltered = onlyFiltered;
+    m_pendingSearch_regExp = regExp;
+    m_pendingSearch_caseSensitive = caseSensitive;
+
+    TRACEX_I("Start Find all  Rows:%d RegEx:%d CS:%d Text: %s\n ", m_database.TIA.rows, regExp, caseSensitive,
+             searchText.toLatin1().constData())
+
+    /* The result view is cleared and then filled in while the search is ongoing */
+    m_incrementalSearch.Stop();
+    m_matchEstimator.Stop();
+
+    m_searchResults.Clear(searchText);
+    m_searchResults.m_running = true;
+
+    QCursor cursor = QCursor(Qt::WaitCursor);
+    CEditorWidget_SetCursor(&cursor);
+
+    CProgressDlg dlg("Finding all...", ProgressCmd_FindAll_en);
+    dlg.setModal(true);
+
+    if (!dlg.m_waitGUILock.tryAcquire(1, 2000 /*ms*/)) {
+        (void)dlg.exec();
+    }
+
+    CEditorWidget_SetCursor(nullptr);
+
+    m_searchResults.m_running = false;
+
+    return m_searchResults.GetCount() > 0;
+}
+
+/***********************************************************************************************************************
+*   StartIncrementalSearch
+***********************************************************************************************************************/
+bool CLogScrutinizerDoc::StartIncrementalSearch(const QString& searchText, bool onlyFiltered, bool regExp,
+                                                bool caseSensitive)
+{
+    if (CSZ_DB_PendingUpdate || (m_database.TIA.rows == 0) || g_processingCtrl_p->isProcessing()) {
+        return false;
+    }
+
+    return m_incrementalSearch.Start(m_qFile_Log, &m_database.TIA, onlyFiltered ? &m_database.FIRA : nullptr,
+                                     m_database.filterItem_LUT, searchText, regExp, caseSensitive);
+}
+
+/***********************************************************************************************************************
+*   StartMatchEstimate
+***********************************************************************************************************************/
+bool CLogScrutinizerDoc::StartMatchEstimate(const QString& text, bool regExp, bool caseSensitive)
+{
+    if (CSZ_DB_PendingUpdate || (m_database.TIA.rows == 0) || g_processingCtrl_p->isProcessing()) {
+        return false;
+    }
+
+    return m_matchEstimator.Start(m_qFile_Log, &m_database.TIA, text, regExp, caseSensitive);
+}
+
+/***********************************************************************************************************************
+*   ExecuteFindAll
+***********************************************************************************************************************/
+void CLogScrutinizerDoc::ExecuteFindAll(void)
+{
+    int savedSize = g_cfg_p->m_workMemSize;
+
+    if ((g_cfg_p->m_workMemSize == 0) || (g_cfg_p->m_workMemSize > 100 * 1000 * 1024)) {
+        g_cfg_p->m_workMemSize = 100 * 1000 * 1024;
+    }
+
+    if (m_database.TIA.rows != 0) {
+        if (m_workMem.Operation(WORK_MEM_OPERATION_COMMIT)) {
+            CSearchCtrl searchCtrl;
+
+            searchCtrl.SetBlockSummary(&m_blockSummary);
+            if (m_pendingSearch_OnlyFiltered) {
+                searchCtrl.SetSparseRows(m_database.packedFIRA_p, m_database.FIRA.filterMatches);
+            }
+            searchCtrl.StartFindAll(
+                &m_qFile_Log,
+                m_workMem.GetRef(),
+                m_workMem.GetSize(),
+                &m_database.TIA,
+                m_pendingSearch_OnlyFiltered ? &m_database.FIRA : nullptr,
+                m_pendingSearch_OnlyFiltered ? m_database.filterItem_LUT : nullptr,
+                m_priority,
+                &m_pendingSearch_searchText,
+                m_pendingSearch_startRow,
+                m_pendingSearch_endRow,
+                m_pendingSearch_regExp,
+                m_pendingSearch_caseSensitive,
+                &m_searchResults);
+
+            (void)m_workMem.Operation(WORK_MEM_OPERATION_FREE);
+        } else {
+            g_processingCtrl_p->AddProgressInfo(QString("Failed to aquire memory for search, search aborted"));
+        }
+    } else {
+        g_processingCtrl_p->AddProgressInfo(QString("Log file is empty, search aborted"));
+    }
+
+    g_cfg_p->m_workMemSize = savedSize;
+}
+
+/***********************************************************************************************************************
+*   ExecuteIndexedSearch
+***********************************************************************************************************************/
+bool CLogScrutinizerDoc::ExecuteIndexedSearch(bool *result_p)
+{
+    std::vector<QByteArray> literals;
+
+    if (!CSearchIndex::GetRequiredLiterals(m_pendingSearch_searchText, m_pendingSearch_regExp, literals)) {
+        return false; /* The index cannot narrow down the rows, search them all */
+    }
+
+    if (!m_searchIndex.IsOpen() && !m_searchIndex.Open(m_searchIndex_FileName, &m_database.TIA)) {
+        CTimeMeas execTime;
+        g_processingCtrl_p->AddProgressInfo(QString("Building search index"));
+
+        if (!m_searchIndex.Build(&m_qFile_Log, m_workMem.GetRef(), m_workMem.GetSize(), &m_database.TIA,
+                                 m_searchIndex_FileName)) {
+            if (g_processingCtrl_p->m_abort) {
+                g_processingCtrl_p->SetFail();
+                g_processingCtrl_p->AddProgressInfo(QString("Search aborted by user"));
+                *result_p = false;
+                return true;
+            }
+            return false;
+        }
+        g_processingCtrl_p->AddProgressInfo(QString("  Search index built, %1").arg(timeToString(execTime.ms())));
+    }
+
+    /* Rows added after the index was built (tracking) are searched without the index */
+    const int indexedRows = m_searchIndex.GetRows();
+    const int startRow = m_pendingSearch_startRow;
+    const int endRow = m_pendingSearch_endRow;
+    const bool backward = m_pendingSearch_backward;
+
+    auto searchIndexed = [&] (int fromRow, int toRow) {
+        std::vector<std::pair<int, int>> ranges;
+        m_searchIndex.GetCandidateRows(literals, fromRow, toRow, backward, ranges);
+
+        CSearchCtrl searchCtrl;
+        (void)searchCtrl.SearchRowRanges(
+            &m_qFile_Log,
+            m_workMem.GetRef(),
+            m_workMem.GetSize(),
+            &m_database.TIA,
+            m_pendingSearch_OnlyFiltered ? &m_database.FIRA : nullptr,
+            m_pendingSearch_OnlyFiltered ? m_database.filterItem_LUT : nullptr,
+            m_priority,
+            &m_pendingSearch_searchText,
+            ranges,
+            backward,
+            m_pendingSearch_regExp,
+            m_pendingSearch_caseSensitive);
+        return searchCtrl.GetSearchResult(m_pendingSearch_row_p);
+    };
+
+    auto searchNotIndexed = [&] (int fromRow, int toRow) {
+        CSearchCtrl searchCtrl;
+        searchCtrl.SetBlockSummary(&m_blockSummary);
+        searchCtrl.StartProcessing(
+            &m_qFile_Log,
+            m_workMem.GetRef(),
+            m_workMem.GetSize(),
+            &m_database.TIA,
+            m_pendingSearch_OnlyFiltered ? &m_database.FIRA : nullptr,
+            m_pendingSearch_OnlyFiltered ? m_database.filterItem_LUT : nullptr,
+            m_priority,
+            &m_pendingSearch_searchText,
+            fromRow,
+            toRow,
+            backward,
+            m_pendingSearch_regExp,
+            m_pendingSearch_caseSensitive);
+        return searchCtrl.GetSearchResult(m_pendingSearch_row_p);
+    };
+
+    *result_p = false;
+
+    if (!backward) {
+        if (startRow < indexedRows) {
+            *result_p = searchIndexed(startRow, endRow < indexedRows ? endRow : indexedRows - 1);
+        }
+        if (!*result_p && !g_processingCtrl_p->m_abort && (endRow >= indexedRows)) {
+            *result_p = searchNotIndexed(startRow > indexedRows ? startRow : indexedRows, endRow);
+        }
+    } else {
+        if (startRow >= indexedRows) {
+            *result_p = searchNotIndexed(startRow, endRow > indexedRows ? endRow : indexedRows);
+        }
+        if (!*result_p && !g_processingCtrl_p->m_abort && (endRow < indexedRows)) {
+            *result_p = searchIndexed(startRow < indexedRows ? startRow : indexedRows - 1, endRow);
+        }
+    }
+
+    return true;
+}
+
 /***********************************************************************************************************************
 *   PostProcSearch
 ***********************************************************************************************************************/
@@ -1417,6 +2068,9 @@ bool CLogScrutinizerDoc::StartPlot(QList<CPlot *> *pendingPlot_execList_p, int s
     m_pendingPlot_startRow = startRow;
     m_pendingPlot_endRow = endRow;
 
+    m_incrementalSearch.Stop();
+    m_matchEstimator.Stop();
+
     CProgressDlg dlg("Running plot generation...", ProgressCmd_Plot_en);
     dlg.setModal(true);
     dlg.exec();
@@ -1539,14 +2193,20 @@ void CLogScrutinizerDoc::ExtendPackedFIRA(unsigned startFrom, unsigned startCoun
             VirtualMem::Free(m_database.packedFIRA_p);
         }
         m_database.packedFIRA_p = nullptr;
+        m_rockScrollSummary.Clean();
         return;
     }
 
     if (m_database.FIRA.filterMatches == startCount) {
-        // No added filter matches
+        // No added filter matches, however the rock scroll summary might still have new exclude matches or bookmarks
+        FilterMgr::PopulatePackedFIRA(m_database.TIA, m_database.FIRA, m_database.packedFIRA_p, m_database.filterItem_LUT,
+                                      startFrom, startCount, &m_rockScrollSummary);
         return;
     }
 
+    /* The rows refiltered may have fewer matches than before, only the entries before startFrom are kept anyway */
+    startCount = std::min(startCount, static_cast<unsigned>(m_database.FIRA.filterMatches));
+
     auto old_p = m_database.packedFIRA_p;
     m_database.packedFIRA_p = reinterpret_cast<packed_FIR_t *>(VirtualMem::Alloc(static_cast<int64_t>(sizeof(packed_FIR_t)) * m_database.FIRA.filterMatches));
     /* Copy old entries to the new memory */
@@ -1556,7 +2216,8 @@ void CLogScrutinizerDoc::ExtendPackedFIRA(unsigned startFrom, unsigned startCoun
     if (old_p != nullptr) {
         VirtualMem::Free(old_p);
     }
-    FilterMgr::PopulatePackedFIRA(m_database.TIA, m_database.FIRA, m_database.packedFIRA_p, m_database.filterItem_LUT, startFrom, startCount);
+    FilterMgr::PopulatePackedFIRA(m_database.TIA, m_database.FIRA, m_database.packedFIRA_p, m_database.filterItem_LUT, startFrom, startCount,
+                                  &m_rockScrollSummary);
 }
 
 /***********************************************************************************************************************
@@ -1571,11 +2232,13 @@ void CLogScrutinizerDoc::CreatePackedFIRA(void)
     m_database.packedFIRA_p = nullptr;
 
     if (m_database.FIRA.filterMatches == 0) {
+        m_rockScrollSummary.Clean();
         return;
     }
 
     m_database.packedFIRA_p = reinterpret_cast<packed_FIR_t *>(VirtualMem::Alloc(static_cast<int64_t>(sizeof(packed_FIR_t)) * m_database.FIRA.filterMatches));
-    FilterMgr::PopulatePackedFIRA(m_database.TIA, m_database.FIRA, m_database.packedFIRA_p, m_database.filterItem_LUT);
+    FilterMgr::PopulatePackedFIRA(m_database.TIA, m_database.FIRA, m_database.packedFIRA_p, m_database.filterItem_LUT, 0, 0,
+                                  &m_rockScrollSummary);
 }
 
 /***********************************************************************************************************************
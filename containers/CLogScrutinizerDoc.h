@@ -16,6 +16,14 @@
 #include "CSelection.h"
 #include "TextDecoration.h"
 #include "CFilterProcCtrl.h"
+#include "CRockScrollSummary.h"
+#include "CTailWatcher.h"
+#include "CLogFile.h"
+#include "CSearchIndex.h"
+#include "CBlockSummary.h"
+#include "CSearchResults.h"
+#include "CIncrementalSearch.h"
+#include "CMatchEstimator.h"
 
 #include <memory>
 #include <QDir>
@@ -23,6 +31,7 @@
 #include <QFileSystemWatcher>
 #include <QDateTime>
 #include <QTimer>
+#include <QElapsedTimer>
 
 #define PIXEL_STAMP_STARTX_MASK      ((static_cast<uint64_t>(1) << 32) - 1)          /* bit 0-31 start_X, 32 bits */
 #define PIXEL_STAMP_STARTY_MASK      ((static_cast<uint64_t>(1 << 23) - 1) << 32)    /* bit 32-54, bit 23 bits */
@@ -162,10 +171,18 @@ public:
     void CreateFiltersFromCCfgItems(void);
     bool CheckAllFilters(void);
     void UpdateFilterItem(int uniqueID, Q_COLORREF color, Q_COLORREF bg_color);
+    bool GetFilterItemProfile(int uniqueID, FilterItemProfile_t *profile_p) const;
 
     void PluginIsUnloaded(void);
 
-    bool LoadLogFile(QString fileName, bool reload = false); /* Will start the progress dialog */
+    /* Will start the progress dialog. segmentFileNames, older files placed in front of fileName (see LoadLogFiles),
+     * are kept at reload, as well as if they are merged with fileName */
+    bool LoadLogFile(QString fileName, bool reload = false, const QStringList& segmentFileNames = QStringList(),
+                     bool merged = false);
+
+    /* Open a set of (rotated) log files as one log, the newest file is the one tracked. The files are concatenated,
+     * or merged by row timestamp (see LOG_MERGE_BY_TIMESTAMP) */
+    bool LoadLogFiles(QStringList fileNames);
     void ExecuteLoadLog(void); /* Is run  from the progress dialog */
 
     /* logUpdated is used after the log has been loaded and memory mapped to inform other components such
@@ -184,6 +201,11 @@ public:
     bool StartSearch(const QString& searchText, int startRow, int endRow,
                      int *row_p, bool backward, bool onlyFiltered, bool regExp, bool caseSensitive);
     bool ExecuteSearch(void);
+    bool ExecuteIndexedSearch(bool *result_p);
+    bool StartFindAll(const QString& searchText, bool onlyFiltered, bool regExp, bool caseSensitive);
+    void ExecuteFindAll(void);
+    bool StartIncrementalSearch(const QString& searchText, bool onlyFiltered, bool regExp, bool caseSensitive);
+    bool StartMatchEstimate(const QString& text, bool regExp, bool caseSensitive);
     bool PostProcSearch(void);
     bool StartPlot(QList<CPlot *> *pendingPlot_execList_p, int startRow = 0, int endRow = 0);
     bool ExecutePlot(void);
@@ -223,11 +245,21 @@ public:
 
 public slots:
     void logFileUpdated(const QString &path, bool useSavedReloadStrategy = false, bool forceUIUpdate = false);
+    void logFileChanged(const QString &path);
     void logFileDirUpdated(const QString &path);
     void onFileChangeTimer(void);
+    void onTailAppended(void);
+    void onTailReplaced(void);
+    void onTailTimer(void);
 
 private:
     void StartFiltering(void);
+    void ScheduleTailUpdate(void);
+    void UpdateTailChecksum(void);
+    bool RotateLogFile(void);
+    void UpdateSegmentRows(void);
+    void ShiftRowReferences(int fromRow, int endRow, int delta);
+    int64_t IndexedLiveFileSize(void);
 
 public:
     /* Priority of the created threads, possible to decrease, increase priority for speed, -1 less, +1 more */
@@ -235,6 +267,7 @@ public:
     int m_numOfFilters;
     bool m_inDestructor;
     DB_t m_database;
+    CRockScrollSummary m_rockScrollSummary; /* Min-LUT summary of FIRA/packedFIRA, resampled by the rock scroll */
     QList<CFilterItem *> m_allEnabledFilterItems;
 
     /* Used to keep track when full filtering is required, that filter has changed since last filtering */
@@ -246,12 +279,20 @@ public:
     QString m_textBuffer;
     char m_delayedErrorMsg[CFG_TEMP_STRING_MAX_SIZE];
     CFontCtrl m_fontCtrl;
-    QFile m_qFile_Log; /*HANDLE                    m_file_h;   //Loaded text file */
+    CLogFile m_qFile_Log; /* Loaded text file, possibly with frozen segments of rotated files */
     QFile m_qFile_TIA; /* m_TIA_MemMapped_File_h; */
     QFile m_qFile_FIRA; /*  HANDLE                    m_FIRA_MemMapped_File_h; */
     QString m_Log_FileName;
+    QStringList m_Log_SegmentFileNames; /* Files opened in front of m_Log_FileName, oldest first */
+    bool m_Log_Merged = false; /* m_Log_SegmentFileNames and m_Log_FileName are merged by timestamp */
     QString m_TIA_FileName;
     QString m_FIRA_FileName;
+    QString m_searchIndex_FileName;
+    CSearchIndex m_searchIndex; /* Opened, or built, at the first search if SEARCH_INDEX is enabled */
+    CBlockSummary m_blockSummary; /* Built when the log is indexed, if BLOCK_SUMMARY is enabled */
+    CSearchResults m_searchResults; /* Matches of the latest find-all search */
+    CIncrementalSearch m_incrementalSearch; /* Search-as-you-type, reset when the TIA or FIRA is changed */
+    CMatchEstimator m_matchEstimator; /* Sampled match count of the filter item, or search, being edited */
     QString m_workspaceFileName;
     QString m_workspaceFileName_revert;  /* in-case we failed to load a new workspace, we revert to the previous */
     CMemPool m_memPool;
@@ -289,6 +330,19 @@ public:
     ReloadStrategy_e m_savedReloadStrategy = RS_Skip;
     CFilterProcCtrl m_incrementalFilterCtrl; // Re-used to speed up incremental filtering
     CWorkMem m_incrementalWorkMem;
+
+    /* Tail mode, appends are signalled by m_tailWatcher and loaded within the max latency */
+    CTailWatcher m_tailWatcher;
+    std::unique_ptr<QTimer> m_tailTimer;
+    QElapsedTimer m_tailLastUpdate;
+    bool m_tailChecksumValid = false;
+    uint32_t m_tailChecksum = 0;  /* Checksum of the block before the last (reloaded) row */
+    int64_t m_tailChecksumStart = 0;
+    int64_t m_tailChecksumSize = 0;
+    uint32_t m_headChecksum = 0;  /* Checksum of the first block of the live log file */
+    int64_t m_headChecksumSize = 0;
+    bool m_logFileIdValid = false;
+    uint64_t m_logFileId = 0;  /* Identity of the live log file when indexed, see CTailWatcher::FileId */
 };
 
 extern CLogScrutinizerDoc *GetTheDoc(void);
@@ -23,6 +23,7 @@ bool CWorkMem::Operation(WorkMem_Operation_t operation)
         assert(m_mem_p == nullptr);
         if (m_mem_p != nullptr) {
             VirtualMem::Free(m_mem_p);
+            MemAcc_Add(MEM_ACC_WORK_MEM_e, -m_size);
             m_mem_p = nullptr;
         }
 
@@ -47,6 +48,14 @@ bool CWorkMem::Operation(WorkMem_Operation_t operation)
                 TRACEX_I(QString("WorkMem reservation OVERRIDE  size:%1").arg(m_size))
             }
         } 
+
+        /* Keep within what is left of the memory budget, smaller chunks are slower but still work. Never below the
+         * tiny size though, as then the processing wouldn't work at all */
+        const int64_t available = MemAcc_Available(MEM_ACC_WORK_MEM_e);
+        if (available < m_size) {
+            m_size = available > DEFAULT_TINY_MEM_SIZE ? available : DEFAULT_TINY_MEM_SIZE;
+            TRACEX_I(QString("WorkMem reservation limited by the memory budget  size:%1MB").arg(m_size >> 20))
+        }
         
         /* Try to do the allocation, step down in size until success */
         while (m_mem_p == nullptr && m_size > DEFAULT_MIN_MEM_SIZE /*100kB*/) {
@@ -63,6 +72,7 @@ bool CWorkMem::Operation(WorkMem_Operation_t operation)
         }
 
         m_status = WORK_MEM_OPERATION_COMMIT;
+        MemAcc_Add(MEM_ACC_WORK_MEM_e, m_size);
         TRACEX_D(QString("Work memory in use:%1MB (%2MB)").arg(m_size >> 20).arg(total >> 20))
         return true;
     }
@@ -70,6 +80,7 @@ bool CWorkMem::Operation(WorkMem_Operation_t operation)
         assert(m_mem_p == nullptr);
         if (m_mem_p != nullptr) {
             VirtualMem::Free(m_mem_p);
+            MemAcc_Add(MEM_ACC_WORK_MEM_e, -m_size);
             m_mem_p = nullptr;
         }
 
@@ -81,12 +92,14 @@ bool CWorkMem::Operation(WorkMem_Operation_t operation)
         }
 
         m_status = WORK_MEM_OPERATION_TINY_COMMIT;
+        MemAcc_Add(MEM_ACC_WORK_MEM_e, m_size);
         TRACEX_D(QString("Work memory in use:%1").arg(m_size))
         return true;
     } else if (operation == WORK_MEM_OPERATION_FREE) {
         Q_ASSERT(m_mem_p != nullptr);
         Q_ASSERT(m_status != WORK_MEM_OPERATION_FREE);
         VirtualMem::Free(m_mem_p);
+        MemAcc_Add(MEM_ACC_WORK_MEM_e, -m_size);
         m_mem_p = nullptr;
         m_size = 0;
         m_status = WORK_MEM_OPERATION_FREE;
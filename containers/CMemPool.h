@@ -6,6 +6,7 @@
 #pragma once
 
 #include "CDebug.h"
+#include "CMemAccounting.h"
 #include "errno.h"
 
 #ifdef _WIN32
@@ -43,12 +44,14 @@ public:
         m_size = size;
 
         g_pool_total_size += size;
+        MemAcc_Add(MEM_ACC_POOL_e, size);
     }
 
     inline ~CMemPoolItem()
     {
         if (m_data_p != nullptr) {
             g_pool_total_size -= m_size;
+            MemAcc_Add(MEM_ACC_POOL_e, -m_size);
             free(m_data_p);
         }
     }
@@ -81,6 +84,7 @@ public:
     {
         m_minSize = minSize;
         m_maxSize = maxSize;
+        m_numOfStartItems = numOfStartItems;
 
         for (int index = 0; index < numOfStartItems; ++index) {
             m_poolItemList.insert(0, new CMemPoolItem(m_maxSize));
@@ -111,7 +115,12 @@ public:
     /****/
     inline void ReturnMem(CMemPoolItem **poolItem_pp)
     {
-        m_poolItemList.insert(0, *poolItem_pp);
+        /* Over the memory budget the items allocated beyond the start items are released instead of kept */
+        if ((m_poolItemList.count() >= m_numOfStartItems) && MemAcc_IsOverBudget()) {
+            delete *poolItem_pp;
+        } else {
+            m_poolItemList.insert(0, *poolItem_pp);
+        }
         *poolItem_pp = nullptr;
     }
 
@@ -120,11 +129,12 @@ public:
 protected:
     CMemPoolItemBin() {}
 
-    void Init(void) {m_minSize = 0; m_maxSize = 0;}
+    void Init(void) {m_minSize = 0; m_maxSize = 0; m_numOfStartItems = 0;}
 
 private:
     int m_minSize;
     int m_maxSize;
+    int m_numOfStartItems;
     QList<CMemPoolItem *> m_poolItemList;
 };
 
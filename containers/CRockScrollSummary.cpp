@@ -0,0 +1,110 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "CRockScrollSummary.h"
+
+#include <limits.h>
+
+/***********************************************************************************************************************
+*   Clean
+***********************************************************************************************************************/
+void CMinLUTPyramid::Clean(void)
+{
+    m_levels.clear();
+    m_count = 0;
+    m_dirtyBlock = 0;
+}
+
+/***********************************************************************************************************************
+*   Finalize
+***********************************************************************************************************************/
+void CMinLUTPyramid::Finalize(int count)
+{
+    m_count = count;
+
+    if (m_levels.empty()) {
+        m_levels.resize(1);
+    }
+
+    size_t size = static_cast<size_t>((count + ROCK_SCROLL_SUMMARY_BLOCK_SIZE - 1) >> ROCK_SCROLL_SUMMARY_BLOCK_SHIFT);
+    m_levels[0].resize(size, RockScrollSummaryEntry_t{-1, 0});
+
+    /* Rebuild the upper levels, only the nodes covering blocks from m_dirtyBlock need to be recomputed */
+    size_t dirty = m_dirtyBlock < 0 ? 0 : static_cast<size_t>(m_dirtyBlock);
+    size_t level = 1;
+
+    while (size > 1) {
+        size_t parentSize = (size + 1) / 2;
+        dirty /= 2;
+
+        if (m_levels.size() <= level) {
+            m_levels.resize(level + 1);
+        }
+
+        const auto& children = m_levels[level - 1];
+        auto& parents = m_levels[level];
+        parents.resize(parentSize, RockScrollSummaryEntry_t{-1, 0});
+
+        for (size_t index = dirty; index < parentSize; ++index) {
+            const size_t child = index * 2;
+            RockScrollSummaryEntry_t best = children[child];
+            if ((child + 1 < size) && IsBetter(children[child + 1], best)) {
+                best = children[child + 1];
+            }
+            parents[index] = best;
+        }
+
+        size = parentSize;
+        ++level;
+    }
+
+    m_levels.resize(level);
+    m_dirtyBlock = INT_MAX;
+}
+
+/***********************************************************************************************************************
+*   Clean
+***********************************************************************************************************************/
+void CRockScrollSummary::Clean(void)
+{
+    m_rows.Clean();
+    m_packed.Clean();
+}
+
+/***********************************************************************************************************************
+*   BeginUpdate
+***********************************************************************************************************************/
+void CRockScrollSummary::BeginUpdate(const FIR_t *FIR_Array_p, int startRow, const packed_FIR_t *packedFIR_p,
+                                     int startPacked)
+{
+    m_rows.Truncate(startRow, [FIR_Array_p](int row) {return FIR_Array_p[row].LUT_index;});
+    m_packed.Truncate(startPacked, [packedFIR_p](int index) {return packedFIR_p[index].LUT_index;});
+}
+
+/***********************************************************************************************************************
+*   EndUpdate
+***********************************************************************************************************************/
+void CRockScrollSummary::EndUpdate(int rows, int packedCount)
+{
+    m_rows.Finalize(rows);
+    m_packed.Finalize(packedCount);
+}
+
+/***********************************************************************************************************************
+*   QueryRows
+***********************************************************************************************************************/
+RockScrollSummaryEntry_t CRockScrollSummary::QueryRows(const FIR_t *FIR_Array_p, int firstRow, int lastRow) const
+{
+    return m_rows.Query(firstRow, lastRow, [FIR_Array_p](int row) {return FIR_Array_p[row].LUT_index;});
+}
+
+/***********************************************************************************************************************
+*   QueryPacked
+***********************************************************************************************************************/
+RockScrollSummaryEntry_t CRockScrollSummary::QueryPacked(const packed_FIR_t *packedFIR_p, int firstIndex,
+                                                         int lastIndex) const
+{
+    return m_packed.Query(firstIndex, lastIndex, [packedFIR_p](int index) {return packedFIR_p[index].LUT_index;});
+}
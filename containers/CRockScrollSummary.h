@@ -0,0 +1,220 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "CFilter.h"
+
+/* Number of items (rows or packed FIR entries) summarized by each level-0 block. The rock scroll resampling scans at
+ * most two partial blocks per raster directly from the FIRA/packedFIRA, everything in-between is taken from the
+ * summary levels. */
+#define ROCK_SCROLL_SUMMARY_BLOCK_SHIFT  10
+#define ROCK_SCROLL_SUMMARY_BLOCK_SIZE   (1 << ROCK_SCROLL_SUMMARY_BLOCK_SHIFT)
+
+typedef struct {
+    int32_t ref;     /* Row (all rows) or packed FIRA index (only filtered) of the best item, -1 if none */
+    uint8_t LUT;     /* Lowest non-zero LUT index (highest filter priority), 0 if no filter match */
+} RockScrollSummaryEntry_t;
+
+/***********************************************************************************************************************
+*   CMinLUTPyramid
+*
+*   Hierarchical summary of the lowest non-zero LUT index over a sequence of items. Level 0 holds one entry per block of
+*   ROCK_SCROLL_SUMMARY_BLOCK_SIZE items, each higher level combines two entries of the level below. Ties are resolved
+*   to the first item, the same as the linear scan previously done by the rock scroll.
+***********************************************************************************************************************/
+class CMinLUTPyramid
+{
+public:
+    /****/
+    static inline bool IsBetter(const RockScrollSummaryEntry_t& a, const RockScrollSummaryEntry_t& b)
+    {
+        if (a.LUT == 0) {
+            return false;
+        }
+        if (b.LUT == 0) {
+            return true;
+        }
+        return (a.LUT < b.LUT) || ((a.LUT == b.LUT) && (a.ref < b.ref));
+    }
+
+    void Clean(void);
+
+    /* Drop all items from count and onwards, the (partial) block containing count is recomputed with getLUT.
+     * Must be followed by Add of the items from count, and a Finalize. */
+    template<typename GetLUT>
+    void Truncate(int count, GetLUT getLUT)
+    {
+        const int block = count >> ROCK_SCROLL_SUMMARY_BLOCK_SHIFT;
+        if (m_levels.empty()) {
+            m_levels.resize(1);
+        }
+
+        auto& level_0 = m_levels[0];
+        if (static_cast<int>(level_0.size()) > block) {
+            level_0.resize(static_cast<size_t>(block));
+        }
+
+        for (int index = block << ROCK_SCROLL_SUMMARY_BLOCK_SHIFT; index < count; ++index) {
+            Add(index, getLUT(index));
+        }
+
+        if (block < m_dirtyBlock) {
+            m_dirtyBlock = block;
+        }
+        m_count = count;
+    }
+
+    /****/
+    inline void Add(int ref, uint8_t LUT)
+    {
+        if (LUT == 0) {
+            return;
+        }
+
+        const size_t block = static_cast<size_t>(ref >> ROCK_SCROLL_SUMMARY_BLOCK_SHIFT);
+        auto& level_0 = m_levels[0];
+        if (block >= level_0.size()) {
+            level_0.resize(block + 1, RockScrollSummaryEntry_t{-1, 0});
+        }
+
+        RockScrollSummaryEntry_t entry = {ref, LUT};
+        if (IsBetter(entry, level_0[block])) {
+            level_0[block] = entry;
+        }
+    }
+
+    void Finalize(int count);
+
+    /* Returns the best entry in the item range [first, last]. Partial blocks at the edges are read with getLUT */
+    template<typename GetLUT>
+    RockScrollSummaryEntry_t Query(int first, int last, GetLUT getLUT) const
+    {
+        RockScrollSummaryEntry_t best = {-1, 0};
+
+        if (last >= m_count) {
+            last = m_count - 1;
+        }
+        if ((first > last) || m_levels.empty()) {
+            return best;
+        }
+
+        int firstBlock = (first + ROCK_SCROLL_SUMMARY_BLOCK_SIZE - 1) >> ROCK_SCROLL_SUMMARY_BLOCK_SHIFT;
+        int lastBlock = ((last + 1) >> ROCK_SCROLL_SUMMARY_BLOCK_SHIFT) - 1;
+
+        if (firstBlock > lastBlock) {
+            /* Range is within a block, or just stretch over a block border */
+            for (int index = first; index <= last; ++index) {
+                Check(best, index, getLUT(index));
+            }
+            return best;
+        }
+
+        const int headEnd = firstBlock << ROCK_SCROLL_SUMMARY_BLOCK_SHIFT;
+        for (int index = first; index < headEnd; ++index) {
+            Check(best, index, getLUT(index));
+        }
+
+        /* Climb the levels, at each level pick the odd edge nodes not covered by a parent */
+        for (size_t level = 0; level < m_levels.size() && firstBlock <= lastBlock; ++level) {
+            const auto& entries = m_levels[level];
+            const int size = static_cast<int>(entries.size());
+            if (lastBlock >= size) {
+                lastBlock = size - 1;
+            }
+            if (firstBlock & 1) {
+                if (IsBetter(entries[static_cast<size_t>(firstBlock)], best)) {
+                    best = entries[static_cast<size_t>(firstBlock)];
+                }
+                ++firstBlock;
+            }
+            if ((firstBlock <= lastBlock) && !(lastBlock & 1)) {
+                if (IsBetter(entries[static_cast<size_t>(lastBlock)], best)) {
+                    best = entries[static_cast<size_t>(lastBlock)];
+                }
+                --lastBlock;
+            }
+            if (firstBlock > lastBlock) {
+                break;
+            }
+            firstBlock >>= 1;
+            lastBlock >>= 1;
+        }
+
+        const int tailStart = (((last + 1) >> ROCK_SCROLL_SUMMARY_BLOCK_SHIFT) << ROCK_SCROLL_SUMMARY_BLOCK_SHIFT);
+        for (int index = tailStart > first ? tailStart : first; index <= last; ++index) {
+            Check(best, index, getLUT(index));
+        }
+
+        return best;
+    }
+
+    int GetCount(void) const {return m_count;}
+
+    /****/
+    size_t GetMemorySize(void) const
+    {
+        size_t size = m_levels.capacity() * sizeof(m_levels[0]);
+        for (const auto& level : m_levels) {
+            size += level.capacity() * sizeof(RockScrollSummaryEntry_t);
+        }
+        return size;
+    }
+
+private:
+    /****/
+    static inline void Check(RockScrollSummaryEntry_t& best, int ref, uint8_t LUT)
+    {
+        RockScrollSummaryEntry_t entry = {ref, LUT};
+        if (IsBetter(entry, best)) {
+            best = entry;
+        }
+    }
+
+    std::vector<std::vector<RockScrollSummaryEntry_t>> m_levels;
+    int m_count = 0;
+    int m_dirtyBlock = 0;   /* First level-0 block changed since last Finalize */
+};
+
+/***********************************************************************************************************************
+*   CRockScrollSummary
+*
+*   Keeps the rock scroll overview as a by-product of filtering. PopulatePackedFIRA feeds it while walking the FIRA, the
+*   editor then only resamples the summary to the current number of rasters instead of walking all rows. At tail
+*   (incremental) filtering only the last blocks are recomputed.
+***********************************************************************************************************************/
+class CRockScrollSummary
+{
+public:
+    void Clean(void);
+
+    /* Prepare for (re-)populating the summary from startRow (all rows) and startPacked (packed FIRA index) */
+    void BeginUpdate(const FIR_t *FIR_Array_p, int startRow, const packed_FIR_t *packedFIR_p, int startPacked);
+
+    /****/
+    inline void AddRow(int row, uint8_t LUT) {m_rows.Add(row, LUT);}
+
+    /****/
+    inline void AddPacked(int packedIndex, uint8_t LUT) {m_packed.Add(packedIndex, LUT);}
+
+    void EndUpdate(int rows, int packedCount);
+
+    RockScrollSummaryEntry_t QueryRows(const FIR_t *FIR_Array_p, int firstRow, int lastRow) const;
+    RockScrollSummaryEntry_t QueryPacked(const packed_FIR_t *packedFIR_p, int firstIndex, int lastIndex) const;
+
+    int GetRows(void) const {return m_rows.GetCount();}
+    int GetPackedCount(void) const {return m_packed.GetCount();}
+
+    /****/
+    size_t GetMemorySize(void) const {return m_rows.GetMemorySize() + m_packed.GetMemorySize();}
+
+private:
+    CMinLUTPyramid m_rows;    /* Over all rows, the raw FIR LUT index (including exclude filters and bookmarks) */
+    CMinLUTPyramid m_packed;  /* Over the packed FIRA, used when only filtered rows are presented */
+};
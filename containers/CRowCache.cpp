@@ -10,6 +10,7 @@
 #include "CMemPool.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 
 static char g_largeTempString[CACHE_CMEM_POOL_SIZE_MAX];  /* this string is used as temporary storage for strings being
                                                            * decoded */
@@ -87,8 +88,13 @@ void CRowCache::Get(const int rowIndex, char **text_p, int *size_p, int *propert
             *properties_p = m_cache_memMap[cacheIndex].properties;
         }
 
+        ++m_stats.hits;
         return;
     } else {
+        QElapsedTimer missTimer;
+        missTimer.start();
+        ++m_stats.misses;
+
         /* In-case the row is really large we limit it here... */
         const auto rowSize = m_TIA_p->textItemArray_p[rowIndex].size > DISPLAY_MAX_ROW_SIZE ?
                              DISPLAY_MAX_ROW_SIZE : m_TIA_p->textItemArray_p[rowIndex].size;
@@ -148,7 +154,13 @@ void CRowCache::Get(const int rowIndex, char **text_p, int *size_p, int *propert
         dataRef_p[readBytes] = 0;  /* 0 terminated */
 
         RemoveBadChars(cacheIndex);
-        Decode(cacheIndex);
+
+        if (!m_decoders.isEmpty()) {
+            QElapsedTimer decodeTimer;
+            decodeTimer.start();
+            Decode(cacheIndex);
+            m_stats.decodeTime_ns += decodeTimer.nsecsElapsed();
+        }
 
         *size_p = m_cache_memMap[cacheIndex].size;
         *text_p = reinterpret_cast<char *>(m_cache_memMap[cacheIndex].poolItem_p->GetDataRef());
@@ -158,6 +170,8 @@ void CRowCache::Get(const int rowIndex, char **text_p, int *size_p, int *propert
         if (properties_p != nullptr) {
             *properties_p = m_cache_memMap[cacheIndex].properties;
         }
+
+        m_stats.missTime_ns += missTimer.nsecsElapsed();
     }
 }
 
@@ -52,6 +52,14 @@ typedef struct {
     int properties; /* TIA_CACHE_MEMMAP_PROPERTY_DECODED */
 }TIA_Cache_MemMap_t;
 
+/* Running counters of the row cache, the editor frame statistics take the difference over a frame */
+typedef struct {
+    int64_t hits;
+    int64_t misses;
+    int64_t missTime_ns;    /* Reading, cleaning and decoding the missing rows */
+    int64_t decodeTime_ns;  /* The part of missTime_ns spent in the decoders */
+}RowCacheStats_t;
+
 /***********************************************************************************************************************
 *   CRowCache
 ***********************************************************************************************************************/
@@ -98,6 +106,12 @@ public:
                 m_cache_memMap[index].poolItem_p = nullptr;
             }
 
+            MemAcc_Add(MEM_ACC_AUTOHIGHLIGHT_e,
+                       -m_cache_memMap[index].autoHighligth.elementRefs.count() *
+                       static_cast<int64_t>(sizeof(TextRectElement_t)) -
+                       m_cache_memMap[index].fontModification.elementRefs.count() *
+                       static_cast<int64_t>(sizeof(FontModification_Element_t)));
+
             while (!m_cache_memMap[index].autoHighligth.elementRefs.isEmpty()) {
                 free(m_cache_memMap[index].autoHighligth.elementRefs.takeFirst());
             }
@@ -160,6 +174,12 @@ public:
     int GetFilterIndex(const int rowIndex);
     void GetTextItemLength(const int rowIndex, int *size_p);
 
+    /****/
+    const RowCacheStats_t& GetStats(void) const
+    {
+        return m_stats;
+    }
+
 private:
     QFile *m_qFile_p;
     TIA_Cache_MemMap_t m_cache_memMap[CACHE_MEM_MAP_SIZE];
@@ -167,4 +187,5 @@ private:
     FIRA_t *m_FIRA_p;
     CFilterItem **m_filterItem_LUT_pp;
     CMemPool& m_memPool;
+    RowCacheStats_t m_stats = {};
 };
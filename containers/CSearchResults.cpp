@@ -0,0 +1,73 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "CSearchResults.h"
+#include "CMemAccounting.h"
+
+#include <string.h>
+
+#define SEARCH_RESULTS_BLOCK_BYTES  (static_cast<int64_t>(sizeof(SearchHit_t)) * SEARCH_RESULTS_BLOCK_SIZE)
+
+/***********************************************************************************************************************
+*   ~CSearchResults
+***********************************************************************************************************************/
+CSearchResults::~CSearchResults(void)
+{
+    for (size_t index = 0; index < m_blocks.size() && m_blocks[index]; ++index) {
+        MemAcc_Add(MEM_ACC_SEARCH_RESULTS_e, -SEARCH_RESULTS_BLOCK_BYTES);
+    }
+}
+
+/***********************************************************************************************************************
+*   Clear
+***********************************************************************************************************************/
+void CSearchResults::Clear(const QString& searchText)
+{
+    m_count.store(0, std::memory_order_release);
+
+    /* Keep the first block, most results fits in it */
+    for (size_t index = 1; index < m_blocks.size() && m_blocks[index]; ++index) {
+        m_blocks[index].reset();
+        MemAcc_Add(MEM_ACC_SEARCH_RESULTS_e, -SEARCH_RESULTS_BLOCK_BYTES);
+    }
+
+    m_searchText = searchText;
+    m_generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+/***********************************************************************************************************************
+*   Append
+***********************************************************************************************************************/
+bool CSearchResults::Append(const SearchHit_t *hits_p, int count)
+{
+    int index = m_count.load(std::memory_order_relaxed);
+
+    while (count > 0) {
+        const size_t block = static_cast<size_t>(index >> SEARCH_RESULTS_BLOCK_SHIFT);
+        const int blockOffset = index & (SEARCH_RESULTS_BLOCK_SIZE - 1);
+
+        if (block >= m_blocks.size()) {
+            return false;
+        }
+
+        if (!m_blocks[block]) {
+            m_blocks[block].reset(new SearchHit_t[SEARCH_RESULTS_BLOCK_SIZE]);
+            MemAcc_Add(MEM_ACC_SEARCH_RESULTS_e, SEARCH_RESULTS_BLOCK_BYTES);
+        }
+
+        const int space = SEARCH_RESULTS_BLOCK_SIZE - blockOffset;
+        const int part = count < space ? count : space;
+        memcpy(&m_blocks[block][blockOffset], hits_p, sizeof(SearchHit_t) * static_cast<size_t>(part));
+
+        hits_p += part;
+        count -= part;
+        index += part;
+
+        /* Publish the hits, the GUI reads up to the count */
+        m_count.store(index, std::memory_order_release);
+    }
+
+    return true;
+}
@@ -0,0 +1,65 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <QString>
+
+#define SEARCH_RESULTS_BLOCK_SHIFT  16
+#define SEARCH_RESULTS_BLOCK_SIZE   (1 << SEARCH_RESULTS_BLOCK_SHIFT)
+#define SEARCH_RESULTS_MAX_BLOCKS   4096       /* 268M hits */
+
+typedef struct {
+    int32_t row;
+    int32_t offset; /* Start of the match in the row, -1 if not known */
+    int32_t length; /* Length of the match, when offset is known */
+} SearchHit_t;
+
+/***********************************************************************************************************************
+*   CSearchResults
+*
+*   The hits of a find-all search, in row order. The hits are stored in fixed size blocks, the block table is never
+*   re-allocated so the GUI may read the hits already added (up to GetCount) while the search is appending more.
+***********************************************************************************************************************/
+class CSearchResults
+{
+public:
+    CSearchResults(void) : m_blocks(SEARCH_RESULTS_MAX_BLOCKS) {}
+    ~CSearchResults(void);
+
+    /* Must not be called while a search is appending */
+    void Clear(const QString& searchText = QString());
+
+    /* Returns false if the result is full, the hits that didn't fit are dropped */
+    bool Append(const SearchHit_t *hits_p, int count);
+
+    /****/
+    int GetCount(void) const {return m_count.load(std::memory_order_acquire);}
+
+    /****/
+    const SearchHit_t& Get(int index) const
+    {
+        return m_blocks[static_cast<size_t>(index >> SEARCH_RESULTS_BLOCK_SHIFT)]
+               [index & (SEARCH_RESULTS_BLOCK_SIZE - 1)];
+    }
+
+    /* Incremented at each Clear, for views to know when to reset */
+    int GetGeneration(void) const {return m_generation.load(std::memory_order_acquire);}
+
+    const QString& GetSearchText(void) const {return m_searchText;}
+
+    std::atomic_bool m_running {false}; /* Set while the find-all search is appending */
+
+private:
+    std::vector<std::unique_ptr<SearchHit_t[]>> m_blocks;
+    std::atomic_int m_count {0};
+    std::atomic_int m_generation {0};
+    QString m_searchText;
+};
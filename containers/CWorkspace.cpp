@@ -347,6 +347,18 @@ bool CWorkspace_isBookmarked(int row)
     return false;
 }
 
+/***********************************************************************************************************************
+*   CWorkspace_ShiftBookmarks
+***********************************************************************************************************************/
+void CWorkspace_ShiftBookmarks(int fromRow, int delta)
+{
+    if (g_workspace_p == nullptr) {
+        Q_ASSERT(CSCZ_SystemState != SYSTEM_STATE_RUNNING);
+        return;
+    }
+    g_workspace_p->ShiftBookmarks(fromRow, delta);
+}
+
 /***********************************************************************************************************************
 *   CWorkspace_RemoveAllBookmarks
 ***********************************************************************************************************************/
@@ -1383,6 +1395,7 @@ CCfgItem_FilterItem *CWorkspace::AddFilterItem(char *filterText_p, CCfgItem_Filt
                           &filterItem_p->m_caseSensitive,
                           &filterItem_p->m_exclude,
                           &filterItem_p->m_regexpr,
+                          &filterItem_p->m_expression,
                           m_filters_p,  /* MOVE_FILTER */
                           &cfgFilter_p,
                           parent);  /* MOVE_FILTER */
@@ -1824,6 +1837,28 @@ void CWorkspace::RemoveAllBookmarks(void)
     m_bookmarks_p->RemoveAllChildren();
 }
 
+/***********************************************************************************************************************
+*   ShiftBookmarks
+***********************************************************************************************************************/
+void CWorkspace::ShiftBookmarks(int fromRow, int delta)
+{
+    /* The rows from fromRow were moved delta rows in the log, e.g. as a frozen log file segment grew. The bookmarks
+     * are kept sorted by row, hence moving the ones after fromRow keeps the order. */
+    if ((m_bookmarks_p == nullptr) || (delta == 0)) {
+        return;
+    }
+    for (auto cfgItem_p : m_bookmarks_p->m_cfgChildItems) {
+        auto bookmark_p = static_cast<CCfgItem_Bookmark *>(cfgItem_p);
+        if (bookmark_p->m_row >= fromRow) {
+            bookmark_p->m_row += delta;
+
+            QString itemText = QString("%1 - %2").arg(bookmark_p->m_row).arg(bookmark_p->m_comment);
+            bookmark_p->Set(itemText, 0, CFG_ITEM_KIND_Bookmark);
+            CWorkspace_ItemUpdated(bookmark_p);
+        }
+    }
+}
+
 /***********************************************************************************************************************
 *   CloseAllPlugins
 ***********************************************************************************************************************/
@@ -2118,6 +2153,16 @@ QVariant Model::data(const QModelIndex &index, int role) const
             return font;
         }
         return QVariant();
+    } else if (role == Qt::ToolTipRole) {
+        /* The filter item profile from the last filtering */
+        FilterItemProfile_t profile;
+        if ((item_p != nullptr) && (item_p->m_itemKind == CFG_ITEM_KIND_FilterItem)) {
+            const int uniqueID = static_cast<CCfgItem_FilterItem *>(item_p)->m_filterItem_ref_p->m_uniqueID;
+            if (GetTheDoc()->GetFilterItemProfile(uniqueID, &profile)) {
+                return QVariant(FilterItemProfile_ToString(profile));
+            }
+        }
+        return QVariant();
     } else if (role == Qt::CheckStateRole) {
         switch (item_p->m_itemKind)
         {
@@ -159,6 +159,7 @@ public:
     int GetBookmarksCount(void) {return m_bookmarks_p->m_cfgChildItems.count();}
     bool NextBookmark(int currentRow, int *bookmarkRow_p, bool backward = false);
     void RemoveAllBookmarks(void);
+    void ShiftBookmarks(int fromRow, int delta);
     void EditBookmark(int row);
     void AddPlugin(CPlugin_DLL_API *pluginAPI_p, QLibrary *library_p);
     void CloseAllPlugins(void);
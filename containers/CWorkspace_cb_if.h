@@ -25,6 +25,7 @@ void CWorkspace_GetMatchingFilters(QList<CCfgItem_FilterItem *> *filterItemList_
                                    const QString& match);
 void CWorkspace_GetBookmarks(QList<int> *bookmarks);
 bool CWorkspace_isBookmarked(int row);
+void CWorkspace_ShiftBookmarks(int fromRow, int delta);
 
 CCfgItem_Plugin *CWorkspace_GetSelectedPlugin(CCfgItem *selection_p = nullptr);
 QList<CCfgItem *> *CWorkspace_GetFilterList(void);
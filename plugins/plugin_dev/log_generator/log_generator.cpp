@@ -0,0 +1,807 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+/* log_generator.cpp : Generates large synthetic logs that look like production logs, for performance testing.
+ *
+ *   log_generator big.txt --size 8G                       Generate an 8 GB log, with all cores
+ *   log_generator live.txt --append --rate 20 --size 0    Append to live.txt at 20 MB/s until stopped (tail mode)
+ *
+ * The rows are "<date> <time> <message>", where the messages are picked from templates with Zipfian frequencies (the
+ * first template is the most frequent). The timestamps come in bursts, a few rows are multi-KB stack traces (with
+ * continuation lines without timestamp), a few rows are longer than FILECTRL_ROW_MAX_SIZE, and a part of the rows end
+ * with CRLF instead of LF.
+ *
+ * The log is generated in blocks, by several threads, and written in block order. Each block has its own random
+ * generator seeded from the seed and the block index, hence the same options generate the same log regardless of the
+ * number of threads. */
+
+#include <QtCore/QCoreApplication>
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <QByteArray>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+#define BLOCK_SIZE              (4 * 1024 * 1024)   /* Generated per thread at a time */
+#define APPEND_BLOCK_SIZE       (256 * 1024)
+#define APPEND_INTERVAL_MS      100
+#define BLOCKS_IN_FLIGHT        2                   /* Per thread, generated but not yet written */
+#define LONG_LINE_MIN_SIZE      (4096 + 512)        /* Above FILECTRL_ROW_MAX_SIZE */
+#define LONG_LINE_MAX_SIZE      (64 * 1024)
+#define STACK_TRACE_MIN_FRAMES  10
+#define STACK_TRACE_MAX_FRAMES  80
+#define TIME_EPOCH              1709251200          /* 2024-03-01 00:00:00 UTC, start of the generated logs */
+#define BURST_START_PROBABILITY 0.002               /* Per row, the timestamps go into a burst */
+#define BURST_END_PROBABILITY   0.02                /* Per row, i.e. bursts of ~50 rows */
+#define BURST_GAP_FACTOR        0.02                /* The time between rows in a burst, relative outside */
+
+typedef std::mt19937_64 Rng_t;
+
+typedef enum {
+    TOKEN_TEXT,
+    TOKEN_INT,      /* {int:min:max} */
+    TOKEN_HEX,      /* {hex:bytes} */
+    TOKEN_JSON,     /* {json} */
+    TOKEN_WORD,     /* {word} */
+    TOKEN_IP,       /* {ip} */
+    TOKEN_UUID,     /* {uuid} */
+    TOKEN_THREAD    /* {thread} */
+} TokenType_e;
+
+typedef struct {
+    TokenType_e type;
+    QByteArray text;
+    int64_t min;
+    int64_t max;
+} Token_t;
+
+typedef std::vector<Token_t> Template_t;
+
+typedef struct {
+    QString fileName;
+    int64_t size;           /* Bytes, 0 is no limit when appending */
+    int threads;
+    uint64_t seed;
+    double zipf;            /* Exponent of the template frequencies */
+    double crlf;            /* Percent of the lines */
+    double stackTraces;     /* Percent of the rows */
+    double longLines;       /* Per million rows */
+    double span;            /* Seconds covered by the timestamps of the log */
+    bool append;
+    double rate;            /* MB/s when appending */
+    int duration;           /* Seconds when appending, 0 until stopped */
+    QStringList templates;
+} GeneratorConfig_t;
+
+/* The default templates, most frequent first */
+static const char *g_defaultTemplates[] = {
+    "INFO  [{thread}] http.server: GET /api/v1/items/{int:1:99999} 200 {int:1:900}ms",
+    "DEBUG [{thread}] db.pool: Acquired connection {int:1:64} of 64, waited {int:0:5000}us",
+    "DEBUG [{thread}] cache: Miss key={hex:8} region={word}",
+    "INFO  [{thread}] session: User {int:1000:99999} logged in from {ip}",
+    "TRACE [{thread}] net.rx: Frame {int:0:65535} len={int:64:1500} data={hex:24}",
+    "INFO  [{thread}] scheduler: Job {uuid} completed in {int:1:60000} ms",
+    "DEBUG [{thread}] kafka.consumer: Committed offset {int:0:999999999} partition {int:0:31}",
+    "INFO  [{thread}] audit: {json}",
+    "INFO  [{thread}] metrics: cpu={int:0:100}% mem={int:100:16000}MB gc={int:0:300}ms threads={int:8:512}",
+    "WARN  [{thread}] http.client: Retrying request to {ip}:{int:1024:65535}, attempt {int:1:5}",
+    "INFO  [{thread}] storage: Wrote block {hex:12} ({int:4096:1048576} bytes) to volume {int:0:7}",
+    "DEBUG [{thread}] config: Reloaded {int:1:400} entries from /etc/app/{word}.conf",
+    "WARN  [{thread}] auth: Token {hex:16} for user {int:1000:99999} expires in {int:1:300}s",
+    "ERROR [{thread}] db.query: Deadlock detected on table {word}, transaction {hex:8} rolled back",
+    "ERROR [{thread}] http.server: POST /api/v1/orders 500 body={json}",
+    "INFO  [{thread}] cluster: Node {ip} joined, members={int:3:64} epoch={int:1:100000}",
+    "WARN  [{thread}] disk: Volume {int:0:7} at {int:80:99}% capacity",
+    "FATAL [{thread}] watchdog: Thread worker-{int:1:16} not responding for {int:10:120}s",
+};
+
+static const char *g_words[] = {
+    "orders", "items", "users", "sessions", "payments", "inventory", "shipping", "catalog", "accounts", "events",
+    "reports", "metrics", "billing", "search", "profile", "settings", "gateway", "ledger", "queue", "archive"
+};
+
+static const char *g_exceptions[] = {
+    "java.lang.IllegalStateException", "java.lang.NullPointerException", "java.io.IOException",
+    "java.util.concurrent.TimeoutException", "java.sql.SQLTransientConnectionException"
+};
+
+static const char *g_methods[] = {
+    "process", "handle", "execute", "run", "invoke", "apply", "dispatch", "call", "doFilter", "service"
+};
+
+#define ARRAY_COUNT(array) (static_cast<int>(sizeof(array) / sizeof((array)[0])))
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ * -- Random helpers --
+ * ---------------------------------------------------------------------------------------------------------------------
+ * */
+
+/* [0, 1) */
+static inline double _uniform(Rng_t& rng)
+{
+    return static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* [min, max] */
+static inline int64_t _range(Rng_t& rng, int64_t min, int64_t max)
+{
+    return min + static_cast<int64_t>(rng() % static_cast<uint64_t>(max - min + 1));
+}
+
+/* The days since 1970-01-01 as a date, H. Hinnant's civil_from_days */
+static void _civilFromDays(int64_t days, int *year_p, unsigned *month_p, unsigned *day_p)
+{
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(days - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+
+    *day_p = doy - (153 * mp + 2) / 5 + 1;
+    *month_p = mp < 10 ? mp + 3 : mp - 9;
+    *year_p = static_cast<int>(static_cast<int64_t>(yoe) + era * 400 + (*month_p <= 2 ? 1 : 0));
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ * -- CLogGenerator --
+ * ---------------------------------------------------------------------------------------------------------------------
+ * */
+class CLogGenerator
+{
+public:
+    explicit CLogGenerator(const GeneratorConfig_t& config);
+
+    /* Generate a block of about blockSize bytes of complete rows, with the timestamps spread over
+     * [timeBase, timeBase + timeSpan[ seconds since TIME_EPOCH */
+    void GenerateBlock(int64_t blockIndex, int blockSize, double timeBase, double timeSpan, QByteArray& out) const;
+
+    /****/
+    bool IsValid(void) const {return !m_templates.empty();}
+
+private:
+    bool ParseTemplate(const QString& text, Template_t& tokens);
+    void AppendEol(Rng_t& rng, QByteArray& out) const;
+    void AppendTemplate(Rng_t& rng, const Template_t& tokens, QByteArray& out) const;
+    void AppendJson(Rng_t& rng, QByteArray& out) const;
+    void AppendHex(Rng_t& rng, int bytes, QByteArray& out) const;
+    void AppendStackTrace(Rng_t& rng, QByteArray& out) const;
+    void AppendLongLine(Rng_t& rng, QByteArray& out) const;
+
+    GeneratorConfig_t m_config;
+    std::vector<Template_t> m_templates;
+    std::vector<double> m_zipfCDF;   /* Cumulative probability per template */
+};
+
+/***********************************************************************************************************************
+*   CLogGenerator
+***********************************************************************************************************************/
+CLogGenerator::CLogGenerator(const GeneratorConfig_t& config) : m_config(config)
+{
+    QStringList templates = config.templates;
+
+    if (templates.isEmpty()) {
+        for (int index = 0; index < ARRAY_COUNT(g_defaultTemplates); ++index) {
+            templates.append(QString(g_defaultTemplates[index]));
+        }
+    }
+
+    for (auto& text : templates) {
+        Template_t tokens;
+        if (ParseTemplate(text, tokens)) {
+            m_templates.push_back(tokens);
+        } else {
+            qInfo() << QString("Template ignored: %1").arg(text);
+        }
+    }
+
+    /* Zipf, the template of rank k (from 1) has the weight 1/k^s */
+    double sum = 0.0;
+    for (size_t index = 0; index < m_templates.size(); ++index) {
+        sum += 1.0 / std::pow(static_cast<double>(index + 1), m_config.zipf);
+        m_zipfCDF.push_back(sum);
+    }
+
+    for (auto& cdf : m_zipfCDF) {
+        cdf /= sum;
+    }
+}
+
+/***********************************************************************************************************************
+*   ParseTemplate
+***********************************************************************************************************************/
+bool CLogGenerator::ParseTemplate(const QString& text, Template_t& tokens)
+{
+    const QByteArray bytes = text.toUtf8();
+    int index = 0;
+
+    while (index < bytes.size()) {
+        const int open = bytes.indexOf('{', index);
+        const int close = open < 0 ? -1 : bytes.indexOf('}', open);
+
+        if (open < 0 || close < 0) {
+            tokens.push_back({TOKEN_TEXT, bytes.mid(index), 0, 0});
+            break;
+        }
+
+        if (open > index) {
+            tokens.push_back({TOKEN_TEXT, bytes.mid(index, open - index), 0, 0});
+        }
+
+        const QList<QByteArray> fields = bytes.mid(open + 1, close - open - 1).split(':');
+        const QByteArray& name = fields[0];
+        Token_t token = {TOKEN_TEXT, QByteArray(), 0, 0};
+        bool ok = true;
+
+        if ((name == "int") && (fields.count() == 3)) {
+            bool minOk;
+            bool maxOk;
+            token = {TOKEN_INT, QByteArray(), fields[1].toLongLong(&minOk), fields[2].toLongLong(&maxOk)};
+            ok = minOk && maxOk && (token.min <= token.max);
+        } else if ((name == "hex") && (fields.count() == 2)) {
+            token = {TOKEN_HEX, QByteArray(), fields[1].toLongLong(&ok), 0};
+            ok = ok && (token.min > 0) && (token.min <= LONG_LINE_MAX_SIZE);
+        } else if (name == "json") {
+            token.type = TOKEN_JSON;
+        } else if (name == "word") {
+            token.type = TOKEN_WORD;
+        } else if (name == "ip") {
+            token.type = TOKEN_IP;
+        } else if (name == "uuid") {
+            token.type = TOKEN_UUID;
+        } else if (name == "thread") {
+            token.type = TOKEN_THREAD;
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            return false;
+        }
+
+        tokens.push_back(token);
+        index = close + 1;
+    }
+
+    return !tokens.empty();
+}
+
+/***********************************************************************************************************************
+*   AppendEol
+***********************************************************************************************************************/
+void CLogGenerator::AppendEol(Rng_t& rng, QByteArray& out) const
+{
+    if (_uniform(rng) * 100.0 < m_config.crlf) {
+        out.append("\r\n", 2);
+    } else {
+        out.append('\n');
+    }
+}
+
+/***********************************************************************************************************************
+*   AppendHex
+***********************************************************************************************************************/
+void CLogGenerator::AppendHex(Rng_t& rng, int bytes, QByteArray& out) const
+{
+    static const char hex[] = "0123456789abcdef";
+    uint64_t value = 0;
+
+    for (int index = 0; index < bytes; ++index) {
+        if ((index & 7) == 0) {
+            value = rng();
+        }
+        out.append(hex[(value >> 4) & 0xf]);
+        out.append(hex[value & 0xf]);
+        value >>= 8;
+    }
+}
+
+/***********************************************************************************************************************
+*   AppendJson
+***********************************************************************************************************************/
+void CLogGenerator::AppendJson(Rng_t& rng, QByteArray& out) const
+{
+    char buffer[128];
+    const int fields = static_cast<int>(_range(rng, 2, 6));
+
+    out.append("{\"id\":");
+    out.append(QByteArray::number(static_cast<qlonglong>(_range(rng, 1, 9999999))));
+
+    for (int index = 0; index < fields; ++index) {
+        const char *key_p = g_words[rng() % ARRAY_COUNT(g_words)];
+
+        switch (rng() % 4)
+        {
+            case 0:
+                snprintf(buffer, sizeof(buffer), ",\"%s\":\"%s\"", key_p, g_words[rng() % ARRAY_COUNT(g_words)]);
+                break;
+
+            case 1:
+                snprintf(buffer, sizeof(buffer), ",\"%s\":%.3f", key_p, _uniform(rng) * 1000.0);
+                break;
+
+            case 2:
+                snprintf(buffer, sizeof(buffer), ",\"%s\":%s", key_p, (rng() & 1) ? "true" : "false");
+                break;
+
+            default:
+                snprintf(buffer, sizeof(buffer), ",\"%s\":{\"count\":%d,\"ref\":\"", key_p,
+                         static_cast<int>(_range(rng, 0, 1000)));
+                out.append(buffer);
+                AppendHex(rng, 6, out);
+                snprintf(buffer, sizeof(buffer), "\"}");
+                break;
+        } /* switch */
+
+        out.append(buffer);
+    }
+
+    out.append('}');
+}
+
+/***********************************************************************************************************************
+*   AppendTemplate
+***********************************************************************************************************************/
+void CLogGenerator::AppendTemplate(Rng_t& rng, const Template_t& tokens, QByteArray& out) const
+{
+    char buffer[64];
+
+    for (auto& token : tokens) {
+        switch (token.type)
+        {
+            case TOKEN_TEXT:
+                out.append(token.text);
+                break;
+
+            case TOKEN_INT:
+                out.append(QByteArray::number(static_cast<qlonglong>(_range(rng, token.min, token.max))));
+                break;
+
+            case TOKEN_HEX:
+                AppendHex(rng, static_cast<int>(token.min), out);
+                break;
+
+            case TOKEN_JSON:
+                AppendJson(rng, out);
+                break;
+
+            case TOKEN_WORD:
+                out.append(g_words[rng() % ARRAY_COUNT(g_words)]);
+                break;
+
+            case TOKEN_IP:
+                snprintf(buffer, sizeof(buffer), "10.%d.%d.%d", static_cast<int>(rng() % 256),
+                         static_cast<int>(rng() % 256), static_cast<int>(_range(rng, 1, 254)));
+                out.append(buffer);
+                break;
+
+            case TOKEN_UUID:
+                AppendHex(rng, 4, out);
+                out.append('-');
+                AppendHex(rng, 2, out);
+                out.append('-');
+                AppendHex(rng, 2, out);
+                out.append('-');
+                AppendHex(rng, 2, out);
+                out.append('-');
+                AppendHex(rng, 6, out);
+                break;
+
+            case TOKEN_THREAD:
+                snprintf(buffer, sizeof(buffer), "worker-%d", static_cast<int>(_range(rng, 1, 16)));
+                out.append(buffer);
+                break;
+        } /* switch */
+    }
+
+    AppendEol(rng, out);
+}
+
+/***********************************************************************************************************************
+*   AppendStackTrace
+*   An error row followed by the frames, as continuation lines without timestamps
+***********************************************************************************************************************/
+void CLogGenerator::AppendStackTrace(Rng_t& rng, QByteArray& out) const
+{
+    char buffer[256];
+    const int frames = static_cast<int>(_range(rng, STACK_TRACE_MIN_FRAMES, STACK_TRACE_MAX_FRAMES));
+
+    snprintf(buffer, sizeof(buffer), "ERROR [worker-%d] app.%s: Unhandled exception %s: %s request failed",
+             static_cast<int>(_range(rng, 1, 16)), g_words[rng() % ARRAY_COUNT(g_words)],
+             g_exceptions[rng() % ARRAY_COUNT(g_exceptions)], g_words[rng() % ARRAY_COUNT(g_words)]);
+    out.append(buffer);
+    AppendEol(rng, out);
+
+    for (int frame = 0; frame < frames; ++frame) {
+        const char *package_p = g_words[rng() % ARRAY_COUNT(g_words)];
+
+        if ((frame > 0) && (rng() % 25 == 0)) {
+            snprintf(buffer, sizeof(buffer), "Caused by: %s: %s unavailable",
+                     g_exceptions[rng() % ARRAY_COUNT(g_exceptions)], package_p);
+        } else {
+            snprintf(buffer, sizeof(buffer), "\tat com.example.%s.%c%sService.%s(%c%sService.java:%d)", package_p,
+                     package_p[0] - 'a' + 'A', &package_p[1], g_methods[rng() % ARRAY_COUNT(g_methods)],
+                     package_p[0] - 'a' + 'A', &package_p[1], static_cast<int>(_range(rng, 20, 2000)));
+        }
+        out.append(buffer);
+        AppendEol(rng, out);
+    }
+}
+
+/***********************************************************************************************************************
+*   AppendLongLine
+***********************************************************************************************************************/
+void CLogGenerator::AppendLongLine(Rng_t& rng, QByteArray& out) const
+{
+    char buffer[64];
+
+    snprintf(buffer, sizeof(buffer), "DEBUG [worker-%d] net.dump: payload=", static_cast<int>(_range(rng, 1, 16)));
+    out.append(buffer);
+    AppendHex(rng, static_cast<int>(_range(rng, LONG_LINE_MIN_SIZE, LONG_LINE_MAX_SIZE)) / 2, out);
+    AppendEol(rng, out);
+}
+
+/***********************************************************************************************************************
+*   GenerateBlock
+*   The events (rows) are generated first, and then the timestamps. The time between the rows is exponentially
+*   distributed, much shorter during bursts, and scaled such that the block covers its time span.
+***********************************************************************************************************************/
+void CLogGenerator::GenerateBlock(int64_t blockIndex, int blockSize, double timeBase, double timeSpan,
+                                  QByteArray& out) const
+{
+    Rng_t rng(m_config.seed * 0x9E3779B97F4A7C15ULL + static_cast<uint64_t>(blockIndex));
+    const double stackTraceProbability = m_config.stackTraces / 100.0;
+    const double longLineProbability = m_config.longLines / 1000000.0;
+    QByteArray events;
+    std::vector<int> eventEnds;
+
+    events.reserve(blockSize + LONG_LINE_MAX_SIZE + 1024);
+
+    while (events.size() < blockSize) {
+        const double u = _uniform(rng);
+
+        if (u < longLineProbability) {
+            AppendLongLine(rng, events);
+        } else if (u < longLineProbability + stackTraceProbability) {
+            AppendStackTrace(rng, events);
+        } else {
+            const double zipf = _uniform(rng);
+            const auto rank = std::lower_bound(m_zipfCDF.begin(), m_zipfCDF.end(), zipf) - m_zipfCDF.begin();
+            AppendTemplate(rng, m_templates[std::min(static_cast<size_t>(rank), m_templates.size() - 1)], events);
+        }
+        eventEnds.push_back(static_cast<int>(events.size()));
+    }
+
+    /* Bursty gaps, as a two state process */
+    std::vector<double> gaps(eventEnds.size());
+    double totalGap = 0.0;
+    bool burst = false;
+
+    for (auto& gap : gaps) {
+        burst = burst ? (_uniform(rng) >= BURST_END_PROBABILITY) : (_uniform(rng) < BURST_START_PROBABILITY);
+        gap = -std::log(1.0 - _uniform(rng)) * (burst ? BURST_GAP_FACTOR : 1.0);
+        totalGap += gap;
+    }
+
+    const double scale = totalGap > 0.0 ? timeSpan / totalGap : 0.0;
+    int64_t prevSecond = -1;
+    char date[32];
+    char prefix[64];
+    double time = timeBase;
+    int start = 0;
+
+    out.clear();
+    out.reserve(events.size() + static_cast<int>(eventEnds.size()) * 28);
+
+    for (size_t index = 0; index < eventEnds.size(); ++index) {
+        const int64_t micro = static_cast<int64_t>(time * 1000000.0);
+        const int64_t second = TIME_EPOCH + micro / 1000000;
+
+        if (second != prevSecond) {
+            int year;
+            unsigned month;
+            unsigned day;
+            const int64_t secondOfDay = second % 86400;
+
+            _civilFromDays(second / 86400, &year, &month, &day);
+            snprintf(date, sizeof(date), "%04d-%02u-%02u %02d:%02d:%02d", year, month, day,
+                     static_cast<int>(secondOfDay / 3600), static_cast<int>((secondOfDay / 60) % 60),
+                     static_cast<int>(secondOfDay % 60));
+            prevSecond = second;
+        }
+
+        const int prefixSize = snprintf(prefix, sizeof(prefix), "%s.%06d ", date, static_cast<int>(micro % 1000000));
+
+        out.append(prefix, prefixSize);
+        out.append(events.constData() + start, eventEnds[index] - start);
+        start = eventEnds[index];
+        time += gaps[index] * scale;
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------------------------------
+ * -- Generation --
+ * ---------------------------------------------------------------------------------------------------------------------
+ * */
+
+/***********************************************************************************************************************
+*   GenerateFile
+*   The blocks are generated by the threads, in any order, and written in block order by the calling thread
+***********************************************************************************************************************/
+static bool GenerateFile(const GeneratorConfig_t& config, const CLogGenerator& generator, QFile& file)
+{
+    const int64_t numOfBlocks = std::max((config.size + BLOCK_SIZE - 1) / BLOCK_SIZE, static_cast<int64_t>(1));
+    const double blockSpan = config.span / static_cast<double>(numOfBlocks);
+    const int64_t maxInFlight = static_cast<int64_t>(config.threads) * BLOCKS_IN_FLIGHT;
+    std::map<int64_t, QByteArray> doneBlocks;
+    QMutex mutex;
+    QWaitCondition condition;
+    int64_t nextBlock = 0;     /* Next to be generated */
+    int64_t writtenBlocks = 0;
+    bool abort = false;
+    QList<QThread *> threads;
+
+    for (int index = 0; index < config.threads; ++index) {
+        threads.append(QThread::create([&]() {
+            QByteArray block;
+            while (true) {
+                int64_t blockIndex;
+                {
+                    QMutexLocker locker(&mutex);
+                    while (!abort && (nextBlock < numOfBlocks) && (nextBlock >= writtenBlocks + maxInFlight)) {
+                        condition.wait(&mutex);
+                    }
+                    if (abort || (nextBlock >= numOfBlocks)) {
+                        return;
+                    }
+                    blockIndex = nextBlock++;
+                }
+
+                generator.GenerateBlock(blockIndex, BLOCK_SIZE, blockSpan * static_cast<double>(blockIndex), blockSpan,
+                                        block);
+
+                QMutexLocker locker(&mutex);
+                doneBlocks[blockIndex] = block;
+                condition.wakeAll();
+            }
+        }));
+        threads.last()->start();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    int64_t written = 0;
+    int64_t reported = 0;
+    bool success = true;
+
+    for (int64_t blockIndex = 0; blockIndex < numOfBlocks && success; ++blockIndex) {
+        QByteArray block;
+        {
+            QMutexLocker locker(&mutex);
+            while (doneBlocks.find(blockIndex) == doneBlocks.end()) {
+                condition.wait(&mutex);
+            }
+            block = doneBlocks[blockIndex];
+            doneBlocks.erase(blockIndex);
+            writtenBlocks = blockIndex + 1;
+            condition.wakeAll();
+        }
+
+        if (file.write(block) != block.size()) {
+            qInfo() << QString("Failed to write %1, %2").arg(file.fileName()).arg(file.errorString());
+            success = false;
+        }
+
+        written += block.size();
+
+        if (written - reported >= 1024LL * 1024 * 1024) {
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            qInfo("%lld MB written, %.0f MB/s", static_cast<long long>(written / (1024 * 1024)),
+                  static_cast<double>(written) / (1024.0 * 1024.0) / std::max(seconds, 0.001));
+            reported = written;
+        }
+    }
+
+    {
+        QMutexLocker locker(&mutex);
+        abort = true;
+        condition.wakeAll();
+    }
+
+    for (auto& thread_p : threads) {
+        thread_p->wait();
+        delete thread_p;
+    }
+
+    success = file.flush() && success;
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    qInfo("Generated %s, %lld bytes in %.1f s, %.0f MB/s", QFileInfo(file).absoluteFilePath().toLatin1().constData(),
+          static_cast<long long>(written), seconds,
+          static_cast<double>(written) / (1024.0 * 1024.0) / std::max(seconds, 0.001));
+
+    return success;
+}
+
+/***********************************************************************************************************************
+*   AppendLive
+*   Appends complete rows every APPEND_INTERVAL_MS, paced to the rate. The timestamps follow the wall clock.
+***********************************************************************************************************************/
+static bool AppendLive(const GeneratorConfig_t& config, const CLogGenerator& generator, QFile& file)
+{
+    const double bytesPerSecond = config.rate * 1024.0 * 1024.0;
+    const double blockSpan = APPEND_BLOCK_SIZE / bytesPerSecond;
+    const double timeBase = static_cast<double>(QDateTime::currentSecsSinceEpoch() - TIME_EPOCH);
+    const auto start = std::chrono::steady_clock::now();
+    QByteArray pending;
+    QByteArray block;
+    int64_t blockIndex = 0;
+    int64_t written = 0;
+
+    qInfo("Appending to %s at %.1f MB/s", QFileInfo(file).absoluteFilePath().toLatin1().constData(), config.rate);
+
+    for (int64_t tick = 1;; ++tick) {
+        const double elapsed = static_cast<double>(tick * APPEND_INTERVAL_MS) / 1000.0;
+
+        if (((config.duration > 0) && (elapsed > config.duration)) || ((config.size > 0) && (written >= config.size))) {
+            break;
+        }
+
+        const int64_t target = static_cast<int64_t>(elapsed * bytesPerSecond) - written;
+
+        while (pending.size() < target) {
+            const double blockTime = timeBase + blockSpan * static_cast<double>(blockIndex);
+            generator.GenerateBlock(blockIndex, APPEND_BLOCK_SIZE, blockTime, blockSpan, block);
+            pending.append(block);
+            ++blockIndex;
+        }
+
+        /* Only complete lines */
+        const int size = target > 0 ? pending.lastIndexOf('\n', static_cast<int>(target) - 1) + 1 : 0;
+
+        if (size > 0) {
+            if (file.write(pending.constData(), size) != size) {
+                qInfo() << QString("Failed to write %1, %2").arg(file.fileName()).arg(file.errorString());
+                return false;
+            }
+            file.flush();
+            pending.remove(0, size);
+            written += size;
+        }
+
+        std::this_thread::sleep_until(start + std::chrono::milliseconds(tick * APPEND_INTERVAL_MS));
+    }
+
+    qInfo("Appended %lld bytes", static_cast<long long>(written));
+    return true;
+}
+
+/***********************************************************************************************************************
+*   _parseSize
+*   Bytes, with an optional K, M or G suffix
+***********************************************************************************************************************/
+static bool _parseSize(const QString& text, int64_t *size_p)
+{
+    QString number = text.trimmed().toUpper();
+    int64_t factor = 1;
+
+    if (number.endsWith('K')) {
+        factor = 1024;
+    } else if (number.endsWith('M')) {
+        factor = 1024 * 1024;
+    } else if (number.endsWith('G')) {
+        factor = 1024 * 1024 * 1024;
+    }
+
+    if (factor != 1) {
+        number.chop(1);
+    }
+
+    bool ok;
+    const double value = number.toDouble(&ok);
+    *size_p = static_cast<int64_t>(value * static_cast<double>(factor));
+    return ok && (value >= 0.0);
+}
+
+/*----------------------------------------------------------------------------------------------------------------------
+ * */
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+
+    parser.setApplicationDescription("Generates large synthetic logs for LogScrutinizer performance testing");
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "The log to generate (or append to)");
+    parser.addOption({{"s", "size"}, "Size of the log, e.g. 8G, 0 is no limit when appending (1G)", "size", "1G"});
+    parser.addOption({{"t", "threads"}, "Generating threads (all cores)", "threads",
+                      QString::number(QThread::idealThreadCount())});
+    parser.addOption({"seed", "Random seed, the same seed and options give the same log (1)", "seed", "1"});
+    parser.addOption({"templates", "File with message templates, one per line and the most frequent first. "
+                                   "Placeholders: {int:min:max} {hex:bytes} {json} {word} {ip} {uuid} {thread}",
+                      "file"});
+    parser.addOption({"zipf", "Exponent of the Zipfian template frequencies (1.1)", "exponent", "1.1"});
+    parser.addOption({"crlf", "Percent of the lines ending with CRLF (5)", "percent", "5"});
+    parser.addOption({"stack-traces", "Percent of the rows being multi-line stack traces (0.2)", "percent", "0.2"});
+    parser.addOption({"long-lines", "Rows per million longer than FILECTRL_ROW_MAX_SIZE (20)", "count", "20"});
+    parser.addOption({"span", "Seconds covered by the timestamps (86400)", "seconds", "86400"});
+    parser.addOption({"append", "Live append to the file, at --rate, for tail mode testing"});
+    parser.addOption({"rate", "MB/s when appending (10)", "rate", "10"});
+    parser.addOption({"duration", "Seconds to append, 0 until stopped (0)", "seconds", "0"});
+    parser.process(app);
+
+    if (parser.positionalArguments().count() != 1) {
+        parser.showHelp(-1);
+    }
+
+    GeneratorConfig_t config;
+    bool ok[9];
+
+    config.fileName = parser.positionalArguments().first();
+    config.append = parser.isSet("append");
+    ok[0] = _parseSize(parser.value("size"), &config.size);
+    config.threads = parser.value("threads").toInt(&ok[1]);
+    config.seed = parser.value("seed").toULongLong(&ok[2]);
+    config.zipf = parser.value("zipf").toDouble(&ok[3]);
+    config.crlf = parser.value("crlf").toDouble(&ok[4]);
+    config.stackTraces = parser.value("stack-traces").toDouble(&ok[5]);
+    config.longLines = parser.value("long-lines").toDouble(&ok[6]);
+    config.span = parser.value("span").toDouble(&ok[7]);
+    config.rate = parser.value("rate").toDouble(&ok[8]);
+    config.duration = parser.value("duration").toInt();
+
+    if (!std::all_of(std::begin(ok), std::end(ok), [](bool value) {return value;}) || (config.threads < 1) ||
+        (config.rate <= 0.0) || (config.span < 0.0) || (!config.append && (config.size == 0))) {
+        qInfo() << "Input parameter error, see --help";
+        return -1;
+    }
+
+    if (parser.isSet("templates")) {
+        QFile templateFile(parser.value("templates"));
+        if (!templateFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            qInfo() << QString("The file %1 couldn't be opened").arg(templateFile.fileName());
+            return -1;
+        }
+        while (!templateFile.atEnd()) {
+            const QString line = QString::fromUtf8(templateFile.readLine()).trimmed();
+            if (!line.isEmpty() && !line.startsWith('#')) {
+                config.templates.append(line);
+            }
+        }
+    }
+
+    CLogGenerator generator(config);
+    QFile file(config.fileName);
+
+    if (!generator.IsValid()) {
+        qInfo() << "No valid templates";
+        return -1;
+    }
+
+    if (!file.open(QIODevice::WriteOnly | (config.append ? QIODevice::Append : QIODevice::Truncate))) {
+        qInfo() << QString("The file %1 cannot be created").arg(config.fileName);
+        return -1;
+    }
+
+    const bool success = config.append ? AppendLive(config, generator, file) : GenerateFile(config, generator, file);
+    file.close();
+
+    return success ? 0 : -1;
+}
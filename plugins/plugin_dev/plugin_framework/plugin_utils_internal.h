@@ -495,6 +495,20 @@ public:
         m_byteStreamList.DeleteAll();
     }
 
+    /***********************************************************************************************************************
+    *   GetAllocatedSize
+    ***********************************************************************************************************************/
+    int64_t GetAllocatedSize(void)
+    {
+        int64_t size = 0;
+        auto byteStream_p = reinterpret_cast<CByteStream *>(m_byteStreamList.first());
+        while (byteStream_p != nullptr) {
+            size += byteStream_p->GetTotalSize();
+            byteStream_p = reinterpret_cast<CByteStream *>(m_byteStreamList.GetNext(byteStream_p));
+        }
+        return size;
+    }
+
 private:
     CByteStreamManager() {}
 
@@ -533,6 +547,12 @@ public:
                       GraphLinePattern_e *m_overrideLinePattern_p);
     void SetProperty(GraphProperty_e property) {m_property = property;}
 
+    /* The memory allocated by the byte streams holding the graphical objects */
+    int64_t GetByteStreamSize(void)
+    {
+        return m_byteStreamManager_p != nullptr ? m_byteStreamManager_p->GetAllocatedSize() : 0;
+    }
+
     /***********************************************************************************************************************
     *   Clean
     ***********************************************************************************************************************/
@@ -14,6 +14,7 @@ add_subdirectory(${PLUGIN_PATH}/plugin_example_6)
 add_subdirectory(${PLUGIN_PATH}/plugin_example_7)
 add_subdirectory(${PLUGIN_PATH}/plugin_tester)
 add_subdirectory(${PLUGIN_PATH}/file_streamer)
+add_subdirectory(${PLUGIN_PATH}/log_generator)
 
 if (EXISTS ${PLUGIN_PATH}/local_plugins.cmake)
     message ("Found ${PLUGIN_PATH}/local_plugins.cmake")
@@ -0,0 +1,147 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "CBlockSummary.h"
+#include "CSearchIndex.h"
+
+#include <algorithm>
+
+/***********************************************************************************************************************
+*   AddAlternative
+***********************************************************************************************************************/
+bool CBlockSummaryQuery::AddAlternative(const QString& text, bool regExp)
+{
+    std::vector<QByteArray> literals;
+
+    if (!CSearchIndex::GetRequiredLiterals(text, regExp, literals)) {
+        m_usable = false;
+        return false;
+    }
+
+    std::vector<uint32_t> bits;
+    for (auto& literal : literals) {
+        const auto *ref_p = reinterpret_cast<const uint8_t *>(literal.constData());
+        uint32_t key = (static_cast<uint32_t>(g_upperChar_LUT[ref_p[0]]) << 8) | g_upperChar_LUT[ref_p[1]];
+
+        for (int index = 2; index < literal.size(); ++index) {
+            key = ((key << 8) | g_upperChar_LUT[ref_p[index]]) & 0xffffff;
+            bits.push_back(BLOCK_SUMMARY_HASH_1(key));
+            bits.push_back(BLOCK_SUMMARY_HASH_2(key));
+        }
+    }
+
+    std::sort(bits.begin(), bits.end());
+    bits.erase(std::unique(bits.begin(), bits.end()), bits.end());
+    m_alternatives.push_back(std::move(bits));
+    return true;
+}
+
+/***********************************************************************************************************************
+*   Merge
+***********************************************************************************************************************/
+void CBlockSummary::Merge(const CBlockSummaryBuilder& builder)
+{
+    if (builder.m_firstBlock < 0) {
+        return;
+    }
+
+    const size_t offset = static_cast<size_t>(builder.m_firstBlock) * BLOCK_SUMMARY_BLOOM_WORDS;
+    if (m_bloom.size() < offset + builder.m_bloom.size()) {
+        const int64_t memSize = GetMemSize();
+        m_bloom.resize(offset + builder.m_bloom.size(), 0);
+        MemAcc_Add(MEM_ACC_BLOCK_SUMMARY_e, GetMemSize() - memSize);
+    }
+
+    /* Blocks at the thread borders are shared by two builders, and at incremental indexing the bits are added to the
+     * ones already there, hence OR */
+    for (size_t index = 0; index < builder.m_bloom.size(); ++index) {
+        m_bloom[offset + index] |= builder.m_bloom[index];
+    }
+}
+
+/***********************************************************************************************************************
+*   isSkippable
+***********************************************************************************************************************/
+bool CBlockSummary::isSkippable(int64_t block, const CBlockSummaryQuery& query) const
+{
+    if ((block < 0) || ((block << BLOCK_SUMMARY_BLOCK_SHIFT) >= m_summarizedSize) ||
+        (static_cast<size_t>(block + 1) * BLOCK_SUMMARY_BLOOM_WORDS > m_bloom.size())) {
+        return false;
+    }
+
+    const uint64_t *bloom_p = &m_bloom[static_cast<size_t>(block) * BLOCK_SUMMARY_BLOOM_WORDS];
+
+    for (auto& bits : query.m_alternatives) {
+        bool mayMatch = true;
+        for (auto bit : bits) {
+            if (!(bloom_p[bit >> 6] & (static_cast<uint64_t>(1) << (bit & 63)))) {
+                mayMatch = false;
+                break;
+            }
+        }
+        if (mayMatch) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/***********************************************************************************************************************
+*   GetSkipRange
+***********************************************************************************************************************/
+bool CBlockSummary::GetSkipRange(int64_t fileIndex, const CBlockSummaryQuery& query, int64_t *start_p,
+                                 int64_t *end_p) const
+{
+    int64_t first = fileIndex >> BLOCK_SUMMARY_BLOCK_SHIFT;
+
+    if (!query.IsUsable() || !isSkippable(first, query)) {
+        return false;
+    }
+
+    int64_t last = first;
+    while (isSkippable(first - 1, query)) {
+        --first;
+    }
+    while (isSkippable(last + 1, query)) {
+        ++last;
+    }
+
+    *start_p = first << BLOCK_SUMMARY_BLOCK_SHIFT;
+    *end_p = std::min((last + 1) << BLOCK_SUMMARY_BLOCK_SHIFT, m_summarizedSize);
+    return true;
+}
+
+/***********************************************************************************************************************
+*   GetNextSkipStart
+***********************************************************************************************************************/
+int64_t CBlockSummary::GetNextSkipStart(int64_t fileIndex, int64_t limit, const CBlockSummaryQuery& query) const
+{
+    if (query.IsUsable()) {
+        for (int64_t block = (fileIndex >> BLOCK_SUMMARY_BLOCK_SHIFT) + 1;
+             (block << BLOCK_SUMMARY_BLOCK_SHIFT) <= limit; ++block) {
+            if (isSkippable(block, query)) {
+                return block << BLOCK_SUMMARY_BLOCK_SHIFT;
+            }
+        }
+    }
+    return INT64_MAX;
+}
+
+/***********************************************************************************************************************
+*   GetPrevSkipEnd
+***********************************************************************************************************************/
+int64_t CBlockSummary::GetPrevSkipEnd(int64_t fileIndex, int64_t limit, const CBlockSummaryQuery& query) const
+{
+    if (query.IsUsable()) {
+        for (int64_t block = (fileIndex >> BLOCK_SUMMARY_BLOCK_SHIFT) - 1;
+             (block >= 0) && (((block + 1) << BLOCK_SUMMARY_BLOCK_SHIFT) > limit); --block) {
+            if (isSkippable(block, query)) {
+                return std::min((block + 1) << BLOCK_SUMMARY_BLOCK_SHIFT, m_summarizedSize);
+            }
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,147 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include "utils.h"
+#include "CMemAccounting.h"
+
+#include <stdint.h>
+#include <vector>
+
+#include <QString>
+
+#define BLOCK_SUMMARY_BLOCK_SHIFT   20  /* Each block summarizes the rows starting within 1 MB of the log */
+#define BLOCK_SUMMARY_BLOCK_SIZE    (static_cast<int64_t>(1) << BLOCK_SUMMARY_BLOCK_SHIFT)
+#define BLOCK_SUMMARY_BLOOM_SHIFT   16  /* Bits in the Bloom filter of a block, 2^16 (8 kB per MB of log) */
+#define BLOCK_SUMMARY_BLOOM_WORDS   ((1 << BLOCK_SUMMARY_BLOOM_SHIFT) / 64)
+
+/* Each trigram (case folded) sets two bits in the Bloom filter of the block */
+#define BLOCK_SUMMARY_HASH_1(KEY)   (((KEY) * 2654435761u) >> (32 - BLOCK_SUMMARY_BLOOM_SHIFT))
+#define BLOCK_SUMMARY_HASH_2(KEY)   (((KEY) * 0x85ebca6bu) >> (32 - BLOCK_SUMMARY_BLOOM_SHIFT))
+
+/***********************************************************************************************************************
+*   CBlockSummaryQuery
+*
+*   What a row must contain to match a search or a filtering. The query consists of alternatives, e.g. one for each
+*   filter, and each alternative of the trigrams of its required literals. A block can be skipped when no alternative
+*   has all its trigrams in the block. If any alternative lacks required literals (short text, or a regular expression
+*   without a required part) nothing can be skipped.
+***********************************************************************************************************************/
+class CBlockSummaryQuery
+{
+public:
+    /****/
+    void Clear(void)
+    {
+        m_alternatives.clear();
+        m_usable = true;
+    }
+
+    /* Returns false if the text has no required literal, the query is then not usable */
+    bool AddAlternative(const QString& text, bool regExp);
+
+    bool IsUsable(void) const {return m_usable && !m_alternatives.empty();}
+
+    /* The Bloom bits of each alternative, two for each trigram */
+    std::vector<std::vector<uint32_t>> m_alternatives;
+
+private:
+    bool m_usable = true;
+};
+
+/***********************************************************************************************************************
+*   CBlockSummaryBuilder
+*
+*   Used by each indexing thread to build the Bloom filters of the blocks its rows start in. The rows must be added in
+*   file order. When done the builder is merged into the CBlockSummary.
+***********************************************************************************************************************/
+class CBlockSummaryBuilder
+{
+public:
+    /****/
+    inline void AddRow(int64_t fileIndex, const char *text_p, int size)
+    {
+        const int64_t block = fileIndex >> BLOCK_SUMMARY_BLOCK_SHIFT;
+        if (m_firstBlock < 0) {
+            m_firstBlock = block;
+        }
+
+        const size_t offset = static_cast<size_t>(block - m_firstBlock) * BLOCK_SUMMARY_BLOOM_WORDS;
+        if (offset >= m_bloom.size()) {
+            m_bloom.resize(offset + BLOCK_SUMMARY_BLOOM_WORDS, 0);
+        }
+
+        if (size < 3) {
+            return;
+        }
+
+        uint64_t *bloom_p = &m_bloom[offset];
+        const auto *ref_p = reinterpret_cast<const uint8_t *>(text_p);
+        uint32_t key = (static_cast<uint32_t>(g_upperChar_LUT[ref_p[0]]) << 8) | g_upperChar_LUT[ref_p[1]];
+
+        for (int index = 2; index < size; ++index) {
+            key = ((key << 8) | g_upperChar_LUT[ref_p[index]]) & 0xffffff;
+
+            const uint32_t bit_1 = BLOCK_SUMMARY_HASH_1(key);
+            const uint32_t bit_2 = BLOCK_SUMMARY_HASH_2(key);
+            bloom_p[bit_1 >> 6] |= static_cast<uint64_t>(1) << (bit_1 & 63);
+            bloom_p[bit_2 >> 6] |= static_cast<uint64_t>(1) << (bit_2 & 63);
+        }
+    }
+
+    int64_t m_firstBlock = -1;
+    std::vector<uint64_t> m_bloom; /* BLOCK_SUMMARY_BLOOM_WORDS for each block from m_firstBlock */
+};
+
+/***********************************************************************************************************************
+*   CBlockSummary
+*
+*   A Bloom filter of the byte trigrams for each block of the log, built as a by-product of indexing (the rows are
+*   already in the cache when the TIA is created). Each row is summarized in the block where it starts, which is how
+*   the file processing steps through the log. The summary never gives false negatives, hence rows in a block where a
+*   required trigram is missing cannot match and the processing doesn't need to load them.
+***********************************************************************************************************************/
+class CBlockSummary
+{
+public:
+    CBlockSummary(void) = default;
+    ~CBlockSummary(void) {Clear();}
+
+    /****/
+    void Clear(void)
+    {
+        MemAcc_Add(MEM_ACC_BLOCK_SUMMARY_e, -GetMemSize());
+        std::vector<uint64_t>().swap(m_bloom);  /* release the memory, clear() keeps it */
+        m_summarizedSize = 0;
+    }
+
+    /* Add the blocks built by an indexing thread */
+    void Merge(const CBlockSummaryBuilder& builder);
+
+    /* All rows starting before size have been added */
+    void SetSummarizedSize(int64_t size) {m_summarizedSize = size;}
+    int64_t GetSummarizedSize(void) const {return m_summarizedSize;}
+
+    /* If rows starting at fileIndex can be skipped, returns true with the file range [*start_p, *end_p) of the
+     * consecutive blocks that can be skipped */
+    bool GetSkipRange(int64_t fileIndex, const CBlockSummaryQuery& query, int64_t *start_p, int64_t *end_p) const;
+
+    /* The start of the first block, after the one containing fileIndex, that can be skipped. INT64_MAX if none
+     * before limit */
+    int64_t GetNextSkipStart(int64_t fileIndex, int64_t limit, const CBlockSummaryQuery& query) const;
+
+    /* The end of the last block, before the one containing fileIndex, that can be skipped. -1 if none after limit */
+    int64_t GetPrevSkipEnd(int64_t fileIndex, int64_t limit, const CBlockSummaryQuery& query) const;
+
+private:
+    bool isSkippable(int64_t block, const CBlockSummaryQuery& query) const;
+
+    /****/
+    int64_t GetMemSize(void) const {return static_cast<int64_t>(m_bloom.capacity() * sizeof(uint64_t));}
+
+    std::vector<uint64_t> m_bloom; /* BLOCK_SUMMARY_BLOOM_WORDS for each block */
+    int64_t m_summarizedSize = 0;
+};
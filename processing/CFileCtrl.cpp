@@ -5,13 +5,16 @@
 
 #include "CFileCtrl.h"
 #include "CTimeMeas.h"
+#include "CTrace.h"
 #include "CConfig.h"
 #include "CDebug.h"
 #include "CProgressCtrl.h"
 #include "filemapping.h"
+#include "CMemAccounting.h"
 #include <QFileInfo>
 #include <QDateTime>
 #include "CLogScrutinizerDoc.h"
+#include "CLogMerge.h"
 
 static int g_totalNumOfThreads; /* Used for caluclating progress */
 static int64_t g_totalFileSize; /* Used for caluclating progress */
@@ -50,12 +53,15 @@ void CTIA_Thread::run()
         g_RamLog->UnregisterThread();
     });
 
+    TRACE_SPAN("TIA parse")
+
     m_maxNumOf_TI_estimated = m_size / FILECTRL_ROW_SIZE_ESTIMATE_persistent;
 
     m_maxNumOf_TI_estimated = m_maxNumOf_TI_estimated < FILECTRL_MINIMAL_NUM_OF_TIs_persistent ?
                               FILECTRL_MINIMAL_NUM_OF_TIs_persistent : m_maxNumOf_TI_estimated;
 
     const bool isSteppingProgressCounter = m_isSteppingProgressCounter;
+    const bool buildBlockSummary = m_buildBlockSummary;
 
     CTIA_p = new CTIA_Chunk(m_maxNumOf_TI_estimated);
 
@@ -117,6 +123,11 @@ void CTIA_Thread::run()
                 TIA_p[currentItemIndex].size = static_cast<int>(ref_p - start_p);
             }
 
+            if (buildBlockSummary) {
+                /* The row is still in the cache */
+                m_blockSummary.AddRow(TIA_p[currentItemIndex].fileIndex, start_p, TIA_p[currentItemIndex].size);
+            }
+
             /* initiate the next text item */
             ++currentItemIndex;
 
@@ -152,6 +163,10 @@ void CTIA_Thread::run()
         if (*(ref_p - 1) == 0x0d) {
             TIA_p[currentItemIndex].size--; /* if line ends with 0x0a 0x0d (and not only 0x0a) */
         }
+
+        if (buildBlockSummary) {
+            m_blockSummary.AddRow(TIA_p[currentItemIndex].fileIndex, start_p, TIA_p[currentItemIndex].size);
+        }
         ++currentItemIndex;
     }
 
@@ -261,7 +276,7 @@ void CParseCmd::AddThread(char *start_p, int64_t size, int64_t fileStartIndex)
         return;
     }
 
-    thread_p->Configure(start_p, size, fileStartIndex);
+    thread_p->Configure(start_p, size, fileStartIndex, m_blockSummary_p != nullptr);
 
     m_threadList.append(thread_p);
 }
@@ -431,6 +446,12 @@ void CParseCmd::Execute(void)
         (*iter)->wait();
     }
 
+    if (m_blockSummary_p != nullptr) {
+        for (iter = m_threadList.begin(); iter != m_threadList.end(); ++iter) {
+            m_blockSummary_p->Merge((*iter)->m_blockSummary);
+        }
+    }
+
     m_processTime = execTime.ms();
 
 #ifdef DEBUG_TIA_PARSING
@@ -581,6 +602,10 @@ bool CFileCtrl::Search_TIA(QFile *qfile_p, const QString& TIA_fileName, char *wo
      *  write the file pointer will be positioned correctly.*/
     Write_TIA_Header(true /*empty*/);
 
+    if (m_blockSummary_p != nullptr) {
+        m_blockSummary_p->Clear();
+    }
+
     seekIndex = 0;
     fileIndex = 0;
 
@@ -594,7 +619,7 @@ bool CFileCtrl::Search_TIA(QFile *qfile_p, const QString& TIA_fileName, char *wo
     if (numOf_CMDs == 1) {
         CMD_size = fileSize;
 
-        parseCmd_p = new CParseCmd();
+        parseCmd_p = new CParseCmd(m_blockSummary_p);
 
         if (parseCmd_p == nullptr) {
             TRACEX_E(
@@ -626,7 +651,7 @@ bool CFileCtrl::Search_TIA(QFile *qfile_p, const QString& TIA_fileName, char *wo
 
             CMD_size_adjusted = CMD_size + EOL_Offset;
 
-            parseCmd_p = new CParseCmd();
+            parseCmd_p = new CParseCmd(m_blockSummary_p);
 
             if (parseCmd_p == nullptr) {
                 TRACEX_E(
@@ -642,7 +667,7 @@ bool CFileCtrl::Search_TIA(QFile *qfile_p, const QString& TIA_fileName, char *wo
             fileIndex += CMD_size_adjusted + 1;
         }
 
-        parseCmd_p = new CParseCmd();
+        parseCmd_p = new CParseCmd(m_blockSummary_p);
 
         if (parseCmd_p == nullptr) {
             TRACEX_E(
@@ -727,12 +752,506 @@ bool CFileCtrl::Search_TIA(QFile *qfile_p, const QString& TIA_fileName, char *wo
         g_processingCtrl_p->SetSuccess();
         m_loadTime = execTime.ms();
         *rows_p = m_numOf_TI;
+        if (m_blockSummary_p != nullptr) {
+            m_blockSummary_p->SetSummarizedSize(fileSize);
+        }
         return true;
     } else {
         g_processingCtrl_p->SetFail();
         *rows_p = 0;
+        if (m_blockSummary_p != nullptr) {
+            m_blockSummary_p->Clear();
+        }
+        return false;
+    }
+}
+
+/***********************************************************************************************************************
+*   run
+***********************************************************************************************************************/
+void CTIA_SegmentThread::run()
+{
+    g_RamLog->RegisterThread();
+
+    auto unregisterRamLog = makeMyScopeGuard([&] () {
+        g_RamLog->UnregisterThread();
+    });
+
+    /* Pick segments until there are no more, since the segments are picked in order the oldest segment is always
+     * worked on first, which is the one the main thread is waiting for to store */
+    while (!m_queue_p->m_abort) {
+        const int index = m_queue_p->m_next.fetch_add(1);
+        if (index >= static_cast<int>(m_queue_p->m_jobs.size())) {
+            return;
+        }
+
+        CTIA_SegmentJob_t *job_p = &m_queue_p->m_jobs[static_cast<size_t>(index)];
+        const bool success = IndexSegment(job_p);
+
+        QMutexLocker locker(&m_queue_p->m_mutex);
+        job_p->success = success;
+        job_p->done = true;
+        m_queue_p->m_jobDone.wakeAll();
+    }
+}
+
+/***********************************************************************************************************************
+*   IndexSegment
+***********************************************************************************************************************/
+bool CTIA_SegmentThread::IndexSegment(CTIA_SegmentJob_t *job_p)
+{
+    TRACE_SPAN("TIA segment")
+    QFile file(job_p->fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        TRACEX_QFILE(LOG_LEVEL_ERROR, "Failed to open log file segment, file locked or removed ?", &file)
+        return false;
+    }
+
+    int64_t maxNumOf_TI = job_p->size / FILECTRL_ROW_SIZE_ESTIMATE_persistent;
+    maxNumOf_TI = maxNumOf_TI < FILECTRL_MINIMAL_NUM_OF_TIs_persistent ?
+                  FILECTRL_MINIMAL_NUM_OF_TIs_persistent : maxNumOf_TI;
+
+    CTIA_Chunk *CTIA_p = new CTIA_Chunk(maxNumOf_TI);
+    job_p->CTIA_Chunks.append(CTIA_p);
+
+    if (CTIA_p->m_TIA_p == nullptr) {
+        TRACEX_E("CTIA_SegmentThread::IndexSegment  out of memory")
+        return false;
+    }
+
+    int currentItemIndex = 0;
+    int64_t rowStart = 0;  /* Offset in the segment where the current row starts */
+    int64_t filePos = 0;
+    int64_t bufferStart = 0;
+    char prev = 0;         /* The byte before the current, carried over between the reads */
+    const bool extractTime = m_queue_p->m_extractTime;
+
+    /* The time is extracted from the row start, which is in the work memory unless the row is longer than it */
+    auto addTime = [&] (int64_t rowEnd) {
+        int64_t time = LOG_MERGE_TIME_NONE;
+        if (rowStart >= bufferStart) {
+            const int64_t length = rowEnd - rowStart;
+            (void)LogMerge_ExtractTime(m_workMem_p + (rowStart - bufferStart),
+                                       static_cast<int>(length < 2 * LOG_MERGE_TIME_MAX_SCAN ?
+                                                        length : 2 * LOG_MERGE_TIME_MAX_SCAN), &time);
+        }
+        job_p->times.push_back(time);
+    };
+
+    /* The segment is read in pieces of the thread work memory, the rows may stretch over the pieces */
+    while (filePos < job_p->size) {
+        if (m_queue_p->m_abort || g_processingCtrl_p->m_abort) {
+            return false;
+        }
+
+        const int64_t toRead = m_workMemSize < (job_p->size - filePos) ? m_workMemSize : (job_p->size - filePos);
+        const int64_t readBytes = file.read(m_workMem_p, toRead);
+
+        if (readBytes <= 0) {
+            TRACEX_QFILE(LOG_LEVEL_ERROR, "Failed to read log file segment", &file)
+            return false;
+        }
+
+        bufferStart = filePos;
+
+        for (int64_t index = 0; index < readBytes; ++index) {
+            const char current = m_workMem_p[index];
+
+            if (current == 0x0a) {
+                const int64_t EOL = filePos + index;
+                TI_t *TI_p = &CTIA_p->m_TIA_p[currentItemIndex];
+
+                TI_p->fileIndex = job_p->offset + rowStart;
+                TI_p->size = static_cast<int32_t>(EOL - rowStart - (prev == 0x0d ? 1 : 0));
+
+                if (extractTime) {
+                    addTime(EOL);
+                }
+
+                if (++currentItemIndex >= maxNumOf_TI) {
+                    CTIA_p->m_num_TI = currentItemIndex;
+                    CTIA_p = new CTIA_Chunk(maxNumOf_TI);
+                    job_p->CTIA_Chunks.append(CTIA_p);
+
+                    if (CTIA_p->m_TIA_p == nullptr) {
+                        TRACEX_E("CTIA_SegmentThread::IndexSegment  out of memory")
+                        return false;
+                    }
+                    currentItemIndex = 0;
+                }
+
+                rowStart = EOL + 1;
+            }
+            prev = current;
+        }
+
+        int64_t consumed = readBytes;
+
+        if (extractTime && (rowStart > filePos) && (rowStart < filePos + readBytes) &&
+            (filePos + readBytes < job_p->size)) {
+            /* Next read starts at the unfinished row, such that its start (and time) is in the work memory */
+            consumed = rowStart - filePos;
+            prev = 0x0a;
+            if (!file.seek(rowStart)) {
+                TRACEX_QFILE(LOG_LEVEL_ERROR, "Failed to seek in log file segment", &file)
+                return false;
+            }
+        }
+
+        filePos += consumed;
+        m_queue_p->m_bytesDone += consumed;
+    }
+
+    /* The last row of the segment doesn't end with a LF, the rows never continue into the next segment */
+    if (rowStart < filePos) {
+        TI_t *TI_p = &CTIA_p->m_TIA_p[currentItemIndex];
+        TI_p->fileIndex = job_p->offset + rowStart;
+        TI_p->size = static_cast<int32_t>(filePos - rowStart - (prev == 0x0d ? 1 : 0));
+        ++currentItemIndex;
+
+        if (extractTime) {
+            addTime(filePos);
+        }
+    }
+
+    CTIA_p->m_num_TI = currentItemIndex;
+    job_p->endsWithLF = (filePos == 0) || (prev == 0x0a);
+
+    if (extractTime) {
+        FinalizeTimes(job_p);
+    }
+    return true;
+}
+
+/***********************************************************************************************************************
+*   FinalizeTimes
+***********************************************************************************************************************/
+void CTIA_SegmentThread::FinalizeTimes(CTIA_SegmentJob_t *job_p)
+{
+    /* The merge needs random access to the rows, move them from the chunks into one array */
+    for (auto& chunk_p : job_p->CTIA_Chunks) {
+        job_p->TIs.insert(job_p->TIs.end(), chunk_p->m_TIA_p, chunk_p->m_TIA_p + chunk_p->m_num_TI);
+    }
+    while (!job_p->CTIA_Chunks.isEmpty()) {
+        delete (job_p->CTIA_Chunks.takeFirst());
+    }
+
+    job_p->tablesMemSize = static_cast<int64_t>(job_p->TIs.capacity() * sizeof(TI_t) +
+                                                job_p->times.capacity() * sizeof(int64_t));
+    MemAcc_Add(MEM_ACC_MERGE_e, job_p->tablesMemSize);
+
+    /* Rows without time (e.g. continuation of a multi-line print) get the time of the row before, and rows before the
+     * first time the first time. A time of day only (no date) going back more than half a day has passed midnight,
+     * the following rows get a day added. Other time going backwards is clamped, such that the times are
+     * non-decreasing. */
+    const int64_t DAY = 86400LL * 1000000LL;
+    int64_t dayOffset = 0;
+    int64_t time = LOG_MERGE_TIME_NONE;
+    for (auto& rowTime : job_p->times) {
+        if (rowTime != LOG_MERGE_TIME_NONE) {
+            time = rowTime;
+            break;
+        }
+    }
+
+    time = time == LOG_MERGE_TIME_NONE ? 0 : time;
+
+    for (auto& rowTime : job_p->times) {
+        if (rowTime == LOG_MERGE_TIME_NONE) {
+            rowTime = time;
+            continue;
+        }
+
+        if (rowTime < DAY) {
+            rowTime += dayOffset;
+            if (time - rowTime > DAY / 2) {
+                dayOffset += DAY;
+                rowTime += DAY;
+            }
+        }
+
+        if (rowTime < time) {
+            rowTime = time;
+        } else {
+            time = rowTime;
+        }
+    }
+}
+
+/***********************************************************************************************************************
+*   StartSegmentThreads
+***********************************************************************************************************************/
+QList<CTIA_SegmentThread *> CFileCtrl::StartSegmentThreads(CTIA_SegmentQueue *queue_p, char *work_mem_p,
+                                                           int64_t workMemSize)
+{
+    const int numOfSegments = static_cast<int>(queue_p->m_jobs.size());
+    int numOfThreads = g_cfg_p->m_numOfThreads < numOfSegments ? g_cfg_p->m_numOfThreads : numOfSegments;
+    numOfThreads = numOfThreads < 1 ? 1 : numOfThreads;
+
+    const int64_t threadWorkMemSize = workMemSize / numOfThreads;
+    QList<CTIA_SegmentThread *> threadList;
+
+    g_processingCtrl_p->AddProgressInfo(QString("   Indexing %1 files, threads:%2").arg(numOfSegments).arg(numOfThreads));
+
+    for (int index = 0; index < numOfThreads; ++index) {
+        auto thread_p = new CTIA_SegmentThread(queue_p, work_mem_p + index * threadWorkMemSize, threadWorkMemSize);
+        threadList.append(thread_p);
+        thread_p->start();
+    }
+
+    return threadList;
+}
+
+/***********************************************************************************************************************
+*   Search_TIA_Segments
+***********************************************************************************************************************/
+bool CFileCtrl::Search_TIA_Segments(CLogFile *logFile_p, const QString& TIA_fileName, char *work_mem_p,
+                                    int64_t workMemSize, int *rows_p)
+{
+    CTIA_SegmentQueue queue;
+    int64_t totalSize = 0;
+    CTimeMeas execTime;
+
+    *rows_p = 0;
+
+    const int numOfSegments = logFile_p->GetNumOfSegments();
+    queue.m_jobs.resize(static_cast<size_t>(numOfSegments));
+
+    for (int segment = 0; segment < numOfSegments; ++segment) {
+        CTIA_SegmentJob_t& job = queue.m_jobs[static_cast<size_t>(segment)];
+        job.fileName = logFile_p->GetSegmentFileName(segment);
+        job.offset = logFile_p->GetSegmentOffset(segment);
+        job.size = logFile_p->GetSegmentSize(segment);
+        job.done = false;
+        job.success = false;
+        totalSize += job.size;
+    }
+
+    PRINT_FILE_TRACKING(QString("Search TIA, segments:%1 size:%2").arg(numOfSegments).arg(totalSize))
+
+    m_LogFile.filePos = 0;
+    m_LogFile.qFile_p = logFile_p;
+
+    m_TIA_FileName = TIA_fileName;
+    m_TIA_File.setFileName(m_TIA_FileName);
+
+    if (!m_TIA_File.open(QIODevice::ReadWrite)) {
+        TRACEX_QFILE(LOG_LEVEL_ERROR, "Failed to open TIA file, file locked?", logFile_p)
         return false;
     }
+
+    Write_TIA_Header(true /*empty*/);
+
+    TRACEX_DISABLE_WINDOW()
+
+    QList<CTIA_SegmentThread *> threadList = StartSegmentThreads(&queue, work_mem_p, workMemSize);
+
+    /* Store the segments in order, while the later segments are still being indexed */
+    bool success = true;
+    m_numOf_TI = 0;
+
+    for (auto& job : queue.m_jobs) {
+        queue.m_mutex.lock();
+        while (!job.done) {
+            queue.m_jobDone.wait(&queue.m_mutex, 100);
+            if (totalSize > 0) {
+                g_processingCtrl_p->SetProgressCounter(static_cast<double>(queue.m_bytesDone) /
+                                                       static_cast<double>(totalSize));
+            }
+        }
+        queue.m_mutex.unlock();
+
+        if (!job.success || g_processingCtrl_p->m_abort) {
+            success = false;
+            break;
+        }
+
+        CTIA_FileStorage fileStorage;
+        int numOf_TI = 0;
+        for (auto& chunk_p : job.CTIA_Chunks) {
+            fileStorage.AddChunk(chunk_p);
+            numOf_TI += chunk_p->m_num_TI;
+        }
+
+        if (!fileStorage.Store_CTIA(m_TIA_File)) {
+            success = false;
+            break;
+        }
+
+        m_numOf_TI += numOf_TI;
+
+        TRACEX_I(QString("  Segment:%1 rows:%2 offset:%3").arg(job.fileName).arg(numOf_TI).arg(job.offset))
+
+        while (!job.CTIA_Chunks.isEmpty()) {
+            delete (job.CTIA_Chunks.takeFirst());
+        }
+    }
+
+    queue.m_abort = !success;
+
+    for (auto& thread_p : threadList) {
+        thread_p->wait();
+        delete thread_p;
+    }
+
+    for (auto& job : queue.m_jobs) {
+        while (!job.CTIA_Chunks.isEmpty()) {
+            delete (job.CTIA_Chunks.takeFirst());
+        }
+    }
+
+    TRACEX_ENABLE_WINDOW()
+
+    if (success && !g_processingCtrl_p->m_abort) {
+        g_processingCtrl_p->AddProgressInfo("  EOL parsing done");
+        TRACEX_D("CFileCtrl::Search_TIA_Segments  Number of TextItems = %d", m_numOf_TI)
+
+        m_TIA_File.flush();
+        Write_TIA_Header();
+        m_TIA_File.flush();
+        m_TIA_File.close();
+
+        g_processingCtrl_p->SetSuccess();
+        m_loadTime = execTime.ms();
+        *rows_p = m_numOf_TI;
+        return true;
+    }
+
+    g_processingCtrl_p->AddProgressInfo("  EOL parsing aborted");
+    m_TIA_File.close();
+    g_processingCtrl_p->SetFail();
+    return false;
+}
+
+/***********************************************************************************************************************
+*   Search_TIA_Merged
+***********************************************************************************************************************/
+bool CFileCtrl::Search_TIA_Merged(CLogFile *logFile_p, const QStringList& fileNames, const QString& TIA_fileName,
+                                  char *work_mem_p, int64_t workMemSize, int *rows_p)
+{
+    CTIA_SegmentQueue queue;
+    int64_t totalSize = 0;
+    CTimeMeas execTime;
+
+    *rows_p = 0;
+
+    /* The files are opened as sources of the merged log, their sizes are fixed at this point */
+    logFile_p->SetMerged();
+
+    queue.m_extractTime = true;
+    queue.m_jobs.resize(static_cast<size_t>(fileNames.count()));
+
+    for (int index = 0; index < fileNames.count(); ++index) {
+        if (logFile_p->AddMergeSource(fileNames[index]) != index) {
+            logFile_p->ClearSegments();
+            m_TIA_File.close(); /* may be open from a previous load with this file control */
+            g_processingCtrl_p->SetFail();
+            return false;
+        }
+
+        /* The size the source was mapped with, a live file may have grown since. The runs must stay within it */
+        CTIA_SegmentJob_t& job = queue.m_jobs[static_cast<size_t>(index)];
+        job.fileName = fileNames[index];
+        job.offset = 0;
+        job.size = logFile_p->GetMergeSourceSize(index);
+        job.done = false;
+        job.success = false;
+        job.tablesMemSize = 0;
+        job.endsWithLF = true;
+        totalSize += job.size;
+    }
+
+    /* The row tables of the sources are released with the jobs, when merged or at failure */
+    auto releaseTables = makeMyScopeGuard([&] () {
+        for (auto& job : queue.m_jobs) {
+            MemAcc_Add(MEM_ACC_MERGE_e, -job.tablesMemSize);
+        }
+        queue.m_jobs.clear();
+    });
+
+    m_LogFile.filePos = 0;
+    m_LogFile.qFile_p = logFile_p;
+
+    m_TIA_FileName = TIA_fileName;
+    m_TIA_File.setFileName(m_TIA_FileName);
+
+    if (!m_TIA_File.open(QIODevice::ReadWrite)) {
+        TRACEX_QFILE(LOG_LEVEL_ERROR, "Failed to open TIA file, file locked?", logFile_p)
+        return false;
+    }
+
+    Write_TIA_Header(true /*empty*/);
+    m_TIA_File.flush();
+
+    TRACEX_DISABLE_WINDOW()
+
+    auto enableWindow = makeMyScopeGuard([&] () {
+        TRACEX_ENABLE_WINDOW()
+    });
+
+    /* 1. Index all files, in parallel, with the time of each row */
+    QList<CTIA_SegmentThread *> threadList = StartSegmentThreads(&queue, work_mem_p, workMemSize);
+
+    for (auto& thread_p : threadList) {
+        while (!thread_p->wait(100)) {
+            if (totalSize > 0) {
+                g_processingCtrl_p->SetProgressCounter(0.5 * static_cast<double>(queue.m_bytesDone) /
+                                                       static_cast<double>(totalSize));
+            }
+        }
+        delete thread_p;
+    }
+
+    std::vector<LogMergeSource_t> sources;
+    for (auto& job : queue.m_jobs) {
+        if (!job.success) {
+            m_TIA_File.close();
+            g_processingCtrl_p->SetFail();
+            return false;
+        }
+        sources.push_back(LogMergeSource_t{job.TIs.data(), job.times.data(), static_cast<int>(job.TIs.size()),
+                                           job.size, job.endsWithLF});
+    }
+
+    g_processingCtrl_p->AddProgressInfo(QString("   Indexing done, %1").arg(GetTheDoc()->timeToString(execTime.ms())));
+    g_processingCtrl_p->SetProgressCounter(0.5);
+
+    /* 2. Merge by time, the merged TIA is written directly to the TIA file */
+    CLogMerge merge;
+    const int numOfThreads = g_cfg_p->m_numOfThreads < 1 ? 1 : g_cfg_p->m_numOfThreads;
+
+    if (!merge.Merge(sources, numOfThreads, m_TIA_FileName, static_cast<int64_t>(sizeof(TIA_FileHeader_t)))) {
+        g_processingCtrl_p->AddProgressInfo("  Merge aborted");
+        m_TIA_File.close();
+        g_processingCtrl_p->SetFail();
+        return false;
+    }
+
+    /* The merged TIA is written, the TIs and times of the sources aren't needed for the runs */
+    sources.clear();
+    for (auto& job : queue.m_jobs) {
+        MemAcc_Add(MEM_ACC_MERGE_e, -job.tablesMemSize);
+    }
+    queue.m_jobs.clear();
+
+    merge.TakeRuns([logFile_p] (const CLogMerge::Run_t& run) {
+        logFile_p->AddMergeRun(run.source, run.fileOffset, run.size);
+    });
+
+    m_numOf_TI = merge.GetRows();
+
+    g_processingCtrl_p->AddProgressInfo(QString("  Merge done, rows:%1 %2").arg(m_numOf_TI)
+                                            .arg(GetTheDoc()->timeToString(execTime.ms())));
+
+    Write_TIA_Header();
+    m_TIA_File.flush();
+    m_TIA_File.close();
+
+    g_processingCtrl_p->SetSuccess();
+    m_loadTime = execTime.ms();
+    *rows_p = m_numOf_TI;
+    return true;
 }
 
 /***********************************************************************************************************************
@@ -740,7 +1259,7 @@ bool CFileCtrl::Search_TIA(QFile *qfile_p, const QString& TIA_fileName, char *wo
 ***********************************************************************************************************************/
 bool CFileCtrl::Search_TIA_Incremental(QFile& logFile, const QString& TIA_fileName, char *work_mem_p,
                                        int64_t workMemSize, int64_t startFromIndex, int32_t fromRowIndex,
-                                       int *rows_added_p)
+                                       int *rows_added_p, int64_t *indexedEnd_p)
 {
     int64_t fileSize;
     int64_t readBytes;
@@ -759,11 +1278,12 @@ bool CFileCtrl::Search_TIA_Incremental(QFile& logFile, const QString& TIA_fileNa
     m_LogFile.qFile_p = &logFile;
     m_LogFile.filePos = startFromIndex;
     m_TIA_FileName = TIA_fileName;
+    m_TIA_File.close(); /* may be open from a previous batch with this file control */
     m_TIA_File.setFileName(m_TIA_FileName);
 
-    QFileInfo fileInfo(logFile);
-    fileInfo.refresh();
-    fileSize = fileInfo.size();
+    /* Note: The size of the log file device, which for a segmented log file (CLogFile) is the size of the virtual
+     * byte space, and startFromIndex is an offset in the same space */
+    fileSize = logFile.size();
 
     PRINT_FILE_TRACKING(QString("Incremental: start_index:%1 start_pos:%2").arg(fromRowIndex).arg(startFromIndex))
 
@@ -781,13 +1301,26 @@ bool CFileCtrl::Search_TIA_Incremental(QFile& logFile, const QString& TIA_fileNa
     }
 
     auto incrementalSize = fileSize - startFromIndex;
-    if (incrementalSize > workMemSize) {
-        TRACEX_QFILE(LOG_LEVEL_INFO, "File increment to large, go for full load of entire file", &logFile)
-        return false;
-    }
     readBytes = logFile.read(work_mem_p, workMemSize);
 
-    if ((readBytes == 0) || (readBytes < incrementalSize)) {
+    const bool batch = (incrementalSize > workMemSize) && (readBytes == workMemSize);
+    if (batch) {
+        /* The increment doesn't fit in the work memory, it is indexed in batches. Only complete rows are indexed in this
+         * batch, the remaining part is picked up by the next incremental load. */
+        char *last_p = work_mem_p + readBytes - 1;
+        while ((last_p > work_mem_p) && (*last_p != 0x0a)) {
+            --last_p;
+        }
+        if (*last_p != 0x0a) {
+            TRACEX_QFILE(LOG_LEVEL_INFO, "Row larger than incremental work memory, go for full load of entire file",
+                         &logFile)
+            return false;
+        }
+        readBytes = last_p - work_mem_p + 1;
+        PRINT_FILE_TRACKING(QString("Incremental batch:%1 of %2").arg(readBytes).arg(incrementalSize))
+    }
+
+    if (!batch && ((readBytes == 0) || (readBytes < incrementalSize))) {
         PRINT_FILE_TRACKING(QString("Failed to read %1 inc bytes from file, got %2")
                                 .arg(incrementalSize).arg(readBytes))
     }
@@ -801,6 +1334,15 @@ bool CFileCtrl::Search_TIA_Incremental(QFile& logFile, const QString& TIA_fileNa
     CTIA_Chunk *CTIA_p;
     TI_t *TIA_p;
     const int NUM_TI_IN_CHUNK = 4096;
+    const int64_t CHUNK_MEM_SIZE = NUM_TI_IN_CHUNK * static_cast<int64_t>(sizeof(TI_t));
+
+    /* The chunks are only needed until written to the TIA file */
+    auto freeChunks = makeMyScopeGuard([&] () {
+        while (!CTIA_Chunks.isEmpty()) {
+            delete (CTIA_Chunks.takeFirst());
+            MemAcc_Add(MEM_ACC_INCREMENTAL_e, -CHUNK_MEM_SIZE);
+        }
+    });
 
     CTIA_p = new CTIA_Chunk(NUM_TI_IN_CHUNK);
 
@@ -810,6 +1352,7 @@ bool CFileCtrl::Search_TIA_Incremental(QFile& logFile, const QString& TIA_fileNa
     }
 
     CTIA_Chunks.append(CTIA_p);
+    MemAcc_Add(MEM_ACC_INCREMENTAL_e, CHUNK_MEM_SIZE);
     TIA_p = CTIA_p->m_TIA_p;
 
     ref_p = work_mem_p;
@@ -858,6 +1401,7 @@ bool CFileCtrl::Search_TIA_Incremental(QFile& logFile, const QString& TIA_fileNa
                 }
 
                 CTIA_Chunks.append(CTIA_p);
+                MemAcc_Add(MEM_ACC_INCREMENTAL_e, CHUNK_MEM_SIZE);
 
                 TIA_p = CTIA_p->m_TIA_p;
                 currentItemIndex = 0;
@@ -889,6 +1433,20 @@ bool CFileCtrl::Search_TIA_Incremental(QFile& logFile, const QString& TIA_fileNa
 
     m_numOf_TI = fromRowIndex + *rows_added_p;
 
+    /* The block summary can only be extended if it covers the log up to the increment */
+    const bool extendBlockSummary = (m_blockSummary_p != nullptr) &&
+                                    (m_blockSummary_p->GetSummarizedSize() >= startFromIndex);
+    if (extendBlockSummary) {
+        CBlockSummaryBuilder builder;
+        for (auto& chunk_p : CTIA_Chunks) {
+            for (int index = 0; index < chunk_p->m_num_TI; ++index) {
+                const TI_t& TI = chunk_p->m_TIA_p[index];
+                builder.AddRow(TI.fileIndex, work_mem_p + (TI.fileIndex - startFromIndex), TI.size);
+            }
+        }
+        m_blockSummary_p->Merge(builder);
+    }
+
     /* Seek to where the new entries in TIA file should be added */
     m_TIA_File.seek(static_cast<int64_t>(sizeof(TIA_FileHeader_t) + static_cast<uint64_t>(fromRowIndex) *
                                          sizeof(TI_t)));
@@ -906,6 +1464,13 @@ bool CFileCtrl::Search_TIA_Incremental(QFile& logFile, const QString& TIA_fileNa
         }
     }
     Write_TIA_Header();
+
+    if (extendBlockSummary) {
+        m_blockSummary_p->SetSummarizedSize(startFromIndex + readBytes);
+    }
+    if (indexedEnd_p != nullptr) {
+        *indexedEnd_p = startFromIndex + readBytes;
+    }
     return true;
 }
 
@@ -9,10 +9,16 @@
 #include "CFilter.h"
 #include "CTimeMeas.h"
 #include "CMemPool.h"
+#include "CLogFile.h"
+#include "CBlockSummary.h"
 
 #include <stdint.h>
+#include <atomic>
+#include <vector>
 
 #include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
 
 /* Each time the decidated thread has run through 10000 lines the progress counter is stepped */
 #define PROGRESS_COUNTER_STEP (10000)
@@ -89,10 +95,11 @@ public:
     uint32_t ThreadMain_CTIA(void);
 
     /****/
-    void Configure(char *start_p, int64_t size, int64_t fileStartIndex) {
+    void Configure(char *start_p, int64_t size, int64_t fileStartIndex, bool buildBlockSummary) {
         m_start_p = start_p;
         m_size = size;
         m_fileStartIndex = fileStartIndex;
+        m_buildBlockSummary = buildBlockSummary;
     }
 
 public:
@@ -105,6 +112,8 @@ public:
     double m_execTime;
     bool m_isSteppingProgressCounter; /* Indicate if this thread should step the progress counter */
     int64_t m_maxNumOf_TI_estimated; /* Estimate the number of TIs to create in each CTIA_Chunk */
+    bool m_buildBlockSummary = false;
+    CBlockSummaryBuilder m_blockSummary; /* The blocks of the rows parsed, merged into the CBlockSummary when done */
 };
 
 /***********************************************************************************************************************
@@ -116,6 +125,8 @@ public:
 class CParseCmd
 {
 public:
+    explicit CParseCmd(CBlockSummary *blockSummary_p = nullptr) : m_blockSummary_p(blockSummary_p) {}
+
     ~CParseCmd(void)
     {
         EmptyThreads();
@@ -160,6 +171,7 @@ private:
     void AddThread(char *start_p, int64_t size, int64_t fileStartIndex);
 
     CFileCtrl_FileHandle_t *m_fileHandle_p;
+    CBlockSummary *m_blockSummary_p;                          /* If set, built by the threads */
     int64_t m_fileSize = 0;                                   /* The total size of the file */
     int64_t m_size = 0;                                       /* Number of bytes to read */
     char *m_workMem_p = nullptr;
@@ -168,6 +180,59 @@ private:
                                                                     * */
 };
 
+/***********************************************************************************************************************
+*   CTIA_SegmentQueue
+*
+* Used when a log consists of several files (segments). Each segment is indexed as a whole by one of the segment threads,
+* into its own list of CTIA_Chunks. The segments are then stored to the TIA file in order, as soon as they are done.
+***********************************************************************************************************************/
+typedef struct {
+    QString fileName;
+    int64_t offset;                    /* Virtual offset of the segment, added to the fileIndex of each TI */
+    int64_t size;                      /* Number of bytes to index */
+    QList<CTIA_Chunk *> CTIA_Chunks;
+    bool done;
+    bool success;
+
+    /* Only when extracting time (merge). The TIs are then moved from the chunks into TIs, one time per row */
+    std::vector<TI_t> TIs;
+    std::vector<int64_t> times;
+    int64_t tablesMemSize;             /* TIs and times, counted in the memory accounting when finalized */
+    bool endsWithLF;
+} CTIA_SegmentJob_t;
+
+class CTIA_SegmentQueue
+{
+public:
+    std::vector<CTIA_SegmentJob_t> m_jobs;  /* Not resized while the threads are running */
+    std::atomic_int m_next {0};             /* Next job to pick */
+    std::atomic_bool m_abort {false};
+    std::atomic<int64_t> m_bytesDone {0};
+    bool m_extractTime = false;             /* Extract the row timestamps, used when merging the segments */
+    QMutex m_mutex;                         /* Protects done/success */
+    QWaitCondition m_jobDone;
+};
+
+/***********************************************************************************************************************
+*   CTIA_SegmentThread
+***********************************************************************************************************************/
+class CTIA_SegmentThread : public QThread
+{
+public:
+    CTIA_SegmentThread(CTIA_SegmentQueue *queue_p, char *workMem_p, int64_t workMemSize)
+        : m_queue_p(queue_p), m_workMem_p(workMem_p), m_workMemSize(workMemSize) {}
+
+    void run() override; /* for override of QThread */
+
+private:
+    bool IndexSegment(CTIA_SegmentJob_t *job_p);
+    void FinalizeTimes(CTIA_SegmentJob_t *job_p);
+
+    CTIA_SegmentQueue *m_queue_p;
+    char *m_workMem_p;      /* This thread's part of the work memory, the segment file is read in pieces of this size */
+    int64_t m_workMemSize;
+};
+
 /***********************************************************************************************************************
 *   CFileCtrl
 ***********************************************************************************************************************/
@@ -183,11 +248,29 @@ public:
     }
 
     bool Search_TIA(QFile *qfile_p, const QString& TIA_fileName, char *work_mem_p, int64_t workMemSize, int *rows_p);
+
+    /* As Search_TIA, but for a log opened from several files. The segments are indexed in parallel, one thread per
+     * segment (up to the configured number of threads) */
+    bool Search_TIA_Segments(CLogFile *logFile_p, const QString& TIA_fileName, char *work_mem_p, int64_t workMemSize,
+                             int *rows_p);
+
+    /* Index the files in parallel, extracting the row timestamps, and merge them by time into one log. logFile_p is
+     * setup as a merged log, with the runs of the files */
+    bool Search_TIA_Merged(CLogFile *logFile_p, const QStringList& fileNames, const QString& TIA_fileName,
+                           char *work_mem_p, int64_t workMemSize, int *rows_p);
+    /* indexedEnd_p: Where the indexing stopped, less than the file size when the increment was indexed as a batch */
     bool Search_TIA_Incremental(QFile& logFile, const QString& TIA_fileName, char *work_mem_p, int64_t workMemSize,
-                                int64_t startFromIndex, int32_t fromRowIndex, int *rows_added_p);
+                                int64_t startFromIndex, int32_t fromRowIndex, int *rows_added_p,
+                                int64_t *indexedEnd_p = nullptr);
+
+    /* Build the block summary while indexing, Search_TIA builds it from scratch and Search_TIA_Incremental extends it
+     * (if it covers the log up to where the increment starts). Not built for logs of several files. */
+    void SetBlockSummary(CBlockSummary *blockSummary_p) {m_blockSummary_p = blockSummary_p;}
 
 private:
     bool Write_TIA_Header(bool empty = false); /* Set empty=true and just the space for the header will be written */
+    QList<CTIA_SegmentThread *> StartSegmentThreads(CTIA_SegmentQueue *queue_p, char *work_mem_p,
+                                                    int64_t workMemSize);
 
     CFileCtrl_FileHandle_t m_LogFile;   /* file handle etc to the log file */
     int m_numOf_TI;
@@ -195,4 +278,5 @@ private:
     QFile m_TIA_File;
     QString m_TIA_FileName;
     QList <CParseCmd *> m_parseCmdList;
+    CBlockSummary *m_blockSummary_p = nullptr;
 };
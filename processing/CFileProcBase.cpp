@@ -5,6 +5,7 @@
 
 #include "CFileProcBase.h"
 #include "CTimeMeas.h"
+#include "CTrace.h"
 #include "CDebug.h"
 #include "CConfig.h"
 #include "CProgressCtrl.h"
@@ -13,6 +14,8 @@
 #include "utils.h"
 #include "CLogScrutinizerDoc.h"
 
+#include <algorithm>
+
 /***********************************************************************************************************************
 *   thread_Match_CS
 ***********************************************************************************************************************/
@@ -41,6 +44,8 @@ bool thread_Match_CS(Match_Description_t *desc_p)
                (*loopFilter_p == *loopText_p)) {
             /* If we have a match for all the letters in the filter then it was success */
             if (filterChIndex == filterLength) {
+                desc_p->matchOffset = textChIndex;
+                desc_p->matchLength = filterLength + 1;
                 return true;
             }
 
@@ -88,6 +93,8 @@ bool thread_Match(Match_Description_t *desc_p)
                (g_upperChar_LUT[*loopFilter_p] == g_upperChar_LUT[*loopText_p])) {
             /* If we have a match for all the letters in the filter then it was success */
             if (filterChIndex == filterLength) {
+                desc_p->matchOffset = textChIndex;
+                desc_p->matchLength = filterLength + 1;
                 return true;
             }
 
@@ -107,12 +114,17 @@ bool thread_Match(Match_Description_t *desc_p)
 static int eventHandler(unsigned int id, unsigned long long from,
                         unsigned long long to, unsigned int flags, void *ctx) {
     Q_UNUSED(id)
-    Q_UNUSED(to)
-    Q_UNUSED(from)
     Q_UNUSED(flags)
 
     auto descr_p = (reinterpret_cast<Match_Description_t *>(ctx));
     descr_p->match = true;
+
+    if (descr_p->regexp_som) {
+        /* The first reported match is the one ending first, the scan is stopped there */
+        descr_p->matchOffset = static_cast<int>(from);
+        descr_p->matchLength = static_cast<int>(to - from);
+        return 1;
+    }
     return 0;
 }
 
@@ -126,13 +138,22 @@ bool thread_Match_RegExp_HyperScan(Match_Description_t *desc_p)
     }
 
     desc_p->match = false;
+    desc_p->matchOffset = -1;
+    desc_p->matchLength = 0;
 
-    if (hs_scan(desc_p->regexp_database, desc_p->text_p, static_cast<unsigned int>(desc_p->textLength),
-                0 /*flags*/, desc_p->regexp_scratch,
-                eventHandler, desc_p) != HS_SUCCESS) {
+    const hs_error_t result = hs_scan(desc_p->regexp_database, desc_p->text_p,
+                                      static_cast<unsigned int>(desc_p->textLength), 0 /*flags*/,
+                                      desc_p->regexp_scratch, eventHandler, desc_p);
+    if ((result != HS_SUCCESS) && (result != HS_SCAN_TERMINATED)) {
         return false;
     }
 
+    if (desc_p->match && (desc_p->regexp_confirm_p != nullptr)) {
+        /* Only the rows passing the prefilter are matched with the full pattern */
+        desc_p->match = RegExpHybrid_Confirm(desc_p->regexp_confirm_p, desc_p->text_p, desc_p->textLength,
+                                             &desc_p->matchOffset, &desc_p->matchLength);
+    }
+
     return desc_p->match;
 }
 
@@ -188,7 +209,7 @@ void CFileProcBase::Start(QFile *qFile_p, char *workMem_p, int64_t workMemSize,
         return;
     }
 
-    for (int index = 0; index < g_cfg_p->m_numOfThreads; ++index) {
+    for (int index = 0; index < m_numOfThreads; ++index) {
         /* This will create the derived configuration objects */
         m_configurationPoolList.append(CreateConfigurationObject());
     }
@@ -238,6 +259,7 @@ bool CFileProcBase::ConfigureThread(CThreadConfiguration *config_p, Chunk_Descri
     stop_TIA_Index = start_TIA_index + num_Of_TI;
 
     config_p->DeltaInit(chunkDescription_p, num_Of_TI, start_TIA_index, stop_TIA_Index, TIA_step);
+    config_p->m_node = m_numaNodes > 1 ? Numa_ThreadNode(threadIndex, m_numberOfChunkThreads, m_numaNodes) : -1;
 
     return true;
 }
@@ -253,6 +275,15 @@ bool CFileProcBase::LoadNextChunk(void)
     bool stop = false;
     int64_t totalRead = 0;
     CTimeMeas execTime;
+    TRACE_SPAN("LoadNextChunk")
+
+    if (isCancelled()) {
+        return false;
+    }
+
+    if (m_sparse) {
+        return LoadNextSparseChunk();
+    }
 
     if (!m_backward) {
         /* LOAD CHUNK FORWARDs */
@@ -264,6 +295,25 @@ bool CFileProcBase::LoadNextChunk(void)
             return false;
         }
 
+        if (m_blockSummary_p != nullptr) {
+            /* Step over the blocks where no row can match */
+            const TI_t *TI_p = m_TIA_p->textItemArray_p;
+            const int startRow = m_chunkDescr.TIA_startRow;
+            int64_t skipStart;
+            int64_t skipEnd;
+
+            if (m_blockSummary_p->GetSkipRange(TI_p[startRow].fileIndex, m_blockQuery, &skipStart, &skipEnd)) {
+                const int nextRow = GetFirstRowFrom(skipEnd, startRow, m_endRow);
+                m_skippedBytes += (nextRow > m_endRow ? m_fileEndIndex : TI_p[nextRow].fileIndex) -
+                                  TI_p[startRow].fileIndex;
+                m_chunkDescr.TIA_startRow = nextRow;
+
+                if (nextRow > m_endRow) {
+                    return false;
+                }
+            }
+        }
+
         m_chunkDescr.fileIndex = m_TIA_p->textItemArray_p[m_chunkDescr.TIA_startRow].fileIndex;
         bytesLeft = m_fileEndIndex - m_chunkDescr.fileIndex;
 
@@ -274,12 +324,30 @@ bool CFileProcBase::LoadNextChunk(void)
         workMem_Max = (bytesLeft > m_workMemSize ? m_workMemSize - 1 : bytesLeft);    /* -1, some headroom */
         maxEndFileIndex = m_chunkDescr.fileIndex + workMem_Max;
 
+        const int rowLimit = GetChunkRowLimit();
+        int lastRow = m_endRow;
+        if ((rowLimit > 0) && (rowLimit <= m_endRow - m_chunkDescr.TIA_startRow)) {
+            lastRow = m_chunkDescr.TIA_startRow + rowLimit - 1;
+        }
+
+        if (m_blockSummary_p != nullptr) {
+            /* End the chunk where the next block that can be skipped starts, it is not loaded */
+            const int64_t skipStart = m_blockSummary_p->GetNextSkipStart(m_chunkDescr.fileIndex, maxEndFileIndex,
+                                                                         m_blockQuery);
+            if (skipStart != INT64_MAX) {
+                const int row = GetFirstRowFrom(skipStart, m_chunkDescr.TIA_startRow, lastRow);
+                if (row <= lastRow) {
+                    lastRow = row - 1;
+                }
+            }
+        }
+
         /* Locate the first TIA index where the line starts outside the maxEndFileIndex. Loop through all the lines.
          * This means that the current line starts outside  of max data, then the previous line would end outside as
          * well. As such stop at TIA_index - 2.
          * TODO: Do this loop quicker... loop to middle, loop to middle of next side, etc. *//* (int) startRow
          * will never be neg */
-        for (int index = m_chunkDescr.TIA_startRow; index < m_endRow && !stop; ++index) {
+        for (int index = m_chunkDescr.TIA_startRow; index < lastRow && !stop; ++index) {
             if (m_TIA_p->textItemArray_p[index].fileIndex > maxEndFileIndex) {
                 /* This TI starts outside workMem, then the previous ended outside, pick from index - 2 */
                 m_chunkDescr.numOfRows = (index - m_chunkDescr.TIA_startRow) - 2;
@@ -289,7 +357,7 @@ bool CFileProcBase::LoadNextChunk(void)
 
         if (!stop) {
             /*Reached end of TIA */
-            m_chunkDescr.numOfRows = m_endRow - m_chunkDescr.TIA_startRow + 1; /* +1 since endRow is last VALID index */
+            m_chunkDescr.numOfRows = lastRow - m_chunkDescr.TIA_startRow + 1; /* +1 since lastRow is last VALID index */
         } else if (m_chunkDescr.numOfRows <= 0) {
             return false;
         }
@@ -305,8 +373,12 @@ bool CFileProcBase::LoadNextChunk(void)
                          + m_TIA_p->textItemArray_p[TIA_LastIndex].size
                          - m_chunkDescr.fileIndex;
         QString size = GetTheDoc()->FileSizeToString(toRead);
-        g_processingCtrl_p->AddProgressInfo(QString("  Loading log file to memory, %1").arg(size));
-        g_processingCtrl_p->SetFileOperationOngoing(true);
+        ReportProgressInfo(QString("  Loading log file to memory, %1").arg(size));
+        ReportFileOperation(true);
+
+        if (m_numaNodes > 1) {
+            PlaceChunk();
+        }
 
         bool isAllRead = false;
         char *tempWorkMem_p = m_workMem_p;
@@ -319,7 +391,7 @@ bool CFileProcBase::LoadNextChunk(void)
 
             if (read < 0) {
                 TRACEX_QFILE(LOG_LEVEL_ERROR, "Failed to read log file data, file locked or removed??", m_qfile_p)
-                g_processingCtrl_p->SetFileOperationOngoing(false);
+                ReportFileOperation(false);
                 m_qfile_p->close();
                 return false;
             }
@@ -362,6 +434,24 @@ bool CFileProcBase::LoadNextChunk(void)
          *  the previous round */
         m_chunkDescr.TIA_startRow -= m_chunkDescr.numOfRows;
 
+        if (m_blockSummary_p != nullptr) {
+            /* Step over the blocks where no row can match */
+            const TI_t *TI_p = m_TIA_p->textItemArray_p;
+            const int startRow = m_chunkDescr.TIA_startRow;
+            int64_t skipStart;
+            int64_t skipEnd;
+
+            if (m_blockSummary_p->GetSkipRange(TI_p[startRow].fileIndex, m_blockQuery, &skipStart, &skipEnd)) {
+                const int firstSkippedRow = GetFirstRowFrom(skipStart, m_endRow, startRow);
+                m_skippedBytes += TI_p[startRow].fileIndex + TI_p[startRow].size - TI_p[firstSkippedRow].fileIndex;
+                m_chunkDescr.TIA_startRow = firstSkippedRow - 1;
+
+                if (m_chunkDescr.TIA_startRow < m_endRow) {
+                    return false;
+                }
+            }
+        }
+
         bytesLeft = (m_TIA_p->textItemArray_p[m_chunkDescr.TIA_startRow].fileIndex
                      + m_TIA_p->textItemArray_p[m_chunkDescr.TIA_startRow].size)
                     - m_fileEndIndex;
@@ -378,6 +468,15 @@ bool CFileProcBase::LoadNextChunk(void)
          * file index within scope */
         int topMostIndex = m_chunkDescr.TIA_startRow;
 
+        /* If the row limit fits in the work memory there is no need to search for the top most index */
+        const int rowLimit = GetChunkRowLimit();
+        if ((rowLimit > 0) && (m_chunkDescr.TIA_startRow - rowLimit + 1 >= 0) &&
+            (m_TIA_p->textItemArray_p[m_chunkDescr.TIA_startRow - rowLimit + 1].fileIndex >= maxEndFileIndex)) {
+            topMostIndex = m_chunkDescr.TIA_startRow - rowLimit + 1;
+            m_chunkDescr.numOfRows = rowLimit;
+            stop = true;
+        }
+
         /* TODO: Do this loop quicker... loop to middle, loop to middle of next side, etc.
          * Search for the first TIA index where the line starts outside the maxEndFileIndex. Loop through all the lines
          **/
@@ -400,12 +499,26 @@ bool CFileProcBase::LoadNextChunk(void)
                 stop = true;
             } else if (topMostIndex < 0) {
                 TRACEX_E("Internal Error when searching for next chunk start in upward search")
-                g_processingCtrl_p->SetFileOperationOngoing(false);
+                ReportFileOperation(false);
                 m_qfile_p->close();
                 return false;
             }
         }
 
+        if (m_blockSummary_p != nullptr) {
+            /* Start the chunk where the previous block that can be skipped ends, it is not loaded */
+            const int64_t skipEnd = m_blockSummary_p->GetPrevSkipEnd(
+                m_TIA_p->textItemArray_p[m_chunkDescr.TIA_startRow].fileIndex,
+                m_TIA_p->textItemArray_p[topMostIndex].fileIndex, m_blockQuery);
+            if (skipEnd >= 0) {
+                const int row = GetFirstRowFrom(skipEnd, topMostIndex, m_chunkDescr.TIA_startRow);
+                if (row > topMostIndex) {
+                    topMostIndex = row;
+                    m_chunkDescr.numOfRows = m_chunkDescr.TIA_startRow - topMostIndex + 1;
+                }
+            }
+        }
+
         TRACEX_I("CFileProcBase::LoadNextChunk Backward - StartRow:%d FileIndex:%lld Rows:%d workMem_Max:%lld Last:%d",
                  topMostIndex, m_chunkDescr.fileIndex, m_chunkDescr.numOfRows, workMem_Max, !stop)
 
@@ -418,8 +531,8 @@ bool CFileProcBase::LoadNextChunk(void)
                          + m_TIA_p->textItemArray_p[m_chunkDescr.TIA_startRow].size
                          - m_chunkDescr.fileIndex;
         QString size = GetTheDoc()->FileSizeToString(toRead);
-        g_processingCtrl_p->AddProgressInfo(QString("  Loading log file to memory, %1").arg(size));
-        g_processingCtrl_p->SetFileOperationOngoing(true);
+        ReportProgressInfo(QString("  Loading log file to memory, %1").arg(size));
+        ReportFileOperation(true);
 
         bool isAllRead = false;
         char *tempWorkMem_p = m_workMem_p;
@@ -427,7 +540,7 @@ bool CFileProcBase::LoadNextChunk(void)
         while (!isAllRead) {
             if (!m_qfile_p->seek(m_chunkDescr.temp_offset)) {
                 TRACEX_QFILE(LOG_LEVEL_ERROR, "Failed to read log file data, file locked or removed?", m_qfile_p)
-                g_processingCtrl_p->SetFileOperationOngoing(false);
+                ReportFileOperation(false);
                 m_qfile_p->close();
                 return false;
             }
@@ -436,7 +549,7 @@ bool CFileProcBase::LoadNextChunk(void)
 
             if (read < 0) {
                 TRACEX_QFILE(LOG_LEVEL_ERROR, "Failed to read log file data, file locked or removed?", m_qfile_p)
-                g_processingCtrl_p->SetFileOperationOngoing(false);
+                ReportFileOperation(false);
                 m_qfile_p->close();
                 return false;
             }
@@ -459,8 +572,8 @@ bool CFileProcBase::LoadNextChunk(void)
     }
 
     QString time = GetTheDoc()->timeToString(execTime.ms());
-    g_processingCtrl_p->AddProgressInfo(QString("  Loading complete, %1").arg(time));
-    g_processingCtrl_p->SetFileOperationOngoing(false);
+    ReportProgressInfo(QString("  Loading complete, %1").arg(time));
+    ReportFileOperation(false);
     TRACEX_D("CFileProcBase::LoadNextChunk, Read:%d", totalRead)
 
     return true;
@@ -474,13 +587,18 @@ void CFileProcBase::Process(void)
     int32_t threadIndex;
     bool continueProcessing = true;
 
-    m_readySem_p = new QSemaphore(g_cfg_p->m_numOfThreads);
-    m_holdupSem_p = new QSemaphore(g_cfg_p->m_numOfThreads);
+    m_readySem_p = new QSemaphore(m_numOfThreads);
+    m_holdupSem_p = new QSemaphore(m_numOfThreads);
+    m_threadInstances.assign(static_cast<size_t>(m_numOfThreads), nullptr);
+    m_startSem_pp.assign(static_cast<size_t>(m_numOfThreads), nullptr);
+
+    /* Consecutive threads on the same node, as the rows they process */
+    m_numaNodes = m_numaPlacement && m_threadTI_Split && (m_numOfThreads > 1) ? Numa_GetNumOfNodes() : 1;
 
     /* The threads pulls configurations from the list of configuraions */
 
     /* Initialize threads, start them, and let them wait for first cmd */
-    for (threadIndex = 0; threadIndex < g_cfg_p->m_numOfThreads; ++threadIndex) {
+    for (threadIndex = 0; threadIndex < m_numOfThreads; ++threadIndex) {
         m_startSem_pp[threadIndex] = new QSemaphore(1);
         m_startSem_pp[threadIndex]->acquire(1);
 
@@ -488,12 +606,16 @@ void CFileProcBase::Process(void)
                                                           m_holdupSem_p, &m_configurationListMutex,
                                                           &m_configurationList, &m_configurationPoolList); /* QT_THREAD
                                                                                                             * */
+        if (m_numaNodes > 1) {
+            m_threadInstances[threadIndex]->m_node = Numa_ThreadNode(threadIndex, m_numOfThreads, m_numaNodes);
+        }
         m_threadInstances[threadIndex]->start();
     }
 
     QList<CThreadConfiguration *>::Iterator configIter;
     for (configIter = m_configurationPoolList.begin(); configIter != m_configurationPoolList.end(); ++configIter) {
         (*configIter)->BasicInit(m_workMem_p, m_TIA_p);
+        (*configIter)->m_cancelToken_p = m_cancelToken_p;
     }
 
     /* m_startRow and numOfRows shall contain the values from the previous chunk load. These values are calculated when
@@ -510,6 +632,21 @@ void CFileProcBase::Process(void)
         m_fileEndIndex = m_TIA_p->textItemArray_p[m_endRow].fileIndex + m_TIA_p->textItemArray_p[m_endRow].size;
     }
 
+    m_sparse = false;
+    if ((m_sparseRows_p != nullptr) && (m_sparseNumOfRows > 0)) {
+        /* Only load the selected rows if these are few compared to all rows in [m_startRow, m_endRow] */
+        const int firstRow = m_backward ? m_endRow : m_startRow;
+        const int lastRow = m_backward ? m_startRow : m_endRow;
+        const int firstIndex = GetFirstSparseIndex(firstRow);
+        const int selected = GetFirstSparseIndex(lastRow + 1) - firstIndex;
+
+        if (static_cast<int64_t>(selected) * SPARSE_LOAD_ROW_RATIO <= m_totalNumOfRows) {
+            m_sparse = true;
+            m_sparseIndex = m_backward ? firstIndex + selected - 1 : firstIndex;
+            m_sparseReadBytes = 0;
+        }
+    }
+
     /* Processing Loop */
 
     while (continueProcessing && LoadNextChunk()) {
@@ -519,21 +656,20 @@ void CFileProcBase::Process(void)
         /* Only use multiple threads if it is at least CFG_MINIMUM_NUM_OF_TIs_FOR_MULTI_THREAD_FILERING rows
          * loaded in the workMem */
 
+        m_numberOfChunkThreads = GetChunkThreads(m_chunkDescr.numOfRows);
+
         if (m_threadTI_Split) {
-            m_numberOfChunkThreads = m_chunkDescr.numOfRows > CFG_MINIMUM_NUM_OF_TIs_FOR_MULTI_THREAD_FILERING ?
-                                     g_cfg_p->m_numOfThreads : 1;
             m_linesPerThread = m_chunkDescr.numOfRows / m_numberOfChunkThreads;
             m_linesExtra = m_chunkDescr.numOfRows - (m_linesPerThread * m_numberOfChunkThreads);
         } else {
-            m_numberOfChunkThreads = g_cfg_p->m_numOfThreads;   /* g_cfg_p->m_numOfThreads must be overriden */
             m_linesPerThread = m_chunkDescr.numOfRows;
             m_linesExtra = 0;
         }
 
         /* If not all created holdUp sems is used, either because its little processing, or because in the end
          * of processing, ensure that the holdupSems not used is required... no one can slip through. */
-        if (m_numberOfChunkThreads < g_cfg_p->m_numOfThreads) {
-            m_holdupSem_p->acquire(g_cfg_p->m_numOfThreads - m_numberOfChunkThreads);
+        if (m_numberOfChunkThreads < m_numOfThreads) {
+            m_holdupSem_p->acquire(m_numOfThreads - m_numberOfChunkThreads);
         }
 
         /* Setup the amount of configuration objects that shall be used
@@ -559,8 +695,12 @@ void CFileProcBase::Process(void)
             /* Function to override by sub-class to add extra configuration parameters to the thread */
             if (!ConfigureThread(config, &m_chunkDescr, threadIndex++)) {
                 continueProcessing = false;
-                g_processingCtrl_p->m_abort = true;
-                g_processingCtrl_p->AddProgressInfo(QString("Failed to setup processing"));
+                if (isBackground()) {
+                    m_cancelToken_p->Cancel();
+                } else {
+                    g_processingCtrl_p->m_abort = true;
+                    g_processingCtrl_p->AddProgressInfo(QString("Failed to setup processing"));
+                }
                 break;
             }
             allocatedLines += config->GetNumOf_TI();
@@ -590,16 +730,18 @@ void CFileProcBase::Process(void)
             currentStep = (PROGRESS_COUNTER_STEP) / static_cast<double>(m_totalNumOfRows);
         }
 
-        g_processingCtrl_p->SetupProgessCounter(currentStep);
+        if (!isBackground()) {
+            g_processingCtrl_p->SetupProgessCounter(currentStep);
 
-        if (!m_backward) {
-            g_processingCtrl_p->SetProgressCounter(
-                (m_chunkDescr.TIA_startRow - m_startRow) / static_cast<double>(m_totalNumOfRows));
-        } else {
-            g_processingCtrl_p->SetProgressCounter(
-                (m_startRow - m_chunkDescr.TIA_startRow) / static_cast<double>(m_totalNumOfRows));
+            if (!m_backward) {
+                g_processingCtrl_p->SetProgressCounter(
+                    (m_chunkDescr.TIA_startRow - m_startRow) / static_cast<double>(m_totalNumOfRows));
+            } else {
+                g_processingCtrl_p->SetProgressCounter(
+                    (m_startRow - m_chunkDescr.TIA_startRow) / static_cast<double>(m_totalNumOfRows));
+            }
+            g_processingCtrl_p->AddProgressInfo(QString("Processing, threads:%1").arg(m_numberOfChunkThreads));
         }
-        g_processingCtrl_p->AddProgressInfo(QString("Processing, threads:%1").arg(m_numberOfChunkThreads));
 
         PRINT_PROGRESS_DBG("Waiting for %d threads to get ready, %d configs for processing",
                            m_numberOfChunkThreads, m_configurationList.count())
@@ -615,7 +757,7 @@ void CFileProcBase::Process(void)
         /* We only process the abort handling when we know that all threads has taken their ready sem and is
          * waiting for the start signal */
 
-        if (g_processingCtrl_p->m_abort) {
+        if (isCancelled()) {
             continueProcessing = false;
             PRINT_PROGRESS_DBG("Processing aborted")
         } else {
@@ -634,7 +776,10 @@ void CFileProcBase::Process(void)
 
             /* Threads are processing, PROC is waiting for them to get info HOLD-UP (releasing their Ready sem)
              * Wait for all threads to release their ready SEM, which they took before started. */
-            m_readySem_p->acquire(m_numberOfChunkThreads);
+            {
+                TRACE_SPAN("Rally")
+                m_readySem_p->acquire(m_numberOfChunkThreads);
+            }
             PRINT_PROGRESS_DBG("All threads ready with processing")
 
             PRINT_PROGRESS_DBG("Releasing ready sems")
@@ -670,7 +815,7 @@ void CFileProcBase::Process(void)
     } /* while continueProcessing */
 
     PRINT_PROGRESS("Finishing stopping threads and release start threads")
-    for (threadIndex = 0; threadIndex < g_cfg_p->m_numOfThreads; ++threadIndex) {
+    for (threadIndex = 0; threadIndex < m_numOfThreads; ++threadIndex) {
         m_threadInstances[threadIndex]->Stop();
         m_startSem_pp[threadIndex]->release(1);
     }
@@ -678,14 +823,281 @@ void CFileProcBase::Process(void)
     /* Wait for all threads to complete */
 
     PRINT_PROGRESS("Wait for all threads to exit")
-    for (threadIndex = 0; threadIndex < g_cfg_p->m_numOfThreads; ++threadIndex) {
+    for (threadIndex = 0; threadIndex < m_numOfThreads; ++threadIndex) {
         m_threadInstances[threadIndex]->wait();
     }
 
+    if (m_skippedBytes > 0) {
+        ReportProgressInfo(QString("  Skipped %1 without possible match (block summary)")
+                               .arg(GetTheDoc()->FileSizeToString(m_skippedBytes)));
+    }
+
+    if (m_sparse) {
+        ReportProgressInfo(QString("  Sparse loading, read %1 for the selected rows")
+                               .arg(GetTheDoc()->FileSizeToString(m_sparseReadBytes)));
+    }
+
     /* Typically a sub-class fetching out results from the threads */
+    TRACE_SPAN("WrapUp")
     WrapUp();
 }
 
+/***********************************************************************************************************************
+*   PlaceChunk
+*   Before the chunk is read, prefer the node of the threads for the rows they will process, the same split as in
+*   Process and ConfigureThread. The pages of the work memory already on the node stay, only the pages around the node
+*   borders move as the row sizes change between the chunks.
+***********************************************************************************************************************/
+void CFileProcBase::PlaceChunk(void)
+{
+    const int numOfThreads = GetChunkThreads(m_chunkDescr.numOfRows);
+
+    if (numOfThreads < 2) {
+        return;
+    }
+
+    TRACE_SPAN("PlaceChunk")
+
+    const TI_t *TI_p = m_TIA_p->textItemArray_p;
+    const int linesPerThread = m_chunkDescr.numOfRows / numOfThreads;
+    const int lastRow = m_chunkDescr.TIA_startRow + m_chunkDescr.numOfRows - 1;
+    const int64_t chunkEnd = TI_p[lastRow].fileIndex + TI_p[lastRow].size - m_chunkDescr.fileIndex;
+    int64_t nodeStart = 0;
+    int node = 0;
+
+    for (int threadIndex = 1; threadIndex <= numOfThreads; ++threadIndex) {
+        const int nextNode = threadIndex < numOfThreads ?
+                             Numa_ThreadNode(threadIndex, numOfThreads, m_numaNodes) : m_numaNodes;
+
+        if (nextNode != node) {
+            const int64_t nodeEnd = threadIndex < numOfThreads ?
+                                    TI_p[m_chunkDescr.TIA_startRow + threadIndex * linesPerThread].fileIndex -
+                                    m_chunkDescr.fileIndex : chunkEnd;
+            Numa_PlaceMemory(m_workMem_p + nodeStart, nodeEnd - nodeStart, node);
+            nodeStart = nodeEnd;
+            node = nextNode;
+        }
+    }
+}
+
+/***********************************************************************************************************************
+*   GetFirstRowFrom
+***********************************************************************************************************************/
+int CFileProcBase::GetFirstRowFrom(int64_t fileIndex, int firstRow, int lastRow) const
+{
+    const TI_t *TI_p = m_TIA_p->textItemArray_p;
+    int low = firstRow;
+    int high = lastRow + 1;
+
+    while (low < high) {
+        const int mid = low + (high - low) / 2;
+        if (TI_p[mid].fileIndex < fileIndex) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+/***********************************************************************************************************************
+*   GetFirstSparseIndex
+***********************************************************************************************************************/
+int CFileProcBase::GetFirstSparseIndex(int row) const
+{
+    int low = 0;
+    int high = m_sparseNumOfRows;
+
+    while (low < high) {
+        const int mid = low + (high - low) / 2;
+        if (m_sparseRows_p[mid].row < row) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+/***********************************************************************************************************************
+*   LoadNextSparseChunk
+*   Load the selected rows following the previous chunk, as many as fits in the work memory. Rows close to each other
+*   are coalesced into one range, the rows not selected in between are loaded as well but not processed.
+***********************************************************************************************************************/
+bool CFileProcBase::LoadNextSparseChunk(void)
+{
+    int64_t memUsed = 0;
+    int lastRow;
+
+    m_sparseRanges.clear();
+
+    if (!m_backward) {
+        m_chunkDescr.TIA_startRow += m_chunkDescr.numOfRows;
+
+        while ((m_sparseIndex < m_sparseNumOfRows) && (m_sparseRows_p[m_sparseIndex].row < m_chunkDescr.TIA_startRow)) {
+            ++m_sparseIndex;
+        }
+
+        if ((m_sparseIndex >= m_sparseNumOfRows) || (m_sparseRows_p[m_sparseIndex].row > m_endRow)) {
+            return false;
+        }
+
+        m_chunkDescr.TIA_startRow = m_sparseRows_p[m_sparseIndex].row;
+
+        const int rowLimit = GetChunkRowLimit();
+        const int maxRow = (rowLimit > 0) && (rowLimit <= m_endRow - m_chunkDescr.TIA_startRow) ?
+                           m_chunkDescr.TIA_startRow + rowLimit - 1 : m_endRow;
+
+        lastRow = -1;
+        while ((m_sparseIndex < m_sparseNumOfRows) && (m_sparseRows_p[m_sparseIndex].row <= maxRow) &&
+               AddSparseRow(m_sparseRows_p[m_sparseIndex].row, &memUsed)) {
+            lastRow = m_sparseRows_p[m_sparseIndex].row;
+            ++m_sparseIndex;
+        }
+
+        if (lastRow < 0) {
+            TRACEX_W("CFileProcBase::LoadNextSparseChunk - Row:%d doesn't fit in the work memory",
+                     m_chunkDescr.TIA_startRow)
+            return false;
+        }
+
+        m_chunkDescr.numOfRows = lastRow - m_chunkDescr.TIA_startRow + 1;
+    } else {
+        /* TIA_startRow is the highest row of the chunk, the chunk is processed from it and upwards */
+        m_chunkDescr.TIA_startRow -= m_chunkDescr.numOfRows;
+
+        while ((m_sparseIndex >= 0) && (m_sparseRows_p[m_sparseIndex].row > m_chunkDescr.TIA_startRow)) {
+            --m_sparseIndex;
+        }
+
+        if ((m_sparseIndex < 0) || (m_sparseRows_p[m_sparseIndex].row < m_endRow)) {
+            return false;
+        }
+
+        m_chunkDescr.TIA_startRow = m_sparseRows_p[m_sparseIndex].row;
+
+        const int rowLimit = GetChunkRowLimit();
+        const int minRow = (rowLimit > 0) && (rowLimit <= m_chunkDescr.TIA_startRow - m_endRow) ?
+                           m_chunkDescr.TIA_startRow - rowLimit + 1 : m_endRow;
+
+        lastRow = -1;
+        while ((m_sparseIndex >= 0) && (m_sparseRows_p[m_sparseIndex].row >= minRow) &&
+               AddSparseRow(m_sparseRows_p[m_sparseIndex].row, &memUsed)) {
+            lastRow = m_sparseRows_p[m_sparseIndex].row;
+            --m_sparseIndex;
+        }
+
+        if (lastRow < 0) {
+            TRACEX_W("CFileProcBase::LoadNextSparseChunk - Row:%d doesn't fit in the work memory",
+                     m_chunkDescr.TIA_startRow)
+            return false;
+        }
+
+        m_chunkDescr.numOfRows = m_chunkDescr.TIA_startRow - lastRow + 1;
+
+        /* The ranges were added from the end of the file, they shall be sorted */
+        std::reverse(m_sparseRanges.begin(), m_sparseRanges.end());
+    }
+
+    int64_t memOffset = 0;
+    for (auto& range : m_sparseRanges) {
+        range.memOffset = memOffset;
+        memOffset += range.size;
+    }
+
+    m_chunkDescr.fileIndex = m_sparseRanges.front().fileIndex;
+    m_chunkDescr.ranges_p = m_sparseRanges.data();
+    m_chunkDescr.numOfRanges = static_cast<int>(m_sparseRanges.size());
+
+    TRACEX_D("CFileProcBase::LoadNextSparseChunk - StartRow:%d Rows:%d Ranges:%d Size:%lld",
+             m_chunkDescr.TIA_startRow, m_chunkDescr.numOfRows, m_chunkDescr.numOfRanges, memUsed)
+
+    return ReadSparseRanges();
+}
+
+/***********************************************************************************************************************
+*   AddSparseRow
+*   Add the row to the ranges to load, returns false if it doesn't fit in the work memory
+***********************************************************************************************************************/
+bool CFileProcBase::AddSparseRow(int row, int64_t *memUsed_p)
+{
+    const TI_t *TI_p = &m_TIA_p->textItemArray_p[row];
+
+    if (!m_sparseRanges.empty()) {
+        Chunk_Range_t *range_p = &m_sparseRanges.back();
+        const int64_t gap = m_backward ? range_p->fileIndex - (TI_p->fileIndex + TI_p->size) :
+                            TI_p->fileIndex - (range_p->fileIndex + range_p->size);
+
+        if (gap <= SPARSE_LOAD_MAX_GAP) {
+            const int64_t growth = gap + TI_p->size;
+            if (*memUsed_p + growth >= m_workMemSize) {   /* some headroom */
+                return false;
+            }
+
+            if (m_backward) {
+                range_p->fileIndex = TI_p->fileIndex;
+            }
+            range_p->size += growth;
+            *memUsed_p += growth;
+            return true;
+        }
+    }
+
+    if (*memUsed_p + TI_p->size >= m_workMemSize) {
+        return false;
+    }
+
+    m_sparseRanges.push_back(Chunk_Range_t {TI_p->fileIndex, TI_p->size, 0});
+    *memUsed_p += TI_p->size;
+    return true;
+}
+
+/***********************************************************************************************************************
+*   ReadSparseRanges
+***********************************************************************************************************************/
+bool CFileProcBase::ReadSparseRanges(void)
+{
+    CTimeMeas execTime;
+    int64_t totalRead = 0;
+
+    ReportProgressInfo(QString("  Loading selected rows to memory, %1 ranges").arg(m_sparseRanges.size()));
+    ReportFileOperation(true);
+
+    /* The ranges are sorted, the reads are only moving forward in the file */
+    for (auto& range : m_sparseRanges) {
+        if (!m_qfile_p->seek(range.fileIndex)) {
+            TRACEX_QFILE(LOG_LEVEL_ERROR, "Failed to read log file data, file locked or removed?", m_qfile_p)
+            ReportFileOperation(false);
+            m_qfile_p->close();
+            return false;
+        }
+
+        for (int64_t offset = 0; offset < range.size;) {
+            const int64_t read = m_qfile_p->read(m_workMem_p + range.memOffset + offset, range.size - offset);
+            if (read <= 0) {
+                TRACEX_QFILE(LOG_LEVEL_ERROR, "Failed to read log file data, file locked or removed?", m_qfile_p)
+                ReportFileOperation(false);
+                m_qfile_p->close();
+                return false;
+            }
+            offset += read;
+        }
+
+        totalRead += range.size;
+    }
+
+    m_sparseReadBytes += totalRead;
+
+    QString time = GetTheDoc()->timeToString(execTime.ms());
+    ReportProgressInfo(QString("  Loading complete, %1").arg(time));
+    ReportFileOperation(false);
+    TRACEX_D("CFileProcBase::ReadSparseRanges, Read:%lld", totalRead)
+
+    return true;
+}
+
 /***********************************************************************************************************************
 *   isProcessingDone
 ***********************************************************************************************************************/
@@ -8,8 +8,13 @@
 #include "CFilter.h"
 #include "CConfig.h"
 #include "CTimeMeas.h"
+#include "CTrace.h"
 #include "CDebug.h"
 #include "CProgressCtrl.h"
+#include "CBlockSummary.h"
+#include "CRegExpSpans.h"
+#include "CRegExpHybrid.h"
+#include "CNuma.h"
 #include "globals.h"
 
 #include "crash_handler_linux.h"
@@ -17,6 +22,7 @@
 #include <iostream>
 #include <string>
 #include <stdint.h>
+#include <vector>
 
 #include <QString>
 #include <QThread>
@@ -30,14 +36,62 @@ const unsigned int REGEXP_HYPERSCAN_FLAGS = (HS_FLAG_DOTALL | HS_FLAG_SINGLEMATC
 
 #define PROGRESS_COUNTER_STEP     (10000)
 
+/* Sparse loading, rows closer than this are loaded in the same range (including the bytes in between) */
+#define SPARSE_LOAD_MAX_GAP       (4 * 1024)
+
+/* Sparse loading is used when at most one row out of SPARSE_LOAD_ROW_RATIO in the processed rows is selected */
+#define SPARSE_LOAD_ROW_RATIO     (8)
+
+typedef struct {
+    int64_t fileIndex; /* Start of the range in the file */
+    int64_t size;
+    int64_t memOffset; /* Where the range is loaded in workMem */
+} Chunk_Range_t;
+
 typedef struct {
     int numOfRows; /* Number of rows loaded in workMem */
     int TIA_startRow; /* The corresponding start index in TIA */
     bool first; /* first chunk load */
     int64_t fileIndex; /* the last start file index location of the m_workMem_p start */
     int64_t temp_offset; /* offset is used in-case not all bytes could be read, failure? */
+
+    /* Sparse loading, the ranges (sorted by fileIndex) loaded one after the other in workMem. With no ranges workMem
+     * holds all the bytes from fileIndex and on */
+    const Chunk_Range_t *ranges_p;
+    int numOfRanges;
 }Chunk_Description_t;
 
+/***********************************************************************************************************************
+*   Chunk_TextRef
+*   The text of the row starting at fileIndex in the work memory. nullptr if the row wasn't loaded (sparse loading)
+***********************************************************************************************************************/
+inline char *Chunk_TextRef(const Chunk_Description_t *chunkDescr_p, char *workMem_p, int64_t fileIndex)
+{
+    if (chunkDescr_p->numOfRanges == 0) {
+        return workMem_p + (fileIndex - chunkDescr_p->fileIndex);
+    }
+
+    /* Find the last range starting at, or before, fileIndex */
+    const Chunk_Range_t *ranges_p = chunkDescr_p->ranges_p;
+    int low = 0;
+    int high = chunkDescr_p->numOfRanges;
+
+    while (low < high) {
+        const int mid = low + (high - low) / 2;
+        if (ranges_p[mid].fileIndex <= fileIndex) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if ((low == 0) || (fileIndex >= ranges_p[low - 1].fileIndex + ranges_p[low - 1].size)) {
+        return nullptr;
+    }
+
+    return workMem_p + ranges_p[low - 1].memOffset + (fileIndex - ranges_p[low - 1].fileIndex);
+}
+
 typedef struct {
     char *text_p;
     int textLength;
@@ -47,8 +101,12 @@ typedef struct {
     /* hyperscan regexp engine */
     hs_database_t *regexp_database;
     hs_scratch_t *regexp_scratch;
+    bool regexp_som; /* The database is compiled with REGEXP_HYPERSCAN_SOM_FLAGS, the match position is reported */
+    const QRegularExpression *regexp_confirm_p; /* Set if the database is a prefilter, see RegExpHybrid_Compile */
     int32_t threadIndex; /* used for saving result */
     bool match;
+    int matchOffset; /* Start of the match in text_p, -1 if not known (regular expression without regexp_som) */
+    int matchLength;
 } Match_Description_t;
 
 extern bool thread_Match(Match_Description_t *desc_p);
@@ -56,6 +114,28 @@ extern bool thread_Match_RegExp(Match_Description_t *desc_p);
 extern bool thread_Match_RegExp_HyperScan(Match_Description_t *desc_p);
 extern bool thread_Match_CS(Match_Description_t *desc_p);
 
+/***********************************************************************************************************************
+*   CCancelToken
+*
+*   Cancellation of a single background processing, checked by the threads for each row. Processing without a token
+*   is cancelled by the user abort (g_processingCtrl_p->m_abort) as before.
+***********************************************************************************************************************/
+class CCancelToken
+{
+public:
+    /****/
+    void Cancel(void) {m_cancelled.store(true, std::memory_order_relaxed);}
+
+    /****/
+    void Reset(void) {m_cancelled.store(false, std::memory_order_relaxed);}
+
+    /****/
+    bool isCancelled(void) const {return m_cancelled.load(std::memory_order_relaxed);}
+
+private:
+    std::atomic_bool m_cancelled {false};
+};
+
 /***********************************************************************************************************************
 *   Sleeper
 ***********************************************************************************************************************/
@@ -138,6 +218,12 @@ public:
 
     int GetNumOf_TI() {return m_numOf_TI;}
 
+    /****/
+    inline bool isCancelled(void) const
+    {
+        return m_cancelToken_p != nullptr ? m_cancelToken_p->isCancelled() : g_processingCtrl_p->m_abort;
+    }
+
     int m_numOf_TI; /* Number of TIA rows this thread shall process from the chunk */
     int m_start_TIA_index; /* At which TIA index this thread shall start */
     int m_stop_TIA_Index; /* Where this thread should stop */
@@ -146,8 +232,10 @@ public:
     /* Identify of the thread, set by the thread that picks up the configuration. If not processed this value is -1 */
     int m_servedBy_threadIndex;
     Chunk_Description_t m_chunkDescr;
+    int m_node = -1; /* NUMA node where the rows are placed, -1 when not placed. See CFileProcBase::PlaceChunk */
     char *m_workMem_p; /* Memory containing the loaded text file */
     TIA_t *m_TIA_p; /* Text Item Array, mapping between fileIndex and rows in the textFile */
+    const CCancelToken *m_cancelToken_p = nullptr; /* Set for background processing, see CFileProcBase */
 };
 
 /***********************************************************************************************************************
@@ -180,6 +268,10 @@ public:
     {
         g_RamLog->RegisterThread();
 
+        if (m_node >= 0) {
+            Numa_PinThread(m_node);
+        }
+
         auto unregisterRamLog = makeMyScopeGuard([&] () {
             g_RamLog->UnregisterThread();
         });
@@ -205,6 +297,7 @@ public:
             if (!m_stop) {
                 if (GetConfiguration()) {
                     PRINT_PROGRESS_DBG("Thread %d processing start %d", m_threadIndex, loops)
+                    TRACE_SPAN("thread_Process")
                     thread_Process(m_configuration_p);
                 } else {
                     TRACEX_E("Thread was allowed to start, but there was no configuration")
@@ -243,12 +336,22 @@ protected:
     void thread_ProcessingDone(void) {}
     bool thread_isStopped(void) {return m_isStopped;}
 
-    /****/
+    /* Prefer a configuration with the rows placed on the node of the thread */
     bool GetConfiguration()
     {
         QMutexLocker locker(m_configurationListMutex_p);
         if (m_configurationList_p->empty()) {return false;} /* error if list is empty */
-        m_configuration_p = m_configurationList_p->takeFirst();
+
+        int index = 0;
+        if (m_node >= 0) {
+            for (int candidate = 0; candidate < m_configurationList_p->count(); ++candidate) {
+                if (m_configurationList_p->at(candidate)->m_node == m_node) {
+                    index = candidate;
+                    break;
+                }
+            }
+        }
+        m_configuration_p = m_configurationList_p->takeAt(index);
         m_configurationListPool_p->append(m_configuration_p); /* put it back to the pool */
         return true;
     }
@@ -257,6 +360,7 @@ public:
     /* Specific variables used for regular expression operations */
     bool m_isConfiguredOnce;
     int32_t m_threadIndex;
+    int m_node = -1; /* NUMA node the thread is pinned to, set before start. -1 not pinned */
 
 protected:
     std::atomic_bool m_isStopped;
@@ -286,26 +390,30 @@ class CFileProcBase : public QObject
     Q_OBJECT
 
 public:
-    CFileProcBase() : m_readySem_p(nullptr), m_holdupSem_p(nullptr)
+    /* With a cancel token the processing is a background processing, it is cancelled only through the token and
+     * doesn't report any progress (the progress belongs to the modal operations) */
+    explicit CFileProcBase(CCancelToken *cancelToken_p = nullptr) : m_readySem_p(nullptr), m_holdupSem_p(nullptr)
     {
-        g_processingCtrl_p->m_abort = false;
-
-        for (int index = 0; index < g_cfg_p->m_numOfThreads; index++) {
-            m_startSem_pp[index] = nullptr;
+        m_cancelToken_p = cancelToken_p;
+        if (m_cancelToken_p == nullptr) {
+            g_processingCtrl_p->m_abort = false;
         }
 
+        m_numOfThreads = g_cfg_p->GetNumOfThreads(0);
         memset(&m_chunkDescr, 0, sizeof(Chunk_Description_t));
-        memset(m_threadInstances, 0, sizeof(m_threadInstances));
     }
 
     virtual ~CFileProcBase(void)
     {
-        for (int index = 0; index < g_cfg_p->m_numOfThreads; ++index) {
-            if (m_threadInstances[index] != nullptr) {
-                delete m_threadInstances[index];
+        for (auto& threadInstance_p : m_threadInstances) {
+            if (threadInstance_p != nullptr) {
+                delete threadInstance_p;
             }
-            if (m_startSem_pp[index] != nullptr) {
-                delete m_startSem_pp[index];
+        }
+
+        for (auto& startSem_p : m_startSem_pp) {
+            if (startSem_p != nullptr) {
+                delete startSem_p;
             }
         }
 
@@ -340,12 +448,57 @@ public:
     double GetProgress(void) {return m_progress;}
     void Cancel(void); /* Cancel pending operation */
 
+    /* The number of processing threads, by default NUM_OF_THREADS. Set before Start */
+    void SetNumOfThreads(int numOfThreads) {m_numOfThreads = numOfThreads > 0 ? numOfThreads : 1;}
+
+    /****/
+    int GetNumOfThreads(void) const {return m_numOfThreads;}
+
+    /* Skip the blocks of the log that cannot contain m_blockQuery, see CBlockSummary. Set before Start */
+    void SetBlockSummary(const CBlockSummary *blockSummary_p) {m_blockSummary_p = blockSummary_p;}
+
+    /* The rows the sub-class will process (sorted), e.g. the filtered rows. When these are only a small part of the
+     * processed rows the chunks are loaded sparse, only the ranges with the selected rows are read from the log and the
+     * threads must use Chunk_TextRef. Set before Start */
+    void SetSparseRows(const packed_FIR_t *rows_p, int numOfRows)
+    {
+        m_sparseRows_p = rows_p;
+        m_sparseNumOfRows = numOfRows;
+    }
+
 public:
 protected:
     /****/
     virtual void ConfigureChunkProcessing(void)
     {
-        g_processingCtrl_p->SetNumOfProgressCounters(m_numberOfChunkThreads);
+        if (!isBackground()) {
+            g_processingCtrl_p->SetNumOfProgressCounters(m_numberOfChunkThreads);
+        }
+    }
+
+    /****/
+    inline bool isBackground(void) const {return m_cancelToken_p != nullptr;}
+
+    /****/
+    inline void ReportProgressInfo(const QString& info)
+    {
+        if (!isBackground()) {
+            g_processingCtrl_p->AddProgressInfo(info);
+        }
+    }
+
+    /****/
+    inline void ReportFileOperation(bool ongoing)
+    {
+        if (!isBackground()) {
+            g_processingCtrl_p->SetFileOperationOngoing(ongoing);
+        }
+    }
+
+    /****/
+    inline bool isCancelled(void) const
+    {
+        return m_cancelToken_p != nullptr ? m_cancelToken_p->isCancelled() : g_processingCtrl_p->m_abort;
     }
 
     /* Override this function to configure m_threadInstances[threadIndex] */
@@ -359,9 +512,33 @@ protected:
     virtual bool isProcessingDone(void);
     virtual void WrapUp(void) {}
 
+    /* Override to limit the number of rows in the next chunk, called once per chunk. 0 means only limited by the work
+     * memory */
+    virtual int GetChunkRowLimit(void) {return 0;}
+
     void Process(void);
     bool LoadNextChunk(void);
 
+    /* The first row in [firstRow, lastRow + 1] starting at, or after, fileIndex */
+    int GetFirstRowFrom(int64_t fileIndex, int firstRow, int lastRow) const;
+
+private:
+    /* The threads processing a chunk, only multiple threads if it has at least
+     * CFG_MINIMUM_NUM_OF_TIs_FOR_MULTI_THREAD_FILERING rows when split */
+    int GetChunkThreads(int numOfRows) const
+    {
+        if (m_threadTI_Split) {
+            return numOfRows > CFG_MINIMUM_NUM_OF_TIs_FOR_MULTI_THREAD_FILERING ? m_numOfThreads : 1;
+        }
+        return m_numOfThreads;   /* Set by the sub-class, e.g. one thread per plot */
+    }
+
+    void PlaceChunk(void);
+    int GetFirstSparseIndex(int row) const; /* The first index in m_sparseRows_p with a row at, or after, row */
+    bool LoadNextSparseChunk(void);
+    bool AddSparseRow(int row, int64_t *memUsed_p);
+    bool ReadSparseRanges(void);
+
 public:
     QMutex m_configurationListMutex;
     QList<CThreadConfiguration *> m_configurationPoolList;
@@ -378,10 +555,21 @@ protected:
     int m_startRow = 0; /* Zooming... restricting lines */
     int m_endRow = 0; /* Zooming... restricting lines */
     bool m_backward = false; /* In case reading file backwards this flag is set */
+    CCancelToken *m_cancelToken_p = nullptr; /* Background processing, see constructor */
+    const CBlockSummary *m_blockSummary_p = nullptr;
+    CBlockSummaryQuery m_blockQuery; /* Setup by the sub-class, what the rows must contain to be processed */
+    int64_t m_skippedBytes = 0;
+    const packed_FIR_t *m_sparseRows_p = nullptr; /* See SetSparseRows */
+    int m_sparseNumOfRows = 0;
+    bool m_sparse = false; /* Sparse loading used, decided at start of processing */
+    int m_sparseIndex = 0; /* Next index in m_sparseRows_p to load */
+    std::vector<Chunk_Range_t> m_sparseRanges; /* The ranges of the current chunk */
+    int64_t m_sparseReadBytes = 0;
 
     /* WORK DATA */
-    CFileProcThreadBase *m_threadInstances[MAX_NUM_OF_THREADS]; /* Work data for the threads */
-    QSemaphore *m_startSem_pp[MAX_NUM_OF_THREADS]; /* Used to trigger when thread shall start */
+    int m_numOfThreads = 1; /* See SetNumOfThreads */
+    std::vector<CFileProcThreadBase *> m_threadInstances; /* Work data for the threads, m_numOfThreads */
+    std::vector<QSemaphore *> m_startSem_pp; /* Used to trigger when thread shall start */
     QSemaphore *m_readySem_p = nullptr; /* Used to indicate to ctrl when thread is ready to run again */
 
     /* Extra semaphore point to make all threads rally, used for extra safety in-case some of the threads pass
@@ -398,5 +586,10 @@ protected:
     /* In-case the thread processing should be on each line, not splitting the work (plugin typically). Each thread
      * has its own unique task */
     bool m_threadTI_Split = false;
+
+    /* Set by the sub-class when the threads process the default split, consecutive rows each, such that the rows of
+     * the threads on a NUMA node are placed on the node. See PlaceChunk */
+    bool m_numaPlacement = false;
+    int m_numaNodes = 1; /* The nodes used for the current processing, 1 if not placed */
     char m_tempString[CFG_TEMP_STRING_MAX_SIZE];
 };
@@ -0,0 +1,443 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "CFilterExpression.h"
+#include "CFileProcBase.h"
+#include "CRegExpHybrid.h"
+
+#include <string.h>
+#include <ctype.h>
+
+/***********************************************************************************************************************
+*   FilterExpression_MatchLeaf
+***********************************************************************************************************************/
+bool FilterExpression_MatchLeaf(const FilterExprLeaf_t& leaf, const char *text_p, int textLength)
+{
+    Match_Description_t matchDescr;
+
+    memset(&matchDescr, 0, sizeof(Match_Description_t));
+    matchDescr.text_p = text_p;
+    matchDescr.textLength = textLength;
+    matchDescr.filter_p = leaf.text.constData();
+
+    if (!leaf.regExp) {
+        if (leaf.text.size() > textLength) {
+            return false;
+        }
+        matchDescr.filterLength = leaf.text.size() - 1; /* the home made search compares length to index */
+        return leaf.caseSensitive ? thread_Match_CS(&matchDescr) : thread_Match(&matchDescr);
+    }
+
+    hs_database_t *database = nullptr;
+    hs_scratch_t *scratch = nullptr;
+    QRegularExpression *confirm_p = nullptr;
+    bool match = false;
+
+    if (RegExpHybrid_Compile(leaf.text.constData(), REGEXP_HYPERSCAN_FLAGS, &database, &confirm_p) &&
+        (hs_alloc_scratch(database, &scratch) == HS_SUCCESS)) {
+        matchDescr.filterLength = leaf.text.size();
+        matchDescr.regexp_database = database;
+        matchDescr.regexp_scratch = scratch;
+        matchDescr.regexp_confirm_p = confirm_p;
+        match = thread_Match_RegExp_HyperScan(&matchDescr);
+    }
+
+    if (scratch != nullptr) {
+        hs_free_scratch(scratch);
+    }
+    if (database != nullptr) {
+        hs_free_database(database);
+    }
+    delete confirm_p;
+    return match;
+}
+
+/***********************************************************************************************************************
+*   Parse
+***********************************************************************************************************************/
+bool CFilterExpression::Parse(const char *text_p, bool caseSensitive, QString *error_p)
+{
+    m_leaves.clear();
+    m_nodes.clear();
+    m_error.clear();
+    m_parse_p = text_p;
+    m_caseSensitive = caseSensitive;
+
+    m_root = ParseOr();
+
+    if (m_root != -1) {
+        SkipSpace();
+        if (*m_parse_p != 0) {
+            m_error = QString("Unexpected \"%1\"").arg(m_parse_p);
+            m_root = -1;
+        }
+    }
+
+    m_parse_p = nullptr;
+
+    if (m_root == -1) {
+        if (error_p != nullptr) {
+            *error_p = m_error;
+        }
+        return false;
+    }
+    return true;
+}
+
+/***********************************************************************************************************************
+*   SkipSpace
+***********************************************************************************************************************/
+void CFilterExpression::SkipSpace(void)
+{
+    while (*m_parse_p == ' ' || *m_parse_p == '\t') {
+        ++m_parse_p;
+    }
+}
+
+/***********************************************************************************************************************
+*   ParseKeyword
+*   The keywords are case insensitive, and must not be followed by a letter or digit
+***********************************************************************************************************************/
+bool CFilterExpression::ParseKeyword(const char *keyword_p)
+{
+    SkipSpace();
+
+    const size_t length = strlen(keyword_p);
+    for (size_t index = 0; index < length; ++index) {
+        if (toupper(static_cast<unsigned char>(m_parse_p[index])) != keyword_p[index]) {
+            return false;
+        }
+    }
+
+    if (isalnum(static_cast<unsigned char>(m_parse_p[length])) || (m_parse_p[length] == '_')) {
+        return false;
+    }
+
+    m_parse_p += length;
+    return true;
+}
+
+/***********************************************************************************************************************
+*   AddNode
+***********************************************************************************************************************/
+int CFilterExpression::AddNode(ExprOp_t op, int left, int right, int leaf, int distance)
+{
+    m_nodes.push_back(ExprNode_t{op, left, right, leaf, distance});
+    return static_cast<int>(m_nodes.size()) - 1;
+}
+
+/***********************************************************************************************************************
+*   ParseOr
+***********************************************************************************************************************/
+int CFilterExpression::ParseOr(void)
+{
+    int left = ParseAnd();
+
+    while ((left != -1) && ParseKeyword("OR")) {
+        const int right = ParseAnd();
+        left = right == -1 ? -1 : AddNode(EXPR_OR, left, right);
+    }
+    return left;
+}
+
+/***********************************************************************************************************************
+*   ParseAnd
+***********************************************************************************************************************/
+int CFilterExpression::ParseAnd(void)
+{
+    int left = ParseWithin();
+
+    while ((left != -1) && ParseKeyword("AND")) {
+        const int right = ParseWithin();
+        left = right == -1 ? -1 : AddNode(EXPR_AND, left, right);
+    }
+    return left;
+}
+
+/***********************************************************************************************************************
+*   ParseWithin
+***********************************************************************************************************************/
+int CFilterExpression::ParseWithin(void)
+{
+    int left = ParseUnary();
+
+    while ((left != -1) && ParseKeyword("WITHIN")) {
+        SkipSpace();
+        if (!isdigit(static_cast<unsigned char>(*m_parse_p))) {
+            m_error = QString("WITHIN shall be followed by the number of rows");
+            return -1;
+        }
+
+        int distance = 0;
+        while (isdigit(static_cast<unsigned char>(*m_parse_p))) {
+            distance = distance * 10 + (*m_parse_p - '0');
+            if (distance > FILTER_EXPR_MAX_DISTANCE) {
+                m_error = QString("WITHIN more than %1 rows").arg(FILTER_EXPR_MAX_DISTANCE);
+                return -1;
+            }
+            ++m_parse_p;
+        }
+
+        const int right = ParseUnary();
+        left = right == -1 ? -1 : AddNode(EXPR_WITHIN, left, right, -1, distance);
+    }
+    return left;
+}
+
+/***********************************************************************************************************************
+*   ParseUnary
+***********************************************************************************************************************/
+int CFilterExpression::ParseUnary(void)
+{
+    if (ParseKeyword("NOT")) {
+        const int operand = ParseUnary();
+        return operand == -1 ? -1 : AddNode(EXPR_NOT, operand, -1);
+    }
+    return ParsePrimary();
+}
+
+/***********************************************************************************************************************
+*   ParsePrimary
+***********************************************************************************************************************/
+int CFilterExpression::ParsePrimary(void)
+{
+    SkipSpace();
+
+    if (*m_parse_p == '(') {
+        ++m_parse_p;
+
+        const int node = ParseOr();
+        if (node == -1) {
+            return -1;
+        }
+
+        SkipSpace();
+        if (*m_parse_p != ')') {
+            m_error = QString("Missing )");
+            return -1;
+        }
+        ++m_parse_p;
+        return node;
+    }
+
+    if ((*m_parse_p != '"') && (*m_parse_p != '/')) {
+        m_error = *m_parse_p == 0 ? QString("Missing operand at the end") :
+                  QString("Expected \"text\" or /regexp/ at \"%1\"").arg(m_parse_p);
+        return -1;
+    }
+
+    const char delimiter = *m_parse_p++;
+    FilterExprLeaf_t leaf;
+
+    leaf.regExp = delimiter == '/';
+    leaf.caseSensitive = m_caseSensitive;
+
+    while ((*m_parse_p != 0) && (*m_parse_p != delimiter)) {
+        if ((m_parse_p[0] == '\\') && (m_parse_p[1] == delimiter)) {
+            ++m_parse_p;
+        }
+        leaf.text.append(*m_parse_p++);
+    }
+
+    if (*m_parse_p != delimiter) {
+        m_error = QString("Missing closing %1").arg(delimiter);
+        return -1;
+    }
+    ++m_parse_p;
+
+    if (leaf.text.isEmpty()) {
+        m_error = QString("Empty operand");
+        return -1;
+    }
+
+    if (leaf.regExp) {
+        hs_database_t *database = nullptr;
+        QRegularExpression *confirm_p = nullptr;
+        QString error;
+
+        if (!RegExpHybrid_Compile(leaf.text.constData(), REGEXP_HYPERSCAN_FLAGS, &database, &confirm_p, &error)) {
+            m_error = QString("Bad regexp /%1/, %2").arg(leaf.text.constData()).arg(error);
+            return -1;
+        }
+        hs_free_database(database);
+        delete confirm_p;
+    }
+
+    /* A sub-pattern used more than once is matched once */
+    for (size_t index = 0; index < m_leaves.size(); ++index) {
+        if ((m_leaves[index].text == leaf.text) && (m_leaves[index].regExp == leaf.regExp)) {
+            return AddNode(EXPR_LEAF, -1, -1, static_cast<int>(index));
+        }
+    }
+
+    m_leaves.push_back(leaf);
+    return AddNode(EXPR_LEAF, -1, -1, static_cast<int>(m_leaves.size()) - 1);
+}
+
+/***********************************************************************************************************************
+*   Dilate
+*   Set the bits at most distance bits from each set bit, the dilations by a and b make the dilation by a + b, hence one
+*   shift for each bit set in distance.
+***********************************************************************************************************************/
+static void Dilate(uint64_t *bits_p, int words, int distance)
+{
+    std::vector<uint64_t> source(static_cast<size_t>(words));
+
+    for (int shift = 1; shift <= distance; shift <<= 1) {
+        if (!(distance & shift)) {
+            continue;
+        }
+
+        memcpy(source.data(), bits_p, sizeof(uint64_t) * static_cast<size_t>(words));
+
+        const int wordShift = shift >> 6;
+        const int bitShift = shift & 63;
+
+        for (int index = 0; index < words; ++index) {
+            uint64_t word = 0;
+
+            /* From lower rows */
+            if (index - wordShift >= 0) {
+                word |= source[index - wordShift] << bitShift;
+                if ((bitShift != 0) && (index - wordShift - 1 >= 0)) {
+                    word |= source[index - wordShift - 1] >> (64 - bitShift);
+                }
+            }
+
+            /* From higher rows */
+            if (index + wordShift < words) {
+                word |= source[index + wordShift] >> bitShift;
+                if ((bitShift != 0) && (index + wordShift + 1 < words)) {
+                    word |= source[index + wordShift + 1] << (64 - bitShift);
+                }
+            }
+
+            bits_p[index] |= word;
+        }
+    }
+}
+
+/***********************************************************************************************************************
+*   Evaluate
+***********************************************************************************************************************/
+void CFilterExpression::Evaluate(const std::vector<const uint64_t *>& leafBitmaps, int firstRow, int lastRow,
+                                 uint64_t *result_p) const
+{
+    const int words = (lastRow >> 6) + 1;
+    std::vector<uint64_t> valid(static_cast<size_t>(words), ~static_cast<uint64_t>(0));
+
+    /* The rows outside firstRow..lastRow weren't filtered, they must neither match NOT nor be reached by WITHIN */
+    for (int index = 0; index < (firstRow >> 6); ++index) {
+        valid[static_cast<size_t>(index)] = 0;
+    }
+    valid[static_cast<size_t>(firstRow >> 6)] &= ~((static_cast<uint64_t>(1) << (firstRow & 63)) - 1);
+    if ((lastRow & 63) != 63) {
+        valid[static_cast<size_t>(words - 1)] &= (static_cast<uint64_t>(1) << ((lastRow & 63) + 1)) - 1;
+    }
+
+    if (m_root == -1) {
+        memset(result_p, 0, sizeof(uint64_t) * static_cast<size_t>(words));
+        return;
+    }
+
+    EvaluateNode(m_root, leafBitmaps, words, valid.data(), result_p);
+
+    for (int index = 0; index < words; ++index) {
+        result_p[index] &= valid[static_cast<size_t>(index)];
+    }
+}
+
+/***********************************************************************************************************************
+*   EvaluateNode
+***********************************************************************************************************************/
+void CFilterExpression::EvaluateNode(int node, const std::vector<const uint64_t *>& leafBitmaps, int words,
+                                     const uint64_t *valid_p, uint64_t *result_p) const
+{
+    const ExprNode_t& exprNode = m_nodes[static_cast<size_t>(node)];
+
+    if (exprNode.op == EXPR_LEAF) {
+        memcpy(result_p, leafBitmaps[static_cast<size_t>(exprNode.leaf)],
+               sizeof(uint64_t) * static_cast<size_t>(words));
+        return;
+    }
+
+    EvaluateNode(exprNode.left, leafBitmaps, words, valid_p, result_p);
+
+    if (exprNode.op == EXPR_NOT) {
+        for (int index = 0; index < words; ++index) {
+            result_p[index] = ~result_p[index] & valid_p[index];
+        }
+        return;
+    }
+
+    std::vector<uint64_t> right(static_cast<size_t>(words));
+    EvaluateNode(exprNode.right, leafBitmaps, words, valid_p, right.data());
+
+    switch (exprNode.op)
+    {
+        case EXPR_AND:
+            for (int index = 0; index < words; ++index) {
+                result_p[index] &= right[static_cast<size_t>(index)];
+            }
+            break;
+
+        case EXPR_OR:
+            for (int index = 0; index < words; ++index) {
+                result_p[index] |= right[static_cast<size_t>(index)];
+            }
+            break;
+
+        case EXPR_WITHIN:
+            Dilate(right.data(), words, exprNode.distance);
+            for (int index = 0; index < words; ++index) {
+                result_p[index] &= right[static_cast<size_t>(index)];
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+/***********************************************************************************************************************
+*   MatchRow
+***********************************************************************************************************************/
+bool CFilterExpression::MatchRow(const char *text_p, int textLength) const
+{
+    if (m_root == -1) {
+        return false;
+    }
+
+    std::vector<bool> leafMatch(m_leaves.size());
+    for (size_t index = 0; index < m_leaves.size(); ++index) {
+        leafMatch[index] = FilterExpression_MatchLeaf(m_leaves[index], text_p, textLength);
+    }
+    return MatchNode(m_root, leafMatch);
+}
+
+/***********************************************************************************************************************
+*   MatchNode
+***********************************************************************************************************************/
+bool CFilterExpression::MatchNode(int node, const std::vector<bool>& leafMatch) const
+{
+    const ExprNode_t& exprNode = m_nodes[static_cast<size_t>(node)];
+
+    switch (exprNode.op)
+    {
+        case EXPR_LEAF:
+            return leafMatch[static_cast<size_t>(exprNode.leaf)];
+
+        case EXPR_NOT:
+            return !MatchNode(exprNode.left, leafMatch);
+
+        case EXPR_OR:
+            return MatchNode(exprNode.left, leafMatch) || MatchNode(exprNode.right, leafMatch);
+
+        case EXPR_AND:
+        case EXPR_WITHIN:
+            return MatchNode(exprNode.left, leafMatch) && MatchNode(exprNode.right, leafMatch);
+    }
+    return false;
+}
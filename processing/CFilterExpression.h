@@ -0,0 +1,101 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+
+#define FILTER_EXPR_MAX_DISTANCE   100000  /* Max N of WITHIN N */
+
+/* A sub-pattern of a compound filter item, matched once per row during filtering */
+typedef struct {
+    QByteArray text;       /* Zero terminated */
+    bool regExp;
+    bool caseSensitive;
+} FilterExprLeaf_t;
+
+/***********************************************************************************************************************
+*   CFilterExpression
+*
+*   A compound filter item, e.g.
+*
+*       "connect" WITHIN 5 ("refused" OR /time ?out/) AND NOT "retry"
+*
+*   The operands are text ("...", \" for a quote) or regular expressions (/.../, \/ for a slash). NOT binds hardest,
+*   then WITHIN, AND and OR. "A WITHIN N B" matches the rows matching A that have a row matching B at most N rows
+*   before or after it (or on the same row).
+*
+*   During filtering each leaf is matched once per row into a bitmap of the rows, and the expression is then evaluated
+*   with word-wide operations on the leaf bitmaps, i.e. 64 rows at a time. WITHIN dilates its right hand bitmap, in
+*   log2(N) steps.
+***********************************************************************************************************************/
+class CFilterExpression
+{
+public:
+    /* Returns false, with the reason in error_p, if the expression isn't valid. Text operands are case sensitive if
+     * caseSensitive */
+    bool Parse(const char *text_p, bool caseSensitive, QString *error_p = nullptr);
+
+    /****/
+    const std::vector<FilterExprLeaf_t>& GetLeaves(void) const {return m_leaves;}
+
+    /* The bitmaps have a bit per row, bit b in word b / 64. The caller places a word aligned row at bit 0, hence
+     * firstRow and lastRow are bit positions and firstRow may be above 0. The leaf bitmaps shall contain the rows
+     * firstRow..lastRow matching the leaf, in lastRow / 64 + 1 words. Sets the bits of the rows matching the
+     * expression in result_p, the bits below firstRow and above lastRow are cleared, these rows neither match NOT
+     * nor are reached by WITHIN. */
+    void Evaluate(const std::vector<const uint64_t *>& leafBitmaps, int firstRow, int lastRow,
+                  uint64_t *result_p) const;
+
+    /* Evaluate on a single row, without the rows around it "A WITHIN N B" is evaluated as "A AND B" */
+    bool MatchRow(const char *text_p, int textLength) const;
+
+private:
+    typedef enum {
+        EXPR_LEAF,
+        EXPR_AND,
+        EXPR_OR,
+        EXPR_NOT,
+        EXPR_WITHIN
+    } ExprOp_t;
+
+    typedef struct {
+        ExprOp_t op;
+        int left;      /* Node index, the operand of NOT */
+        int right;     /* Node index */
+        int leaf;      /* Leaf index, for EXPR_LEAF */
+        int distance;  /* N, for EXPR_WITHIN */
+    } ExprNode_t;
+
+    int ParseOr(void);
+    int ParseAnd(void);
+    int ParseWithin(void);
+    int ParseUnary(void);
+    int ParsePrimary(void);
+    bool ParseKeyword(const char *keyword_p);
+    void SkipSpace(void);
+    int AddNode(ExprOp_t op, int left, int right, int leaf = -1, int distance = 0);
+
+    void EvaluateNode(int node, const std::vector<const uint64_t *>& leafBitmaps, int words, const uint64_t *valid_p,
+                      uint64_t *result_p) const;
+    bool MatchNode(int node, const std::vector<bool>& leafMatch) const;
+
+    std::vector<FilterExprLeaf_t> m_leaves;
+    std::vector<ExprNode_t> m_nodes;
+    int m_root = -1;
+
+    /* Parsing state */
+    const char *m_parse_p = nullptr;
+    bool m_caseSensitive = false;
+    QString m_error;
+};
+
+/* Match text with one leaf, with the matchers used by the filtering. Regular expressions are compiled for each call,
+ * used when filtering single rows */
+bool FilterExpression_MatchLeaf(const FilterExprLeaf_t& leaf, const char *text_p, int textLength);
@@ -7,6 +7,11 @@
 #include "CFilterProcCtrl.h"
 #include "CProgressCtrl.h"
 #include "CMemPool.h"
+#include "CSearchIndex.h"
+
+#include <chrono>
+
+#include <QtAlgorithms>
 
 /***********************************************************************************************************************
 *   FileIndex_To_MemRef
@@ -16,6 +21,96 @@ inline char *FileIndex_To_MemRef(int64_t *fileIndex_p, int64_t *workMemFileIndex
     return (static_cast<char *>(WorkMem_p + (*fileIndex_p - *workMemFileIndex_p)));
 }
 
+/***********************************************************************************************************************
+*   _profileNow
+***********************************************************************************************************************/
+static inline int64_t _profileNow(void)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* How a regular expression filter item is evaluated in a chunk. Since the first matching filter item decides the
+ * row, each filter item before it must be evaluated, the order can't be changed without evaluating more. Instead an
+ * expensive regular expression is guarded by the literals it requires, found with a (cheap) plain text search.
+ * A thread samples the first rows of its chunk, matching both, and uses the guard for the remaining rows if it
+ * rejects enough rows to pay for itself. The guard only rejects rows that the regular expression can't match, the
+ * result is the same either way. */
+typedef enum {
+    FILTER_PLAN_SAMPLING,
+    FILTER_PLAN_DIRECT,
+    FILTER_PLAN_GUARDED
+} FilterPlanState_e;
+
+typedef struct {
+    FilterPlanState_e state;
+    const std::vector<QByteArray> *literals_p;  /* nullptr if the item isn't guarded */
+    int samples;
+    int guardPassed;
+    int64_t guardTime;  /* ns */
+    int64_t matchTime;  /* ns */
+} FilterPlan_t;
+
+/***********************************************************************************************************************
+*   _matchGuard
+*   True if the row contains all the literals (ignoring case, as the literals are matched in the block summary)
+***********************************************************************************************************************/
+static inline bool _matchGuard(const Match_Description_t& matchDescr, const std::vector<QByteArray>& literals)
+{
+    Match_Description_t guardDescr = matchDescr;
+
+    for (auto& literal : literals) {
+        if (literal.size() > guardDescr.textLength) {
+            return false;
+        }
+        guardDescr.filter_p = literal.constData();
+        guardDescr.filterLength = literal.size() - 1; /* the home made search compares length to index */
+        if (!thread_Match(&guardDescr)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/***********************************************************************************************************************
+*   _matchRegExpPlanned
+***********************************************************************************************************************/
+static bool _matchRegExpPlanned(Match_Description_t *matchDescr_p, FilterPlan_t *plan_p)
+{
+    switch (plan_p->state)
+    {
+        case FILTER_PLAN_DIRECT:
+            return thread_Match_RegExp_HyperScan(matchDescr_p);
+
+        case FILTER_PLAN_GUARDED:
+            return _matchGuard(*matchDescr_p, *plan_p->literals_p) && thread_Match_RegExp_HyperScan(matchDescr_p);
+
+        default:
+            break;
+    }
+
+    const int64_t start = _profileNow();
+    const bool guard = _matchGuard(*matchDescr_p, *plan_p->literals_p);
+    const int64_t guardEnd = _profileNow();
+    const bool match = thread_Match_RegExp_HyperScan(matchDescr_p);
+
+    plan_p->guardTime += guardEnd - start;
+    plan_p->matchTime += _profileNow() - guardEnd;
+    plan_p->guardPassed += guard ? 1 : 0;
+
+    if (match && !guard) {
+        /* The literals weren't required after all, never guard this one */
+        plan_p->state = FILTER_PLAN_DIRECT;
+    } else if (++plan_p->samples == FILTER_PLAN_SAMPLE_ROWS) {
+        /* Guarded, the regular expression is only matched on the rows passing the guard */
+        const double guardedTime = static_cast<double>(plan_p->guardTime) +
+                                   static_cast<double>(plan_p->matchTime) * plan_p->guardPassed / plan_p->samples;
+        plan_p->state = guardedTime < static_cast<double>(plan_p->matchTime) ? FILTER_PLAN_GUARDED :
+                        FILTER_PLAN_DIRECT;
+    }
+    return match;
+}
+
 /* Main for v-table generation */
 CFilterThreadConfiguration::~CFilterThreadConfiguration() {}
 
@@ -60,6 +155,39 @@ static void _filter(CThreadConfiguration *config_p, std::atomic_bool* isStopped,
 
     int numOfFilterItems = filterConfig_p->m_numOfFilterItems;
 
+    /* The leaf bits of the current bitmap word are collected locally, and ORed into the shared bitmaps when the row
+     * passes into the next word (the words at the thread borders are shared) */
+    const int numOfLeaves = filterConfig_p->m_exprBitmaps_p != nullptr ?
+                            static_cast<int>(filterConfig_p->m_exprLeaves_p->size()) : 0;
+    std::vector<uint64_t> leafWords(static_cast<size_t>(numOfLeaves), 0);
+    int leafWordIndex = -1;
+    auto flushLeafWords = [&] () {
+        for (int leaf = 0; leaf < numOfLeaves; ++leaf) {
+            if (leafWords[static_cast<size_t>(leaf)] != 0) {
+                filterConfig_p->m_exprBitmaps_p[leaf * filterConfig_p->m_exprWords + leafWordIndex].fetch_or(
+                    leafWords[static_cast<size_t>(leaf)], std::memory_order_relaxed);
+                leafWords[static_cast<size_t>(leaf)] = 0;
+            }
+        }
+    };
+
+    /* Profiling, the evaluations and matches are counted on every row, the time only on every
+     * FILTER_PROFILE_SAMPLE_ROWS row */
+    FilterItemProfileCounters_t *profileCounters_p = filterConfig_p->m_profile_p;
+    std::vector<FilterItemProfile_t> profile(profileCounters_p != nullptr ? static_cast<size_t>(numOfFilterItems) : 0);
+    const bool profiled = !profile.empty();
+    int sampleCount = 1;
+
+    std::vector<FilterPlan_t> plans(static_cast<size_t>(numOfFilterItems));
+    for (size_t index = 0; index < plans.size(); ++index) {
+        memset(&plans[index], 0, sizeof(FilterPlan_t));
+        plans[index].state = FILTER_PLAN_DIRECT;
+        if ((filterConfig_p->m_guardLiterals_p != nullptr) && !(*filterConfig_p->m_guardLiterals_p)[index].empty()) {
+            plans[index].state = FILTER_PLAN_SAMPLING;
+            plans[index].literals_p = &(*filterConfig_p->m_guardLiterals_p)[index];
+        }
+    }
+
     progressCount = PROGRESS_COUNTER_STEP;
 
     while (TIA_Index < stop_TIA_Index && !g_processingCtrl_p->m_abort) {
@@ -70,19 +198,65 @@ static void _filter(CThreadConfiguration *config_p, std::atomic_bool* isStopped,
         match = false;
         filterIndex = 0;
 
+        if (numOfLeaves > 0) {
+            Match_Description_t leafDescr = matchDescr;
+            const int bit = TIA_Index - filterConfig_p->m_exprFirstRow;
+
+            if ((bit >> 6) != leafWordIndex) {
+                if (leafWordIndex != -1) {
+                    flushLeafWords();
+                }
+                leafWordIndex = bit >> 6;
+            }
+
+            if (filterConfig_p->m_useColClip) {
+                _colClipAdapt(leafDescr, &filterConfig_p->m_packedFilterItems_p[0]);
+            }
+
+            for (int leaf = 0; leaf < numOfLeaves; ++leaf) {
+                const FilterExprLeaf_t& leafRef = (*filterConfig_p->m_exprLeaves_p)[static_cast<size_t>(leaf)];
+                bool leafMatch = false;
+
+                leafDescr.filter_p = leafRef.text.constData();
+                if (leafRef.regExp) {
+                    leafDescr.filterLength = leafRef.text.size();
+                    leafDescr.regexp_database = filterConfig_p->m_exprDatabases[static_cast<size_t>(leaf)];
+                    leafDescr.regexp_scratch = filterConfig_p->m_exprScratches[static_cast<size_t>(leaf)];
+                    leafDescr.regexp_confirm_p = filterConfig_p->m_exprConfirms[static_cast<size_t>(leaf)];
+                    leafMatch = thread_Match_RegExp_HyperScan(&leafDescr);
+                } else if (leafRef.text.size() <= leafDescr.textLength) {
+                    leafDescr.filterLength = leafRef.text.size() - 1;
+                    leafMatch = leafRef.caseSensitive ? thread_Match_CS(&leafDescr) : thread_Match(&leafDescr);
+                }
+
+                if (leafMatch) {
+                    leafWords[static_cast<size_t>(leaf)] |= static_cast<uint64_t>(1) << (bit & 63);
+                }
+            }
+        }
+
         --progressCount;
         if (progressCount <= 0) {
             g_processingCtrl_p->StepProgressCounter(threadIndex);
             progressCount = PROGRESS_COUNTER_STEP;
         }
 
+        bool timed = false;
+        if (profiled && (--sampleCount == 0)) {
+            timed = true;
+            sampleCount = FILTER_PROFILE_SAMPLE_ROWS;
+        }
+
         while (filterIndex < numOfFilterItems && !match) {
             packedFilterItem_t *packedFilterItem_p = &filterConfig_p->m_packedFilterItems_p[filterIndex];
             const bool regExp = packedFilterItem_p->filterRef_p->m_regexpr;
+            const int64_t start = timed ? _profileNow() : 0;
             if (filterConfig_p->m_useColClip) {
                 _colClipAdapt(matchDescr, packedFilterItem_p);
             }
-            if (regExp || (packedFilterItem_p->length <= matchDescr.textLength)) {
+            if (packedFilterItem_p->m_expressionIndex != -1) {
+                /* Compound filter item, evaluated on the leaf bitmaps when all rows are filtered */
+            } else if (regExp || (packedFilterItem_p->length <= matchDescr.textLength)) {
                 matchDescr.filter_p = packedFilterItem_p->start_p;
                 if (regExp) {
                     matchDescr.filterLength = packedFilterItem_p->length;
@@ -90,7 +264,9 @@ static void _filter(CThreadConfiguration *config_p, std::atomic_bool* isStopped,
                         filterConfig_p->m_regexp_database_array[packedFilterItem_p->m_regExpLUTIndex];
                     matchDescr.regexp_scratch =
                         filterConfig_p->m_regexp_scratch_array[packedFilterItem_p->m_regExpLUTIndex];
-                    match = thread_Match_RegExp_HyperScan(&matchDescr);
+                    matchDescr.regexp_confirm_p =
+                        filterConfig_p->m_regexp_confirm_array[packedFilterItem_p->m_regExpLUTIndex];
+                    match = _matchRegExpPlanned(&matchDescr, &plans[static_cast<size_t>(filterIndex)]);
                 } else if (packedFilterItem_p->filterRef_p->m_caseSensitive) {
                     /*CASE */
                     matchDescr.filterLength = packedFilterItem_p->length - 1;
@@ -101,6 +277,18 @@ static void _filter(CThreadConfiguration *config_p, std::atomic_bool* isStopped,
                 }
             }
 
+            if (profiled && (packedFilterItem_p->m_expressionIndex == -1)) {
+                FilterItemProfile_t& itemProfile = profile[static_cast<size_t>(filterIndex)];
+                ++itemProfile.evaluations;
+                if (match) {
+                    ++itemProfile.matches;
+                }
+                if (timed) {
+                    ++itemProfile.sampledEvaluations;
+                    itemProfile.sampledTime += _profileNow() - start;
+                }
+            }
+
             ++filterIndex;
         }
 
@@ -115,6 +303,17 @@ static void _filter(CThreadConfiguration *config_p, std::atomic_bool* isStopped,
         TIA_Index += TIA_step;
     } /* while */
 
+    if (leafWordIndex != -1) {
+        flushLeafWords();
+    }
+
+    for (size_t index = 0; index < profile.size(); ++index) {
+        profileCounters_p[index].evaluations.fetch_add(profile[index].evaluations, std::memory_order_relaxed);
+        profileCounters_p[index].matches.fetch_add(profile[index].matches, std::memory_order_relaxed);
+        profileCounters_p[index].sampledEvaluations.fetch_add(profile[index].sampledEvaluations,
+                                                              std::memory_order_relaxed);
+        profileCounters_p[index].sampledTime.fetch_add(profile[index].sampledTime, std::memory_order_relaxed);
+    }
 }
 
 
@@ -127,7 +326,8 @@ void CFilterThread::thread_Process(CThreadConfiguration* config_p)
 /***********************************************************************************************************************
 *   init
 ***********************************************************************************************************************/
-void CFilterThreadConfiguration::init(FIR_t *FIRA_p, packedFilterItem_t *packedFilterItems_p, int numOfFilterItems)
+void CFilterThreadConfiguration::init(FIR_t *FIRA_p, packedFilterItem_t *packedFilterItems_p, int numOfFilterItems,
+                                      const std::vector<FilterExprLeaf_t> *exprLeaves_p)
 {
     m_FIRA_p = FIRA_p;
     m_packedFilterItems_p = packedFilterItems_p;
@@ -147,7 +347,7 @@ void CFilterThreadConfiguration::init(FIR_t *FIRA_p, packedFilterItem_t *packedF
 
         /* Count number of regex based filters */
         for (int index = 0; index < m_numOfFilterItems; ++index) {
-            if (m_packedFilterItems_p[index].filterRef_p->m_regexpr) {
+            if (m_packedFilterItems_p[index].m_regExpLUTIndex != -1) {
                 ++m_numOfRegExpFilters;
             }
         }
@@ -158,39 +358,23 @@ void CFilterThreadConfiguration::init(FIR_t *FIRA_p, packedFilterItem_t *packedF
         if (m_numOfRegExpFilters > 0) {
             m_regexp_database_array = new hs_database_t *[static_cast<uint32_t>(m_numOfRegExpFilters)];
             m_regexp_scratch_array = new hs_scratch_t *[static_cast<uint32_t>(m_numOfRegExpFilters)];
+            m_regexp_confirm_array = new QRegularExpression *[static_cast<uint32_t>(m_numOfRegExpFilters)];
 
             /* Create a set of database and scratch for each filter (in each configuration objects) */
             for (int index = 0; index < m_numOfFilterItems; index++) {
                 auto packedFilter_p = &m_packedFilterItems_p[index];
 
                 if (-1 != m_packedFilterItems_p[index].m_regExpLUTIndex) {
-                    hs_compile_error_t *compile_err;
                     hs_database_t *database = nullptr;
                     hs_scratch_t *scratch = nullptr;
+                    QRegularExpression *confirm_p = nullptr;
 
-                    if (hs_compile(packedFilter_p->start_p,
-                                   REGEXP_HYPERSCAN_FLAGS,
-                                   HS_MODE_BLOCK,
-                                   nullptr,
-                                   &database,
-                                   &compile_err) != HS_SUCCESS) {
-#if 0
-                        if (hs_compile_ext_multi(&packedFilter_p->start_p,
-                                                 &REGEXP_HYPERSCAN_FLAGS,
-                                                 nullptr, /*ids*/
-                                                 nullptr, /*ext*/
-                                                 1, /*elements*/
-                                                 HS_MODE_BLOCK, /*mode*/
-                                                 nullptr, /*platform*/
-                                                 &database,
-                                                 &compile_err) != HS_SUCCESS) {
-#endif
-
-                        TRACEX_I(QString("RegExp failed %1").arg(compile_err->message))
+                    /* Patterns not supported by Hyperscan are prefiltered by it and confirmed with PCRE */
+                    if (!RegExpHybrid_Compile(packedFilter_p->start_p, REGEXP_HYPERSCAN_FLAGS, &database,
+                                              &confirm_p)) {
                         g_processingCtrl_p->AddProgressInfo(QString("Regular expression contains error: %1")
                                                                 .arg(packedFilter_p->start_p));
                         g_processingCtrl_p->m_abort = true;
-                        hs_free_compile_error(compile_err);
                     }
 
                     hs_error_t error;
@@ -200,6 +384,28 @@ void CFilterThreadConfiguration::init(FIR_t *FIRA_p, packedFilterItem_t *packedF
                     }
                     m_regexp_database_array[packedFilter_p->m_regExpLUTIndex] = database;
                     m_regexp_scratch_array[packedFilter_p->m_regExpLUTIndex] = scratch;
+                    m_regexp_confirm_array[packedFilter_p->m_regExpLUTIndex] = confirm_p;
+                }
+            }
+        }
+
+        /* The regular expression leaves of the compound filter items, validated when the expressions were parsed */
+        m_exprLeaves_p = exprLeaves_p;
+        if (m_exprLeaves_p != nullptr) {
+            const size_t numOfLeaves = m_exprLeaves_p->size();
+            m_exprDatabases.assign(numOfLeaves, nullptr);
+            m_exprScratches.assign(numOfLeaves, nullptr);
+            m_exprConfirms.assign(numOfLeaves, nullptr);
+
+            for (size_t index = 0; index < numOfLeaves; ++index) {
+                const FilterExprLeaf_t& leaf = (*m_exprLeaves_p)[index];
+                if (leaf.regExp &&
+                    (!RegExpHybrid_Compile(leaf.text.constData(), REGEXP_HYPERSCAN_FLAGS, &m_exprDatabases[index],
+                                           &m_exprConfirms[index]) ||
+                     (hs_alloc_scratch(m_exprDatabases[index], &m_exprScratches[index]) != HS_SUCCESS))) {
+                    g_processingCtrl_p->AddProgressInfo(QString("Regular expression contains error: %1")
+                                                            .arg(leaf.text.constData()));
+                    g_processingCtrl_p->m_abort = true;
                 }
             }
         }
@@ -316,6 +522,30 @@ void CFilterProcCtrl::StartProcessing(QFile *qFile_p, char *workMem_p, int64_t w
 
     /* Might be 0 if only bookmarks */
     if (filterItems_p->count() > 0) {
+        /* A row matches no filter if it lacks a required literal of each one, include as well as exclude. The
+         * rows skipped keep the LUT_index 0 set by ClearFilterRefs */
+        m_blockQuery.Clear();
+        for (auto& filterItem_p : *filterItems_p) {
+            if (filterItem_p->m_expression) {
+                /* A compound item may match rows without any of its sub-patterns (NOT), and WITHIN needs the rows
+                 * around, the empty query skips nothing */
+                m_blockQuery.Clear();
+                break;
+            }
+            if (!m_blockQuery.AddAlternative(QString::fromLatin1(filterItem_p->m_start_p, filterItem_p->m_size),
+                                             filterItem_p->m_regexpr)) {
+                break;
+            }
+        }
+
+        AllocExpressionBitmaps(m_startRow, m_endRow);
+
+        /* The profile is of the last filtering, the incremental filtering after it adds to it */
+        for (auto& filterItem_p : *filterItems_p) {
+            memset(&filterItem_p->m_profile, 0, sizeof(FilterItemProfile_t));
+        }
+        AllocProfileCounters();
+
         g_processingCtrl_p->AddProgressInfo(QString("Start filtering"));
         m_timeExec.Restart();
         CFileProcBase::Start(m_qfile_p, workMem_p, workMemSize, m_TIA_p, priority, m_startRow, m_endRow, false);
@@ -358,8 +588,11 @@ void CFilterProcCtrl::SetupIncrementalFiltering(QList<CFilterItem *> *filterItem
     /* Number of filters (which contains filterItems) */
     if (filterItems_p->count() > 0) {
         PackFilters();
+        AllocProfileCounters();
         m_incrementalThreadConfig_p = new CFilterThreadConfiguration();
-        m_incrementalThreadConfig_p->init(nullptr /*FIRA_p*/, m_packedFilterItems_p, m_numOfFilterItems);
+        m_incrementalThreadConfig_p->init(nullptr /*FIRA_p*/, m_packedFilterItems_p, m_numOfFilterItems,
+                                          &m_exprLeaves);
+        m_incrementalThreadConfig_p->m_guardLiterals_p = &m_guardLiterals;
     }
 }
 
@@ -374,7 +607,8 @@ bool CFilterProcCtrl::ExecuteIncrementalFiltering(QFile *qFile_p,
                                                   unsigned startIndex,
                                                   FilterExecTimes_t *execTimes_p,
                                                   int *totalFilterMatches_p,
-                                                  int *totalExcludeFilterMatches_p)
+                                                  int *totalExcludeFilterMatches_p,
+                                                  QList<int> *bookmarkList_p)
 {
     m_TIA_p = TIA_p;
     m_FIRA_p = FIRA_p;
@@ -398,8 +632,15 @@ bool CFilterProcCtrl::ExecuteIncrementalFiltering(QFile *qFile_p,
         return false;
     }
 
+    /* WITHIN only sees the rows added, the rows before were evaluated at the previous filtering */
+    AllocExpressionBitmaps(m_startRow, m_endRow);
+
     auto config_p = m_incrementalThreadConfig_p;
     config_p->m_FIRA_p = FIRA_p;
+    config_p->m_exprBitmaps_p = m_exprBitmaps_p.get();
+    config_p->m_exprWords = m_exprWords;
+    config_p->m_exprFirstRow = m_exprFirstRow;
+    config_p->m_profile_p = m_profileCounters_p.get();
     config_p->m_TIA_p = TIA_p;
     config_p->m_TIA_step = 1;
     config_p->m_start_TIA_index = startIndex;
@@ -410,6 +651,18 @@ bool CFilterProcCtrl::ExecuteIncrementalFiltering(QFile *qFile_p,
     std::atomic_bool dummy = false;
     _filter(config_p, &dummy, 0);
 
+    CombineExpressions(m_startRow, m_endRow);
+    StoreProfiles();
+
+    /* Add the bookmarks among the rows filtered again, as DecorateFIRA does at a full filtering */
+    if (bookmarkList_p != nullptr) {
+        for (auto& row : *bookmarkList_p) {
+            if ((row >= m_startRow) && (row <= m_endRow)) {
+                FIRA_p[row].LUT_index = BOOKMARK_FILTER_LUT_INDEX;
+            }
+        }
+    }
+
     /* Wrap-up, will add new filter matches to the total count */
     NumerateFIRA();
 
@@ -450,24 +703,21 @@ CFilterItem *CFilterProcCtrl::GetFilterMatch(char *text_p, int textLength,
             const bool regExp = m_packedFilterItems_p[filterIndex].filterRef_p->m_regexpr;
             matchDescr.filter_p = packedFilterItem_p->start_p;
 
-            if (regExp) {
-                hs_compile_error_t *compile_err;
+            if (packedFilterItem_p->m_expressionIndex != -1) {
+                const auto& expression = m_expressions[static_cast<size_t>(packedFilterItem_p->m_expressionIndex)];
+                match = expression.MatchRow(text_p, textLength);
+            } else if (regExp) {
                 hs_database_t *database;
                 hs_scratch_t *scratch;
+                QRegularExpression *confirm_p;
 
                 matchDescr.filterLength = packedFilterItem_p->length;
 
-                if (hs_compile(packedFilterItem_p->start_p,
-                               REGEXP_HYPERSCAN_FLAGS,
-                               HS_MODE_BLOCK,
-                               nullptr,
-                               &database,
-                               &compile_err) != HS_SUCCESS) {
-                    TRACEX_I(QString("RegExp failed %1").arg(compile_err->message))
+                if (!RegExpHybrid_Compile(packedFilterItem_p->start_p, REGEXP_HYPERSCAN_FLAGS, &database,
+                                          &confirm_p)) {
                     g_processingCtrl_p->AddProgressInfo(QString("Regular expression contains error: %1")
                                                             .arg(packedFilterItem_p->start_p));
                     g_processingCtrl_p->m_abort = true;
-                    hs_free_compile_error(compile_err);
                 }
 
                 if (hs_alloc_scratch(database, &scratch) != HS_SUCCESS) {
@@ -477,9 +727,11 @@ CFilterItem *CFilterProcCtrl::GetFilterMatch(char *text_p, int textLength,
 
                 matchDescr.regexp_database = database;
                 matchDescr.regexp_scratch = scratch;
+                matchDescr.regexp_confirm_p = confirm_p;
                 match = thread_Match_RegExp_HyperScan(&matchDescr);
                 hs_free_database(database);
                 hs_free_scratch(scratch);
+                delete confirm_p;
             } else if (m_packedFilterItems_p[filterIndex].filterRef_p->m_caseSensitive) {
                 matchDescr.filterLength = packedFilterItem_p->length - 1;
                 match = thread_Match_CS(&matchDescr);
@@ -535,25 +787,22 @@ void CFilterProcCtrl::StartOneLine(TIA_t *TIA_p, FIR_t *FIRA_p, int row, char *t
             const bool regExp = m_packedFilterItems_p[filterIndex].filterRef_p->m_regexpr;
             matchDescr.filter_p = packedFilterItem_p->start_p;
 
-            if (regExp) {
-                hs_compile_error_t *compile_err;
+            if (packedFilterItem_p->m_expressionIndex != -1) {
+                const auto& expression = m_expressions[static_cast<size_t>(packedFilterItem_p->m_expressionIndex)];
+                match = expression.MatchRow(text_p, textLength);
+            } else if (regExp) {
                 hs_database_t *database;
                 hs_scratch_t *scratch;
+                QRegularExpression *confirm_p;
 
                 matchDescr.filterLength = packedFilterItem_p->length;
 
                 TRACEX_I(QString("-pf %1").arg(packedFilterItem_p->start_p))
-                if (hs_compile(packedFilterItem_p->start_p,
-                               REGEXP_HYPERSCAN_FLAGS,
-                               HS_MODE_BLOCK,
-                               nullptr,
-                               &database,
-                               &compile_err) != HS_SUCCESS) {
-                    TRACEX_I(QString("RegExp failed %1").arg(compile_err->message))
+                if (!RegExpHybrid_Compile(packedFilterItem_p->start_p, REGEXP_HYPERSCAN_FLAGS, &database,
+                                          &confirm_p)) {
                     g_processingCtrl_p->AddProgressInfo(QString("Regular expression contains error: %1")
                                                             .arg(packedFilterItem_p->start_p));
                     g_processingCtrl_p->m_abort = true;
-                    hs_free_compile_error(compile_err);
                 }
 
                 if (hs_alloc_scratch(database, &scratch) != HS_SUCCESS) {
@@ -563,9 +812,11 @@ void CFilterProcCtrl::StartOneLine(TIA_t *TIA_p, FIR_t *FIRA_p, int row, char *t
 
                 matchDescr.regexp_database = database;
                 matchDescr.regexp_scratch = scratch;
+                matchDescr.regexp_confirm_p = confirm_p;
                 match = thread_Match_RegExp_HyperScan(&matchDescr);
                 hs_free_database(database);
                 hs_free_scratch(scratch);
+                delete confirm_p;
             } else if (m_packedFilterItems_p[filterIndex].filterRef_p->m_caseSensitive) {
                 matchDescr.filterLength = packedFilterItem_p->length - 1; /* index is compared to filter length...
                                                                            * length is +1 */
@@ -606,8 +857,14 @@ void CFilterProcCtrl::StartOneLine(TIA_t *TIA_p, FIR_t *FIRA_p, int row, char *t
 bool CFilterProcCtrl::ConfigureThread(CThreadConfiguration *config_p, Chunk_Description_t *chunkDescription_p,
                                       int32_t threadIndex)
 {
-    static_cast<CFilterThreadConfiguration *>(config_p)->init(m_FIRA_p, m_packedFilterItems_p,
-                                                              m_numOfFilterItems);
+    auto filterConfig_p = static_cast<CFilterThreadConfiguration *>(config_p);
+
+    filterConfig_p->init(m_FIRA_p, m_packedFilterItems_p, m_numOfFilterItems, &m_exprLeaves);
+    filterConfig_p->m_exprBitmaps_p = m_exprBitmaps_p.get();
+    filterConfig_p->m_exprWords = m_exprWords;
+    filterConfig_p->m_exprFirstRow = m_exprFirstRow;
+    filterConfig_p->m_profile_p = m_profileCounters_p.get();
+    filterConfig_p->m_guardLiterals_p = &m_guardLiterals;
 
     CFileProcBase::ConfigureThread(config_p, chunkDescription_p, threadIndex); /* Use the default initialization */
     return true;
@@ -629,6 +886,9 @@ void CFilterProcCtrl::WrapUp(void)
     if (!g_processingCtrl_p->m_abort) {
         g_processingCtrl_p->AddProgressInfo(QString("Post-process filtering"));
 
+        CombineExpressions(m_startRow, m_endRow);
+        StoreProfiles();
+
         /* Add bookmarks (will be overriden by filter matches) */
         DecorateFIRA();
 
@@ -651,6 +911,9 @@ void CFilterProcCtrl::WrapUp(void)
         VirtualMem::Free(m_packedFilterItems_p);
     }
 
+    m_exprBitmaps_p.reset();
+    m_profileCounters_p.reset();
+
     if (m_execTimes_p != nullptr) {
         m_execTimes_p->totalFilterTime = m_timeExec.ms();
     }
@@ -710,6 +973,11 @@ void CFilterProcCtrl::PackFilters(void)
     int filterIndex = 1;   /* start at 1, since index 0 is nullptr (no filter match) */
     int regExpCount = 0;
 
+    m_expressions.clear();
+    m_exprLeaves.clear();
+    m_exprLeafIndexes.clear();
+    m_guardLiterals.assign(static_cast<size_t>(m_numOfFilterItems), std::vector<QByteArray>());
+
     for (auto& filterItem_p : *m_filterItems_p) {
         memcpy(destMem_p, filterItem_p->m_start_p, static_cast<size_t>(filterItem_p->m_size));
         packedfilterItem_p->filterRef_p = filterItem_p;
@@ -723,9 +991,44 @@ void CFilterProcCtrl::PackFilters(void)
         packedfilterItem_p->m_colClip_End = m_colClip_End;
         packedfilterItem_p->m_adaptiveClipEnabled = filterItem_p->m_adaptiveClipEnabled;
         packedfilterItem_p->m_regExpLUTIndex = -1;
+        packedfilterItem_p->m_expressionIndex = -1;
+
+        if (filterItem_p->m_expression) {
+            CFilterExpression expression;
+            QString error;
+
+            if (expression.Parse(filterItem_p->m_start_p, filterItem_p->m_caseSensitive, &error)) {
+                /* Each sub-pattern is matched once per row, even if used by several expressions */
+                std::vector<int> leafIndexes;
+                for (auto& leaf : expression.GetLeaves()) {
+                    size_t index = 0;
+                    while ((index < m_exprLeaves.size()) &&
+                           ((m_exprLeaves[index].text != leaf.text) || (m_exprLeaves[index].regExp != leaf.regExp) ||
+                            (m_exprLeaves[index].caseSensitive != leaf.caseSensitive))) {
+                        ++index;
+                    }
+                    if (index == m_exprLeaves.size()) {
+                        m_exprLeaves.push_back(leaf);
+                    }
+                    leafIndexes.push_back(static_cast<int>(index));
+                }
 
-        if (filterItem_p->m_regexpr) {
+                packedfilterItem_p->m_expressionIndex = static_cast<int>(m_expressions.size());
+                m_expressions.push_back(expression);
+                m_exprLeafIndexes.push_back(leafIndexes);
+            } else {
+                g_processingCtrl_p->AddProgressInfo(QString("Filter expression contains error: %1, %2")
+                                                        .arg(filterItem_p->m_start_p).arg(error));
+                g_processingCtrl_p->m_abort = true;
+            }
+        } else if (filterItem_p->m_regexpr) {
             packedfilterItem_p->m_regExpLUTIndex = regExpCount++;
+
+            std::vector<QByteArray> literals;
+            if (CSearchIndex::GetRequiredLiterals(QString::fromLatin1(filterItem_p->m_start_p, filterItem_p->m_size),
+                                                  true, literals)) {
+                m_guardLiterals[static_cast<size_t>(packedfilterItem_p - m_packedFilterItems_p)] = literals;
+            }
         }
 
         destMem_p += filterItem_p->m_size;
@@ -770,6 +1073,134 @@ void CFilterProcCtrl::PackFilters(void)
 #endif
 }
 
+/***********************************************************************************************************************
+*   AllocExpressionBitmaps
+*   One bitmap for each expression leaf, covering firstRow..lastRow
+***********************************************************************************************************************/
+void CFilterProcCtrl::AllocExpressionBitmaps(int firstRow, int lastRow)
+{
+    m_exprBitmaps_p.reset();
+    m_exprWords = 0;
+    m_exprFirstRow = firstRow & ~63; /* Word aligned, the leaf bits of a row in the same word in all bitmaps */
+
+    if (m_exprLeaves.empty() || (lastRow < firstRow)) {
+        return;
+    }
+
+    m_exprWords = ((lastRow - m_exprFirstRow) >> 6) + 1;
+
+    const size_t size = m_exprLeaves.size() * static_cast<size_t>(m_exprWords);
+    m_exprBitmaps_p.reset(new std::atomic<uint64_t>[size]);
+    for (size_t index = 0; index < size; ++index) {
+        m_exprBitmaps_p[index].store(0, std::memory_order_relaxed);
+    }
+}
+
+/***********************************************************************************************************************
+*   CombineExpressions
+*   Evaluate the compound filter items on the leaf bitmaps, 64 rows at a time. A row matching an expression gets its
+*   LUT index unless it matched a filter item before it in the list (lower LUT index). In the profile an expression is
+*   evaluated on every row, timed here, the matching of its sub-patterns is not included.
+***********************************************************************************************************************/
+void CFilterProcCtrl::CombineExpressions(int firstRow, int lastRow)
+{
+    if (!m_exprBitmaps_p || (m_packedFilterItems_p == nullptr) || (lastRow < firstRow)) {
+        return;
+    }
+
+    const size_t words = static_cast<size_t>(m_exprWords);
+    std::vector<std::vector<uint64_t>> leafBitmaps(m_exprLeaves.size(), std::vector<uint64_t>(words));
+    std::vector<uint64_t> result(words);
+
+    for (size_t leaf = 0; leaf < m_exprLeaves.size(); ++leaf) {
+        for (size_t index = 0; index < words; ++index) {
+            leafBitmaps[leaf][index] = m_exprBitmaps_p[leaf * words + index].load(std::memory_order_relaxed);
+        }
+    }
+
+    for (int filterIndex = 0; filterIndex < m_numOfFilterItems; ++filterIndex) {
+        const int expressionIndex = m_packedFilterItems_p[filterIndex].m_expressionIndex;
+        if (expressionIndex == -1) {
+            continue;
+        }
+
+        const int64_t start = _profileNow();
+        int64_t matches = 0;
+
+        std::vector<const uint64_t *> expressionLeaves;
+        for (auto leaf : m_exprLeafIndexes[static_cast<size_t>(expressionIndex)]) {
+            expressionLeaves.push_back(leafBitmaps[static_cast<size_t>(leaf)].data());
+        }
+
+        m_expressions[static_cast<size_t>(expressionIndex)].Evaluate(expressionLeaves, firstRow - m_exprFirstRow,
+                                                                     lastRow - m_exprFirstRow, result.data());
+
+        /* Index 0 means none found, hence first filter starts at index +1 */
+        const auto LUT_index = static_cast<uint8_t>(filterIndex + 1);
+
+        for (size_t index = 0; index < words; ++index) {
+            uint64_t bits = result[index];
+            while (bits != 0) {
+                const int bit = static_cast<int>(index * 64) + static_cast<int>(qCountTrailingZeroBits(bits));
+                FIR_t& FIR = m_FIRA_p[m_exprFirstRow + bit];
+
+                if ((FIR.LUT_index == 0) || (FIR.LUT_index > LUT_index)) {
+                    if (m_profileCounters_p && (FIR.LUT_index != 0) && (FIR.LUT_index <= m_numOfFilterItems)) {
+                        /* The row is no longer decided by the later filter item */
+                        m_profileCounters_p[FIR.LUT_index - 1].matches.fetch_sub(1, std::memory_order_relaxed);
+                    }
+                    FIR.LUT_index = LUT_index;
+                    ++matches;
+                }
+                bits &= bits - 1;
+            }
+        }
+
+        if (m_profileCounters_p) {
+            FilterItemProfileCounters_t& counters = m_profileCounters_p[filterIndex];
+            counters.evaluations.fetch_add(lastRow - firstRow + 1, std::memory_order_relaxed);
+            counters.matches.fetch_add(matches, std::memory_order_relaxed);
+            counters.sampledEvaluations.fetch_add(lastRow - firstRow + 1, std::memory_order_relaxed);
+            counters.sampledTime.fetch_add(_profileNow() - start, std::memory_order_relaxed);
+        }
+    }
+}
+
+/***********************************************************************************************************************
+*   AllocProfileCounters
+***********************************************************************************************************************/
+void CFilterProcCtrl::AllocProfileCounters(void)
+{
+    m_profileCounters_p.reset(new FilterItemProfileCounters_t[static_cast<size_t>(m_numOfFilterItems)]);
+    for (int index = 0; index < m_numOfFilterItems; ++index) {
+        m_profileCounters_p[index].evaluations.store(0, std::memory_order_relaxed);
+        m_profileCounters_p[index].matches.store(0, std::memory_order_relaxed);
+        m_profileCounters_p[index].sampledEvaluations.store(0, std::memory_order_relaxed);
+        m_profileCounters_p[index].sampledTime.store(0, std::memory_order_relaxed);
+    }
+}
+
+/***********************************************************************************************************************
+*   StoreProfiles
+*   Add the profile counters to the filter items, and restart them (for the next incremental filtering)
+***********************************************************************************************************************/
+void CFilterProcCtrl::StoreProfiles(void)
+{
+    if (!m_profileCounters_p || (m_packedFilterItems_p == nullptr)) {
+        return;
+    }
+
+    for (int index = 0; index < m_numOfFilterItems; ++index) {
+        FilterItemProfile_t& profile = m_packedFilterItems_p[index].filterRef_p->m_profile;
+        FilterItemProfileCounters_t& counters = m_profileCounters_p[index];
+
+        profile.evaluations += counters.evaluations.exchange(0, std::memory_order_relaxed);
+        profile.matches += counters.matches.exchange(0, std::memory_order_relaxed);
+        profile.sampledEvaluations += counters.sampledEvaluations.exchange(0, std::memory_order_relaxed);
+        profile.sampledTime += counters.sampledTime.exchange(0, std::memory_order_relaxed);
+    }
+}
+
 /***********************************************************************************************************************
 *   DecorateFIRA
 ***********************************************************************************************************************/
@@ -17,8 +17,24 @@
 #include "CFileProcBase.h"
 #include "CTimeMeas.h"
 #include "CFilter.h"
+#include "CFilterExpression.h"
 #include <hs/hs.h>
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#define FILTER_PLAN_SAMPLE_ROWS   256   /* Rows per chunk used to decide if a regular expression is guarded */
+
+/* Per filter item profile counters, shared by the filter threads. Each thread counts locally, and adds its counts
+ * when done with its chunk. */
+typedef struct {
+    std::atomic<int64_t> evaluations;
+    std::atomic<int64_t> matches;
+    std::atomic<int64_t> sampledEvaluations;
+    std::atomic<int64_t> sampledTime;   /* ns */
+} FilterItemProfileCounters_t;
+
 /* This class is used to carry configuration data */
 class CFilterThreadConfiguration : public CThreadConfiguration
 {
@@ -26,7 +42,8 @@ public:
     CFilterThreadConfiguration() : CThreadConfiguration() {}
     virtual ~CFilterThreadConfiguration() override;
 
-    void init(FIR_t *FIRA_p, packedFilterItem_t *packedFilters_p, int numOfFilterItems);
+    void init(FIR_t *FIRA_p, packedFilterItem_t *packedFilters_p, int numOfFilterItems,
+              const std::vector<FilterExprLeaf_t> *exprLeaves_p = nullptr);
 
     /****/
     virtual void PrepareRemove() override {
@@ -34,8 +51,19 @@ public:
             for (int index = 0; index < m_numOfRegExpFilters; index++) {
                 hs_free_database(m_regexp_database_array[index]);
                 hs_free_scratch(m_regexp_scratch_array[index]);
+                delete m_regexp_confirm_array[index];
             }
         }
+        for (size_t index = 0; index < m_exprDatabases.size(); ++index) {
+            if (m_exprDatabases[index] != nullptr) {
+                hs_free_database(m_exprDatabases[index]);
+                hs_free_scratch(m_exprScratches[index]);
+                delete m_exprConfirms[index];
+            }
+        }
+        m_exprDatabases.clear();
+        m_exprScratches.clear();
+        m_exprConfirms.clear();
         CThreadConfiguration::PrepareRemove();
     }
 
@@ -49,6 +77,22 @@ public:
     /* hyperscan regexp engine */
     hs_database_t **m_regexp_database_array = nullptr;
     hs_scratch_t **m_regexp_scratch_array = nullptr;
+    QRegularExpression **m_regexp_confirm_array = nullptr; /* nullptr for the filters Hyperscan matches alone */
+
+    /* Leaves of the compound filter items, each is matched on every row into its bitmap (m_exprWords words from
+     * m_exprBitmaps_p + leaf * m_exprWords, bit 0 is m_exprFirstRow) */
+    const std::vector<FilterExprLeaf_t> *m_exprLeaves_p = nullptr;
+    std::atomic<uint64_t> *m_exprBitmaps_p = nullptr;
+    int m_exprWords = 0;
+    int m_exprFirstRow = 0;
+    std::vector<hs_database_t *> m_exprDatabases; /* nullptr for the text leaves */
+    std::vector<hs_scratch_t *> m_exprScratches;
+    std::vector<QRegularExpression *> m_exprConfirms;
+
+    FilterItemProfileCounters_t *m_profile_p = nullptr; /* One per filter item, nullptr if not profiled */
+
+    /* One per filter item, the literals a row must contain to match the regular expression (empty if none) */
+    const std::vector<std::vector<QByteArray>> *m_guardLiterals_p = nullptr;
 };
 
 /***********************************************************************************************************************
@@ -84,7 +128,12 @@ protected:
 class CFilterProcCtrl : public CFileProcBase
 {
 public:
-    CFilterProcCtrl(void) : m_numOfFilterItems(0) {}
+    CFilterProcCtrl(void) : m_numOfFilterItems(0)
+    {
+        m_numOfThreads = g_cfg_p->GetNumOfThreads(g_cfg_p->m_filterThreads);
+        m_threadTI_Split = true;   /* Each thread filters its own consecutive rows of the chunk */
+        m_numaPlacement = true;
+    }
     virtual ~CFilterProcCtrl(void) override {}
 
 public:
@@ -140,7 +189,8 @@ public:
                                      unsigned startIndex,
                                      FilterExecTimes_t *execTimes_p,
                                      int *totalFilterMatches_p,
-                                     int *totalExcludeFilterMatches_p);
+                                     int *totalExcludeFilterMatches_p,
+                                     QList<int> *bookmarkList_p = nullptr);
 
     CFilterItem *GetFilterMatch(
         char *text_p,
@@ -152,6 +202,10 @@ public:
     void ClearFilterRefs(void);
     void NumerateFIRA(void);
     void DecorateFIRA(void);
+    void AllocExpressionBitmaps(int firstRow, int lastRow);
+    void CombineExpressions(int firstRow, int lastRow);
+    void AllocProfileCounters(void);
+    void StoreProfiles(void);
 
 protected:
     virtual bool ConfigureThread(CThreadConfiguration *config_p,
@@ -195,4 +249,18 @@ private:
     int m_totalExcludeFilterMatches = 0; /* initially contains matches from prevous filtering */
     bool m_incremental = false; /* If the filtering is incremental */
     CFilterThreadConfiguration *m_incrementalThreadConfig_p = nullptr;
+
+    /* Compound filter items, parsed by PackFilters */
+    std::vector<CFilterExpression> m_expressions;
+    std::vector<FilterExprLeaf_t> m_exprLeaves;          /* The leaves of all expressions, each sub-pattern once */
+    std::vector<std::vector<int>> m_exprLeafIndexes;     /* For each expression, its leaves in m_exprLeaves */
+    std::unique_ptr<std::atomic<uint64_t>[]> m_exprBitmaps_p;
+    int m_exprWords = 0;
+    int m_exprFirstRow = 0;
+
+    /* Literal guards of the regular expression filter items, set up by PackFilters */
+    std::vector<std::vector<QByteArray>> m_guardLiterals;
+
+    /* Added to the m_profile of the filter items when the filtering is done */
+    std::unique_ptr<FilterItemProfileCounters_t[]> m_profileCounters_p;
 };
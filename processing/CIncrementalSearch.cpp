@@ -0,0 +1,196 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "CIncrementalSearch.h"
+#include "CSearchCtrl.h"
+#include "CDebug.h"
+
+#include <string.h>
+
+/***********************************************************************************************************************
+*   run
+***********************************************************************************************************************/
+void CIncrementalSearchThread::run()
+{
+    g_RamLog->RegisterThread();
+
+    auto unregisterRamLog = makeMyScopeGuard([&] () {
+        g_RamLog->UnregisterThread();
+    });
+
+    m_owner_p->Run();
+}
+
+/***********************************************************************************************************************
+*   Stop
+***********************************************************************************************************************/
+void CIncrementalSearch::Stop(void)
+{
+    if (m_thread.isRunning()) {
+        m_cancelToken.Cancel();
+        m_thread.wait();
+    }
+}
+
+/***********************************************************************************************************************
+*   Reset
+***********************************************************************************************************************/
+void CIncrementalSearch::Reset(void)
+{
+    Stop();
+    m_results.Clear();
+    m_candidates.clear();
+    m_complete = false;
+    m_searchText.clear();
+    m_logFile.close();
+    m_logFile.ClearSegments();
+}
+
+/***********************************************************************************************************************
+*   isRefinement
+***********************************************************************************************************************/
+bool CIncrementalSearch::isRefinement(const QString& searchText, bool regExp, bool caseSensitive,
+                                      const FIRA_t *FIRA_p) const
+{
+    /* Every row containing the new text also contains the previous text, given that the previous query searched all
+     * rows. Not true for regular expressions. */
+    return m_complete && !regExp && !m_regExp && (caseSensitive == m_caseSensitive) && (FIRA_p == m_FIRA_p) &&
+           !m_searchText.isEmpty() &&
+           searchText.contains(m_searchText, caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+}
+
+/***********************************************************************************************************************
+*   Start
+***********************************************************************************************************************/
+bool CIncrementalSearch::Start(const CLogFile& logFile, TIA_t *TIA_p, FIRA_t *FIRA_p, CFilterItem **filterItem_LUT_p,
+                               const QString& searchText, bool regExp, bool caseSensitive)
+{
+    Stop();
+    m_cancelToken.Reset();
+
+    if (!m_logFile.isOpen() && !m_logFile.OpenCopy(logFile)) {
+        return false;
+    }
+
+    if (!m_workMem_p) {
+        m_workMem_p.reset(new char[INCREMENTAL_SEARCH_WORK_MEM]);
+    }
+
+    const bool refine = isRefinement(searchText, regExp, caseSensitive, FIRA_p);
+
+    m_candidates.clear();
+    if (refine) {
+        const int count = m_results.GetCount();
+        m_candidates.reserve(static_cast<size_t>(count));
+        for (int index = 0; index < count; ++index) {
+            m_candidates.push_back(m_results.Get(index).row);
+        }
+    }
+
+    m_searchText = searchText;
+    m_regExp = regExp;
+    m_caseSensitive = caseSensitive;
+    m_TIA_p = TIA_p;
+    m_FIRA_p = FIRA_p;
+    m_filterItem_LUT_p = filterItem_LUT_p;
+    m_complete = false;
+
+    m_results.Clear(searchText);
+
+    if (searchText.isEmpty() || (TIA_p->rows == 0) || (refine && m_candidates.empty())) {
+        /* Nothing to search, an empty candidate set refines to no match */
+        m_complete = refine;
+        return true;
+    }
+
+    m_results.m_running = true;
+    m_thread.start(QThread::LowPriority);
+    return true;
+}
+
+/***********************************************************************************************************************
+*   Run
+***********************************************************************************************************************/
+void CIncrementalSearch::Run(void)
+{
+    if (!m_candidates.empty()) {
+        SearchCandidates();
+    } else {
+        CSearchCtrl searchCtrl(&m_cancelToken);
+
+        searchCtrl.StartFindAll(&m_logFile, m_workMem_p.get(), INCREMENTAL_SEARCH_WORK_MEM, m_TIA_p, m_FIRA_p,
+                                m_FIRA_p != nullptr ? m_filterItem_LUT_p : nullptr, 0, &m_searchText, 0,
+                                m_TIA_p->rows - 1, m_regExp, m_caseSensitive, &m_results);
+    }
+
+    /* A result that didn't fit in the search results isn't complete either */
+    m_complete = !m_cancelToken.isCancelled() &&
+                 (m_results.GetCount() < SEARCH_RESULTS_BLOCK_SIZE * SEARCH_RESULTS_MAX_BLOCKS);
+    m_results.m_running = false;
+}
+
+/***********************************************************************************************************************
+*   SearchCandidates
+*   The candidate rows are read in blocks, rows close to each other are read with one file read.
+***********************************************************************************************************************/
+void CIncrementalSearch::SearchCandidates(void)
+{
+    const TI_t *TI_p = m_TIA_p->textItemArray_p;
+    const QByteArray searchText = m_searchText.toLatin1();
+    const size_t count = m_candidates.size();
+    char *workMem_p = m_workMem_p.get();
+    std::vector<SearchHit_t> hits;
+    Match_Description_t matchDescr;
+
+    memset(&matchDescr, 0, sizeof(Match_Description_t));
+    matchDescr.filter_p = searchText.constData();
+    matchDescr.filterLength = searchText.size() - 1; /* the home made search compares length to index */
+
+    size_t index = 0;
+    while ((index < count) && !m_cancelToken.isCancelled()) {
+        const int64_t blockStart = TI_p[m_candidates[index]].fileIndex;
+        int64_t blockEnd = blockStart + TI_p[m_candidates[index]].size;
+        size_t last = index;
+
+        while (last + 1 < count) {
+            const TI_t& next = TI_p[m_candidates[last + 1]];
+            if ((next.fileIndex - blockEnd > INCREMENTAL_SEARCH_MAX_GAP) ||
+                (next.fileIndex + next.size - blockStart > INCREMENTAL_SEARCH_WORK_MEM)) {
+                break;
+            }
+            blockEnd = next.fileIndex + next.size;
+            ++last;
+        }
+
+        if (blockEnd - blockStart > INCREMENTAL_SEARCH_WORK_MEM) {
+            blockEnd = blockStart + INCREMENTAL_SEARCH_WORK_MEM; /* a single very long row, clipped */
+        }
+
+        const int64_t blockSize = blockEnd - blockStart;
+        if (!m_logFile.seek(blockStart) || (m_logFile.read(workMem_p, blockSize) != blockSize)) {
+            TRACEX_W("CIncrementalSearch::SearchCandidates  Failed to read log file")
+            m_cancelToken.Cancel();
+            break;
+        }
+
+        hits.clear();
+        for (; index <= last; ++index) {
+            const int row = m_candidates[index];
+            const int64_t end = TI_p[row].fileIndex + TI_p[row].size;
+
+            matchDescr.text_p = workMem_p + (TI_p[row].fileIndex - blockStart);
+            matchDescr.textLength = static_cast<int>((end < blockEnd ? end : blockEnd) - TI_p[row].fileIndex) - 1;
+
+            if ((matchDescr.textLength > 0) &&
+                (m_caseSensitive ? thread_Match_CS(&matchDescr) : thread_Match(&matchDescr))) {
+                hits.push_back(SearchHit_t{row, matchDescr.matchOffset, matchDescr.matchLength});
+            }
+        }
+
+        if (!m_results.Append(hits.data(), static_cast<int>(hits.size()))) {
+            break;
+        }
+    }
+}
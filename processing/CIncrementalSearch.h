@@ -0,0 +1,92 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include "CFilter.h"
+#include "CFileProcBase.h"
+#include "CSearchResults.h"
+#include "CLogFile.h"
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include <QString>
+#include <QThread>
+
+#define INCREMENTAL_SEARCH_WORK_MEM   (16 * 1024 * 1024)  /* Work memory of the background search */
+#define INCREMENTAL_SEARCH_MAX_GAP    (64 * 1024)         /* Candidate rows further apart are read separately */
+
+class CIncrementalSearch;
+
+/***********************************************************************************************************************
+*   CIncrementalSearchThread
+***********************************************************************************************************************/
+class CIncrementalSearchThread : public QThread
+{
+public:
+    explicit CIncrementalSearchThread(CIncrementalSearch *owner_p) : m_owner_p(owner_p) {}
+
+    void run() override;
+
+private:
+    CIncrementalSearch *m_owner_p;
+};
+
+/***********************************************************************************************************************
+*   CIncrementalSearch
+*
+*   Search-as-you-type. Each query runs as a background find-all search, with its own log file handle and work memory,
+*   and is cancelled through its CCancelToken when the next query is started. If the new query text contains the text
+*   of the previous, completed, query only the rows matching the previous query are searched (the candidate set).
+*   The GUI picks the match count and the hit to present from GetResults while the query is running.
+***********************************************************************************************************************/
+class CIncrementalSearch
+{
+public:
+    CIncrementalSearch(void) : m_thread(this) {}
+    ~CIncrementalSearch(void) {Stop();}
+
+    /* Cancel the query in progress and start a new one. TIA (and FIRA if only filtered rows) must stay unchanged
+     * until Stop or Reset is called. */
+    bool Start(const CLogFile& logFile, TIA_t *TIA_p, FIRA_t *FIRA_p, CFilterItem **filterItem_LUT_p,
+               const QString& searchText, bool regExp, bool caseSensitive);
+
+    /* Cancel the query in progress and wait for the thread, the result found so far is kept */
+    void Stop(void);
+
+    /* Stop, and drop the result and the log file handle. Called when the log, or the filtering, is changed */
+    void Reset(void);
+
+    /****/
+    const CSearchResults& GetResults(void) const {return m_results;}
+
+    /****/
+    bool isRunning(void) const {return m_thread.isRunning();}
+
+    /* Run in the background thread */
+    void Run(void);
+
+private:
+    bool isRefinement(const QString& searchText, bool regExp, bool caseSensitive, const FIRA_t *FIRA_p) const;
+    void SearchCandidates(void);
+
+    CIncrementalSearchThread m_thread;
+    CCancelToken m_cancelToken;
+    CLogFile m_logFile;      /* Separate handle, the document's log file is used by the GUI thread */
+    std::unique_ptr<char[]> m_workMem_p;
+    CSearchResults m_results;
+    std::vector<int> m_candidates;   /* Rows to search when refining, from the previous query */
+
+    /* The query */
+    QString m_searchText;
+    bool m_regExp = false;
+    bool m_caseSensitive = false;
+    TIA_t *m_TIA_p = nullptr;
+    FIRA_t *m_FIRA_p = nullptr;
+    CFilterItem **m_filterItem_LUT_p = nullptr;
+    bool m_complete = false;  /* Set when the query searched all rows, its result may then be refined */
+};
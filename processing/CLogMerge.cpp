@@ -0,0 +1,438 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "CLogMerge.h"
+#include "CDebug.h"
+#include "CProgressCtrl.h"
+#include "CMemAccounting.h"
+
+#include <QFile>
+
+#include <algorithm>
+#include <atomic>
+#include <queue>
+
+/****/
+static inline bool IsDigit(char c)
+{
+    return (c >= '0') && (c <= '9');
+}
+
+/****/
+static inline int Digits(const char *text_p, int count)
+{
+    int value = 0;
+    for (int index = 0; index < count; ++index) {
+        value = value * 10 + (text_p[index] - '0');
+    }
+    return value;
+}
+
+/***********************************************************************************************************************
+*   DaysFromCivil
+*   Number of days since 1970-01-01 (proleptic Gregorian calendar)
+***********************************************************************************************************************/
+static int64_t DaysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2 ? 1 : 0;
+
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const int64_t yearOfEra = year - era * 400;
+    const int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+    return era * 146097 + dayOfEra - 719468;
+}
+
+/***********************************************************************************************************************
+*   DateBefore
+*   Day number of a date ending at text_p[end - 1], 0 if there is no date. Logs without year use 1970.
+***********************************************************************************************************************/
+static int64_t DateBefore(const char *text_p, int end)
+{
+    static const char *months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    auto isSeparator = [](char c) {return (c == '-') || (c == '/');};
+
+    /* YYYY-MM-DD */
+    if (end >= 10) {
+        const char *p = text_p + end - 10;
+        if (IsDigit(p[0]) && IsDigit(p[1]) && IsDigit(p[2]) && IsDigit(p[3]) && isSeparator(p[4]) &&
+            IsDigit(p[5]) && IsDigit(p[6]) && isSeparator(p[7]) && IsDigit(p[8]) && IsDigit(p[9])) {
+            return DaysFromCivil(Digits(p, 4), Digits(p + 5, 2), Digits(p + 8, 2));
+        }
+    }
+
+    /* MM-DD, e.g. logcat */
+    if (end >= 5) {
+        const char *p = text_p + end - 5;
+        if (IsDigit(p[0]) && IsDigit(p[1]) && isSeparator(p[2]) && IsDigit(p[3]) && IsDigit(p[4])) {
+            return DaysFromCivil(1970, Digits(p, 2), Digits(p + 3, 2));
+        }
+    }
+
+    /* Mon DD, or Mon  D, e.g. syslog */
+    if (end >= 6) {
+        const char *p = text_p + end - 6;
+        if ((p[3] == ' ') && (IsDigit(p[4]) || (p[4] == ' ')) && IsDigit(p[5])) {
+            for (int month = 0; month < 12; ++month) {
+                if ((p[0] == months[month][0]) && (p[1] == months[month][1]) && (p[2] == months[month][2])) {
+                    return DaysFromCivil(1970, month + 1, p[4] == ' ' ? Digits(p + 5, 1) : Digits(p + 4, 2));
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+/***********************************************************************************************************************
+*   LogMerge_ExtractTime
+***********************************************************************************************************************/
+bool LogMerge_ExtractTime(const char *text_p, int length, int64_t *time_p)
+{
+    const int scan = length < LOG_MERGE_TIME_MAX_SCAN ? length : LOG_MERGE_TIME_MAX_SCAN;
+    const char *end_p = text_p + length;
+
+    /* Time of day, H:MM:SS or HH:MM:SS */
+    for (int index = 0; index + 7 <= scan; ++index) {
+        const char *p = text_p + index;
+        int hourDigits = 0;
+
+        if ((index > 0) && IsDigit(p[-1])) {
+            continue;
+        }
+        if (IsDigit(p[0]) && IsDigit(p[1]) && (p[2] == ':')) {
+            hourDigits = 2;
+        } else if (IsDigit(p[0]) && (p[1] == ':')) {
+            hourDigits = 1;
+        } else {
+            continue;
+        }
+
+        const char *minute_p = p + hourDigits + 1;
+        if ((minute_p + 5 > end_p) || !IsDigit(minute_p[0]) || !IsDigit(minute_p[1]) || (minute_p[2] != ':') ||
+            !IsDigit(minute_p[3]) || !IsDigit(minute_p[4])) {
+            continue;
+        }
+
+        int64_t time = (static_cast<int64_t>(Digits(p, hourDigits)) * 3600 + Digits(minute_p, 2) * 60 +
+                        Digits(minute_p + 3, 2)) * 1000000;
+
+        /* Fraction, e.g. .123 or ,123456 */
+        const char *fraction_p = minute_p + 5;
+        if ((fraction_p + 1 < end_p) && ((*fraction_p == '.') || (*fraction_p == ',')) && IsDigit(fraction_p[1])) {
+            int64_t scale = 100000;
+            for (++fraction_p; fraction_p < end_p && IsDigit(*fraction_p); ++fraction_p) {
+                time += (*fraction_p - '0') * scale;
+                scale /= 10;
+            }
+        }
+
+        /* Date in front, separated by a space or a T (ISO 8601) */
+        if ((index > 0) && ((p[-1] == ' ') || (p[-1] == 'T'))) {
+            time += DateBefore(text_p, index - 1) * 86400LL * 1000000LL;
+        }
+
+        *time_p = time;
+        return true;
+    }
+
+    /* Leading number of seconds, e.g. "[  123.456789]" */
+    int index = 0;
+    while ((index < scan) && ((text_p[index] == ' ') || (text_p[index] == '['))) {
+        ++index;
+    }
+
+    int64_t seconds = 0;
+    int start = index;
+    while ((index < scan) && IsDigit(text_p[index]) && (index - start < 12)) {
+        seconds = seconds * 10 + (text_p[index++] - '0');
+    }
+
+    if ((index == start) || (index + 1 >= length) || (text_p[index] != '.') || !IsDigit(text_p[index + 1])) {
+        return false;
+    }
+
+    int64_t time = seconds * 1000000;
+    int64_t scale = 100000;
+    for (++index; index < length && IsDigit(text_p[index]); ++index) {
+        time += (text_p[index] - '0') * scale;
+        scale /= 10;
+    }
+
+    *time_p = time;
+    return true;
+}
+
+/***********************************************************************************************************************
+*   RunParallel
+***********************************************************************************************************************/
+void CLogMerge::RunParallel(int numOfThreads, int numOfItems, const std::function<void(int)>& work)
+{
+    std::atomic_int next(0);
+    QList<CLogMergeThread *> threadList;
+
+    numOfThreads = numOfThreads < numOfItems ? numOfThreads : numOfItems;
+
+    for (int index = 0; index < numOfThreads; ++index) {
+        auto thread_p = new CLogMergeThread([&] () {
+            g_RamLog->RegisterThread();
+            for (int item = next.fetch_add(1); item < numOfItems; item = next.fetch_add(1)) {
+                work(item);
+            }
+            g_RamLog->UnregisterThread();
+        });
+        threadList.append(thread_p);
+        thread_p->start();
+    }
+
+    for (auto& thread_p : threadList) {
+        thread_p->wait();
+        delete thread_p;
+    }
+}
+
+/***********************************************************************************************************************
+*   CreatePartitions
+***********************************************************************************************************************/
+void CLogMerge::CreatePartitions(const std::vector<LogMergeSource_t>& sources, int numOfPartitions)
+{
+    const int SAMPLES_PER_SOURCE = 256;
+    std::vector<int64_t> samples;
+
+    /* Pivots are picked from evenly spaced samples of all sources, such that the partitions gets about the same number
+     * of rows */
+    for (auto& source : sources) {
+        const int step = source.rows / SAMPLES_PER_SOURCE + 1;
+        for (int row = 0; row < source.rows; row += step) {
+            samples.push_back(source.time_p[row]);
+        }
+    }
+
+    std::sort(samples.begin(), samples.end());
+    samples.erase(std::unique(samples.begin(), samples.end()), samples.end());
+
+    std::vector<int64_t> pivots;
+    for (int index = 1; index < numOfPartitions && !samples.empty(); ++index) {
+        const int64_t pivot = samples[samples.size() * static_cast<size_t>(index) / static_cast<size_t>(numOfPartitions)];
+        if (pivots.empty() || (pivot > pivots.back())) {
+            pivots.push_back(pivot);
+        }
+    }
+
+    ClearPartitions();
+    m_partitions.resize(pivots.size() + 1);
+
+    for (size_t index = 0; index < m_partitions.size(); ++index) {
+        Partition_t& partition = m_partitions[index];
+        for (auto& source : sources) {
+            const int64_t *begin_p = source.time_p;
+            const int64_t *end_p = source.time_p + source.rows;
+            partition.start.push_back(index == 0 ? 0 :
+                                      static_cast<int>(std::lower_bound(begin_p, end_p, pivots[index - 1]) - begin_p));
+            partition.end.push_back(index == pivots.size() ? source.rows :
+                                    static_cast<int>(std::lower_bound(begin_p, end_p, pivots[index]) - begin_p));
+        }
+        partition.bytes = 0;
+        partition.success = false;
+    }
+}
+
+/***********************************************************************************************************************
+*   MergePartition
+***********************************************************************************************************************/
+void CLogMerge::MergePartition(const std::vector<LogMergeSource_t>& sources, const Partition_t& partition,
+                               const std::function<void(int, int)>& emit)
+{
+    typedef std::pair<int64_t, int> HeapEntry_t; /* time, source */
+
+    auto after = [](const HeapEntry_t& a, const HeapEntry_t& b) {
+        return (a.first > b.first) || ((a.first == b.first) && (a.second > b.second));
+    };
+    std::priority_queue<HeapEntry_t, std::vector<HeapEntry_t>, decltype(after)> heap(after);
+    std::vector<int> next(partition.start);
+
+    for (int source = 0; source < static_cast<int>(sources.size()); ++source) {
+        if (next[source] < partition.end[source]) {
+            heap.push(HeapEntry_t(sources[source].time_p[next[source]], source));
+        }
+    }
+
+    while (!heap.empty()) {
+        const int source = heap.top().second;
+        const int64_t *time_p = sources[source].time_p;
+        const int end = partition.end[source];
+        int& row = next[source];
+        heap.pop();
+
+        /* Keep taking rows from the same source as long as they are first, typically there are long such runs */
+        do {
+            emit(source, row);
+            ++row;
+        } while ((row < end) &&
+                 (heap.empty() || !after(HeapEntry_t(time_p[row], source), heap.top())));
+
+        if (row < end) {
+            heap.push(HeapEntry_t(time_p[row], source));
+        }
+    }
+}
+
+/***********************************************************************************************************************
+*   WritePartition
+***********************************************************************************************************************/
+bool CLogMerge::WritePartition(const std::vector<LogMergeSource_t>& sources, Partition_t& partition,
+                               const QString& TIA_fileName, int64_t TIA_offset)
+{
+    QFile TIA_File(TIA_fileName);
+
+    if (!TIA_File.open(QIODevice::ReadWrite) ||
+        !TIA_File.seek(TIA_offset + partition.outRow * static_cast<int64_t>(sizeof(TI_t)))) {
+        TRACEX_QFILE(LOG_LEVEL_ERROR, "Failed to open TIA file for merge, file locked?", &TIA_File)
+        return false;
+    }
+
+    std::vector<TI_t> block;
+    block.reserve(LOG_MERGE_TI_WRITE_BLOCK);
+
+    int64_t offset = partition.outOffset;
+    bool success = true;
+
+    auto flush = [&] () {
+        const int64_t bytesToWrite = static_cast<int64_t>(block.size() * sizeof(TI_t));
+        if (TIA_File.write(reinterpret_cast<const char *>(block.data()), bytesToWrite) != bytesToWrite) {
+            TRACEX_QFILE(LOG_LEVEL_ERROR, "Failed to save merged TIA data", &TIA_File)
+            success = false;
+        }
+        block.clear();
+    };
+
+    MergePartition(sources, partition, [&] (int sourceIndex, int row) {
+        const LogMergeSource_t& source = sources[static_cast<size_t>(sourceIndex)];
+        const int64_t start = source.TI_p[row].fileIndex;
+        const int64_t end = row + 1 < source.rows ? source.TI_p[row + 1].fileIndex : source.fileSize;
+
+        block.push_back(TI_t{offset, source.TI_p[row].size});
+        offset += end - start;
+
+        if (end == start) {
+            /* Empty last row, without LF */
+        } else if (!partition.runs.empty() && (partition.runs.back().source == sourceIndex) &&
+                   (partition.runs.back().fileOffset + partition.runs.back().size == start)) {
+            partition.runs.back().size += end - start;
+        } else {
+            partition.runs.push_back(Run_t{sourceIndex, start, end - start});
+        }
+
+        if ((row + 1 == source.rows) && !source.endsWithLF) {
+            partition.runs.push_back(Run_t{-1, 0, 1});
+            ++offset;
+        }
+
+        if (block.size() == LOG_MERGE_TI_WRITE_BLOCK) {
+            flush();
+        }
+    });
+
+    flush();
+    TIA_File.close();
+
+    /* The runs are kept until taken */
+    MemAcc_Add(MEM_ACC_MERGE_e, static_cast<int64_t>(partition.runs.capacity() * sizeof(Run_t)));
+    return success && !g_processingCtrl_p->m_abort;
+}
+
+/***********************************************************************************************************************
+*   Merge
+***********************************************************************************************************************/
+bool CLogMerge::Merge(const std::vector<LogMergeSource_t>& sources, int numOfThreads, const QString& TIA_fileName,
+                      int64_t TIA_offset)
+{
+    ClearPartitions();
+    m_rows = 0;
+
+    if (sources.empty()) {
+        return false;
+    }
+
+    CreatePartitions(sources, numOfThreads * 4 /* some extra for balancing */);
+
+    const int numOfPartitions = static_cast<int>(m_partitions.size());
+
+    /* 1. Merge once to find out the size of each partition, in rows and bytes */
+    RunParallel(numOfThreads, numOfPartitions, [&] (int index) {
+        Partition_t& partition = m_partitions[static_cast<size_t>(index)];
+        MergePartition(sources, partition, [&] (int sourceIndex, int row) {
+            const LogMergeSource_t& source = sources[static_cast<size_t>(sourceIndex)];
+            const int64_t end = row + 1 < source.rows ? source.TI_p[row + 1].fileIndex : source.fileSize;
+            partition.bytes += end - source.TI_p[row].fileIndex;
+            if ((row + 1 == source.rows) && !source.endsWithLF) {
+                ++partition.bytes;
+            }
+        });
+    });
+
+    if (g_processingCtrl_p->m_abort) {
+        return false;
+    }
+
+    int64_t outRow = 0;
+    int64_t outOffset = 0;
+    for (auto& partition : m_partitions) {
+        partition.outRow = outRow;
+        partition.outOffset = outOffset;
+        for (size_t source = 0; source < sources.size(); ++source) {
+            outRow += partition.end[source] - partition.start[source];
+        }
+        outOffset += partition.bytes;
+    }
+
+    /* 2. Merge again, now writing the TIs at their final place in the TIA file */
+    RunParallel(numOfThreads, numOfPartitions, [&] (int index) {
+        Partition_t& partition = m_partitions[static_cast<size_t>(index)];
+        partition.success = WritePartition(sources, partition, TIA_fileName, TIA_offset);
+    });
+
+    size_t numOfRuns = 0;
+    for (auto& partition : m_partitions) {
+        if (!partition.success) {
+            ClearPartitions();
+            return false;
+        }
+        numOfRuns += partition.runs.size();
+    }
+
+    m_rows = static_cast<int>(outRow);
+
+    TRACEX_I(QString("Merged %1 logs, rows:%2 runs:%3 partitions:%4")
+                 .arg(sources.size()).arg(m_rows).arg(numOfRuns).arg(numOfPartitions))
+    return true;
+}
+
+/***********************************************************************************************************************
+*   TakeRuns
+***********************************************************************************************************************/
+void CLogMerge::TakeRuns(const std::function<void(const Run_t&)>& take)
+{
+    for (auto& partition : m_partitions) {
+        for (auto& run : partition.runs) {
+            take(run);
+        }
+        MemAcc_Add(MEM_ACC_MERGE_e, -static_cast<int64_t>(partition.runs.capacity() * sizeof(Run_t)));
+        std::vector<Run_t>().swap(partition.runs);
+    }
+    m_partitions.clear();
+}
+
+/***********************************************************************************************************************
+*   ClearPartitions
+***********************************************************************************************************************/
+void CLogMerge::ClearPartitions(void)
+{
+    for (auto& partition : m_partitions) {
+        MemAcc_Add(MEM_ACC_MERGE_e, -static_cast<int64_t>(partition.runs.capacity() * sizeof(Run_t)));
+    }
+    m_partitions.clear();
+}
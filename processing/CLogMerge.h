@@ -0,0 +1,104 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include "CFilter.h"
+
+#include <stdint.h>
+#include <vector>
+#include <functional>
+
+#include <QString>
+#include <QThread>
+
+#define LOG_MERGE_TIME_NONE        INT64_MIN
+#define LOG_MERGE_TIME_MAX_SCAN    64         /* Number of bytes from the row start searched for a timestamp */
+#define LOG_MERGE_TI_WRITE_BLOCK   (64 * 1024) /* Number of merged TIs buffered before written to the TIA file */
+
+/* Built-in timestamp parser, looks for a time of day (H:MM:SS or HH:MM:SS, with optional fraction) close to the row
+ * start, and a date just in front of it (YYYY-MM-DD, MM-DD or Mon DD). As fallback a leading (bracketed) number of
+ * seconds, e.g. the kernel log "[  123.456789]". Returns the time in microseconds. */
+bool LogMerge_ExtractTime(const char *text_p, int length, int64_t *time_p);
+
+/* One log file to merge. The times are one per row and non-decreasing, rows without a time have been given the time of
+ * the row before (at indexing) */
+typedef struct {
+    const TI_t *TI_p;       /* fileIndex is relative to the file start */
+    const int64_t *time_p;
+    int rows;
+    int64_t fileSize;
+    bool endsWithLF;        /* If false, a LF separator is added after the last row */
+} LogMergeSource_t;
+
+/***********************************************************************************************************************
+*   CLogMergeThread
+***********************************************************************************************************************/
+class CLogMergeThread : public QThread
+{
+public:
+    explicit CLogMergeThread(std::function<void(void)> work) : m_work(std::move(work)) {}
+
+    void run() override {m_work();}
+
+private:
+    std::function<void(void)> m_work;
+};
+
+/***********************************************************************************************************************
+*   CLogMerge
+*
+*   K-way merge, by timestamp, of the rows of several log files. The result is a TIA for the merged log and the runs
+*   (consecutive bytes from one source file) that make up the merged virtual byte space, no text is copied. The sources
+*   aren't used once merged, they may be freed before the runs are taken.
+*
+*   The merged rows are split into partitions by timestamp pivots. Since the times are non-decreasing per source each
+*   partition is a range of rows in each source, and the partitions are merged in parallel. Rows with equal times are
+*   taken from the source with lowest index first (the oldest file), and the rows from one source are never reordered.
+***********************************************************************************************************************/
+class CLogMerge
+{
+public:
+    typedef struct {
+        int source;          /* -1 for a LF separator */
+        int64_t fileOffset;
+        int64_t size;
+    } Run_t;
+
+    CLogMerge(void) = default;
+    ~CLogMerge(void) {ClearPartitions();}
+
+    /* Write the merged TIA, starting at TIA_offset in TIA_fileName (i.e. after the header) */
+    bool Merge(const std::vector<LogMergeSource_t>& sources, int numOfThreads, const QString& TIA_fileName,
+               int64_t TIA_offset);
+
+    /* Hand over the runs, in virtual offset order, the memory of each partition is released when handed over */
+    void TakeRuns(const std::function<void(const Run_t&)>& take);
+    int GetRows(void) const {return m_rows;}
+
+    /* Run work(index) for index 0 .. numOfItems - 1, spread on numOfThreads threads */
+    static void RunParallel(int numOfThreads, int numOfItems, const std::function<void(int)>& work);
+
+private:
+    typedef struct {
+        std::vector<int> start;   /* Per source, the first row in the partition */
+        std::vector<int> end;     /* Per source, the row after the last row in the partition */
+        int64_t outRow;           /* The first merged row */
+        int64_t outOffset;        /* Virtual offset of the first merged row */
+        int64_t bytes;
+        std::vector<Run_t> runs;
+        bool success;
+    } Partition_t;
+
+    void CreatePartitions(const std::vector<LogMergeSource_t>& sources, int numOfPartitions);
+    void ClearPartitions(void);
+    static void MergePartition(const std::vector<LogMergeSource_t>& sources, const Partition_t& partition,
+                               const std::function<void(int, int)>& emit);
+    bool WritePartition(const std::vector<LogMergeSource_t>& sources, Partition_t& partition,
+                        const QString& TIA_fileName, int64_t TIA_offset);
+
+    std::vector<Partition_t> m_partitions;
+    int m_rows = 0;
+};
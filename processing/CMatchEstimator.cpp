@@ -0,0 +1,256 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "CMatchEstimator.h"
+#include "CRegExpHybrid.h"
+#include "CDebug.h"
+
+#include <string.h>
+#include <math.h>
+#include <random>
+
+#include <QElapsedTimer>
+#include <QHash>
+
+/***********************************************************************************************************************
+*   MatchEstimate_ToString
+***********************************************************************************************************************/
+QString MatchEstimate_ToString(const MatchEstimate_t& estimate)
+{
+    if (!estimate.valid) {
+        return QString("Invalid regular expression");
+    }
+
+    if (estimate.sampled == 0) {
+        return estimate.running ? QString("Estimating...") : QString();
+    }
+
+    if (estimate.exact) {
+        return QString("%1 matches").arg(estimate.estimate);
+    }
+
+    return QString("~%1 matches (%2 - %3)%4").arg(estimate.estimate).arg(estimate.low).arg(estimate.high)
+               .arg(estimate.running ? "..." : "");
+}
+
+/***********************************************************************************************************************
+*   run
+***********************************************************************************************************************/
+void CMatchEstimatorThread::run()
+{
+    g_RamLog->RegisterThread();
+
+    auto unregisterRamLog = makeMyScopeGuard([&] () {
+        g_RamLog->UnregisterThread();
+    });
+
+    m_owner_p->Run();
+}
+
+/***********************************************************************************************************************
+*   Stop
+***********************************************************************************************************************/
+void CMatchEstimator::Stop(void)
+{
+    if (m_thread.isRunning()) {
+        m_cancelToken.Cancel();
+        m_thread.wait();
+    }
+}
+
+/***********************************************************************************************************************
+*   Reset
+***********************************************************************************************************************/
+void CMatchEstimator::Reset(void)
+{
+    Stop();
+    m_text.clear();
+    m_sampled = 0;
+    m_hits = 0;
+    m_exact = false;
+    m_valid = true;
+    m_logFile.close();
+    m_logFile.ClearSegments();
+}
+
+/***********************************************************************************************************************
+*   Start
+***********************************************************************************************************************/
+bool CMatchEstimator::Start(const CLogFile& logFile, TIA_t *TIA_p, const QString& text, bool regExp,
+                            bool caseSensitive)
+{
+    Stop();
+    m_cancelToken.Reset();
+
+    if (!m_logFile.isOpen() && !m_logFile.OpenCopy(logFile)) {
+        return false;
+    }
+
+    if (!m_workMem_p) {
+        m_workMem_p.reset(new char[MATCH_ESTIMATE_MAX_ROW]);
+    }
+
+    m_text = text;
+    m_regExp = regExp;
+    m_caseSensitive = caseSensitive;
+    m_TIA_p = TIA_p;
+    m_sampled = 0;
+    m_hits = 0;
+    m_exact = false;
+    m_valid = true;
+
+    if (text.isEmpty() || (TIA_p->rows == 0)) {
+        return true;
+    }
+
+    m_thread.start(QThread::LowPriority);
+    return true;
+}
+
+/***********************************************************************************************************************
+*   GetEstimate
+*   The interval is the Wilson score interval of the sampled hit ratio, scaled to the number of rows. Since the strata
+*   are equally sized, and equally sampled, the plain interval is a (slightly) conservative one for the stratified
+*   sample.
+***********************************************************************************************************************/
+MatchEstimate_t CMatchEstimator::GetEstimate(void) const
+{
+    MatchEstimate_t estimate;
+    const int64_t hits = m_hits;
+    const int64_t sampled = m_sampled; /* read after the hits, never less than the hits then */
+    const double rows = m_TIA_p != nullptr ? static_cast<double>(m_TIA_p->rows) : 0.0;
+
+    memset(&estimate, 0, sizeof(MatchEstimate_t));
+    estimate.sampled = sampled;
+    estimate.exact = m_exact;
+    estimate.running = m_thread.isRunning();
+    estimate.valid = m_valid;
+
+    if (sampled == 0) {
+        return estimate;
+    }
+
+    if (estimate.exact) {
+        estimate.estimate = estimate.low = estimate.high = hits;
+        return estimate;
+    }
+
+    const double n = static_cast<double>(sampled);
+    const double p = static_cast<double>(hits) / n;
+    const double z2 = MATCH_ESTIMATE_Z * MATCH_ESTIMATE_Z;
+    const double denominator = 1.0 + z2 / n;
+    const double center = (p + z2 / (2.0 * n)) / denominator;
+    const double halfWidth = MATCH_ESTIMATE_Z * sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n)) / denominator;
+
+    estimate.estimate = llround(p * rows);
+    estimate.low = llround((center - halfWidth > 0.0 ? center - halfWidth : 0.0) * rows);
+    estimate.high = llround((center + halfWidth < 1.0 ? center + halfWidth : 1.0) * rows);
+    return estimate;
+}
+
+/***********************************************************************************************************************
+*   Sample
+*   Read one row and match it, returns false if the row couldn't be read
+***********************************************************************************************************************/
+bool CMatchEstimator::Sample(int row, Match_Description_t *matchDescr_p)
+{
+    const TI_t& TI = m_TIA_p->textItemArray_p[row];
+    const int size = TI.size < MATCH_ESTIMATE_MAX_ROW ? TI.size : MATCH_ESTIMATE_MAX_ROW;
+
+    if (!m_logFile.seek(TI.fileIndex) || (m_logFile.read(m_workMem_p.get(), size) != size)) {
+        TRACEX_W("CMatchEstimator::Sample  Failed to read log file")
+        return false;
+    }
+
+    /* The home made search relies on that size is one less than it should... */
+    matchDescr_p->text_p = m_workMem_p.get();
+    matchDescr_p->textLength = size - (m_regExp ? 0 : 1);
+
+    bool match = false;
+    if (matchDescr_p->textLength > 0) {
+        if (m_regExp) {
+            match = thread_Match_RegExp_HyperScan(matchDescr_p);
+        } else if (m_caseSensitive) {
+            match = thread_Match_CS(matchDescr_p);
+        } else {
+            match = thread_Match(matchDescr_p);
+        }
+    }
+
+    ++m_sampled; /* before the hits, GetEstimate reads them in the opposite order */
+    if (match) {
+        ++m_hits;
+    }
+    return true;
+}
+
+/***********************************************************************************************************************
+*   Run
+*   Logs with few rows are matched row by row, giving the exact count. Otherwise, each round samples one random row
+*   (with replacement) from each stratum, in file order, until the time budget is spent or the maximum number of
+*   samples is reached.
+***********************************************************************************************************************/
+void CMatchEstimator::Run(void)
+{
+    const QByteArray text = m_text.toLatin1();
+    const int rows = m_TIA_p->rows;
+    Match_Description_t matchDescr;
+    hs_database_t *regexp_database = nullptr;
+    hs_scratch_t *regexp_scratch = nullptr;
+    QRegularExpression *regexp_confirm_p = nullptr;
+    auto freeRegExp = makeMyScopeGuard([&] () {
+        if (regexp_scratch != nullptr) {
+            hs_free_scratch(regexp_scratch);
+        }
+        if (regexp_database != nullptr) {
+            hs_free_database(regexp_database);
+        }
+        delete regexp_confirm_p;
+    });
+    QElapsedTimer timer;
+
+    timer.start();
+
+    memset(&matchDescr, 0, sizeof(Match_Description_t));
+    matchDescr.filter_p = text.constData();
+    matchDescr.filterLength = text.size() - 1; /* the home made search compares length to index */
+
+    if (m_regExp) {
+        if (!RegExpHybrid_Compile(text.constData(), REGEXP_HYPERSCAN_FLAGS, &regexp_database, &regexp_confirm_p) ||
+            (hs_alloc_scratch(regexp_database, &regexp_scratch) != HS_SUCCESS)) {
+            m_valid = false;
+            return;
+        }
+        matchDescr.regexp_database = regexp_database;
+        matchDescr.regexp_scratch = regexp_scratch;
+        matchDescr.regexp_confirm_p = regexp_confirm_p;
+    }
+
+    if (rows <= MATCH_ESTIMATE_MAX_SAMPLES) {
+        for (int row = 0; row < rows && !m_cancelToken.isCancelled(); ++row) {
+            if (!Sample(row, &matchDescr)) {
+                return;
+            }
+        }
+        m_exact = !m_cancelToken.isCancelled();
+        return;
+    }
+
+    /* The same text gives the same estimate */
+    std::mt19937 generator(static_cast<uint32_t>(qHash(text)));
+
+    while (!m_cancelToken.isCancelled() && (m_sampled < MATCH_ESTIMATE_MAX_SAMPLES) &&
+           (timer.elapsed() < MATCH_ESTIMATE_TIME_BUDGET)) {
+        for (int stratum = 0; stratum < MATCH_ESTIMATE_STRATA && !m_cancelToken.isCancelled(); ++stratum) {
+            const int first = static_cast<int>(static_cast<int64_t>(rows) * stratum / MATCH_ESTIMATE_STRATA);
+            const int last = static_cast<int>(static_cast<int64_t>(rows) * (stratum + 1) / MATCH_ESTIMATE_STRATA) - 1;
+            std::uniform_int_distribution<int> distribution(first, last);
+
+            if (!Sample(distribution(generator), &matchDescr)) {
+                return;
+            }
+        }
+    }
+}
@@ -0,0 +1,106 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include "CFilter.h"
+#include "CFileProcBase.h"
+#include "CLogFile.h"
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+
+#include <QString>
+#include <QThread>
+
+#define MATCH_ESTIMATE_TIME_BUDGET   100           /* ms, the sampling stops after this time */
+#define MATCH_ESTIMATE_STRATA        256           /* The rows are split in this many equally sized strata */
+#define MATCH_ESTIMATE_MAX_SAMPLES   (64 * 1024)   /* Logs with fewer rows are counted exactly instead */
+#define MATCH_ESTIMATE_MAX_ROW       (64 * 1024)   /* Longer rows are clipped when sampled */
+#define MATCH_ESTIMATE_Z             1.96          /* 95% confidence interval */
+
+/* An estimated number of matching rows, with its confidence interval [low, high] */
+typedef struct {
+    int64_t estimate;
+    int64_t low;
+    int64_t high;
+    int64_t sampled;   /* Number of rows sampled, 0 if there is no estimate yet */
+    bool exact;        /* All rows were sampled, the estimate is the match count */
+    bool running;
+    bool valid;        /* False if e.g. the regular expression didn't compile */
+} MatchEstimate_t;
+
+/* The estimate as presented in the GUI, e.g. "~1200 matches (1050 - 1370)" */
+QString MatchEstimate_ToString(const MatchEstimate_t& estimate);
+
+class CMatchEstimator;
+
+/***********************************************************************************************************************
+*   CMatchEstimatorThread
+***********************************************************************************************************************/
+class CMatchEstimatorThread : public QThread
+{
+public:
+    explicit CMatchEstimatorThread(CMatchEstimator *owner_p) : m_owner_p(owner_p) {}
+
+    void run() override;
+
+private:
+    CMatchEstimator *m_owner_p;
+};
+
+/***********************************************************************************************************************
+*   CMatchEstimator
+*
+*   Estimates how many rows a filter item, or a search, matches without processing the whole log. The rows are split
+*   into strata of consecutive rows, and in each round one random row of every stratum is read (through the TIA) and
+*   matched with the same matchers as the filtering. The sampling runs in the background, with its own log file
+*   handle, until the time budget is spent. The GUI polls GetEstimate, which gets more accurate while sampling.
+***********************************************************************************************************************/
+class CMatchEstimator
+{
+public:
+    CMatchEstimator(void) : m_thread(this) {}
+    ~CMatchEstimator(void) {Stop();}
+
+    /* Cancel the estimate in progress and start a new one. The TIA must stay unchanged until Stop or Reset is
+     * called. */
+    bool Start(const CLogFile& logFile, TIA_t *TIA_p, const QString& text, bool regExp, bool caseSensitive);
+
+    /* Cancel the estimate in progress and wait for the thread */
+    void Stop(void);
+
+    /* Stop, and drop the estimate and the log file handle. Called when the log is changed */
+    void Reset(void);
+
+    MatchEstimate_t GetEstimate(void) const;
+
+    /****/
+    const QString& GetText(void) const {return m_text;}
+
+    /* Run in the background thread */
+    void Run(void);
+
+private:
+    bool Sample(int row, Match_Description_t *matchDescr_p);
+
+    CMatchEstimatorThread m_thread;
+    CCancelToken m_cancelToken;
+    CLogFile m_logFile;      /* Separate handle, the document's log file is used by the GUI thread */
+    std::unique_ptr<char[]> m_workMem_p;
+
+    /* The query */
+    QString m_text;
+    bool m_regExp = false;
+    bool m_caseSensitive = false;
+    TIA_t *m_TIA_p = nullptr;
+
+    /* Written by the background thread, read by GetEstimate */
+    std::atomic<int64_t> m_sampled {0};
+    std::atomic<int64_t> m_hits {0};
+    std::atomic<bool> m_exact {false};
+    std::atomic<bool> m_valid {true};
+};
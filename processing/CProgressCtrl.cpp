@@ -50,12 +50,43 @@ void CProgressMgr::InitProgressCounter(void)
     if (m_disabled)
       return;
 
-    for (int index = 0; index < MAX_NUM_OF_THREADS; ++index) {
+    QMutexLocker Lock(&m_mutex); /* RAII */
+    for (int index = 0; index < m_progressCounter.Count(); ++index) {
         m_progressCounter[index] = 0.0;
     }
     m_timer.start();
 }
 
+/***********************************************************************************************************************
+*   SetNumOfProgressCounters
+***********************************************************************************************************************/
+void CProgressMgr::SetNumOfProgressCounters(int numOfProgressCounters)
+{
+    QMutexLocker Lock(&m_mutex); /* RAII */
+    m_progressCounter.Grow(numOfProgressCounters);
+    m_numOfProgressCounters = numOfProgressCounters;
+}
+
+/***********************************************************************************************************************
+*   GetProgress
+***********************************************************************************************************************/
+double CProgressMgr::GetProgress(void)
+{
+    QMutexLocker Lock(&m_mutex); /* RAII */
+
+    if (m_numOfProgressCounters <= 0) {
+        return 0.0;
+    }
+
+    double progress = 1.0;   /* Keeps the smallest progress value */
+    for (int index = 0; index < m_numOfProgressCounters; ++index) {
+        if (m_progressCounter[index] < progress) {
+            progress = m_progressCounter[index];
+        }
+    }
+    return progress;
+}
+
 /***********************************************************************************************************************
 *   Processing_StartReport
 ***********************************************************************************************************************/
@@ -7,6 +7,7 @@
 
 #include <QMutex>
 #include "CConfig.h"
+#include "CPerThreadArray.h"
 
 #include <stdint.h>
 #include <QElapsedTimer>
@@ -35,6 +36,7 @@ public:
     CProgressMgr(void)
     {
         m_processingLevel = 0;
+        m_progressCounter.Resize(1); /* StepProgressCounter falls back to the first counter */
         g_processingCtrl_p = this;
     }
     virtual ~CProgressMgr(void);
@@ -43,11 +45,8 @@ public:
      *  counter until reaching * 1.0 */
     void SetupProgessCounter(double countStep) {m_progressStep = countStep;}
 
-    /****/
-    void GetProgressCounter(double **progressCounters_pp, int *count_p) {
-        *progressCounters_pp = &m_progressCounter[0];
-        *count_p = m_numOfProgressCounters;
-    }
+    /* The least progress of the counters, 0.0 - 1.0 */
+    double GetProgress(void);
 
     void SetDisabled(bool disabled = true) { m_disabled = disabled; }
     void Processing_StartReport(void);
@@ -56,7 +55,7 @@ public:
     void AddProgressInfo(const QString& info);
     bool GetProgressInfo(QString& info);  /* Returns true if there are more strings to fetch */
     void InitProgressCounter(void);
-    void SetNumOfProgressCounters(int numOfProgressCounters) {m_numOfProgressCounters = numOfProgressCounters;}
+    void SetNumOfProgressCounters(int numOfProgressCounters); /* While the counters aren't stepped */
     void SetProgressCounter(double value); /* To align the * progress * this could * be used to * "jump" * forward */
     void StepProgressCounter(int counterIndex = 0);
     void SetSuccess(void) {m_success = 1; SetProgressCounter(1.0);}
@@ -79,7 +78,9 @@ private:
     int m_numOfProgressCounters = 0;
     QBasicMutex m_mutex;
     double m_progressStep = 0; /* Each call to StepProgress will increase m_progressCounter with this value */
-    double m_progressCounter[MAX_NUM_OF_THREADS];  /* Keeping count of the current progress..  1.0 means done */
+    /* Keeping count of the current progress..  1.0 means done. One per thread, stepped by the threads. Resized only
+     * with m_mutex taken, GetProgress reads them from the GUI thread */
+    CPerThreadArray<double> m_progressCounter;
     QList<QString> m_progressInfo;
     QElapsedTimer m_timer;
 };
@@ -120,27 +120,7 @@ void CProgressDlg::OnTimer()
 void CProgressDlg::UpdateProgressInfo(void)
 {
     if ((g_processingCtrl_p != nullptr) && m_visible) {
-        double *progressCounters_p;
-        int numOfProgressCounters;
-        double progress;
-
-        g_processingCtrl_p->GetProgressCounter(&progressCounters_p, &numOfProgressCounters);
-
-        if (numOfProgressCounters > 1) {
-            const int COUNT = numOfProgressCounters;
-
-            progress = 1.0;                   /* Keeps the smallest progress value */
-
-            for (int index = 0; index < COUNT; ++index) {
-                if (progressCounters_p[index] < progress) {
-                    progress = progressCounters_p[index];
-                }
-            }
-        } else if (numOfProgressCounters == 1) {
-            progress = progressCounters_p[0];
-        } else {
-            progress = 0.0;
-        }
+        const double progress = g_processingCtrl_p->GetProgress();
 
         m_progressBar_p->setValue(static_cast<int>(progress * 100.0));
 
@@ -338,6 +318,10 @@ uint32_t CProgressThread::Progress_ThreadMain()
         case ProgressCmd_TestProgress_en:
             TestProgress();
             break;
+
+        case ProgressCmd_FindAll_en:
+            doc_p->ExecuteFindAll();
+            break;
     }
 
     if (!m_threadCfg_p->gui_sem_p->available()) {
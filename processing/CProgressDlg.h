@@ -29,7 +29,8 @@ typedef enum {
     ProgressCmd_Filter_en,
     ProgressCmd_LoadLog_en,
     ProgressCmd_Plot_en,
-    ProgressCmd_TestProgress_en
+    ProgressCmd_TestProgress_en,
+    ProgressCmd_FindAll_en
 }ProgressCmd_t;
 
 class CProgressThread;
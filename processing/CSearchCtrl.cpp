@@ -7,6 +7,22 @@
 #include "CSearchCtrl.h"
 
 #include <hs/hs.h>
+#include <algorithm>
+#include <limits.h>
+
+/***********************************************************************************************************************
+*   UpdateHitRow
+*   Make row the hit row if it is earlier (in search direction) than the hit row set by any other thread
+***********************************************************************************************************************/
+static inline void UpdateHitRow(std::atomic_int *hitRow_p, int row, bool backward)
+{
+    int current = hitRow_p->load(std::memory_order_relaxed);
+    while (backward ? (row > current) : (row < current)) {
+        if (hitRow_p->compare_exchange_weak(current, row, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+}
 
 #ifdef TEST_HS
 
@@ -69,14 +85,6 @@ void test(void)
 CSearchThreadConfiguration::~CSearchThreadConfiguration(void)
 {}
 
-/***********************************************************************************************************************
-*   FileIndex_To_MemRef
-***********************************************************************************************************************/
-inline char *FileIndex_To_MemRef(int64_t *fileIndex_p, int64_t *workMemFileIndex_p, char *WorkMem_p)
-{
-    return (WorkMem_p + (*fileIndex_p - *workMemFileIndex_p));
-}
-
 /***********************************************************************************************************************
 *   thread_Process
 ***********************************************************************************************************************/
@@ -103,7 +111,6 @@ void CSearchThread::thread_Process(CThreadConfiguration *config_p)
 #endif
 
     m_isStopped = false;
-    *searchConfig_p->m_TIA_Index_p = -1; /* invalid value, hence shall not be used for wrap-up */
 
     /* filter length is compared to index */
     matchDescr.filterLength = static_cast<int>(strlen(searchConfig_p->m_searchText) - 1);
@@ -111,10 +118,15 @@ void CSearchThread::thread_Process(CThreadConfiguration *config_p)
 
     const bool regExp = searchConfig_p->m_regExp;
     const bool CS = searchConfig_p->m_caseSensitive;
+    const bool findAll = searchConfig_p->m_findAll;
+    std::atomic_int *hitRow_p = searchConfig_p->m_hitRow_p;
+    const bool reportProgress = searchConfig_p->m_cancelToken_p == nullptr; /* Background search doesn't report */
 
     if (searchConfig_p->m_regExp) {
         matchDescr.regexp_database = searchConfig_p->m_regexp_database;
         matchDescr.regexp_scratch = searchConfig_p->m_regexp_scratch;
+        matchDescr.regexp_som = searchConfig_p->m_regexp_som;
+        matchDescr.regexp_confirm_p = searchConfig_p->m_regexp_confirm_p;
         matchDescr.threadIndex = m_threadIndex;
     }
 
@@ -139,36 +151,44 @@ void CSearchThread::thread_Process(CThreadConfiguration *config_p)
                 ((LUT_Index != 0) && !filterItem_LUT_p[LUT_Index]->m_exclude)) {
                 /* The home made search relies on that size is one less than it should... */
                 matchDescr.textLength = TIA_p->textItemArray_p[TIA_Index].size - (regExp ? 0 : 1);
-                matchDescr.text_p = FileIndex_To_MemRef(&TIA_p->textItemArray_p[TIA_Index].fileIndex,
-                                                        &searchConfig_p->m_chunkDescr.fileIndex,
-                                                        searchConfig_p->m_workMem_p);
+                matchDescr.text_p = Chunk_TextRef(&searchConfig_p->m_chunkDescr, searchConfig_p->m_workMem_p,
+                                                  TIA_p->textItemArray_p[TIA_Index].fileIndex);
 
                 --progressCount;
                 if (progressCount == 0) {
-                    g_processingCtrl_p->StepProgressCounter(m_threadIndex);
+                    if (reportProgress) {
+                        g_processingCtrl_p->StepProgressCounter(m_threadIndex);
+                    }
                     progressCount = PROGRESS_COUNTER_STEP;
                 }
 
-                if (matchDescr.textLength > 0) {
+                if ((matchDescr.textLength > 0) && (matchDescr.text_p != nullptr)) {
+                    bool match;
                     if (regExp) {
-                        if (thread_Match_RegExp_HyperScan(&matchDescr)) {
-                            *searchConfig_p->m_searchStop_p = true;  /* signal that there is a search match */
-                            stopLoop = true;
-                        }
+                        match = thread_Match_RegExp_HyperScan(&matchDescr);
                     } else if (CS) {
-                        if (thread_Match_CS(&matchDescr)) {
-                            *searchConfig_p->m_searchStop_p = true; /* signal that there is a search match */
-                            stopLoop = true;
-                        }
+                        match = thread_Match_CS(&matchDescr);
                     } else {
-                        if (thread_Match(&matchDescr)) {
+                        match = thread_Match(&matchDescr);
+                    }
+
+                    if (match) {
+                        if (findAll) {
+                            searchConfig_p->m_hits.push_back(SearchHit_t{TIA_Index, matchDescr.matchOffset,
+                                                                       matchDescr.matchLength});
+                        } else {
+                            UpdateHitRow(hitRow_p, TIA_Index, false);
                             *searchConfig_p->m_searchStop_p = true; /* signal that there is a search match */
                             stopLoop = true;
                         }
                     }
                 }
             }
-            if (!*searchConfig_p->m_searchStop_p && !g_processingCtrl_p->m_abort) {
+
+            /* Continue until passing the earliest hit found by any thread, rows before it must still be searched
+             * since they could contain an earlier match */
+            if (!searchConfig_p->isCancelled() &&
+                (TIA_Index + TIA_step < hitRow_p->load(std::memory_order_relaxed))) {
                 TIA_Index += TIA_step;
             } else {
                 stopLoop = true;
@@ -180,7 +200,9 @@ void CSearchThread::thread_Process(CThreadConfiguration *config_p)
         while (TIA_Index >= stop_TIA_Index && !stopLoop) {
             --progressCount;
             if (progressCount == 0) {
-                g_processingCtrl_p->StepProgressCounter(m_threadIndex);
+                if (reportProgress) {
+                    g_processingCtrl_p->StepProgressCounter(m_threadIndex);
+                }
                 progressCount = PROGRESS_COUNTER_STEP;
             }
 
@@ -189,43 +211,36 @@ void CSearchThread::thread_Process(CThreadConfiguration *config_p)
                 ((LUT_Index != 0) && !filterItem_LUT_p[LUT_Index]->m_exclude)) {
                 /* The home made search relies on that size is one less than it should... */
                 matchDescr.textLength = TIA_p->textItemArray_p[TIA_Index].size - (regExp ? 0 : 1);
-                matchDescr.text_p = FileIndex_To_MemRef(&TIA_p->textItemArray_p[TIA_Index].fileIndex,
-                                                        &config_p->m_chunkDescr.fileIndex, config_p->m_workMem_p);
+                matchDescr.text_p = Chunk_TextRef(&config_p->m_chunkDescr, config_p->m_workMem_p,
+                                                  TIA_p->textItemArray_p[TIA_Index].fileIndex);
 
-                if (matchDescr.textLength > 0) {
+                if ((matchDescr.textLength > 0) && (matchDescr.text_p != nullptr)) {
+                    bool match;
                     if (regExp) {
-                        if (thread_Match_RegExp_HyperScan(&matchDescr)) {
-                            *searchConfig_p->m_searchStop_p = true;  /* signal that there is a search match */
-                            stopLoop = true;
-                        }
+                        match = thread_Match_RegExp_HyperScan(&matchDescr);
                     } else if (CS) {
-                        if (thread_Match_CS(&matchDescr)) {
-                            *searchConfig_p->m_searchStop_p = true; /* signal that there is a search match */
-                            stopLoop = true;
-                        }
+                        match = thread_Match_CS(&matchDescr);
                     } else {
-                        if (thread_Match(&matchDescr)) {
-                            *searchConfig_p->m_searchStop_p = true; /* signal that there is a search match */
-                            stopLoop = true;
-                        }
+                        match = thread_Match(&matchDescr);
+                    }
+
+                    if (match) {
+                        UpdateHitRow(hitRow_p, TIA_Index, true);
+                        *searchConfig_p->m_searchStop_p = true; /* signal that there is a search match */
+                        stopLoop = true;
                     }
                 }
             }
 
-            if (!*searchConfig_p->m_searchStop_p && !g_processingCtrl_p->m_abort) {
-                if (TIA_Index != stop_TIA_Index) {
-                    TIA_Index -= TIA_step;
-                } else {
-                    stopLoop = true;
-                }
+            if (!stopLoop && !searchConfig_p->isCancelled() && (TIA_Index != stop_TIA_Index) &&
+                (TIA_Index - TIA_step > hitRow_p->load(std::memory_order_relaxed))) {
+                TIA_Index -= TIA_step;
             } else {
                 stopLoop = true;
             }
         } /* while search */
     } /* else upward */
 
-    *searchConfig_p->m_TIA_Index_p = TIA_Index;
-
     (void)thread_ProcessingDone();
 }
 
@@ -252,10 +267,94 @@ void CSearchCtrl::StartProcessing(QFile *qFile_p, char *workMem_p, int64_t workM
     m_caseSensitive = caseSensitive;
     m_FIRA_p = FIRA_p;
     m_filterItem_LUT_p = filterItem_LUT_p;
+    m_hitRow = backward ? -1 : INT_MAX;
+    m_windowRows = SEARCH_FIRST_WINDOW_ROWS;
+
+    m_blockQuery.Clear();
+    (void)m_blockQuery.AddAlternative(*searchText_p, regExp);
 
     CFileProcBase::Start(qFile_p, workMem_p, workMemSize, TIA_p, priority, startRow, endRow, backward);
 }
 
+/***********************************************************************************************************************
+*   StartFindAll
+***********************************************************************************************************************/
+void CSearchCtrl::StartFindAll(QFile *qFile_p, char *workMem_p, int64_t workMemSize, TIA_t *TIA_p, FIRA_t *FIRA_p,
+                               CFilterItem **filterItem_LUT_p, int priority, QString *searchText_p, int startRow,
+                               int endRow, bool regExp, bool caseSensitive, CSearchResults *results_p)
+{
+    TRACEX_I("Find all started  text:%s regExp:%d startRow:%d endRow:%d  %s",
+             searchText_p->toLatin1().constData(), regExp ? 1 : 0, startRow, endRow,
+             FIRA_p == nullptr ? "Full search" : "Filtered search")
+
+    ReportProgressInfo(QString("Starting find all"));
+
+    m_findAll = true;
+    m_results_p = results_p;
+    m_hitRow = INT_MAX;
+    m_searchText_p = searchText_p;
+    m_regExp = regExp;
+    m_caseSensitive = caseSensitive;
+    m_FIRA_p = FIRA_p;
+    m_filterItem_LUT_p = filterItem_LUT_p;
+
+    m_blockQuery.Clear();
+    (void)m_blockQuery.AddAlternative(*searchText_p, regExp);
+
+    CFileProcBase::Start(qFile_p, workMem_p, workMemSize, TIA_p, priority, startRow, endRow, false);
+}
+
+/***********************************************************************************************************************
+*   SearchRowRanges
+***********************************************************************************************************************/
+bool CSearchCtrl::SearchRowRanges(QFile *qFile_p, char *workMem_p, int64_t workMemSize, TIA_t *TIA_p, FIRA_t *FIRA_p,
+                                  CFilterItem **filterItem_LUT_p, int priority, QString *searchText_p,
+                                  const std::vector<std::pair<int, int>>& ranges, bool backward, bool regExp,
+                                  bool caseSensitive)
+{
+    m_searchSuccess = false;
+    m_searchResult_TI = 0;
+
+    if (ranges.empty()) {
+        g_processingCtrl_p->SetFail();
+        g_processingCtrl_p->AddProgressInfo(QString("Search complete, FAIL  No match"));
+        return false;
+    }
+
+    /* The ranges are ordered in the search direction, the rows from the first to the last range are searched */
+    const int startRow = backward ? ranges.front().second : ranges.front().first;
+    const int endRow = backward ? ranges.back().first : ranges.back().second;
+    int64_t numOfCandidates = 0;
+
+    for (auto& range : ranges) {
+        numOfCandidates += range.second - range.first + 1;
+    }
+
+    g_processingCtrl_p->AddProgressInfo(QString("Searching %1 row ranges, %2 rows").arg(ranges.size())
+                                            .arg(numOfCandidates));
+
+    /* The candidate rows are loaded sparse, only the ranges are read from the log. If the candidates are most of the
+     * rows they wouldn't be loaded sparse anyway, then all rows are searched */
+    m_candidateRows.clear();
+    if (numOfCandidates * SPARSE_LOAD_ROW_RATIO <= std::abs(endRow - startRow) + 1) {
+        m_candidateRows.reserve(static_cast<size_t>(numOfCandidates));
+        for (size_t index = 0; index < ranges.size(); ++index) {
+            const auto& range = ranges[backward ? ranges.size() - 1 - index : index]; /* Ascending rows */
+            for (int row = range.first; row <= range.second; ++row) {
+                m_candidateRows.push_back(packed_FIR_t {row, 0});
+            }
+        }
+        SetSparseRows(m_candidateRows.data(), static_cast<int>(m_candidateRows.size()));
+    }
+
+    StartProcessing(qFile_p, workMem_p, workMemSize, TIA_p, FIRA_p, filterItem_LUT_p, priority, searchText_p,
+                    startRow, endRow, backward, regExp, caseSensitive);
+
+    SetSparseRows(nullptr, 0);
+    m_candidateRows.clear();
+    return m_searchSuccess;
+}
+
 /***********************************************************************************************************************
 *   ConfigureThread
 ***********************************************************************************************************************/
@@ -275,16 +374,9 @@ bool CSearchCtrl::ConfigureThread(CThreadConfiguration *config_p, Chunk_Descript
     searchConfig_p->m_caseSensitive = m_caseSensitive;
     searchConfig_p->m_FIRA_p = m_FIRA_p;
     searchConfig_p->m_filterItem_LUT_p = m_filterItem_LUT_p;
-
-    if (threadIndex == 0) {
-        /* Clear the result array each time the processing restart for a new chunk */
-        for (int index = 0; index < g_cfg_p->m_numOfThreads; ++index) {
-            m_threadStopRow[index] = -1;
-        }
-    }
-
-    /* Setup where the search thread should put its search result, used at wrapup */
-    searchConfig_p->m_TIA_Index_p = &m_threadStopRow[threadIndex];
+    searchConfig_p->m_findAll = m_findAll;
+    searchConfig_p->m_hits.clear();
+    searchConfig_p->m_hitRow_p = &m_hitRow;
 
     /* Setup NumOf_TIs */
     if (threadIndex < m_linesExtra) {
@@ -315,17 +407,28 @@ bool CSearchCtrl::ConfigureThread(CThreadConfiguration *config_p, Chunk_Descript
 
     if (m_regExp && (nullptr == searchConfig_p->m_regexp_database)) {
         hs_compile_error_t *compile_err;
-        if (hs_compile(searchConfig_p->m_searchText,
-                       REGEXP_HYPERSCAN_FLAGS,
-                       HS_MODE_BLOCK,
-                       nullptr,
-                       &searchConfig_p->m_regexp_database,
-                       &compile_err) != HS_SUCCESS) {
-            TRACEX_I(QString("RegExp failed %1").arg(compile_err->message))
-            g_processingCtrl_p->AddProgressInfo(QString("Regular expression contains error: %1")
-                                                    .arg(searchConfig_p->m_searchText));
-            g_processingCtrl_p->m_abort = true;
-            hs_free_compile_error(compile_err);
+
+        /* Find-all presents where in the row the match is, start of match mode is used if the pattern supports it */
+        searchConfig_p->m_regexp_som = false;
+        if (m_findAll) {
+            if (hs_compile(searchConfig_p->m_searchText, REGEXP_HYPERSCAN_SOM_FLAGS, HS_MODE_BLOCK, nullptr,
+                           &searchConfig_p->m_regexp_database, &compile_err) == HS_SUCCESS) {
+                searchConfig_p->m_regexp_som = true;
+            } else {
+                hs_free_compile_error(compile_err);
+                searchConfig_p->m_regexp_database = nullptr;
+            }
+        }
+
+        /* Patterns not supported by Hyperscan are prefiltered by it and confirmed with PCRE */
+        if (!searchConfig_p->m_regexp_som &&
+            !RegExpHybrid_Compile(searchConfig_p->m_searchText, REGEXP_HYPERSCAN_FLAGS,
+                                  &searchConfig_p->m_regexp_database, &searchConfig_p->m_regexp_confirm_p)) {
+            if (!isBackground()) {
+                g_processingCtrl_p->AddProgressInfo(QString("Regular expression contains error: %1")
+                                                        .arg(searchConfig_p->m_searchText));
+                g_processingCtrl_p->m_abort = true;
+            }
             return false;
         }
 
@@ -352,6 +455,29 @@ CThreadConfiguration *CSearchCtrl::CreateConfigurationObject(void)
 ***********************************************************************************************************************/
 bool CSearchCtrl::isProcessingDone(void)
 {
+    if (m_findAll) {
+        /* Called after each chunk. The threads have interleaved rows, so their matches are merged into row order
+         * before added to the result, where they are immediately available for presentation. */
+        m_chunkHits.clear();
+        for (auto& config : m_configurationPoolList) {
+            auto searchConfig_p = static_cast<CSearchThreadConfiguration *>(config);
+            m_chunkHits.insert(m_chunkHits.end(), searchConfig_p->m_hits.begin(), searchConfig_p->m_hits.end());
+            searchConfig_p->m_hits.clear();
+        }
+
+        std::sort(m_chunkHits.begin(), m_chunkHits.end(), [] (const SearchHit_t& a, const SearchHit_t& b) {
+            return a.row < b.row;
+        });
+
+        if (!m_results_p->Append(m_chunkHits.data(), static_cast<int>(m_chunkHits.size()))) {
+            ReportProgressInfo(QString("  Too many matches, find all stopped"));
+            return true;
+        }
+
+        ReportProgressInfo(QString("  Matches: %1").arg(m_results_p->GetCount()));
+        return false;
+    }
+
     if (m_searchStop) {
         return true;
     } else {
@@ -364,173 +490,42 @@ bool CSearchCtrl::isProcessingDone(void)
 ***********************************************************************************************************************/
 void CSearchCtrl::WrapUp(void)
 {
-    int low_TI_Index = -1;
-    int high_TI_Index = -1;
-    FIR_t *FIR_Array_p = nullptr;
-
-    if (m_FIRA_p != nullptr) {
-        FIR_Array_p = &m_FIRA_p->FIR_Array_p[0];
-    }
-
-    char searchText[CFG_TEMP_STRING_MAX_SIZE];
-
-    SAFE_STR_MEMCPY(searchText, CFG_TEMP_STRING_MAX_SIZE, m_searchText_p->toLatin1().constData(),
-                    static_cast<size_t>(m_searchText_p->size()))
-
     m_searchResult_TI = 0;
     m_searchSuccess = false;
 
-    if (g_processingCtrl_p->m_abort) {
+    if (isCancelled()) {
         m_searchSuccess = false;
-        g_processingCtrl_p->SetFail();
-        g_processingCtrl_p->AddProgressInfo(QString("Search aborted by user"));
+        if (!isBackground()) {
+            g_processingCtrl_p->SetFail();
+            g_processingCtrl_p->AddProgressInfo(QString("Search aborted by user"));
+        }
         return;
     }
 
-    /* Hard to say if all threads manage to process all their lines, one thread might have been quicker and
-     * the match is actually not the last one */
-
-    TRACEX_D("CSearchCtrl::WrapUp")
-
-    /*Sweep from thread with lowest TI until the one with the highest, pick the earliest */
-
-    if (m_searchStop) {
-        g_processingCtrl_p->AddProgressInfo(QString("  Search hit, aligning threads"));
-
-        /* Get the low / high limits by comparing the results from each thread */
-        for (int index = 0; index < m_numberOfChunkThreads; ++index) {
-            if (m_threadStopRow[index] != -1) {
-                if (low_TI_Index == -1) {
-                    low_TI_Index = m_threadStopRow[index];
-                    high_TI_Index = m_threadStopRow[index];
-                }
-                if (low_TI_Index > m_threadStopRow[index]) {
-                    low_TI_Index = m_threadStopRow[index];
-                }
-                if (high_TI_Index < m_threadStopRow[index]) {
-                    high_TI_Index = m_threadStopRow[index];
-                }
-            }
+    if (m_findAll) {
+        m_searchSuccess = m_results_p->GetCount() > 0;
+        if (m_searchSuccess) {
+            m_searchResult_TI = m_results_p->Get(0).row;
         }
-
-        TRACEX_D("CSearchCtrl::WrapUp found:%d low:%d high:%d total:%d",
-                 m_searchStop, low_TI_Index, high_TI_Index, m_TIA_p->rows)
-
-        if (low_TI_Index == high_TI_Index) {
-            m_searchSuccess = true;
-            m_searchResult_TI = high_TI_Index;
-            g_processingCtrl_p->SetSuccess();
-            g_processingCtrl_p->AddProgressInfo(QString("Search complete, SUCCESS   Line:%1").arg(m_searchResult_TI));
-            return;
-        } else {
-            Match_Description_t matchDescr;
-            bool match = false;
-
-            memset(&matchDescr, 0, sizeof(Match_Description_t));
-
-            matchDescr.filterLength = static_cast<int>(strlen(searchText) - 1);
-            matchDescr.filter_p = searchText;
-
-            if (m_regExp) {
-                CSearchThreadConfiguration *configuration = nullptr;
-
-                for (auto& config : m_configurationList) {
-                    auto searchConfig = static_cast<CSearchThreadConfiguration *>(config);
-                    if (searchConfig->m_regexp_database != nullptr && searchConfig->m_regexp_scratch != nullptr) {
-                        configuration = searchConfig;
-                        break;
-                    }
-                }
-
-                if (configuration == nullptr) {
-                    for (auto& config : m_configurationPoolList) {
-                        auto searchConfig = static_cast<CSearchThreadConfiguration *>(config);
-                        if (searchConfig->m_regexp_database != nullptr && searchConfig->m_regexp_scratch != nullptr) {
-                            configuration = searchConfig;
-                            break;
-                        }
-                    }
-                }
-
-                if (configuration == nullptr) {
-                    TRACEX_E("CSearchCtrl::WrapUp missing regular expression configuration")
-                    g_processingCtrl_p->SetFail();
-                    g_processingCtrl_p->AddProgressInfo(QString("Search failed, regular expression state missing"));
-                    return;
-                }
-
-                matchDescr.regexp_database = configuration->m_regexp_database;
-                matchDescr.regexp_scratch = configuration->m_regexp_scratch;
-            }
-
-            /* Sweep between the low - high row index to see if there is any earlier match in the lowest index
-             * (search forward), or in the highest region when searching backwards. */
-
-            /* SEARCH FORWARD */
-
-            if (!m_backward) {
-                for (int TIA_Index = low_TI_Index; TIA_Index <= high_TI_Index && !(match); ++TIA_Index) {
-                    const auto LUT_Index = FIR_Array_p == nullptr ? 0 : FIR_Array_p[TIA_Index].LUT_index;
-                    if ((FIR_Array_p == nullptr) ||
-                        ((LUT_Index != 0) && !m_filterItem_LUT_p[LUT_Index]->m_exclude)) {
-                        /* The home made search relies on that size is one less than it should... */
-                        matchDescr.textLength = m_TIA_p->textItemArray_p[TIA_Index].size - (m_regExp ? 0 : 1);
-                        matchDescr.text_p = FileIndex_To_MemRef(&m_TIA_p->textItemArray_p[TIA_Index].fileIndex,
-                                                                &m_chunkDescr.fileIndex, m_workMem_p);
-
-                        if (m_regExp) {
-                            match = thread_Match_RegExp_HyperScan(&matchDescr);
-                        } else if (m_caseSensitive) {
-                            match = thread_Match_CS(&matchDescr);
-                        } else {
-                            match = thread_Match(&matchDescr);
-                        }
-                        if (match) {
-                            m_searchSuccess = true;
-                            m_searchResult_TI = TIA_Index;
-                        }
-                    }
-                }
+        if (!isBackground()) {
+            if (m_searchSuccess) {
+                g_processingCtrl_p->SetSuccess();
+            } else {
+                g_processingCtrl_p->SetFail();
             }
+            g_processingCtrl_p->AddProgressInfo(QString("Find all complete, %1 matches")
+                                                    .arg(m_results_p->GetCount()));
+        }
+        return;
+    }
 
-            /* SEARCH BACKWARD */
-            else {
-                int TIA_Index = high_TI_Index;
-                bool stop = false;
-
-                while (TIA_Index >= low_TI_Index && !(match) && !stop) {
-                    const auto LUT_Index = FIR_Array_p == nullptr ? 0 : FIR_Array_p[TIA_Index].LUT_index;
-                    if ((FIR_Array_p == nullptr) ||
-                        ((LUT_Index != 0) && !m_filterItem_LUT_p[LUT_Index]->m_exclude)) {
-                        /* The home made search relies on that size is one less than it should... */
-                        matchDescr.textLength = m_TIA_p->textItemArray_p[TIA_Index].size - (m_regExp ? 0 : 1);
-                        matchDescr.text_p = FileIndex_To_MemRef(&m_TIA_p->textItemArray_p[TIA_Index].fileIndex,
-                                                                &m_chunkDescr.fileIndex, m_workMem_p);
-
-                        if (m_regExp) {
-                            match = thread_Match_RegExp_HyperScan(&matchDescr);
-                        } else if (m_caseSensitive) {
-                            match = thread_Match_CS(&matchDescr);
-                        } else {
-                            match = thread_Match(&matchDescr);
-                        }
-                    }
+    TRACEX_D("CSearchCtrl::WrapUp")
 
-                    if (match) {
-                        m_searchSuccess = true;
-                        m_searchResult_TI = TIA_Index;
-                    } else {
-                        /* being causius with unsigned values and decrements... if passing
-                         * zero the value will be big... not neg */
-                        if (TIA_Index != 0) {
-                            --TIA_Index;
-                        } else {
-                            stop = true;
-                        }
-                    }
-                }
-            }
-        } /* else if (low_TI_Index == high_TI_Index) */
+    /* The threads didn't stop until they passed the earliest hit found by any of them, hence m_hitRow is the first
+     * match in search direction */
+    if (m_searchStop) {
+        m_searchSuccess = true;
+        m_searchResult_TI = m_hitRow.load();
     } else {
         g_processingCtrl_p->AddProgressInfo(QString("Search complete, FAIL  No match"));
     }
@@ -544,3 +539,21 @@ void CSearchCtrl::WrapUp(void)
 
     TRACEX_D("CSearchCtrl::WrapUp match:%d row:%d", m_searchSuccess, m_searchResult_TI)
 }
+
+/***********************************************************************************************************************
+*   GetChunkRowLimit
+***********************************************************************************************************************/
+int CSearchCtrl::GetChunkRowLimit(void)
+{
+    if (m_findAll) {
+        return 0;
+    }
+
+    /* Search in windows growing from the start row, a hit close to the start row is then found without waiting for
+     * the full work memory to be loaded and searched. */
+    const int limit = m_windowRows;
+    if (m_windowRows > 0) {
+        m_windowRows = m_windowRows > INT_MAX / SEARCH_WINDOW_GROWTH ? 0 : m_windowRows * SEARCH_WINDOW_GROWTH;
+    }
+    return limit;
+}
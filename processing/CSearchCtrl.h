@@ -15,8 +15,17 @@
 #include "CFilter.h"
 #include "CConfig.h"
 #include "CFileProcBase.h"
+#include "CSearchResults.h"
 #include "hs/hs.h"
 
+#include <vector>
+#include <utility>
+#include <atomic>
+#include <limits.h>
+
+#define SEARCH_FIRST_WINDOW_ROWS  4096  /* Rows in the first chunk searched from the start row */
+#define SEARCH_WINDOW_GROWTH      8     /* Each following chunk has this many times more rows, up to the work memory */
+
 /***********************************************************************************************************************
 *   CSearchThreadConfiguration
 ***********************************************************************************************************************/
@@ -41,6 +50,9 @@ public:
             m_regexp_database = nullptr;
         }
 
+        delete m_regexp_confirm_p;
+        m_regexp_confirm_p = nullptr;
+
         CThreadConfiguration::PrepareRemove();
     }
 
@@ -53,11 +65,15 @@ public:
     bool m_caseSensitive; /* true if match is case sensitive */
     FIRA_t *m_FIRA_p; /* Keeping track of filtered rows, if required. Null if full search */
     CFilterItem **m_filterItem_LUT_p; /* Lookup table, contains all filter items */
-    int32_t *m_TIA_Index_p; /* The TIA index where the search thread stopped  OUT-VALUE, -1 if not set */
+    std::atomic_int *m_hitRow_p; /* Earliest hit row (in search direction) found by any thread */
+    bool m_findAll; /* Don't stop at the first match, all matches are added to m_hits */
+    std::vector<SearchHit_t> m_hits; /* Matches in the current chunk (find-all), collected by the ctrl */
 
     /* hyperscan regexp engine */
     hs_database_t *m_regexp_database = nullptr;
     hs_scratch_t *m_regexp_scratch = nullptr;
+    bool m_regexp_som = false; /* m_regexp_database is compiled in start of match mode */
+    QRegularExpression *m_regexp_confirm_p = nullptr; /* m_regexp_database is a prefilter, see RegExpHybrid_Compile */
 };
 
 /***********************************************************************************************************************
@@ -96,13 +112,18 @@ protected:
 class CSearchCtrl : public CFileProcBase
 {
 public:
-    CSearchCtrl(void)
+    explicit CSearchCtrl(CCancelToken *cancelToken_p = nullptr) : CFileProcBase(cancelToken_p)
     {
         m_threadTI_Split = true;
+        m_numOfThreads = g_cfg_p->GetNumOfThreads(g_cfg_p->m_searchThreads);
         m_searchText_p = nullptr;
         m_searchStop = false;
         m_searchSuccess = false;
         m_searchResult_TI = 0;
+        m_findAll = false;
+        m_results_p = nullptr;
+        m_hitRow = INT_MAX;
+        m_windowRows = 0;
     }
 
     virtual ~CSearchCtrl(void) override {}
@@ -113,6 +134,20 @@ public:
                                  int startRow, int endRow, bool backward, bool regExp,
                                  bool caseSensitive);
 
+    /* Find all matches from startRow to endRow in one pass, the matches are appended to results_p for each chunk
+     * processed, in row order */
+    void StartFindAll(QFile *qFile_p, char *workMem_p, int64_t workMemSize, TIA_t *TIA_p, FIRA_t *FIRA_p,
+                      CFilterItem **filterItem_LUT_p, int priority, QString *searchText_p, int startRow, int endRow,
+                      bool regExp, bool caseSensitive, CSearchResults *results_p);
+
+    /* Search only the row ranges [first, last] given, ordered in the search direction, typically the candidates from
+     * the search index. The candidate rows are processed as sparse rows (see SetSparseRows), otherwise as
+     * StartProcessing. Returns true if there was a match */
+    bool SearchRowRanges(QFile *qFile_p, char *workMem_p, int64_t workMemSize, TIA_t *TIA_p, FIRA_t *FIRA_p,
+                         CFilterItem **filterItem_LUT_p, int priority, QString *searchText_p,
+                         const std::vector<std::pair<int, int>>& ranges, bool backward, bool regExp,
+                         bool caseSensitive);
+
     /****/
     bool GetSearchResult(int *searchResult_TI_p)
     {
@@ -145,6 +180,7 @@ protected:
     virtual CThreadConfiguration *CreateConfigurationObject(void) override;
     virtual bool isProcessingDone(void) override; /* Override to enable early stop when search successful */
     virtual void WrapUp(void) override;
+    virtual int GetChunkRowLimit(void) override;
 
 private:
     QString *m_searchText_p; /* Search string */
@@ -156,6 +192,10 @@ private:
     CFilterItem **m_filterItem_LUT_p;
     bool m_searchSuccess; /* Result of the search */
     int m_searchResult_TI; /* Result of the search */
-    int32_t m_threadStopRow[MAX_NUM_OF_THREADS]; /* Each thread put their value into the array when they exit the
-                                                  * processing loop. Wrap up will determine the final search hit row */
+    std::atomic_int m_hitRow; /* Threads continue until they pass this row, INT_MAX (or -1 backward) if no hit */
+    int m_windowRows; /* Row limit of the next chunk, grows for each chunk */
+    bool m_findAll;
+    CSearchResults *m_results_p; /* Find-all, where the matches are added */
+    std::vector<SearchHit_t> m_chunkHits; /* Find-all, the matches of all threads for the current chunk */
+    std::vector<packed_FIR_t> m_candidateRows; /* SearchRowRanges, the rows of the ranges, loaded sparse */
 };
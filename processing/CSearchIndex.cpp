@@ -0,0 +1,646 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "CSearchIndex.h"
+#include "CLogMerge.h"
+#include "CDebug.h"
+#include "CConfig.h"
+#include "CProgressCtrl.h"
+#include "CTimeMeas.h"
+#include "CMemAccounting.h"
+#include "globals.h"
+#include "utils.h"
+
+#include <ctype.h>
+#include <string.h>
+#include <algorithm>
+#include <iterator>
+
+/* Size of the bucket offset table of a segment */
+#define SEARCH_INDEX_OFFSETS_SIZE \
+    (static_cast<int64_t>(SEARCH_INDEX_BUCKETS + 1) * static_cast<int64_t>(sizeof(uint32_t)))
+
+/***********************************************************************************************************************
+*   GetFileName
+***********************************************************************************************************************/
+QString CSearchIndex::GetFileName(const QString& TIA_fileName)
+{
+    if (TIA_fileName.endsWith(QString(".tia"))) {
+        return TIA_fileName.left(TIA_fileName.size() - 4) + QString(".tri");
+    }
+    return TIA_fileName + QString(".tri");
+}
+
+/***********************************************************************************************************************
+*   Build
+***********************************************************************************************************************/
+bool CSearchIndex::Build(QFile *qFile_p, char *workMem_p, int64_t workMemSize, const TIA_t *TIA_p,
+                         const QString& fileName)
+{
+    Close();
+
+    const int rows = TIA_p->rows;
+    const TI_t *TI_p = TIA_p->textItemArray_p;
+
+    if ((rows <= 0) || (TI_p == nullptr) || (workMem_p == nullptr)) {
+        return false;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        TRACEX_QFILE(LOG_LEVEL_WARNING, "Failed to create the search index file", &file)
+        return false;
+    }
+
+    SearchIndex_FileHeader_t header;
+    memset(&header, 0, sizeof(header));
+    header.headerSize = sizeof(SearchIndex_FileHeader_t);
+    header.fileVersion = SEARCH_INDEX_FILE_VERSION;
+    header.blockRows = SEARCH_INDEX_BLOCK_ROWS;
+    header.bucketBits = SEARCH_INDEX_BUCKET_BITS;
+
+    bool success = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header);
+
+    const int numOfBlocks = (rows + SEARCH_INDEX_BLOCK_ROWS - 1) / SEARCH_INDEX_BLOCK_ROWS;
+    const int numOfThreads = g_cfg_p->m_numOfThreads > 0 ? g_cfg_p->m_numOfThreads : 1;
+    auto blockEndRow = [&] (int block) {
+        return std::min((block + 1) * SEARCH_INDEX_BLOCK_ROWS, rows); /* the row after the block */
+    };
+
+    std::vector<std::vector<uint8_t>> postings(SEARCH_INDEX_BUCKETS);
+    std::vector<int> prevBlock(SEARCH_INDEX_BUCKETS, -1);
+    int segmentFirstBlock = 0;
+    int64_t dataSize = 0;
+    int block = 0;
+    CTimeMeas execTime;
+
+    /* The posting lists keep their capacity between the segments, counted after each chunk and released when built */
+    int64_t memSize = 0;
+    auto setMemSize = [&] (int64_t size) {
+        MemAcc_Add(MEM_ACC_SEARCH_INDEX_e, size - memSize);
+        memSize = size;
+    };
+    auto releaseMem = makeMyScopeGuard([&] () {
+        setMemSize(0);
+    });
+
+    while (success && (block < numOfBlocks) && !g_processingCtrl_p->m_abort) {
+        /* Load as many whole blocks as fits in the work memory */
+        const int64_t chunkStart = TI_p[block * SEARCH_INDEX_BLOCK_ROWS].fileIndex;
+        int endBlock = block;
+        int64_t chunkSize = 0;
+
+        while (endBlock < numOfBlocks) {
+            const TI_t& last = TI_p[blockEndRow(endBlock) - 1];
+            const int64_t size = last.fileIndex + last.size - chunkStart;
+            if (size > workMemSize) {
+                break;
+            }
+            chunkSize = size;
+            ++endBlock;
+        }
+
+        if (endBlock == block) {
+            TRACEX_W(QString("Search index not built, %1 rows doesn't fit the work memory")
+                         .arg(SEARCH_INDEX_BLOCK_ROWS))
+            success = false;
+            break;
+        }
+
+        if (!qFile_p->seek(chunkStart)) {
+            TRACEX_QFILE(LOG_LEVEL_ERROR, "Failed to read log file data, file locked or removed?", qFile_p)
+            success = false;
+            break;
+        }
+
+        for (int64_t offset = 0; offset < chunkSize;) {
+            const int64_t read = qFile_p->read(workMem_p + offset, chunkSize - offset);
+            if (read <= 0) {
+                TRACEX_QFILE(LOG_LEVEL_ERROR, "Failed to read log file data, file locked or removed?", qFile_p)
+                success = false;
+                break;
+            }
+            offset += read;
+        }
+
+        if (!success) {
+            break;
+        }
+
+        /* Collect the distinct trigram buckets of each block, the blocks in the chunk are split in slices which are
+         * processed in parallel. The buckets are then added to the posting lists in block order. */
+        const int chunkBlocks = endBlock - block;
+        const int numOfSlices = std::min(chunkBlocks, numOfThreads * 4);
+        auto sliceFirstBlock = [&] (int slice) {
+            return block + static_cast<int>(static_cast<int64_t>(chunkBlocks) * slice / numOfSlices);
+        };
+        std::vector<std::vector<uint32_t>> sliceBuckets(static_cast<size_t>(numOfSlices));
+        std::vector<std::vector<size_t>> sliceBlockEnds(static_cast<size_t>(numOfSlices));
+
+        CLogMerge::RunParallel(numOfThreads, numOfSlices, [&] (int slice) {
+            std::vector<uint64_t> seen(SEARCH_INDEX_BUCKETS / 64, 0);
+            auto& buckets = sliceBuckets[static_cast<size_t>(slice)];
+            auto& blockEnds = sliceBlockEnds[static_cast<size_t>(slice)];
+            const int lastBlock = sliceFirstBlock(slice + 1);
+
+            for (int sliceBlock = sliceFirstBlock(slice); sliceBlock < lastBlock; ++sliceBlock) {
+                const size_t blockStart = buckets.size();
+
+                for (int row = sliceBlock * SEARCH_INDEX_BLOCK_ROWS; row < blockEndRow(sliceBlock); ++row) {
+                    const uint8_t *text_p = reinterpret_cast<const uint8_t *>(
+                        workMem_p + (TI_p[row].fileIndex - chunkStart));
+                    const int size = TI_p[row].size;
+                    if (size < 3) {
+                        continue;
+                    }
+
+                    uint8_t a = g_upperChar_LUT[text_p[0]];
+                    uint8_t b = g_upperChar_LUT[text_p[1]];
+                    for (int index = 2; index < size; ++index) {
+                        const uint8_t c = g_upperChar_LUT[text_p[index]];
+                        const uint32_t bucket = Bucket(a, b, c);
+                        uint64_t& word = seen[bucket >> 6];
+                        const uint64_t bit = static_cast<uint64_t>(1) << (bucket & 63);
+                        if (!(word & bit)) {
+                            word |= bit;
+                            buckets.push_back(bucket);
+                        }
+                        a = b;
+                        b = c;
+                    }
+                }
+
+                for (size_t index = blockStart; index < buckets.size(); ++index) {
+                    seen[buckets[index] >> 6] = 0;
+                }
+                blockEnds.push_back(buckets.size());
+            }
+        });
+
+        for (int slice = 0; slice < numOfSlices; ++slice) {
+            const auto& buckets = sliceBuckets[static_cast<size_t>(slice)];
+            const auto& blockEnds = sliceBlockEnds[static_cast<size_t>(slice)];
+            int sliceBlock = sliceFirstBlock(slice);
+            size_t start = 0;
+
+            for (auto end : blockEnds) {
+                for (size_t index = start; index < end; ++index) {
+                    const uint32_t bucket = buckets[index];
+                    auto& list = postings[bucket];
+                    auto delta = static_cast<uint32_t>(sliceBlock - prevBlock[bucket]);
+                    prevBlock[bucket] = sliceBlock;
+
+                    while (delta >= 0x80) {
+                        list.push_back(static_cast<uint8_t>(delta | 0x80));
+                        delta >>= 7;
+                        ++dataSize;
+                    }
+                    list.push_back(static_cast<uint8_t>(delta));
+                    ++dataSize;
+                }
+                start = end;
+                ++sliceBlock;
+            }
+        }
+
+        int64_t postingsSize = static_cast<int64_t>(sizeof(int) * prevBlock.size());
+        for (auto& list : postings) {
+            postingsSize += static_cast<int64_t>(list.capacity());
+        }
+        setMemSize(postingsSize);
+
+        block = endBlock;
+
+        if ((dataSize >= SEARCH_INDEX_SEGMENT_SIZE) || (block == numOfBlocks)) {
+            success = WriteSegment(file, postings, segmentFirstBlock, block - segmentFirstBlock, dataSize);
+            ++header.numOfSegments;
+            segmentFirstBlock = block;
+            dataSize = 0;
+            std::fill(prevBlock.begin(), prevBlock.end(), segmentFirstBlock - 1);
+        }
+
+        g_processingCtrl_p->SetProgressCounter(block / static_cast<double>(numOfBlocks));
+    }
+
+    if (success && !g_processingCtrl_p->m_abort) {
+        header.numOfRows = rows;
+        header.indexedSize = TI_p[rows - 1].fileIndex + TI_p[rows - 1].size;
+        success = file.seek(0) &&
+                  (file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header));
+    } else {
+        success = false;
+    }
+
+    const int64_t indexSize = file.size();
+    file.close();
+
+    if (!success) {
+        file.remove();
+        return false;
+    }
+
+    TRACEX_I(QString("Search index built, rows:%1 segments:%2 size:%3 time:%4ms")
+                 .arg(rows).arg(header.numOfSegments).arg(indexSize).arg(execTime.ms()))
+
+    return Open(fileName, TIA_p);
+}
+
+/***********************************************************************************************************************
+*   WriteSegment
+***********************************************************************************************************************/
+bool CSearchIndex::WriteSegment(QFile& file, std::vector<std::vector<uint8_t>>& postings, int firstBlock,
+                                int numOfBlocks, int64_t dataSize)
+{
+    if (dataSize > UINT32_MAX) {
+        TRACEX_W(QString("Search index segment too large, %1 bytes").arg(dataSize))
+        return false;
+    }
+
+    SearchIndex_SegmentHeader_t header = {firstBlock, numOfBlocks, dataSize};
+    std::vector<uint32_t> offsets(SEARCH_INDEX_BUCKETS + 1);
+    uint32_t offset = 0;
+
+    for (size_t bucket = 0; bucket < SEARCH_INDEX_BUCKETS; ++bucket) {
+        offsets[bucket] = offset;
+        offset += static_cast<uint32_t>(postings[bucket].size());
+    }
+    offsets[SEARCH_INDEX_BUCKETS] = offset;
+
+    bool success = (file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header)) &&
+                   (file.write(reinterpret_cast<const char *>(offsets.data()), SEARCH_INDEX_OFFSETS_SIZE) ==
+                    SEARCH_INDEX_OFFSETS_SIZE);
+
+    for (auto& list : postings) {
+        if (success && !list.empty()) {
+            const auto size = static_cast<int64_t>(list.size());
+            success = file.write(reinterpret_cast<const char *>(list.data()), size) == size;
+        }
+        list.clear();
+    }
+
+    if (!success) {
+        TRACEX_QFILE(LOG_LEVEL_WARNING, "Failed to write the search index file", &file)
+    }
+
+    return success;
+}
+
+/***********************************************************************************************************************
+*   Open
+***********************************************************************************************************************/
+bool CSearchIndex::Open(const QString& fileName, const TIA_t *TIA_p)
+{
+    Close();
+
+    m_file.setFileName(fileName);
+
+    if (!m_file.exists() || !m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const int64_t fileSize = m_file.size();
+    SearchIndex_FileHeader_t header;
+
+    if (fileSize >= static_cast<int64_t>(sizeof(header))) {
+        m_map_p = m_file.map(0, fileSize);
+    }
+
+    if (m_map_p == nullptr) {
+        m_file.close();
+        return false;
+    }
+
+    MemAcc_Map(MEM_ACC_SEARCH_INDEX_e, m_map_p, fileSize);
+
+    memcpy(&header, m_map_p, sizeof(header));
+
+    bool valid = (header.headerSize == sizeof(SearchIndex_FileHeader_t)) &&
+                 (header.fileVersion == SEARCH_INDEX_FILE_VERSION) &&
+                 (header.blockRows == SEARCH_INDEX_BLOCK_ROWS) &&
+                 (header.bucketBits == SEARCH_INDEX_BUCKET_BITS) &&
+                 (header.numOfRows > 0) && (header.numOfRows <= TIA_p->rows);
+
+    if (valid) {
+        /* The indexed rows shall still be at the same place in the log */
+        const TI_t& last = TIA_p->textItemArray_p[header.numOfRows - 1];
+        valid = last.fileIndex + last.size == header.indexedSize;
+    }
+
+    int64_t offset = sizeof(header);
+    for (int segment = 0; valid && segment < header.numOfSegments; ++segment) {
+        SearchIndex_SegmentHeader_t segmentHeader;
+        if (offset + static_cast<int64_t>(sizeof(segmentHeader)) + SEARCH_INDEX_OFFSETS_SIZE > fileSize) {
+            valid = false;
+            break;
+        }
+        memcpy(&segmentHeader, m_map_p + offset, sizeof(segmentHeader));
+        m_segments.push_back(m_map_p + offset);
+        offset += static_cast<int64_t>(sizeof(segmentHeader)) + SEARCH_INDEX_OFFSETS_SIZE + segmentHeader.dataSize;
+        valid = offset <= fileSize;
+    }
+
+    if (!valid) {
+        TRACEX_I(QString("Search index %1 doesn't match the log, it will be rebuilt").arg(fileName))
+        Close();
+        return false;
+    }
+
+    m_rows = header.numOfRows;
+
+    TRACEX_I(QString("Search index opened, rows:%1 segments:%2").arg(m_rows).arg(header.numOfSegments))
+
+    return true;
+}
+
+/***********************************************************************************************************************
+*   Close
+***********************************************************************************************************************/
+void CSearchIndex::Close(void)
+{
+    if (m_map_p != nullptr) {
+        MemAcc_Unmap(MEM_ACC_SEARCH_INDEX_e, m_map_p);
+        m_file.unmap(m_map_p);
+        m_map_p = nullptr;
+    }
+
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+
+    m_segments.clear();
+    m_rows = 0;
+}
+
+/***********************************************************************************************************************
+*   GetRequiredLiterals
+***********************************************************************************************************************/
+bool CSearchIndex::GetRequiredLiterals(const QString& searchText, bool regExp, std::vector<QByteArray>& literals)
+{
+    const QByteArray text = searchText.toLatin1();
+    QByteArray literal;
+    int depth = 0; /* Inside a group, nothing is taken as required (it might be optional or an alternation) */
+
+    literals.clear();
+
+    auto endLiteral = [&] () {
+        if (literal.size() >= 3) {
+            literals.push_back(literal);
+        }
+        literal.clear();
+    };
+
+    if (!regExp) {
+        literal = text;
+        endLiteral();
+        return !literals.empty();
+    }
+
+    /* Inline options change how the rest of the expression is read, e.g. (?x) makes white space insignificant, and
+     * {,n} is an optional repetition in PCRE2 10.43+. The groups (?: (?= (?! (?< (?> (?| (?# (?P (?' are parsed as
+     * any group */
+    if (text.startsWith("(?") || text.contains("{,")) {
+        return false;
+    }
+    for (int index = text.indexOf("(?"); index >= 0; index = text.indexOf("(?", index + 2)) {
+        if ((index + 2 >= text.size()) || (strchr(":=!<>|#P'", text[index + 2]) == nullptr)) {
+            return false;
+        }
+    }
+
+    for (int index = 0; index < text.size(); ++index) {
+        const char ch = text[index];
+
+        switch (ch)
+        {
+            case '\\':
+                if (++index < text.size()) {
+                    const auto escaped = static_cast<uint8_t>(text[index]);
+                    if (isalnum(escaped)) {
+                        /* Character class, anchor or code (\d, \b, \x41, \p{L}, ...) */
+                        endLiteral();
+                        if (escaped == 'Q') {
+                            index = text.size(); /* Quoted text, not parsed */
+                        } else if (isdigit(escaped) || (strchr("xpPckgNou", escaped) != nullptr)) {
+                            /* Skip the arguments of the code */
+                            while ((index + 1 < text.size()) &&
+                                   (isalnum(static_cast<uint8_t>(text[index + 1])) || (text[index + 1] == '{') ||
+                                    (text[index + 1] == '}'))) {
+                                ++index;
+                            }
+                        }
+                    } else if (depth == 0) {
+                        literal.append(static_cast<char>(escaped));
+                    }
+                }
+                break;
+
+            case '[':
+                /* Character class, skip to the end of it */
+                ++index;
+                if ((index < text.size()) && (text[index] == '^')) {
+                    ++index;
+                }
+                if ((index < text.size()) && (text[index] == ']')) {
+                    ++index;
+                }
+                while ((index < text.size()) && (text[index] != ']')) {
+                    if (text[index] == '\\') {
+                        ++index;
+                    }
+                    ++index;
+                }
+                endLiteral();
+                break;
+
+            case '(':
+                ++depth;
+                endLiteral();
+                break;
+
+            case ')':
+                --depth;
+                endLiteral();
+                break;
+
+            case '|':
+                if (depth == 0) {
+                    literals.clear(); /* Top level alternation, nothing is required */
+                    return false;
+                }
+                break;
+
+            case '?':
+            case '*':
+                /* The previous character is optional */
+                if (!literal.isEmpty()) {
+                    literal.chop(1);
+                }
+                endLiteral();
+                break;
+
+            case '{':
+                if ((index + 1 < text.size()) && isdigit(static_cast<uint8_t>(text[index + 1]))) {
+                    /* Repetition, if the minimum count is 0 the previous character is optional */
+                    if ((text[index + 1] == '0') && !literal.isEmpty()) {
+                        literal.chop(1);
+                    }
+                    endLiteral();
+                    while ((index < text.size()) && (text[index] != '}')) {
+                        ++index;
+                    }
+                } else if (depth == 0) {
+                    literal.append(ch);
+                }
+                break;
+
+            case '+':
+            case '.':
+            case '^':
+            case '$':
+                endLiteral();
+                break;
+
+            default:
+                if (depth == 0) {
+                    literal.append(ch);
+                }
+                break;
+        }
+    }
+
+    endLiteral();
+
+    return !literals.empty();
+}
+
+/***********************************************************************************************************************
+*   GetBuckets
+***********************************************************************************************************************/
+void CSearchIndex::GetBuckets(const QByteArray& literal, std::vector<uint32_t>& buckets)
+{
+    const auto *text_p = reinterpret_cast<const uint8_t *>(literal.constData());
+
+    for (int index = 2; index < literal.size(); ++index) {
+        buckets.push_back(Bucket(g_upperChar_LUT[text_p[index - 2]],
+                                 g_upperChar_LUT[text_p[index - 1]],
+                                 g_upperChar_LUT[text_p[index]]));
+    }
+}
+
+/***********************************************************************************************************************
+*   DecodeList
+***********************************************************************************************************************/
+void CSearchIndex::DecodeList(size_t segment, uint32_t bucket, std::vector<int>& blocks) const
+{
+    const uchar *segment_p = m_segments[segment];
+    SearchIndex_SegmentHeader_t header;
+    uint32_t offsets[2];
+
+    memcpy(&header, segment_p, sizeof(header));
+    memcpy(offsets, segment_p + sizeof(header) + bucket * sizeof(uint32_t), sizeof(offsets));
+
+    const uchar *data_p = segment_p + sizeof(header) + SEARCH_INDEX_OFFSETS_SIZE;
+    const uchar *list_p = data_p + offsets[0];
+    const uchar *end_p = data_p + offsets[1];
+    int block = header.firstBlock - 1;
+
+    blocks.clear();
+
+    while (list_p < end_p) {
+        uint32_t delta = 0;
+        int shift = 0;
+        uint8_t byte;
+        do {
+            byte = *list_p++;
+            delta |= static_cast<uint32_t>(byte & 0x7f) << shift;
+            shift += 7;
+        } while ((byte & 0x80) && (list_p < end_p));
+
+        block += static_cast<int>(delta);
+        blocks.push_back(block);
+    }
+}
+
+/***********************************************************************************************************************
+*   GetCandidateRows
+***********************************************************************************************************************/
+void CSearchIndex::GetCandidateRows(const std::vector<QByteArray>& literals, int startRow, int endRow, bool backward,
+                                    std::vector<std::pair<int, int>>& ranges) const
+{
+    const int firstRow = backward ? endRow : startRow;
+    const int lastRow = std::min(backward ? startRow : endRow, m_rows - 1);
+
+    ranges.clear();
+
+    if (!IsOpen() || (firstRow > lastRow)) {
+        return;
+    }
+
+    std::vector<uint32_t> buckets;
+    for (auto& literal : literals) {
+        GetBuckets(literal, buckets);
+    }
+    std::sort(buckets.begin(), buckets.end());
+    buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+
+    if (buckets.empty()) {
+        ranges.push_back(std::make_pair(firstRow, lastRow));
+    } else {
+        const int firstBlock = firstRow / SEARCH_INDEX_BLOCK_ROWS;
+        const int lastBlock = lastRow / SEARCH_INDEX_BLOCK_ROWS;
+        std::vector<int> candidates;
+        std::vector<int> list;
+        std::vector<int> intersection;
+
+        for (size_t segment = 0; segment < m_segments.size(); ++segment) {
+            SearchIndex_SegmentHeader_t header;
+            memcpy(&header, m_segments[segment], sizeof(header));
+
+            if ((header.firstBlock > lastBlock) || (header.firstBlock + header.numOfBlocks <= firstBlock)) {
+                continue;
+            }
+
+            /* Intersect the shortest lists first, the candidates then quickly become few */
+            const uchar *offsets_p = m_segments[segment] + sizeof(header);
+            auto listSize = [offsets_p] (uint32_t bucket) {
+                uint32_t offsets[2];
+                memcpy(offsets, offsets_p + bucket * sizeof(uint32_t), sizeof(offsets));
+                return offsets[1] - offsets[0];
+            };
+            std::sort(buckets.begin(), buckets.end(), [&] (uint32_t a, uint32_t b) {
+                return listSize(a) < listSize(b);
+            });
+
+            DecodeList(segment, buckets[0], candidates);
+
+            for (size_t index = 1; index < buckets.size() && !candidates.empty(); ++index) {
+                DecodeList(segment, buckets[index], list);
+                intersection.clear();
+                std::set_intersection(candidates.begin(), candidates.end(), list.begin(), list.end(),
+                                      std::back_inserter(intersection));
+                candidates.swap(intersection);
+            }
+
+            for (auto block : candidates) {
+                if ((block < firstBlock) || (block > lastBlock)) {
+                    continue;
+                }
+
+                const int first = std::max(firstRow, block * SEARCH_INDEX_BLOCK_ROWS);
+                const int last = std::min(lastRow, (block + 1) * SEARCH_INDEX_BLOCK_ROWS - 1);
+
+                if (!ranges.empty() && (ranges.back().second + 1 == first)) {
+                    ranges.back().second = last;
+                } else {
+                    ranges.push_back(std::make_pair(first, last));
+                }
+            }
+        }
+    }
+
+    if (backward) {
+        std::reverse(ranges.begin(), ranges.end());
+    }
+}
@@ -0,0 +1,99 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include "CFilter.h"
+
+#include <stdint.h>
+#include <vector>
+#include <utility>
+
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+
+#define SEARCH_INDEX_FILE_VERSION   1
+#define SEARCH_INDEX_BLOCK_ROWS     128        /* Rows per block, the posting lists refer to blocks and not rows */
+#define SEARCH_INDEX_BUCKET_BITS    18
+#define SEARCH_INDEX_BUCKETS        (1 << SEARCH_INDEX_BUCKET_BITS)
+#define SEARCH_INDEX_SEGMENT_SIZE   (64 * 1024 * 1024) /* Posting data kept in memory before written as a segment */
+
+typedef struct {
+    int32_t headerSize; /**< sizeof(SearchIndex_FileHeader_t) */
+    int32_t fileVersion; /**< SEARCH_INDEX_FILE_VERSION */
+    int32_t blockRows;
+    int32_t bucketBits;
+    int32_t numOfRows; /**< Rows indexed, the log may have more rows (tracking) */
+    int32_t numOfSegments;
+    int64_t indexedSize; /**< End file index of the last indexed row, checked against the TIA when opened */
+} SearchIndex_FileHeader_t;
+
+typedef struct {
+    int32_t firstBlock;
+    int32_t numOfBlocks;
+    int64_t dataSize; /**< Bytes of posting data after the bucket offset table */
+} SearchIndex_SegmentHeader_t;
+
+/***********************************************************************************************************************
+*   CSearchIndex
+*
+*   On-disk trigram index over the rows of the log. Each trigram, case folded, is hashed to a bucket and every bucket
+*   has a posting list of the row blocks containing it (delta and varint coded). A search collects the trigrams
+*   required by the search text and intersects their posting lists, only the rows of the remaining blocks needs to
+*   be matched. Hash collisions and trigrams not next to each other in the row only give false candidates, which are
+*   removed by the match, so the index is never wrong, it just narrows the rows to search.
+*
+*   The postings are written in segments, each covering a range of blocks with its own bucket offset table, to limit
+*   the memory used while building the index of a large log.
+***********************************************************************************************************************/
+class CSearchIndex
+{
+public:
+    CSearchIndex(void) = default;
+    ~CSearchIndex(void) {Close();}
+
+    /* The index file is placed next to the TIA file, e.g. log.txt.tia -> log.txt.tri */
+    static QString GetFileName(const QString& TIA_fileName);
+
+    /* Index all rows in the TIA, the log is read chunk-wise into workMem. The index is opened when built */
+    bool Build(QFile *qFile_p, char *workMem_p, int64_t workMemSize, const TIA_t *TIA_p, const QString& fileName);
+
+    /* Open an existing index file, fails if it doesn't match the TIA */
+    bool Open(const QString& fileName, const TIA_t *TIA_p);
+    void Close(void);
+
+    bool IsOpen(void) const {return m_map_p != nullptr;}
+    int GetRows(void) const {return m_rows;}
+
+    /* The literals that a matching row must contain. For a regular expression these are extracted from the parts
+     * of the expression that are required. Returns false if no literal is long enough to use the index, or if the
+     * expression has inline options (they may change what is required). Used by the index, the block summary and the
+     * filter guards, a literal returned that isn't required means missed matches */
+    static bool GetRequiredLiterals(const QString& searchText, bool regExp, std::vector<QByteArray>& literals);
+
+    /* The row ranges [first, last], within the rows from startRow to endRow, that may contain all literals. The
+     * ranges are ordered in the search direction, i.e. descending if backward */
+    void GetCandidateRows(const std::vector<QByteArray>& literals, int startRow, int endRow, bool backward,
+                          std::vector<std::pair<int, int>>& ranges) const;
+
+private:
+    /****/
+    static inline uint32_t Bucket(uint8_t a, uint8_t b, uint8_t c)
+    {
+        const uint32_t key = (static_cast<uint32_t>(a) << 16) | (static_cast<uint32_t>(b) << 8) | c;
+        return (key * 2654435761u) >> (32 - SEARCH_INDEX_BUCKET_BITS);
+    }
+
+    static void GetBuckets(const QByteArray& literal, std::vector<uint32_t>& buckets);
+    bool WriteSegment(QFile& file, std::vector<std::vector<uint8_t>>& postings, int firstBlock, int numOfBlocks,
+                      int64_t dataSize);
+    void DecodeList(size_t segment, uint32_t bucket, std::vector<int>& blocks) const;
+
+    QFile m_file;
+    uchar *m_map_p = nullptr;
+    int m_rows = 0;
+    std::vector<const uchar *> m_segments; /* Start of each segment header in m_map_p */
+};
@@ -52,23 +52,11 @@ void CWorker::run(void)
 
 CThreadManager::CThreadManager()
 {
-    m_numOfThreads = g_cfg_p->m_numOfThreads;
+    m_numOfThreads = g_cfg_p->GetNumOfThreads(0);
 
-    m_threadInstanceArray =
-        static_cast<threadInstance_base_t *>(malloc(sizeof(threadInstance_base_t) *
-                                                    static_cast<size_t>(m_numOfThreads)));
-    if (m_threadInstanceArray == nullptr) {
-        TRACEX_E("CThreadManager::CThreadManager  m_threadInstanceArray is nullptr")
-        return;
-    }
-    memset(m_threadInstanceArray, 0, sizeof(threadInstance_base_t) * static_cast<size_t>(m_numOfThreads));
-
-    m_hThreadArray_pp = static_cast<CWorker **>(malloc(sizeof(CWorker *) * static_cast<size_t>(m_numOfThreads)));
-    if (m_hThreadArray_pp == nullptr) {
-        TRACEX_E("CThreadManager::CThreadManager  m_hThreadArray_pp is nullptr")
-        return;
-    }
-    memset(m_hThreadArray_pp, 0, sizeof(QThread *) * static_cast<size_t>(m_numOfThreads));
+    /* Zeroed, value initialized */
+    m_threadInstanceArray.Resize(m_numOfThreads);
+    m_hThreadArray_pp.assign(static_cast<size_t>(m_numOfThreads), nullptr);
 
     InitializeThreads();
 }
@@ -81,15 +69,7 @@ CThreadManager::~CThreadManager()
         IF_NOT_NULL_DELETE_AND_SET_NULL(m_threadInstanceArray[threadIndex].cmdSync_sem_p);
         IF_NOT_NULL_DELETE_AND_SET_NULL(m_threadInstanceArray[threadIndex].doneSync_sem_p);
         IF_NOT_NULL_DELETE_AND_SET_NULL(m_threadInstanceArray[threadIndex].killed_sem_p);
-        IF_NOT_NULL_DELETE_AND_SET_NULL(m_hThreadArray_pp[threadIndex]);
-    }
-
-    if (m_threadInstanceArray != nullptr) {
-        free(m_threadInstanceArray);
-    }
-
-    if (m_hThreadArray_pp != nullptr) {
-        free(m_hThreadArray_pp);
+        IF_NOT_NULL_DELETE_AND_SET_NULL(m_hThreadArray_pp[static_cast<size_t>(threadIndex)]);
     }
 }
 
@@ -6,9 +6,12 @@
 #pragma once
 
 #include <stdlib.h>
+#include <vector>
 #include <QThread>
 #include <QSemaphore>
 
+#include "CPerThreadArray.h"
+
 typedef enum
 {
     THREAD_CMD_START = 0x01,
@@ -74,8 +77,8 @@ private:
     void KillThreads(void);
     void InitializeThreads(void);
 
-    threadInstance_base_t *m_threadInstanceArray; /* Work data for the threads */
-    CWorker **m_hThreadArray_pp; /* Used to wait for all threads to exit before it is possible to close the thread
-                                  * handles */
-    int m_numOfThreads;
+    CPerThreadArray<threadInstance_base_t> m_threadInstanceArray; /* Work data for the threads */
+    std::vector<CWorker *> m_hThreadArray_pp; /* Used to wait for all threads to exit before it is possible to close
+                                               * the thread handles */
+    int m_numOfThreads; /* Running threads, 0 when killed */
 };
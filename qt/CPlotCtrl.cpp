@@ -6,6 +6,7 @@
 #include <stdlib.h>
 
 #include "CDebug.h"
+#include "CTrace.h"
 #include "cplotctrl.h"
 #include "../processing/CProgressCtrl.h"
 
@@ -22,6 +23,8 @@ inline char *FileIndex_To_MemRef(int64_t *fileIndex_p, int64_t *workMemFileIndex
 ***********************************************************************************************************************/
 void CPlotThread::thread_Process(CThreadConfiguration *config_p)
 {
+    TRACE_SPAN("Plot rows")
+
     TRACEX_DE(
         "CPlotThread::thread_Process  0x%x   m_start_TIA_index:%d m_stop_TIA_Index:%d m_TIA_step:%d",
         this, config_p->m_start_TIA_index, config_p->m_stop_TIA_Index, config_p->m_TIA_step)
@@ -85,11 +88,14 @@ void CPlotCtrl::Start_PlotProcessing(QFile *qFile_p, char *workMem_p, int64_t wo
     /* Make sure that each thread work with all line, since each thread has its own plugin to work with */
     m_threadTI_Split = false;
 
-    int savedNumOfThreads = g_cfg_p->m_numOfThreads;          /* override temporary */
-    g_cfg_p->m_numOfThreads = m_pendingPlot_execList_p->count();     /* override temporary */
+    if (m_pendingPlot_execList_p->isEmpty()) {
+        return;
+    }
+
+    /* One thread per plot */
+    SetNumOfThreads(m_pendingPlot_execList_p->count());
 
     CFileProcBase::Start(qFile_p, workMem_p, workMemSize, TIA_p, priority, startRow, endRow, false /*backward*/);
-    g_cfg_p->m_numOfThreads = savedNumOfThreads;
 }
 
 /***********************************************************************************************************************
@@ -12,6 +12,8 @@
 #include <exception>
 
 #include "mainwindow_cb_if.h"
+#include "CTrace.h"
+#include "cframestats.h"
 
 using namespace std;
 
@@ -438,6 +440,7 @@ CEditorWidget::CEditorWidget(QWidget *parent) :
 void CEditorWidget::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event)
+    TRACE_SPAN("Editor paint")
 
     try {
         LS_Painter painter(this);
@@ -445,7 +448,15 @@ void CEditorWidget::paintEvent(QPaintEvent *event)
 
         m_painter_p->setBrush(m_background);
         GetTheDoc()->m_fontCtrl.SetFont(m_painter_p, m_whiteFont_p);
+
+        const RowCacheStats_t& rowCacheStats = GetTheDoc()->m_rowCache_p->GetStats();
+        g_frameStats.BeginFrame(&rowCacheStats);
         OnDraw(); /* After this call it might be that m_painter_p is exchanged to the double buffer */
+        g_frameStats.EndFrame(&rowCacheStats);
+
+        if (m_perfHUD) {
+            DrawPerfHUD(&painter);
+        }
     } catch (...) {}
 
     /* DO NOT USE m_painter_p HERE */
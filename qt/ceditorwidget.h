@@ -167,6 +167,7 @@ private:
 
 protected:
     int m_onDrawCount;
+    bool m_perfHUD; /**< Frame time HUD shown, toggled with F12 */
     bool m_windowCfgChanged;
     QSize m_adaptWindowSize; /**< Set by main window when settings didn't contain window sizes. */
     QSize m_lastResize; /**< From resizeEvent */
@@ -403,6 +404,7 @@ public:
     void DrawColumnClip();
     void DrawScrollWindow(void);
     void DrawDebugWindow(void); /* Shows a window on-top of everything with some realtime info */
+    void DrawPerfHUD(LS_Painter *painter_p); /* Frame time overlay, drawn on-top after the frame is timed */
     void DrawBookmark(QRect *rect_p);
 
     void SearchNewTopLine(bool checkDisplayCache = true, int focusRow = -1);
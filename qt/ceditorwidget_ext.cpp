@@ -13,6 +13,7 @@
 #include <QAction>
 #include <QClipboard>
 #include <QMimeData>
+#include <QFontDatabase>
 
 #include "CDebug.h"
 #include "CConfig.h"
@@ -30,6 +31,8 @@
 #include "CConfigurationCtrl.h"
 
 #include "cplotpane.h"
+#include "cframestats.h"
+#include "CMemAccounting.h"
 
 extern CLogScrutinizerDoc *GetDocument(void);
 
@@ -151,6 +154,7 @@ void CEditorWidget::Initialize_0(void)
 
     m_bitmapsLoaded = false;
     m_onDrawCount = 0;
+    m_perfHUD = false;
     m_inFocus = false;
 
     m_maxColWidth = 0;
@@ -861,9 +865,13 @@ void CEditorWidget::OnDraw(void)
 
     if ((!doc_p->m_allEnabledFilterItems.empty() || (g_workspace_p->GetBookmarksCount() > 0)) &&
         (m_presentationMode == PRESENTATION_MODE_ONLY_FILTERED_e)) {
+        g_frameStats.BeginStage(FRAME_STAGE_FILL_SCREEN_ROWS_e);
         FillScreenRows_Filtered();      /* Add max number of rows to the screenBuffer */
+        g_frameStats.EndStage(FRAME_STAGE_FILL_SCREEN_ROWS_e);
     } else {
+        g_frameStats.BeginStage(FRAME_STAGE_FILL_SCREEN_ROWS_e);
         FillScreenRows();               /* Add max number of rows to the screenBuffer */
+        g_frameStats.EndStage(FRAME_STAGE_FILL_SCREEN_ROWS_e);
     }
 
     OutlineScreenRows();
@@ -900,7 +908,9 @@ void CEditorWidget::OnDraw(void)
     DrawWindow();
 
     if (!m_rockScroll_Valid) {
+        g_frameStats.BeginStage(FRAME_STAGE_ROCK_SCROLL_e);
         FillRockScroll();
+        g_frameStats.EndStage(FRAME_STAGE_ROCK_SCROLL_e);
         m_rockScroll_Valid = true;
     }
 
@@ -1068,7 +1078,9 @@ void CEditorWidget::DrawTextWindow(void)
     static QElapsedTimer e_timer;
     e_timer.restart();
 
+    g_frameStats.BeginStage(FRAME_STAGE_DRAW_ROWS_e);
     DrawRows();
+    g_frameStats.EndStage(FRAME_STAGE_DRAW_ROWS_e);
 
     qint64 elapsedTime = e_timer.nsecsElapsed();
     if ((elapsedTime != 0) && !m_drawTimesZero) {
@@ -2149,6 +2161,107 @@ void CEditorWidget::DrawDebugWindow(void)
     }
 }
 
+/***********************************************************************************************************************
+*   DrawPerfHUD
+*
+*   Frame time overlay (F12), per stage the last/avg/p95/max over the rolling window, the frame time histogram since
+*   the last reset (CTRL-F12) and a graph of the last frames. In the graph each frame is a column stacked with
+*   FillScreenRows (blue), DrawRows (green, the row cache misses in orange) and rock scroll (red) on top of the frame
+*   total (gray), the white line is 16.7 ms (60 fps).
+***********************************************************************************************************************/
+void CEditorWidget::DrawPerfHUD(LS_Painter *painter_p)
+{
+    const int margin = 8;
+    const int graphHeight = 64;
+    const double graphMax_ms = 33.3;
+    const QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    const QFontMetrics metrics(font);
+    const int lineHeight = metrics.height();
+    const int width = std::max(FRAME_STATS_HISTORY, metrics.horizontalAdvance(QString(52, QChar('0')))) + 2 * margin;
+    const int textLines = 2 + FRAME_STAGE_COUNT_e + 1 + FRAME_STATS_BUCKETS;
+    const QRect hud(rect().right() - m_vscrollFrame.width() - width - margin, rect().top() + margin,
+                    width, textLines * lineHeight + graphHeight + 3 * margin);
+
+    painter_p->save();
+    painter_p->fillRect(hud, QColor(0, 0, 0, 200));
+    painter_p->setFont(font);
+    painter_p->setPen(QColor(Qt::white));
+
+    int y = hud.top() + margin + metrics.ascent();
+    const int x = hud.left() + margin;
+
+    const FrameSample_t& last = g_frameStats.GetSample(0);
+    painter_p->drawText(x, y, QString("Frames %1  Row cache misses %2 (last frame)")
+                            .arg(static_cast<qlonglong>(g_frameStats.GetFrameCount()))
+                            .arg(static_cast<qlonglong>(last.rowCacheMisses)));
+    y += lineHeight;
+    painter_p->drawText(x, y, QString("%1 %2 %3 %4 %5 ms").arg(QString(), -18).arg(QString("last"), 7)
+                            .arg(QString("avg"), 7).arg(QString("p95"), 7).arg(QString("max"), 7));
+    y += lineHeight;
+
+    for (int stage = 0; stage < FRAME_STAGE_COUNT_e; ++stage) {
+        const FrameStageSummary_t summary = g_frameStats.GetSummary(static_cast<FrameStage_e>(stage));
+        painter_p->drawText(x, y, QString("%1 %2 %3 %4 %5")
+                                .arg(QString(CFrameStats::GetStageName(static_cast<FrameStage_e>(stage))), -18)
+                                .arg(summary.last_ms, 7, 'f', 2).arg(summary.avg_ms, 7, 'f', 2)
+                                .arg(summary.p95_ms, 7, 'f', 2).arg(summary.max_ms, 7, 'f', 2));
+        y += lineHeight;
+    }
+    y += lineHeight;
+
+    /* Histogram, the bars are relative the largest bucket */
+    int64_t maxBucket = 1;
+    for (int bucket = 0; bucket < FRAME_STATS_BUCKETS; ++bucket) {
+        maxBucket = std::max(maxBucket, g_frameStats.GetBucketCount(bucket));
+    }
+
+    const int barLeft = x + metrics.horizontalAdvance(QString(18, QChar('0')));
+    const int barWidth = hud.right() - margin - barLeft;
+    for (int bucket = 0; bucket < FRAME_STATS_BUCKETS; ++bucket) {
+        const int64_t count = g_frameStats.GetBucketCount(bucket);
+        painter_p->drawText(x, y, QString("%1 %2").arg(CFrameStats::GetBucketLabel(bucket), -6)
+                                .arg(static_cast<qlonglong>(count), 10));
+        painter_p->fillRect(barLeft, y - metrics.ascent() + 2, static_cast<int>(barWidth * count / maxBucket),
+                            metrics.ascent() - 2, bucket < 3 ? QColor(0x40, 0xc0, 0x40) : QColor(0xe0, 0x60, 0x40));
+        y += lineHeight;
+    }
+
+    /* Graph of the last frames, the newest to the right */
+    const int graphBottom = hud.bottom() - margin;
+    auto toPixels = [&] (int64_t ns) {
+        return std::min(graphHeight, static_cast<int>(graphHeight * (ns / 1000000.0) / graphMax_ms));
+    };
+
+    const int frames = g_frameStats.GetWindowCount();
+    for (int age = 0; age < frames; ++age) {
+        const FrameSample_t& sample = g_frameStats.GetSample(age);
+        const int column = hud.right() - margin - age;
+        int bottom = graphBottom;
+
+        auto stack = [&] (int64_t ns, const QColor& color) {
+            const int height = std::min(toPixels(ns), bottom - (graphBottom - graphHeight));
+            painter_p->fillRect(column, bottom - height, 1, height, color);
+            bottom -= height;
+        };
+
+        painter_p->fillRect(column, graphBottom - toPixels(sample.stage_ns[FRAME_STAGE_TOTAL_e]), 1,
+                            toPixels(sample.stage_ns[FRAME_STAGE_TOTAL_e]), QColor(0x80, 0x80, 0x80));
+        stack(sample.stage_ns[FRAME_STAGE_FILL_SCREEN_ROWS_e], QColor(0x40, 0x80, 0xff));
+
+        const int64_t missTime = std::min(sample.stage_ns[FRAME_STAGE_ROW_CACHE_MISS_e],
+                                          sample.stage_ns[FRAME_STAGE_DRAW_ROWS_e]);
+        stack(missTime, QColor(0xff, 0xa0, 0x20));
+        stack(sample.stage_ns[FRAME_STAGE_DRAW_ROWS_e] - missTime, QColor(0x40, 0xc0, 0x40));
+        stack(sample.stage_ns[FRAME_STAGE_ROCK_SCROLL_e], QColor(0xe0, 0x40, 0x40));
+    }
+
+    const int fpsLine = graphBottom - toPixels(16700000);
+    painter_p->setPen(QColor(Qt::white));
+    painter_p->drawLine(hud.left() + margin, fpsLine, hud.right() - margin, fpsLine);
+
+    painter_p->restore();
+}
+
 /***********************************************************************************************************************
 *   showEvent
 ***********************************************************************************************************************/
@@ -6522,6 +6635,9 @@ int CEditorWidget::GetScreenRowOffset(const int row)
 *
 * The rock scroll is the coloring on the right hand side, e.g. showing filter matches in relation to the total file.
 *
+* When there are more rows than rasters the rock scroll is resampled from the document rock scroll summary, built when
+* the packed FIRA was populated. Hence resizing or refreshing doesn't require to walk all rows again.
+*
 ***********************************************************************************************************************/
 void CEditorWidget::FillRockScroll(void)
 {
@@ -6556,13 +6672,18 @@ void CEditorWidget::FillRockScroll(void)
         m_rockScrollInfo.itemArraySize = m_vscrollFrame.height() + 100; /* MAX size */
     }
 
+    MemAcc_Set(MEM_ACC_ROCK_SCROLL_e,
+               static_cast<int64_t>(m_rockScroll_All.sizeInBytes() + m_rockScroll_Filtered.sizeInBytes()) +
+               static_cast<int64_t>(sizeof(RockScrollItem_t)) * m_rockScrollInfo.itemArraySize +
+               static_cast<int64_t>(doc_p->m_rockScrollSummary.GetMemorySize()));
+
     double deltaRasterPerRow;
     double rowsPerRaster;
     double y = 0.0;
     int next_y = 1;
     uint8_t bestLUT = 0;
-    int bestLUT_ref = 0;    /* Row, or packed FIR index in-case of PRESENTATION_MODE_ONLY_FILTERED_e */
     packed_FIR_t *packedFIR_p = &doc_p->m_database.packedFIRA_p[0];
+    const CRockScrollSummary& summary = doc_p->m_rockScrollSummary;
     rowsPerRaster = static_cast<double>(m_totalNumOfRows) / static_cast<double>(m_vscrollFrame.height());
 
     m_rockScrollInfo.rowsPerRaster = static_cast<int>(rowsPerRaster);
@@ -6577,46 +6698,43 @@ void CEditorWidget::FillRockScroll(void)
         m_rockScrollInfo.itemArray_p[0].startRow = packedFIR_p[0].row;
 
         if (rowsPerRaster > 1.0) {
-            /* More rows than rasters */
-            deltaRasterPerRow =
-                static_cast<double>(m_vscrollFrame.height()) / static_cast<double>(MAX_ITEM_INDEX - m_minFIRAIndex);
-
-            for (int index = m_minFIRAIndex; index < MAX_ITEM_INDEX; ++index) {
-                uint8_t currentLUT = packedFIR_p[index].LUT_index;
-
-                if ((bestLUT == 0) || (currentLUT < bestLUT)) {
-                    bestLUT = currentLUT;
-                    bestLUT_ref = index;
+            /* More rows than rasters, each raster presents the best filter among its range of packed FIR items */
+            const int NUM_RASTERS = m_vscrollFrame.height();
+            const double itemsPerRaster = static_cast<double>(MAX_ITEM_INDEX - m_minFIRAIndex) /
+                                          static_cast<double>(NUM_RASTERS);
+            double nextIndex = m_minFIRAIndex + itemsPerRaster;
+            int startIndex = m_minFIRAIndex;
+
+            for (int raster = 0; raster < NUM_RASTERS && startIndex < MAX_ITEM_INDEX; ++raster) {
+                int endIndex = raster == NUM_RASTERS - 1 ? MAX_ITEM_INDEX - 1 : static_cast<int>(nextIndex + 0.5) - 1;
+                nextIndex += itemsPerRaster;
+
+                if (endIndex < startIndex) {
+                    continue; /* less than one item in this raster */
+                }
+                if (endIndex >= MAX_ITEM_INDEX) {
+                    endIndex = MAX_ITEM_INDEX - 1;
                 }
 
-                if (static_cast<int>(y) >= next_y) {
-                    /* ensure that we get the last index
-                     * Enters here when we have reached as NEW section, now fill the color for the previous
-                     * Define Y and Height */
-                    if (bestLUT != 0) {
-                        if (next_y >= (m_vscrollFrame.height() - 1)) {
-                            next_y = m_vscrollFrame.height() - 1;
-                        }
+                auto best = summary.QueryPacked(packedFIR_p, startIndex, endIndex);
+                bestLUT = best.LUT;
 
-                        /* x. fill 1 line for previous saved section */
-                        Q_COLORREF color = doc_p->m_database.filterItem_LUT[bestLUT]->m_bg_color == BACKGROUND_COLOR ?
-                                           doc_p->m_database.filterItem_LUT[bestLUT]->m_color :
-                                           doc_p->m_database.filterItem_LUT[bestLUT]->m_bg_color;
+                if (bestLUT != 0) {
+                    Q_COLORREF color = doc_p->m_database.filterItem_LUT[bestLUT]->m_bg_color == BACKGROUND_COLOR ?
+                                       doc_p->m_database.filterItem_LUT[bestLUT]->m_color :
+                                       doc_p->m_database.filterItem_LUT[bestLUT]->m_bg_color;
 
-                        rs_painter.fillRect(0, next_y - 1, m_vscrollFrame.width(), 1, color);
+                    rs_painter.fillRect(0, raster, m_vscrollFrame.width(), 1, color);
 
-                        m_rockScrollInfo.itemArray_p[next_y - 1].color = color;
-                        m_rockScrollInfo.itemArray_p[next_y - 1].bestRow = packedFIR_p[bestLUT_ref].row;
-                        m_rockScrollInfo.itemArray_p[next_y - 1].y_line = next_y - 1;
-                        m_rockScrollInfo.itemArray_p[next_y - 1].endRow = packedFIR_p[index - 1].row;
-                        m_rockScrollInfo.itemArray_p[next_y].startRow = packedFIR_p[index].row;
-                        m_rockScrollInfo.numberOfItems++;
-                    }
-                    ++next_y;
-                    bestLUT = 0;
-                } /* if time to draw line */
-                y += deltaRasterPerRow;
-            } /* for each filter */
+                    m_rockScrollInfo.itemArray_p[raster].color = color;
+                    m_rockScrollInfo.itemArray_p[raster].bestRow = packedFIR_p[best.ref].row;
+                    m_rockScrollInfo.itemArray_p[raster].y_line = raster;
+                    m_rockScrollInfo.itemArray_p[raster].startRow = packedFIR_p[startIndex].row;
+                    m_rockScrollInfo.itemArray_p[raster].endRow = packedFIR_p[endIndex].row;
+                    m_rockScrollInfo.numberOfItems = raster + 1;
+                }
+                startIndex = endIndex + 1;
+            } /* for each raster */
 
 #ifdef _DEBUG
             if (m_rockScrollInfo.numberOfItems > m_vscrollFrame.height()) {
@@ -6712,45 +6830,40 @@ void CEditorWidget::FillRockScroll(void)
         } else {
             /* More rows than pixels */
             if ((doc_p->m_database.FIRA.filterMatches != 0) && (m_totalNumOfRows != 0) && g_cfg_p->m_rockSrollEnabled) {
+                /* Each raster presents the best filter among its rows, taken from the rock scroll summary */
+                const int NUM_RASTERS = m_vscrollFrame.height();
+                const FIR_t *FIR_Array_p = doc_p->m_database.FIRA.FIR_Array_p;
                 double nextRow = rowsPerRaster;
-                int nextRow_int = static_cast<int>(nextRow + 0.5);
-                int index = 0;
-
-                for (int row = 0; row < NUM_ROWS; ++row) {
-                    uint8_t currentLUT = doc_p->m_database.FIRA.FIR_Array_p[row].LUT_index;
-                    if ((bestLUT == 0) || ((currentLUT < bestLUT) && (currentLUT != 0))) {
-                        bestLUT = currentLUT;
-                        bestLUT_ref = row;
+                int startRow = 0;
+
+                for (int index = 0; index < NUM_RASTERS && startRow < NUM_ROWS; ++index) {
+                    /* make sure that last raster contains the final rows */
+                    int endRow = index == NUM_RASTERS - 1 ? NUM_ROWS - 1 : static_cast<int>(nextRow + 0.5);
+                    if (endRow >= NUM_ROWS) {
+                        endRow = NUM_ROWS - 1;
                     }
-                    if (row == nextRow_int) {
-                        Q_COLORREF color = BACKGROUND_COLOR;
+                    nextRow += rowsPerRaster;
 
-                        /* If bestLUT is 0 then there was not filtered row found for the searched rows. */
-                        if (bestLUT != 0) {
-                            m_rockScrollInfo.itemArray_p[index].bestRow = bestLUT_ref;
+                    auto best = summary.QueryRows(FIR_Array_p, startRow, endRow);
+                    bestLUT = best.LUT;
 
-                            color = doc_p->m_database.filterItem_LUT[bestLUT]->m_bg_color == BACKGROUND_COLOR ?
-                                    doc_p->m_database.filterItem_LUT[bestLUT]->m_color :
-                                    doc_p->m_database.filterItem_LUT[bestLUT]->m_bg_color;
+                    Q_COLORREF color = BACKGROUND_COLOR;
 
-                            rs_painter.fillRect(0, index, m_vscrollFrame.width(), 1, color);
-                            bestLUT = 0;
-                        }
-                        m_rockScrollInfo.itemArray_p[index].color = color;
-                        m_rockScrollInfo.itemArray_p[index].y_line = index;
-                        m_rockScrollInfo.itemArray_p[index].endRow = row;
-                        m_rockScrollInfo.itemArray_p[index + 1].startRow = row + 1;
-                        m_rockScrollInfo.numberOfItems++;
-                        nextRow += rowsPerRaster;
-                        nextRow_int = static_cast<int>(nextRow + 0.5);
-                        ++index;
-
-                        if (nextRow >= NUM_ROWS - 1) {
-                            /* make sure that last raster contains the final rows */
-                            nextRow = static_cast<double>(NUM_ROWS - 1);
-                            nextRow_int = static_cast<int>(nextRow + 0.5);
-                        }
+                    /* If bestLUT is 0 then there was not filtered row found for the searched rows. */
+                    if (bestLUT != 0) {
+                        color = doc_p->m_database.filterItem_LUT[bestLUT]->m_bg_color == BACKGROUND_COLOR ?
+                                doc_p->m_database.filterItem_LUT[bestLUT]->m_color :
+                                doc_p->m_database.filterItem_LUT[bestLUT]->m_bg_color;
+
+                        rs_painter.fillRect(0, index, m_vscrollFrame.width(), 1, color);
                     }
+                    m_rockScrollInfo.itemArray_p[index].bestRow = bestLUT != 0 ? best.ref : 0;
+                    m_rockScrollInfo.itemArray_p[index].color = color;
+                    m_rockScrollInfo.itemArray_p[index].y_line = index;
+                    m_rockScrollInfo.itemArray_p[index].startRow = startRow;
+                    m_rockScrollInfo.itemArray_p[index].endRow = endRow;
+                    m_rockScrollInfo.numberOfItems++;
+                    startRow = endRow + 1;
                 } /* for */
 #ifdef _DEBUG
                 if (m_rockScrollInfo.numberOfItems > m_vscrollFrame.height()) {
@@ -7411,6 +7524,17 @@ void CEditorWidget::keyPressEvent(QKeyEvent *e)
             EmptySelectionList(true);
             break;
 
+        case Qt::Key_F12:
+            if (m_CTRL_Pressed) {
+                TRACEX_D("CEditorWidget::keyPressEvent  CTRL-F12  Reset frame statistics")
+                g_frameStats.Reset();
+            } else {
+                TRACEX_D("CEditorWidget::keyPressEvent  F12  Toggle frame time HUD")
+                m_perfHUD = !m_perfHUD;
+            }
+            update();
+            break;
+
         case Qt::Key_F9:
             if (m_CTRL_Pressed) {
                 SetRowClip(false);
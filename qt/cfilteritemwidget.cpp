@@ -23,6 +23,7 @@ CFilterItemWidget::CFilterItemWidget(
     bool *caseSensitive_p,
     bool *exclude_p,
     bool *regExpr_p,
+    bool *expression_p,
     CCfgItem_Filters *filters_p,
     CCfgItem_Filter **filterSelection_pp,
     QWidget *pParent)
@@ -37,6 +38,7 @@ CFilterItemWidget::CFilterItemWidget(
     m_caseSensitive_p = caseSensitive_p;
     m_exclude_p = exclude_p;
     m_regExpr_p = regExpr_p;
+    m_expression_p = expression_p;
     m_filters_p = filters_p;
     m_filterSelection_pp = filterSelection_pp;
 
@@ -50,6 +52,7 @@ CFilterItemWidget::CFilterItemWidget(
     m_temp_caseSensitive = *m_caseSensitive_p;
     m_temp_exclude = *m_exclude_p;
     m_temp_regExpr = *m_regExpr_p;
+    m_temp_expression = *m_expression_p;
     m_temp_enabled = *m_enabled_p;
 
     setWindowTitle("Filter Item Editor");
@@ -84,6 +87,8 @@ CFilterItemWidget::CFilterItemWidget(
     ui->checkBox_exclude->setChecked(m_temp_exclude);
     ui->checkBox_matchCase->setChecked(m_temp_caseSensitive);
     ui->checkBox_regExpr->setChecked(m_temp_regExpr);
+    ui->checkBox_expression->setChecked(m_temp_expression);
+    ui->checkBox_regExpr->setDisabled(m_temp_expression);
 
     if (filterText_p->isEmpty()) {
         *filterText_p = QString("Add match string");
@@ -94,6 +99,7 @@ CFilterItemWidget::CFilterItemWidget(
 
 CFilterItemWidget::~CFilterItemWidget()
 {
+    GetTheDoc()->m_matchEstimator.Stop();
     delete ui;
 }
 
@@ -138,6 +144,7 @@ void CFilterItemWidget::on_buttonBox_accepted()
     *m_caseSensitive_p = m_temp_caseSensitive;
     *m_exclude_p = m_temp_exclude;
     *m_regExpr_p = m_temp_regExpr;
+    *m_expression_p = m_temp_expression;
     *m_enabled_p = m_temp_enabled;
 
     *m_colorRef_p = m_temp_color.rgb();
@@ -169,6 +176,7 @@ void CFilterItemWidget::on_checkBox_exclude_stateChanged(int arg1)
 void CFilterItemWidget::on_checkBox_matchCase_stateChanged(int arg1)
 {
     m_temp_caseSensitive = arg1 ? true : false;
+    startMatchEstimate();
 }
 
 /***********************************************************************************************************************
@@ -177,6 +185,18 @@ void CFilterItemWidget::on_checkBox_matchCase_stateChanged(int arg1)
 void CFilterItemWidget::on_checkBox_regExpr_stateChanged(int arg1)
 {
     m_temp_regExpr = arg1 ? true : false;
+    startMatchEstimate();
+}
+
+/***********************************************************************************************************************
+*   on_checkBox_expression_stateChanged
+*   The regular expressions of an expression are written as /.../, hence RegExpr doesn't apply
+***********************************************************************************************************************/
+void CFilterItemWidget::on_checkBox_expression_stateChanged(int arg1)
+{
+    m_temp_expression = arg1 ? true : false;
+    ui->checkBox_regExpr->setDisabled(m_temp_expression);
+    startMatchEstimate();
 }
 
 /***********************************************************************************************************************
@@ -221,6 +241,7 @@ void CFilterItemWidget::on_checkBox_enableBGColor_stateChanged(int arg1)
 void CFilterItemWidget::on_lineEdit_filterItemEdit_textChanged(const QString &arg1)
 {
     Q_UNUSED(arg1)
+    startMatchEstimate();
     repaint();
 }
 
@@ -231,3 +252,47 @@ void CFilterItemWidget::on_checkBox_enable_stateChanged(int arg1)
 {
     m_temp_enabled = arg1 ? true : false;
 }
+
+/***********************************************************************************************************************
+*   startMatchEstimate
+*   Restarted at each change of the filter item, the previous estimate is cancelled
+***********************************************************************************************************************/
+void CFilterItemWidget::startMatchEstimate(void)
+{
+    /* The sampled rows are matched one by one, an expression needs the rows around (WITHIN) */
+    if (m_temp_expression) {
+        GetTheDoc()->m_matchEstimator.Stop();
+        if (m_estimateTimer) {
+            m_estimateTimer->stop();
+        }
+        ui->label_estimate->clear();
+        return;
+    }
+
+    if (!GetTheDoc()->StartMatchEstimate(ui->lineEdit_filterItemEdit->text(), m_temp_regExpr,
+                                         m_temp_caseSensitive)) {
+        ui->label_estimate->clear();
+        return;
+    }
+
+    if (!m_estimateTimer) {
+        m_estimateTimer = std::make_unique<QTimer>(this);
+        connect(m_estimateTimer.get(), &QTimer::timeout, this, &CFilterItemWidget::onEstimateTimer);
+    }
+    m_estimateTimer->start(FILTER_ITEM_ESTIMATE_POLL_TIME);
+    onEstimateTimer();
+}
+
+/***********************************************************************************************************************
+*   onEstimateTimer
+***********************************************************************************************************************/
+void CFilterItemWidget::onEstimateTimer(void)
+{
+    const MatchEstimate_t estimate = GetTheDoc()->m_matchEstimator.GetEstimate();
+
+    ui->label_estimate->setText(MatchEstimate_ToString(estimate));
+
+    if (!estimate.running && m_estimateTimer) {
+        m_estimateTimer->stop();
+    }
+}
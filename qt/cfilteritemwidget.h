@@ -12,9 +12,14 @@
 #include <QDialog>
 #include <QComboBox>
 #include <QMouseEvent>
+#include <QTimer>
+
+#include <memory>
 
 #include <QDialog>
 
+#define FILTER_ITEM_ESTIMATE_POLL_TIME  30  /* ms, how often the estimated match count is checked */
+
 namespace Ui
 {
     class FilterItemEditor;
@@ -39,6 +44,7 @@ public:
         bool *caseSensitive_p,
         bool *exclude_p,
         bool *regExpr_p,
+        bool *expression_p,
         CCfgItem_Filters *filters_p,
         CCfgItem_Filter **filterSelection_pp,
         QWidget *pParent = nullptr);
@@ -53,11 +59,13 @@ public:
     bool *m_caseSensitive_p;
     bool *m_exclude_p;
     bool *m_regExpr_p;
+    bool *m_expression_p;
     QColor m_temp_color;
     QColor m_temp_bgColor;
     bool m_temp_caseSensitive;
     bool m_temp_exclude;
     bool m_temp_regExpr;
+    bool m_temp_expression;
     bool m_temp_enabled;
     CCfgItem_Filters *m_filters_p;
     CCfgItem_Filter **m_filterSelection_pp;
@@ -72,13 +80,18 @@ private slots:
     void on_checkBox_exclude_stateChanged(int arg1);
     void on_checkBox_matchCase_stateChanged(int arg1);
     void on_checkBox_regExpr_stateChanged(int arg1);
+    void on_checkBox_expression_stateChanged(int arg1);
     void on_pushButton_textColor_clicked();
     void on_pushButton_BGTextColor_clicked();
     void on_checkBox_enableBGColor_stateChanged(int arg1);
     void on_lineEdit_filterItemEdit_textChanged(const QString &arg1);
 
     void on_checkBox_enable_stateChanged(int arg1);
+    void onEstimateTimer(void);
 
 private:
+    void startMatchEstimate(void);
+
     Ui::FilterItemEditor *ui;
+    std::unique_ptr<QTimer> m_estimateTimer;
 };
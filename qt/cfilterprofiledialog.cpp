@@ -0,0 +1,97 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "cfilterprofiledialog.h"
+
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+typedef enum {
+    FILTER_PROFILE_COLUMN_PRIORITY,
+    FILTER_PROFILE_COLUMN_TEXT,
+    FILTER_PROFILE_COLUMN_EVALUATIONS,
+    FILTER_PROFILE_COLUMN_MATCHES,
+    FILTER_PROFILE_COLUMN_SELECTIVITY,
+    FILTER_PROFILE_COLUMN_TIME,
+    FILTER_PROFILE_COLUMN_TIME_PER_EVALUATION,
+    FILTER_PROFILE_COLUMNS
+} FilterProfileColumn_e;
+
+/***********************************************************************************************************************
+*   _numericItem
+*   The value is stored as data, not as text, such that the column sorts numerically
+***********************************************************************************************************************/
+static QTableWidgetItem *_numericItem(const QVariant& value)
+{
+    auto item_p = new QTableWidgetItem();
+    item_p->setData(Qt::DisplayRole, value);
+    item_p->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item_p;
+}
+
+/***********************************************************************************************************************
+*   CFilterProfileDialog
+***********************************************************************************************************************/
+CFilterProfileDialog::CFilterProfileDialog(const QList<CFilterItem *>& filterItems, QWidget *parent_p)
+    : QDialog(parent_p)
+{
+    setWindowTitle(QString("Filter Profile"));
+    resize(900, 500);
+
+    auto table_p = new QTableWidget(filterItems.count(), FILTER_PROFILE_COLUMNS, this);
+    table_p->setHorizontalHeaderLabels(QStringList() << "Priority" << "Filter item" << "Evaluations" << "Matches"
+                                                     << "Matches (%)" << "Time (ms)" << "Time/evaluation (ns)");
+    table_p->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table_p->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table_p->verticalHeader()->setVisible(false);
+
+    double totalTime = 0.0;
+    int row = 0;
+
+    for (auto& filterItem_p : filterItems) {
+        const FilterItemProfile_t& profile = filterItem_p->m_profile;
+        const double time = FilterItemProfile_EstimatedTime(profile);
+        const double selectivity = profile.evaluations == 0 ? 0.0 :
+                                   100.0 * static_cast<double>(profile.matches) / profile.evaluations;
+        const double timePerEvaluation = profile.sampledEvaluations == 0 ? 0.0 :
+                                         static_cast<double>(profile.sampledTime) / profile.sampledEvaluations;
+
+        auto textItem_p = new QTableWidgetItem(QString::fromLatin1(filterItem_p->m_start_p, filterItem_p->m_size));
+        textItem_p->setForeground(QBrush(QColor(filterItem_p->m_color)));
+
+        table_p->setItem(row, FILTER_PROFILE_COLUMN_PRIORITY, _numericItem(row + 1));
+        table_p->setItem(row, FILTER_PROFILE_COLUMN_TEXT, textItem_p);
+        table_p->setItem(row, FILTER_PROFILE_COLUMN_EVALUATIONS,
+                         _numericItem(static_cast<qlonglong>(profile.evaluations)));
+        table_p->setItem(row, FILTER_PROFILE_COLUMN_MATCHES, _numericItem(static_cast<qlonglong>(profile.matches)));
+        table_p->setItem(row, FILTER_PROFILE_COLUMN_SELECTIVITY, _numericItem(qRound(selectivity * 100.0) / 100.0));
+        table_p->setItem(row, FILTER_PROFILE_COLUMN_TIME, _numericItem(qRound64(time / 1000.0) / 1000.0));
+        table_p->setItem(row, FILTER_PROFILE_COLUMN_TIME_PER_EVALUATION, _numericItem(qRound(timePerEvaluation)));
+
+        totalTime += time;
+        ++row;
+    }
+
+    table_p->setSortingEnabled(true);
+    table_p->sortItems(FILTER_PROFILE_COLUMN_TIME, Qt::DescendingOrder);
+    table_p->horizontalHeader()->setSectionResizeMode(FILTER_PROFILE_COLUMN_TEXT, QHeaderView::Stretch);
+
+    auto summary_p = new QLabel(QString("%1 filter items, ~%2 ms matching in total (timed on every %3th row). "
+                                        "An item is only evaluated on the rows no item before it matched.")
+                                    .arg(filterItems.count()).arg(totalTime / 1000000.0, 0, 'f', 1)
+                                    .arg(FILTER_PROFILE_SAMPLE_ROWS), this);
+    summary_p->setWordWrap(true);
+
+    auto buttonBox_p = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(buttonBox_p, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    auto layout_p = new QVBoxLayout(this);
+    layout_p->addWidget(summary_p);
+    layout_p->addWidget(table_p);
+    layout_p->addWidget(buttonBox_p);
+}
@@ -0,0 +1,27 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include "CFilter.h"
+
+#include <QDialog>
+#include <QList>
+
+/***********************************************************************************************************************
+*   CFilterProfileDialog
+*
+*   Report of the filter item profiles from the last filtering, one row per filter item in priority order. The columns
+*   are sortable, initially sorted on the estimated time such that the most expensive filter items are on top.
+***********************************************************************************************************************/
+class CFilterProfileDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    CFilterProfileDialog() = delete;
+    CFilterProfileDialog(const QList<CFilterItem *>& filterItems, QWidget *parent_p = nullptr);
+    virtual ~CFilterProfileDialog() override {}
+};
@@ -0,0 +1,243 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "cframestats.h"
+#include "CDebug.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+CFrameStats g_frameStats;
+
+/* Upper limits of the histogram buckets, the last bucket has no limit. 16.7 and 33.3 ms are 60 and 30 fps */
+static const double g_bucketLimits_ms[FRAME_STATS_BUCKETS - 1] = {4.0, 8.0, 16.7, 33.3, 50.0, 100.0};
+
+static const char *g_stageNames[FRAME_STAGE_COUNT_e] = {
+    "total", "fill_screen_rows", "draw_rows", "row_cache_miss", "decode", "rock_scroll"
+};
+
+/***********************************************************************************************************************
+*   _ms
+***********************************************************************************************************************/
+static inline double _ms(int64_t ns)
+{
+    return static_cast<double>(ns) / 1000000.0;
+}
+
+/***********************************************************************************************************************
+*   Reset
+***********************************************************************************************************************/
+void CFrameStats::Reset(void)
+{
+    memset(m_history, 0, sizeof(m_history));
+    memset(&m_current, 0, sizeof(m_current));
+    memset(&m_frameStartRowCache, 0, sizeof(m_frameStartRowCache));
+    memset(m_buckets, 0, sizeof(m_buckets));
+    memset(m_totals_ns, 0, sizeof(m_totals_ns));
+    m_frames = 0;
+    m_totalMax_ns = 0;
+    m_totalRowCacheMisses = 0;
+    m_writeIndex = 0;
+    m_inFrame = false;
+}
+
+/***********************************************************************************************************************
+*   BeginFrame
+***********************************************************************************************************************/
+void CFrameStats::BeginFrame(const RowCacheStats_t *rowCacheStats_p)
+{
+    memset(&m_current, 0, sizeof(m_current));
+
+    if (rowCacheStats_p != nullptr) {
+        m_frameStartRowCache = *rowCacheStats_p;
+    } else {
+        memset(&m_frameStartRowCache, 0, sizeof(m_frameStartRowCache));
+    }
+
+    m_inFrame = true;
+    m_frameTimer.start();
+}
+
+/***********************************************************************************************************************
+*   EndFrame
+***********************************************************************************************************************/
+void CFrameStats::EndFrame(const RowCacheStats_t *rowCacheStats_p)
+{
+    if (!m_inFrame) {
+        return;
+    }
+
+    m_inFrame = false;
+    m_current.stage_ns[FRAME_STAGE_TOTAL_e] = m_frameTimer.nsecsElapsed();
+
+    /* The row cache counters are running, only the difference over the frame counts */
+    if (rowCacheStats_p != nullptr) {
+        m_current.rowCacheMisses = rowCacheStats_p->misses - m_frameStartRowCache.misses;
+        m_current.rowCacheHits = rowCacheStats_p->hits - m_frameStartRowCache.hits;
+        m_current.stage_ns[FRAME_STAGE_ROW_CACHE_MISS_e] =
+            rowCacheStats_p->missTime_ns - m_frameStartRowCache.missTime_ns;
+        m_current.stage_ns[FRAME_STAGE_DECODE_e] = rowCacheStats_p->decodeTime_ns - m_frameStartRowCache.decodeTime_ns;
+    }
+
+    m_history[m_writeIndex] = m_current;
+    m_writeIndex = (m_writeIndex + 1) % FRAME_STATS_HISTORY;
+    ++m_frames;
+
+    for (int stage = 0; stage < FRAME_STAGE_COUNT_e; ++stage) {
+        m_totals_ns[stage] += m_current.stage_ns[stage];
+    }
+
+    m_totalRowCacheMisses += m_current.rowCacheMisses;
+    m_totalMax_ns = std::max(m_totalMax_ns, m_current.stage_ns[FRAME_STAGE_TOTAL_e]);
+
+    const double total_ms = _ms(m_current.stage_ns[FRAME_STAGE_TOTAL_e]);
+    int bucket = 0;
+    while (bucket < FRAME_STATS_BUCKETS - 1 && total_ms >= g_bucketLimits_ms[bucket]) {
+        ++bucket;
+    }
+    ++m_buckets[bucket];
+}
+
+/***********************************************************************************************************************
+*   GetSample
+***********************************************************************************************************************/
+const FrameSample_t& CFrameStats::GetSample(int age) const
+{
+    return m_history[(m_writeIndex - 1 - age + 2 * FRAME_STATS_HISTORY) % FRAME_STATS_HISTORY];
+}
+
+/***********************************************************************************************************************
+*   GetSummary
+***********************************************************************************************************************/
+FrameStageSummary_t CFrameStats::GetSummary(FrameStage_e stage) const
+{
+    FrameStageSummary_t summary = {};
+    const int count = GetWindowCount();
+
+    if (count == 0) {
+        return summary;
+    }
+
+    std::vector<int64_t> times;
+    times.reserve(static_cast<size_t>(count));
+
+    int64_t sum = 0;
+    for (int age = 0; age < count; ++age) {
+        times.push_back(GetSample(age).stage_ns[stage]);
+        sum += times.back();
+    }
+
+    summary.last_ms = _ms(times.front());
+    summary.avg_ms = _ms(sum) / count;
+
+    std::sort(times.begin(), times.end());
+
+    auto percentile = [&] (int percent) {
+        return _ms(times[static_cast<size_t>(((count - 1) * percent + 50) / 100)]);
+    };
+
+    summary.p50_ms = percentile(50);
+    summary.p95_ms = percentile(95);
+    summary.p99_ms = percentile(99);
+    summary.max_ms = _ms(times.back());
+
+    return summary;
+}
+
+/***********************************************************************************************************************
+*   GetBucketLabel
+***********************************************************************************************************************/
+QString CFrameStats::GetBucketLabel(int bucket)
+{
+    if (bucket < FRAME_STATS_BUCKETS - 1) {
+        return QString("<%1").arg(g_bucketLimits_ms[bucket]);
+    }
+    return QString(">=%1").arg(g_bucketLimits_ms[FRAME_STATS_BUCKETS - 2]);
+}
+
+/***********************************************************************************************************************
+*   GetStageName
+***********************************************************************************************************************/
+const char *CFrameStats::GetStageName(FrameStage_e stage)
+{
+    return g_stageNames[stage];
+}
+
+/***********************************************************************************************************************
+*   ExportJson
+*
+*   The percentiles are over the rolling window, the histogram, the averages and the max over all frames since the
+*   last reset. The window samples are included as well, in microseconds, oldest first.
+***********************************************************************************************************************/
+bool CFrameStats::ExportJson(const QString& fileName) const
+{
+    QJsonObject root;
+    root["frames"] = static_cast<qint64>(m_frames);
+    root["window_frames"] = GetWindowCount();
+    root["row_cache_misses"] = static_cast<qint64>(m_totalRowCacheMisses);
+    root["max_frame_ms"] = _ms(m_totalMax_ns);
+
+    QJsonObject stages;
+    for (int stage = 0; stage < FRAME_STAGE_COUNT_e; ++stage) {
+        const FrameStageSummary_t summary = GetSummary(static_cast<FrameStage_e>(stage));
+        QJsonObject stageObject;
+        stageObject["avg_ms"] = m_frames == 0 ? 0.0 : _ms(m_totals_ns[stage]) / m_frames;
+        stageObject["window_avg_ms"] = summary.avg_ms;
+        stageObject["p50_ms"] = summary.p50_ms;
+        stageObject["p95_ms"] = summary.p95_ms;
+        stageObject["p99_ms"] = summary.p99_ms;
+        stageObject["window_max_ms"] = summary.max_ms;
+        stages[g_stageNames[stage]] = stageObject;
+    }
+    root["stages"] = stages;
+
+    QJsonArray histogram;
+    for (int bucket = 0; bucket < FRAME_STATS_BUCKETS; ++bucket) {
+        QJsonObject bucketObject;
+        bucketObject["frame_ms"] = GetBucketLabel(bucket);
+        bucketObject["frames"] = static_cast<qint64>(m_buckets[bucket]);
+        histogram.append(bucketObject);
+    }
+    root["histogram"] = histogram;
+
+    QJsonArray columns;
+    for (int stage = 0; stage < FRAME_STAGE_COUNT_e; ++stage) {
+        columns.append(QString("%1_us").arg(g_stageNames[stage]));
+    }
+    columns.append(QString("row_cache_misses"));
+    columns.append(QString("row_cache_hits"));
+    root["sample_columns"] = columns;
+
+    QJsonArray samples;
+    for (int age = GetWindowCount() - 1; age >= 0; --age) {
+        const FrameSample_t& sample = GetSample(age);
+        QJsonArray sampleArray;
+        for (int stage = 0; stage < FRAME_STAGE_COUNT_e; ++stage) {
+            sampleArray.append(static_cast<qint64>(sample.stage_ns[stage] / 1000));
+        }
+        sampleArray.append(static_cast<qint64>(sample.rowCacheMisses));
+        sampleArray.append(static_cast<qint64>(sample.rowCacheHits));
+        samples.append(sampleArray);
+    }
+    root["samples"] = samples;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        TRACEX_W(QString("Failed to write the frame statistics to %1").arg(fileName))
+        return false;
+    }
+
+    file.write(QJsonDocument(root).toJson());
+    file.close();
+
+    TRACEX_I(QString("Frame statistics, %1 frames, written to %2").arg(static_cast<qlonglong>(m_frames)).arg(fileName))
+    return true;
+}
@@ -0,0 +1,110 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+#include <QElapsedTimer>
+#include <QString>
+
+#include "CRowCache.h"
+
+#define FRAME_STATS_HISTORY         256     /* Frames in the rolling window, percentiles and the HUD graph */
+#define FRAME_STATS_BUCKETS         7       /* Frame time histogram, <4, <8, <16.7, <33.3, <50, <100 and >=100 ms */
+#define FRAME_STATS_ENV_VARIABLE    "LOGSCRUTINIZER_FRAME_STATS"  /* Frame statistics exported to this file at exit */
+
+typedef enum {
+    FRAME_STAGE_TOTAL_e,            /* The whole OnDraw */
+    FRAME_STAGE_FILL_SCREEN_ROWS_e,
+    FRAME_STAGE_DRAW_ROWS_e,
+    FRAME_STAGE_ROW_CACHE_MISS_e,   /* Part of the other stages, mostly DrawRows */
+    FRAME_STAGE_DECODE_e,           /* Part of the row cache misses */
+    FRAME_STAGE_ROCK_SCROLL_e,
+    FRAME_STAGE_COUNT_e
+} FrameStage_e;
+
+typedef struct {
+    int64_t stage_ns[FRAME_STAGE_COUNT_e];
+    int64_t rowCacheMisses;
+    int64_t rowCacheHits;
+} FrameSample_t;
+
+typedef struct {
+    double last_ms;
+    double avg_ms;
+    double p50_ms;
+    double p95_ms;
+    double p99_ms;
+    double max_ms;
+} FrameStageSummary_t;
+
+/***********************************************************************************************************************
+*   CFrameStats
+*
+*   Timing of the editor frames (CEditorWidget::OnDraw), split into the stages of the frame. The last
+*   FRAME_STATS_HISTORY frames are kept for the percentiles and the HUD (F12 in the editor), while the frame time
+*   histogram and the totals count all frames since the last reset. Always collected, it is a handful of clock reads
+*   per frame, such that the counters can be exported after e.g. an automated scroll benchmark.
+***********************************************************************************************************************/
+class CFrameStats
+{
+public:
+    CFrameStats() {Reset();}
+
+    void Reset(void);
+
+    /* rowCacheStats_p may be nullptr if there is no document */
+    void BeginFrame(const RowCacheStats_t *rowCacheStats_p);
+    void EndFrame(const RowCacheStats_t *rowCacheStats_p);
+
+    /****/
+    void BeginStage(FrameStage_e stage) {m_stageTimer[stage].start();}
+
+    /****/
+    void EndStage(FrameStage_e stage) {m_current.stage_ns[stage] += m_stageTimer[stage].nsecsElapsed();}
+
+    /* Summary of a stage over the rolling window */
+    FrameStageSummary_t GetSummary(FrameStage_e stage) const;
+
+    /* Sample age 0 is the last frame, up to GetWindowCount() - 1 */
+    const FrameSample_t& GetSample(int age) const;
+
+    /****/
+    int GetWindowCount(void) const
+    {
+        return m_frames < FRAME_STATS_HISTORY ? static_cast<int>(m_frames) : FRAME_STATS_HISTORY;
+    }
+
+    /****/
+    int64_t GetFrameCount(void) const {return m_frames;}
+
+    /****/
+    int64_t GetBucketCount(int bucket) const {return m_buckets[bucket];}
+
+    /* Label of a histogram bucket, e.g. "<16.7" or ">=100" */
+    static QString GetBucketLabel(int bucket);
+
+    static const char *GetStageName(FrameStage_e stage);
+
+    /* Write the statistics as JSON, returns false if the file couldn't be written */
+    bool ExportJson(const QString& fileName) const;
+
+private:
+    FrameSample_t m_history[FRAME_STATS_HISTORY];
+    FrameSample_t m_current;
+    RowCacheStats_t m_frameStartRowCache;   /* Row cache counters at the start of the frame */
+    QElapsedTimer m_frameTimer;
+    QElapsedTimer m_stageTimer[FRAME_STAGE_COUNT_e];
+    int64_t m_frames;
+    int64_t m_buckets[FRAME_STATS_BUCKETS];
+    int64_t m_totals_ns[FRAME_STAGE_COUNT_e];
+    int64_t m_totalMax_ns;
+    int64_t m_totalRowCacheMisses;
+    int m_writeIndex;
+    bool m_inFrame;
+};
+
+extern CFrameStats g_frameStats;
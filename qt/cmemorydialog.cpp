@@ -0,0 +1,116 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "cmemorydialog.h"
+#include "CMemAccounting.h"
+
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+typedef enum {
+    MEMORY_COLUMN_SUBSYSTEM,
+    MEMORY_COLUMN_RESIDENT,
+    MEMORY_COLUMN_PEAK_RESIDENT,
+    MEMORY_COLUMN_MAPPED,
+    MEMORY_COLUMN_PEAK_MAPPED,
+    MEMORY_COLUMNS
+} MemoryColumn_e;
+
+/***********************************************************************************************************************
+*   _MBItem
+***********************************************************************************************************************/
+static QTableWidgetItem *_MBItem(int64_t bytes)
+{
+    auto item_p = new QTableWidgetItem(QString::number(static_cast<double>(bytes) / (1024.0 * 1024.0), 'f', 1));
+    item_p->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item_p;
+}
+
+/***********************************************************************************************************************
+*   CMemoryDialog
+***********************************************************************************************************************/
+CMemoryDialog::CMemoryDialog(QWidget *parent_p)
+    : QDialog(parent_p)
+{
+    setWindowTitle(QString("Memory Usage"));
+    resize(700, 350);
+
+    /* One row per subsystem and the total */
+    m_table_p = new QTableWidget(MEM_ACC_COUNT_e + 1, MEMORY_COLUMNS, this);
+    m_table_p->setHorizontalHeaderLabels(QStringList() << "Subsystem" << "Resident (MB)" << "Peak resident (MB)"
+                                                       << "Mapped (MB)" << "Peak mapped (MB)");
+    m_table_p->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table_p->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table_p->verticalHeader()->setVisible(false);
+    m_table_p->horizontalHeader()->setSectionResizeMode(MEMORY_COLUMN_SUBSYSTEM, QHeaderView::Stretch);
+
+    m_summary_p = new QLabel(this);
+    m_summary_p->setWordWrap(true);
+
+    auto buttonBox_p = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    auto refreshButton_p = buttonBox_p->addButton(QString("Refresh"), QDialogButtonBox::ActionRole);
+    connect(refreshButton_p, &QPushButton::clicked, this, &CMemoryDialog::Fill);
+    connect(buttonBox_p, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    auto layout_p = new QVBoxLayout(this);
+    layout_p->addWidget(m_summary_p);
+    layout_p->addWidget(m_table_p);
+    layout_p->addWidget(buttonBox_p);
+
+    Fill();
+}
+
+/***********************************************************************************************************************
+*   Fill
+***********************************************************************************************************************/
+void CMemoryDialog::Fill(void)
+{
+    MemAcc_Refresh();
+
+    MemAccCounters_t total = {};
+
+    for (int subsystem = 0; subsystem < MEM_ACC_COUNT_e; ++subsystem) {
+        const MemAccCounters_t counters = MemAcc_Get(static_cast<MemAccSubsystem_e>(subsystem));
+
+        m_table_p->setItem(subsystem, MEMORY_COLUMN_SUBSYSTEM,
+                           new QTableWidgetItem(QString(MemAcc_GetName(static_cast<MemAccSubsystem_e>(subsystem)))));
+        m_table_p->setItem(subsystem, MEMORY_COLUMN_RESIDENT, _MBItem(counters.resident));
+        m_table_p->setItem(subsystem, MEMORY_COLUMN_PEAK_RESIDENT, _MBItem(counters.peakResident));
+        m_table_p->setItem(subsystem, MEMORY_COLUMN_MAPPED, _MBItem(counters.mapped));
+        m_table_p->setItem(subsystem, MEMORY_COLUMN_PEAK_MAPPED, _MBItem(counters.peakMapped));
+
+        total.resident += counters.resident;
+        total.mapped += counters.mapped;
+
+        /* The subsystems peak at different times, the sum of the peaks is an upper limit */
+        total.peakResident += counters.peakResident;
+        total.peakMapped += counters.peakMapped;
+    }
+
+    auto totalItem_p = new QTableWidgetItem(QString("Total"));
+    QFont font = totalItem_p->font();
+    font.setBold(true);
+    totalItem_p->setFont(font);
+
+    m_table_p->setItem(MEM_ACC_COUNT_e, MEMORY_COLUMN_SUBSYSTEM, totalItem_p);
+    m_table_p->setItem(MEM_ACC_COUNT_e, MEMORY_COLUMN_RESIDENT, _MBItem(total.resident));
+    m_table_p->setItem(MEM_ACC_COUNT_e, MEMORY_COLUMN_PEAK_RESIDENT, _MBItem(total.peakResident));
+    m_table_p->setItem(MEM_ACC_COUNT_e, MEMORY_COLUMN_MAPPED, _MBItem(total.mapped));
+    m_table_p->setItem(MEM_ACC_COUNT_e, MEMORY_COLUMN_PEAK_MAPPED, _MBItem(total.peakMapped));
+
+    const int64_t budget = MemAcc_GetBudget();
+    if (budget == 0) {
+        m_summary_p->setText(QString("No memory budget (MEMORY_BUDGET in the settings). Mapped memory is backed by "
+                                     "the TIA and FIRA files, the OS pages it in and out as needed."));
+    } else {
+        m_summary_p->setText(QString("Memory budget %1 MB, %2 MB resident%3. The budget limits the resident memory, "
+                                     "the mapped memory is backed by the TIA and FIRA files.")
+                                 .arg(static_cast<qlonglong>(budget / (1024 * 1024)))
+                                 .arg(static_cast<double>(total.resident) / (1024.0 * 1024.0), 0, 'f', 1)
+                                 .arg(total.resident > budget ? QString(" (over budget)") : QString()));
+    }
+}
@@ -0,0 +1,31 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include <QDialog>
+#include <QLabel>
+#include <QTableWidget>
+
+/***********************************************************************************************************************
+*   CMemoryDialog
+*
+*   The memory accounting (CMemAccounting) per subsystem, the current and peak resident and mapped memory, together
+*   with the memory budget. Refresh measures the subsystems again.
+***********************************************************************************************************************/
+class CMemoryDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit CMemoryDialog(QWidget *parent_p = nullptr);
+    virtual ~CMemoryDialog() override {}
+
+private:
+    void Fill(void);
+
+    QTableWidget *m_table_p;
+    QLabel *m_summary_p;
+};
@@ -10,6 +10,7 @@
 #include "CDebug.h"
 #include "cplotpane.h"
 #include "CConfig.h"
+#include "CMemAccounting.h"
 #include "globals.h"
 #include "utils.h"
 
@@ -37,6 +38,14 @@ CSubPlotSurface *g_currentShadowCopy = nullptr; /* Used as temp storage for copy
 CThreadManager *g_CPlotPane_ThreadMananger_p = nullptr;
 CPlot *CPlotPane_GetPlotFocus(void);
 
+/***********************************************************************************************************************
+*   CPlotPane_GetByteStreamSize
+***********************************************************************************************************************/
+static int64_t CPlotPane_GetByteStreamSize(void)
+{
+    return g_CPlotPane != nullptr ? g_CPlotPane->getByteStreamSize() : 0;
+}
+
 /***********************************************************************************************************************
 *   CPlotPane_GetPlotPane
 ***********************************************************************************************************************/
@@ -290,6 +299,9 @@ CPlotPane::CPlotPane(QWidget *parent) : QTabWidget(parent)
 
     g_CPlotPane_ThreadMananger_p = &m_threadManager;
     g_CPlotPane = this;
+
+    /* The byte streams are allocated by the plugins, hence measured when the memory accounting is refreshed */
+    MemAcc_SetRefresh(MEM_ACC_PLOT_e, CPlotPane_GetByteStreamSize);
 }
 
 CPlotPane::~CPlotPane()
@@ -303,6 +315,8 @@ CPlotPane::~CPlotPane()
     IF_NOT_NULL_DELETE_AND_SET_NULL(g_plotWnd_focusPen_p)
     IF_NOT_NULL_DELETE_AND_SET_NULL(g_plotWnd_passiveFocusPen_p)
 
+    MemAcc_SetRefresh(MEM_ACC_PLOT_e, nullptr);
+    MemAcc_Set(MEM_ACC_PLOT_e, 0);
     g_CPlotPane = nullptr;
 
     g_CPlotPane_ThreadMananger_p = nullptr;
@@ -445,6 +459,43 @@ CPlotWidgetInterface *CPlotPane::addPlot(const char *plotName_p, CPlot *plot_p)
     return pwi_p;
 }
 
+/***********************************************************************************************************************
+*   getByteStreamSize
+***********************************************************************************************************************/
+int64_t CPlotPane::getByteStreamSize(void)
+{
+    int64_t size = 0;
+
+    for (auto& plotWidget_p : m_plotWnds) {
+        CList_LSZ *subPlotList_p;
+        if (!plotWidget_p->GetPlotRef()->GetSubPlots(&subPlotList_p)) {
+            continue;
+        }
+
+        auto subPlot_p = reinterpret_cast<CSubPlot *>(subPlotList_p->first());
+        while (subPlot_p != nullptr) {
+            CList_LSZ *graphList_p;
+            if (subPlot_p->GetGraphs(&graphList_p)) {
+                auto graph_p = reinterpret_cast<CGraph_Internal *>(graphList_p->first());
+                while (graph_p != nullptr) {
+                    size += graph_p->GetByteStreamSize();
+                    graph_p = reinterpret_cast<CGraph_Internal *>(graphList_p->GetNext(graph_p));
+                }
+            }
+
+            CDecorator *decorator_p;
+            subPlot_p->GetDecorator(&decorator_p);
+            if (decorator_p != nullptr) {
+                size += decorator_p->GetByteStreamSize();
+            }
+
+            subPlot_p = reinterpret_cast<CSubPlot *>(subPlotList_p->GetNext(subPlot_p));
+        }
+    }
+
+    return size;
+}
+
 /***********************************************************************************************************************
 *   removePlot
 ***********************************************************************************************************************/
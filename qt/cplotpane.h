@@ -66,6 +66,8 @@ public:
     void align_Reset_Zoom(void);
     void align_X_Cursor(double cursorTime, double x_min, double x_max);
 
+    int64_t getByteStreamSize(void); /* Memory allocated by the graphs of all plots, see CMemAccounting */
+
 public:
     virtual ~CPlotPane() override;
 
@@ -16,7 +16,9 @@
 #include "CWorkspace_cb_if.h"
 #include "cplotpane_cb_if.h"
 #include "utils.h"
+#include "CTrace.h"
 #include "../processing/CThread.h"
+#include "CPerThreadArray.h"
 
 #include <QOpenGLWidget>
 #include <QPaintEvent>
@@ -47,7 +49,7 @@ typedef struct {
     CSubPlotSurface *subplotSurface_p;
 } OnPaint_Data_t;
 
-static OnPaint_Data_t g_onPaint_WorkData[MAX_NUM_OF_THREADS];
+static CPerThreadArray<OnPaint_Data_t> g_onPaint_WorkData; /* Grown to the threads used */
 void OnPaint_ThreadAction(volatile void *data_p);
 
 CPlotWidgetInterface::~CPlotWidgetInterface() {} /* for vtable impl. */
@@ -247,6 +249,7 @@ bool CPlotWidget::event(QEvent *event)
 void CPlotWidget::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event)
+    TRACE_SPAN("Plot paint")
 
     LS_Painter originalPainter(this);
     static bool inPaintEvent = false;
@@ -521,6 +524,8 @@ void CPlotWidget::DrawSubPlots(void)
     int threadIndex = 0;
     QRect tempRect;
 
+    g_onPaint_WorkData.Grow(threadCount);
+
     if (!m_surfaces.isEmpty()) {
         for (auto& surface_p : m_surfaces) {
             surface_p->GetWindowRect(&tempRect);
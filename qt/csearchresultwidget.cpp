@@ -0,0 +1,168 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "csearchresultwidget.h"
+#include "CLogScrutinizerDoc.h"
+#include "ceditorwidget_cb_if.h"
+#include "CProgressCtrl.h"
+
+#include "CDebug.h"
+#include "globals.h"
+
+#include <QVBoxLayout>
+
+/***********************************************************************************************************************
+*   CSearchResultModel
+***********************************************************************************************************************/
+CSearchResultModel::CSearchResultModel(QObject *parent) : QAbstractListModel(parent)
+{}
+
+/***********************************************************************************************************************
+*   rowCount
+***********************************************************************************************************************/
+int CSearchResultModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_count;
+}
+
+/***********************************************************************************************************************
+*   data
+***********************************************************************************************************************/
+QVariant CSearchResultModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || (index.row() >= m_count) || (role != Qt::DisplayRole)) {
+        return QVariant();
+    }
+
+    auto doc_p = GetTheDoc();
+    const SearchHit_t& hit = doc_p->m_searchResults.Get(index.row());
+    QString text = QString("%1: ").arg(hit.row);
+
+    /* The log file is shared with the search threads, the row text is only read when the search is done. The text is
+     * read straight from the file to not thrash the row cache used by the editor. */
+    if (!g_processingCtrl_p->isProcessing() && !CSZ_DB_PendingUpdate && (hit.row < doc_p->m_database.TIA.rows)) {
+        const TI_t& TI = doc_p->m_database.TIA.textItemArray_p[hit.row];
+        const int size = TI.size < SEARCH_RESULT_MAX_ROW_TEXT ? TI.size : SEARCH_RESULT_MAX_ROW_TEXT;
+        char buffer[SEARCH_RESULT_MAX_ROW_TEXT];
+
+        if ((size > 0) && doc_p->m_rowCache_p->rawFromFile(TI.fileIndex, size, buffer)) {
+            text += QString::fromLatin1(buffer, size);
+        }
+    }
+
+    return text;
+}
+
+/***********************************************************************************************************************
+*   poll
+***********************************************************************************************************************/
+void CSearchResultModel::poll(void)
+{
+    const CSearchResults& results = GetTheDoc()->m_searchResults;
+    const int generation = results.GetGeneration();
+    const int count = results.GetCount();
+
+    if (generation != m_generation) {
+        beginResetModel();
+        m_generation = generation;
+        m_count = count;
+        endResetModel();
+    } else if (count > m_count) {
+        beginInsertRows(QModelIndex(), m_count, count - 1);
+        m_count = count;
+        endInsertRows();
+    }
+}
+
+/***********************************************************************************************************************
+*   CSearchResultWidget
+***********************************************************************************************************************/
+CSearchResultWidget::CSearchResultWidget(QWidget *parent) : QWidget(parent)
+{
+    auto layout_p = new QVBoxLayout(this);
+
+    m_label_p = new QLabel(this);
+    m_listView_p = new QListView(this);
+    m_listView_p->setModel(&m_model);
+    m_listView_p->setUniformItemSizes(true); /* Required for the view to not query every item */
+    m_listView_p->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    layout_p->addWidget(m_label_p);
+    layout_p->addWidget(m_listView_p);
+
+    connect(m_listView_p, &QListView::activated, this, &CSearchResultWidget::onActivated);
+    connect(m_listView_p, &QListView::doubleClicked, this, &CSearchResultWidget::onActivated);
+
+    m_timer = std::make_unique<QTimer>(this);
+    connect(m_timer.get(), &QTimer::timeout, this, &CSearchResultWidget::onTimer);
+    m_timer->start(SEARCH_RESULT_POLL_TIME);
+
+    updateLabel();
+}
+
+/***********************************************************************************************************************
+*   onTimer
+***********************************************************************************************************************/
+void CSearchResultWidget::onTimer(void)
+{
+    const bool running = GetTheDoc()->m_searchResults.m_running;
+    const int count = m_model.rowCount();
+
+    m_model.poll();
+
+    if ((count != m_model.rowCount()) || running) {
+        updateLabel();
+    } else if (m_wasRunning) {
+        /* The row text is available when the search is done */
+        updateLabel();
+        m_listView_p->viewport()->update();
+    }
+    m_wasRunning = running;
+}
+
+/***********************************************************************************************************************
+*   updateLabel
+***********************************************************************************************************************/
+void CSearchResultWidget::updateLabel(void)
+{
+    const CSearchResults& results = GetTheDoc()->m_searchResults;
+
+    if (results.GetSearchText().isEmpty()) {
+        m_label_p->setText("No search");
+        return;
+    }
+
+    m_label_p->setText(QString("%1 matches of \"%2\"%3")
+                           .arg(m_model.rowCount())
+                           .arg(results.GetSearchText())
+                           .arg(results.m_running ? ", searching..." : ""));
+}
+
+/***********************************************************************************************************************
+*   onActivated
+***********************************************************************************************************************/
+void CSearchResultWidget::onActivated(const QModelIndex& index)
+{
+    auto doc_p = GetTheDoc();
+    if (!index.isValid() || doc_p->m_searchResults.m_running || (index.row() >= m_model.rowCount())) {
+        return;
+    }
+
+    const SearchHit_t& hit = doc_p->m_searchResults.Get(index.row());
+    if (hit.row >= doc_p->m_database.TIA.rows) {
+        return;
+    }
+
+    int startCol = -1;
+    int endCol = -1;
+    if ((hit.offset >= 0) && (hit.length > 0)) {
+        startCol = hit.offset;
+        endCol = hit.offset + hit.length - 1;
+    }
+
+    CEditorWidget_EmptySelectionList();
+    CEditorWidget_AddSelection(hit.row, startCol, endCol, true, true, true, true);
+    CEditorWidget_SearchNewTopLine(hit.row);
+}
@@ -0,0 +1,68 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include <memory>
+
+#include <QWidget>
+#include <QAbstractListModel>
+#include <QListView>
+#include <QLabel>
+#include <QTimer>
+
+#include "CSearchResults.h"
+
+#define SEARCH_RESULT_POLL_TIME      50    /* ms, how often the result is checked for new hits */
+#define SEARCH_RESULT_MAX_ROW_TEXT   512   /* Number of characters of the row presented in the list */
+
+/***********************************************************************************************************************
+*   CSearchResultModel
+*
+*   List model on top of CSearchResults, only the visible items are requested by the view. The result is polled for
+*   new hits since it is filled in by the search threads.
+***********************************************************************************************************************/
+class CSearchResultModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit CSearchResultModel(QObject *parent = nullptr);
+    virtual ~CSearchResultModel() override {}
+
+    virtual int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    void poll(void);
+
+private:
+    int m_count = 0;
+    int m_generation = -1;
+};
+
+/***********************************************************************************************************************
+*   CSearchResultWidget
+***********************************************************************************************************************/
+class CSearchResultWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit CSearchResultWidget(QWidget *parent = nullptr);
+    virtual ~CSearchResultWidget() override {}
+
+private slots:
+    void onTimer(void);
+    void onActivated(const QModelIndex& index);
+
+private:
+    void updateLabel(void);
+
+    CSearchResultModel m_model;
+    QLabel *m_label_p = nullptr;
+    QListView *m_listView_p = nullptr;
+    std::unique_ptr<QTimer> m_timer;
+    bool m_wasRunning = false;
+};
@@ -19,6 +19,7 @@
 #include <QCheckBox>
 #include <QApplication>
 #include <QCompleter>
+#include <QLabel>
 
 /***********************************************************************************************************************
 *   on_pushButton_Forward_clicked
@@ -26,6 +27,7 @@
 void CSearchWidget::on_pushButton_Forward_clicked(void)
 {
     TRACEX_DE("Forward")
+    endIncrementalSession();
     addCurrentToHistory();
     CEditorWidget_EmptySelectionList();
     MW_Search(true);
@@ -61,11 +63,219 @@ void CSearchWidget::keyPressEvent(QKeyEvent *e)
 void CSearchWidget::on_pushButton_Back_clicked(void)
 {
     TRACEX_DE("Backwards")
+    endIncrementalSession();
     addCurrentToHistory();
     CEditorWidget_EmptySelectionList();
     MW_Search(false);
 }
 
+/***********************************************************************************************************************
+*   on_pushButton_FindAll_clicked
+***********************************************************************************************************************/
+void CSearchWidget::on_pushButton_FindAll_clicked(void)
+{
+    TRACEX_DE("Find all")
+    addCurrentToHistory();
+    MW_FindAll();
+}
+
+/***********************************************************************************************************************
+*   on_comboBox_editTextChanged
+***********************************************************************************************************************/
+void CSearchWidget::on_comboBox_editTextChanged(const QString& text)
+{
+    Q_UNUSED(text)
+
+    QCheckBox *incrementalOption_p = findChild<QCheckBox *>("incremental_option");
+    if ((incrementalOption_p != nullptr) && incrementalOption_p->isChecked()) {
+        startIncrementalSearch();
+    } else {
+        startMatchEstimate();
+    }
+}
+
+/***********************************************************************************************************************
+*   on_incremental_option_toggled
+***********************************************************************************************************************/
+void CSearchWidget::on_incremental_option_toggled(bool checked)
+{
+    if (checked) {
+        GetTheDoc()->m_matchEstimator.Stop();
+        if (m_estimateTimer) {
+            m_estimateTimer->stop();
+        }
+        startIncrementalSearch();
+    } else {
+        GetTheDoc()->m_incrementalSearch.Stop();
+        endIncrementalSession();
+        startMatchEstimate();
+    }
+}
+
+/***********************************************************************************************************************
+*   startMatchEstimate
+*   Without search-as-you-type the number of matches is estimated from a sample of the rows
+***********************************************************************************************************************/
+void CSearchWidget::startMatchEstimate(void)
+{
+    QString searchText;
+    bool caseSensitive;
+    bool regExp;
+
+    getSearchParameters(searchText, &caseSensitive, &regExp);
+
+    if (!GetTheDoc()->StartMatchEstimate(searchText, regExp, caseSensitive)) {
+        QLabel *label_p = findChild<QLabel *>("label_matches");
+        if (label_p != nullptr) {
+            label_p->clear();
+        }
+        return;
+    }
+
+    if (!m_estimateTimer) {
+        m_estimateTimer = std::make_unique<QTimer>(this);
+        connect(m_estimateTimer.get(), &QTimer::timeout, this, &CSearchWidget::onEstimateTimer);
+    }
+    m_estimateTimer->start(INCREMENTAL_SEARCH_POLL_TIME);
+    onEstimateTimer();
+}
+
+/***********************************************************************************************************************
+*   onEstimateTimer
+***********************************************************************************************************************/
+void CSearchWidget::onEstimateTimer(void)
+{
+    const MatchEstimate_t estimate = GetTheDoc()->m_matchEstimator.GetEstimate();
+
+    QLabel *label_p = findChild<QLabel *>("label_matches");
+    if (label_p != nullptr) {
+        label_p->setText(MatchEstimate_ToString(estimate));
+    }
+
+    if (!estimate.running && m_estimateTimer) {
+        m_estimateTimer->stop();
+    }
+}
+
+/***********************************************************************************************************************
+*   startIncrementalSearch
+*   Each key stroke starts a new query, the previous is cancelled
+***********************************************************************************************************************/
+void CSearchWidget::startIncrementalSearch(void)
+{
+    auto doc_p = GetTheDoc();
+    QString searchText;
+    bool caseSensitive;
+    bool regExp;
+
+    getSearchParameters(searchText, &caseSensitive, &regExp);
+
+    if (m_incrementalStartRow == -1) {
+        m_incrementalStartRow = CEditorWidget_GetCursorPosition().row;
+        if (m_incrementalStartRow < 0) {
+            m_incrementalStartRow = 0;
+        }
+    }
+    m_incrementalShownRow = -1;
+
+    const bool onlyFiltered = CEditorWidget_isPresentationModeFiltered() && (doc_p->m_database.FIRA.filterMatches > 0);
+    if (!doc_p->StartIncrementalSearch(searchText, onlyFiltered, regExp, caseSensitive)) {
+        return;
+    }
+
+    if (!m_incrementalTimer) {
+        m_incrementalTimer = std::make_unique<QTimer>(this);
+        connect(m_incrementalTimer.get(), &QTimer::timeout, this, &CSearchWidget::onIncrementalTimer);
+    }
+    m_incrementalTimer->start(INCREMENTAL_SEARCH_POLL_TIME);
+    onIncrementalTimer();
+}
+
+/***********************************************************************************************************************
+*   endIncrementalSession
+***********************************************************************************************************************/
+void CSearchWidget::endIncrementalSession(void)
+{
+    m_incrementalStartRow = -1;
+    m_incrementalShownRow = -1;
+    if (m_incrementalTimer) {
+        m_incrementalTimer->stop();
+    }
+}
+
+/***********************************************************************************************************************
+*   onIncrementalTimer
+***********************************************************************************************************************/
+void CSearchWidget::onIncrementalTimer(void)
+{
+    auto doc_p = GetTheDoc();
+    const CSearchResults& results = doc_p->m_incrementalSearch.GetResults();
+    const bool running = doc_p->m_incrementalSearch.isRunning();
+
+    QLabel *label_p = findChild<QLabel *>("label_matches");
+    if (label_p != nullptr) {
+        if (results.GetSearchText().isEmpty()) {
+            label_p->clear();
+        } else {
+            label_p->setText(QString("%1 matches%2").arg(results.GetCount()).arg(running ? "..." : ""));
+        }
+    }
+
+    presentIncrementalHit(running);
+
+    if (!running && m_incrementalTimer) {
+        m_incrementalTimer->stop();
+    }
+}
+
+/***********************************************************************************************************************
+*   presentIncrementalHit
+*   The hit presented is the first one at, or after, the row where the session started. The hits are added in row
+*   order, hence once found it is final. When the query is done without any such hit it wraps to the first hit.
+***********************************************************************************************************************/
+void CSearchWidget::presentIncrementalHit(bool running)
+{
+    auto doc_p = GetTheDoc();
+    const CSearchResults& results = doc_p->m_incrementalSearch.GetResults();
+    const int count = results.GetCount();
+
+    if ((m_incrementalShownRow != -1) || (count == 0) || CSZ_DB_PendingUpdate) {
+        return;
+    }
+
+    int low = 0;
+    int high = count;
+    while (low < high) {
+        const int mid = low + (high - low) / 2;
+        if (results.Get(mid).row < m_incrementalStartRow) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if (low == count) {
+        if (running) {
+            return; /* an earlier hit may still be found */
+        }
+        low = 0;
+    }
+
+    const SearchHit_t& hit = results.Get(low);
+    int startCol = -1;
+    int endCol = -1;
+    if ((hit.offset >= 0) && (hit.length > 0)) {
+        startCol = hit.offset;
+        endCol = hit.offset + hit.length - 1;
+    }
+
+    m_incrementalShownRow = hit.row;
+
+    CEditorWidget_EmptySelectionList();
+    CEditorWidget_AddSelection(hit.row, startCol, endCol, true, true, true, true);
+    CEditorWidget_SearchNewTopLine(hit.row);
+}
+
 /***********************************************************************************************************************
 *   addCurrentToHistory
 ***********************************************************************************************************************/
@@ -175,6 +385,8 @@ void CSearchWidget::activate(void)
     completer.setCaseSensitivity(Qt::CaseSensitive);
     combo_p->setCompleter(&completer);
     combo_p->setFocus();
+
+    endIncrementalSession(); /* a new incremental search starts from the current cursor */
 }
 
 /***********************************************************************************************************************
@@ -7,6 +7,9 @@
 
 #include <QWidget>
 #include <QCompleter>
+#include <QTimer>
+
+#include <memory>
 
 #include "csubplotsurface.h"
 #include "plugin_api.h"
@@ -17,6 +20,8 @@
 #include "ceditorwidget.h"
 #include "ui_searchform.h"
 
+#define INCREMENTAL_SEARCH_POLL_TIME  30  /* ms, how often the search-as-you-type result is checked */
+
 /***********************************************************************************************************************
 *   CSearchWidget
 ***********************************************************************************************************************/
@@ -70,6 +75,22 @@ private:
 private slots:
     void on_pushButton_Back_clicked(void);
     void on_pushButton_Forward_clicked(void);
+    void on_pushButton_FindAll_clicked(void);
+    void on_comboBox_editTextChanged(const QString& text);
+    void on_incremental_option_toggled(bool checked);
+    void onIncrementalTimer(void);
+    void onEstimateTimer(void);
+
+private:
+    void startIncrementalSearch(void);
+    void endIncrementalSession(void);
+    void presentIncrementalHit(bool running);
+    void startMatchEstimate(void);
+
+    std::unique_ptr<QTimer> m_incrementalTimer;
+    std::unique_ptr<QTimer> m_estimateTimer;
+    int m_incrementalStartRow = -1; /* Cursor row when the session (typing) started */
+    int m_incrementalShownRow = -1; /* Hit presented in the editor, -1 if none */
 
 private:
     QCompleter completer;
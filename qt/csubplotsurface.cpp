@@ -18,6 +18,7 @@
 #include "globals.h"
 #include "CFontCtrl.h"
 #include "CTimeMeas.h"
+#include "CPerThreadArray.h"
 
 extern QPen *g_plotWnd_focusPen_p;
 extern QPen *g_plotWnd_passiveFocusPen_p;
@@ -61,7 +62,7 @@ typedef struct {
     int stopIndex;
 } SetupGraph_Data_t;
 
-static SetupGraph_Data_t g_setupGraph_WorkData[MAX_NUM_OF_THREADS];
+static CPerThreadArray<SetupGraph_Data_t> g_setupGraph_WorkData; /* Grown to the threads used */
 void SetupGraph_ThreadAction(void *data_p);
 
 const QString g_avg_str("XXXXXXxxxxxZZZZzzzzz");   /* used to calculate size of text in a box/line */
@@ -2275,6 +2276,12 @@ void CSubPlotSurface::SetupGraphs(void)
 
     int threadIndex = 0;
 
+#ifdef MULTIPROC_SETUPGRAPH
+    g_setupGraph_WorkData.Grow(g_CPlotPane_ThreadMananger_p->GetThreadCount());
+#else
+    g_setupGraph_WorkData.Grow(1);
+#endif
+
 #ifdef _DEBUG
     CTimeMeas execTime;
 #endif
@@ -6,6 +6,7 @@
 #include "mainwindow.h"
 
 #include "CDebug.h"
+#include "CTrace.h"
 #include "CRecentFile.h"
 #include "CMemPool.h"
 #include "CFileCtrl.h"
@@ -20,6 +21,8 @@
 #include "CProgressDlg.h"
 #include "CWorkspace.h"
 #include "CConfigurationCtrl.h"
+#include "Benchmark.h"
+#include "cframestats.h"
 #include "utils/utils.h"
 
 #include <QApplication>
@@ -105,6 +108,7 @@ int main(int argc, char *argv[])
     QString title, version, buildDate, configuration;
     QDir dir;
     QString workingDir = CFGCTRL_GetWorkingDir();
+    const QString startDir = QDir::currentPath(); /* Relative file names on the command line */
 
     dir.mkpath(workingDir);
     dir.setCurrent(workingDir);
@@ -213,6 +217,7 @@ int main(int argc, char *argv[])
     parser.addHelpOption();
     parser.addVersionOption();
     parser.addPositionalArgument("input", QCoreApplication::translate("main", "Files to load"));
+    Benchmark_AddOptions(parser);
 
     /* Process the actual command line arguments given by the user */
     parser.process(app);
@@ -223,6 +228,29 @@ int main(int argc, char *argv[])
     }
     TRACEX_I(rawArgs);
 
+    /* Trace the processing pipeline from start up to exit, e.g. for start up and loading performance */
+    const QString traceFileName = qEnvironmentVariable(TRACE_ENV_VARIABLE);
+    if (!traceFileName.isEmpty()) {
+        Trace_Start();
+    }
+
+    if (Benchmark_IsRequested(parser)) {
+        /* Headless, the benchmarks are run without the main window and the application exits when done */
+        const int exitCode = Benchmark_Main(parser, startDir);
+
+        if (!traceFileName.isEmpty() && Trace_IsEnabled()) {
+            Trace_Stop();
+            (void)Trace_ExportChromeJson(traceFileName);
+        }
+
+        g_RamLog->UnregisterThread();
+        doc.CleanDB();
+        workspace.cleanAll();
+        ramLog.cleanUp();
+        debug.cleanUp();
+        return exitCode;
+    }
+
     const QStringList args = parser.positionalArguments();
     MainWindow w;
     w.setCommandLineParams(args);
@@ -230,6 +258,17 @@ int main(int argc, char *argv[])
 
     (void)app.exec();
 
+    if (!traceFileName.isEmpty() && Trace_IsEnabled()) {
+        Trace_Stop();
+        (void)Trace_ExportChromeJson(traceFileName);
+    }
+
+    /* Editor frame times, e.g. for automated scroll benchmarks */
+    const QString frameStatsFileName = qEnvironmentVariable(FRAME_STATS_ENV_VARIABLE);
+    if (!frameStatsFileName.isEmpty()) {
+        (void)g_frameStats.ExportJson(frameStatsFileName);
+    }
+
     /* Application terminated */
 
     g_cfg_p->writeDefaultSettings(); /* settings.xml */
@@ -19,8 +19,12 @@
 #include "CProgressCtrl.h"
 #include "CConfig.h"
 #include "cplotwidget.h"
+#include "cfilterprofiledialog.h"
+#include "cframestats.h"
+#include "cmemorydialog.h"
 
 #include "CDebug.h"
+#include "CTrace.h"
 #include "CWorkspace.h"
 #include <QSettings>
 #include <QApplication>
@@ -234,6 +238,19 @@ void MW_Search(bool forward)
     }
 }
 
+/***********************************************************************************************************************
+*   MW_FindAll
+***********************************************************************************************************************/
+void MW_FindAll(void)
+{
+#ifdef ASSERT_ON_NULL
+    Q_ASSERT(g_mainWindow_p != nullptr);
+#endif
+    if (g_mainWindow_p != nullptr) {
+        g_mainWindow_p->handleFindAll();
+    }
+}
+
 /***********************************************************************************************************************
 *   MW_ModifyFontSize
 ***********************************************************************************************************************/
@@ -413,7 +430,7 @@ bool MW_AppendLogMsg(const QString& message)
     Q_ASSERT(g_mainWindow_p->m_logWindow_p != nullptr);
 #endif
 
-    /* Scope is locked from TRACEX */
+    /* Only called from the TRACEX drainer thread, see CDebug */
 
     static QStringList string_queue;
 
@@ -748,6 +765,8 @@ MainWindow::MainWindow(QWidget *parent) :
      * ~Qt::WindowSystemMenuHint & ~Qt::WindowMinMaxButtonsHint & ~Qt::WindowContextHelpButtonHint);*/
 
     m_tabWidget_p->addTab(m_searchWidget_p, mainIcon, "Search window");
+    m_searchResultWidget_p = new CSearchResultWidget();
+    m_tabWidget_p->addTab(m_searchResultWidget_p, mainIcon, "Search results");
 
     statusBar()->showMessage(tr("Ready"));
     setAcceptDrops(true);
@@ -1391,6 +1410,76 @@ void MainWindow::createActions(void)
         });
     }
 
+    {
+        /* Tools - cost and selectivity of each filter item at the last filtering */
+        QAction *action_p;
+        action_p = toolsMenu->addAction(QString("Filter Profile..."));
+        action_p->setEnabled(true);
+        connect(action_p, &QAction::triggered, [ = ] ()
+        {
+            CFilterProfileDialog dialog(GetTheDoc()->m_allEnabledFilterItems, this);
+            dialog.exec();
+        });
+    }
+
+    {
+        /* Tools - record the processing pipeline, saved as a Chrome trace (chrome://tracing or Perfetto) */
+        QAction *action_p;
+        action_p = toolsMenu->addAction(QString("Record Pipeline Trace"));
+        action_p->setCheckable(true);
+        action_p->setChecked(Trace_IsEnabled());
+        connect(action_p, &QAction::toggled, [ = ] (bool checked)
+        {
+            if (checked) {
+                Trace_Start();
+                return;
+            }
+
+            Trace_Stop();
+
+            QStringList fileNames = CFGCTRL_GetUserPickedFileNames(QString("trace.json"),
+                                                                   QFileDialog::AcceptSave,
+                                                                   QStringList("Chrome trace (*.json)"),
+                                                                   QList<RecentFile_Kind_e>(),
+                                                                   QString());
+            if (!fileNames.isEmpty() && !Trace_ExportChromeJson(fileNames.first())) {
+                QMessageBox::warning(this, QString("Pipeline Trace"),
+                                     QString("Failed to save the trace to %1").arg(fileNames.first()));
+            }
+        });
+    }
+
+    {
+        /* Tools - editor frame times since the last reset (CTRL-F12 in the editor), the HUD is toggled with F12 */
+        QAction *action_p;
+        action_p = toolsMenu->addAction(QString("Export Frame Statistics..."));
+        action_p->setEnabled(true);
+        connect(action_p, &QAction::triggered, [ = ] ()
+        {
+            QStringList fileNames = CFGCTRL_GetUserPickedFileNames(QString("frame_stats.json"),
+                                                                   QFileDialog::AcceptSave,
+                                                                   QStringList("Frame statistics (*.json)"),
+                                                                   QList<RecentFile_Kind_e>(),
+                                                                   QString());
+            if (!fileNames.isEmpty() && !g_frameStats.ExportJson(fileNames.first())) {
+                QMessageBox::warning(this, QString("Frame Statistics"),
+                                     QString("Failed to save the frame statistics to %1").arg(fileNames.first()));
+            }
+        });
+    }
+
+    {
+        /* Tools - memory usage per subsystem and the memory budget */
+        QAction *action_p;
+        action_p = toolsMenu->addAction(QString("Memory Usage..."));
+        action_p->setEnabled(true);
+        connect(action_p, &QAction::triggered, [ = ] ()
+        {
+            CMemoryDialog dialog(this);
+            dialog.exec();
+        });
+    }
+
     /*auto settingsMenu = toolsMenu->addMenu(tr("&Settings...")); */
 #if _DEBUG
     auto debugMenu = toolsMenu->addMenu(tr("&Settings..."));
@@ -2218,6 +2307,44 @@ bool MainWindow::handleSearch(bool forward)
     return true;
 }
 
+/***********************************************************************************************************************
+*   handleFindAll
+***********************************************************************************************************************/
+bool MainWindow::handleFindAll(void)
+{
+    CLogScrutinizerDoc *doc_p = GetTheDoc();
+    QString searchText;
+    bool caseSensitive;
+    bool regExp;
+
+    m_searchWidget_p->getSearchParameters(searchText, &caseSensitive, &regExp);
+
+    if (CSZ_DB_PendingUpdate || searchText.isEmpty() || (doc_p->m_database.TIA.rows == 0)) {
+        return false;
+    }
+
+    g_processingCtrl_p->Processing_StartReport();
+
+    const bool result = doc_p->StartFindAll(
+        searchText,
+        (CEditorWidget_isPresentationModeFiltered() && doc_p->m_database.FIRA.filterMatches > 0) ? true : false,
+        regExp,
+        caseSensitive);
+
+    g_processingCtrl_p->Processing_StopReport();
+
+    m_tabWidget_p->setCurrentWidget(m_searchResultWidget_p);
+
+    if (result) {
+        m_searchWidget_p->addToHistory(searchText);
+    } else {
+        TRACEX_I("Find all, no match\n")
+        MW_PlaySystemSound(SYSTEM_SOUND_FAILURE);
+    }
+
+    return result;
+}
+
 /***********************************************************************************************************************
 *   changeEvent
 ***********************************************************************************************************************/
@@ -14,6 +14,7 @@
 #include "cplotpane.h"
 #include "cplotwidget.h"
 #include "csearchwidget.h"
+#include "csearchresultwidget.h"
 
 #include <map>
 
@@ -233,6 +234,7 @@ public:
                            int& numOfFastSearchRows, bool& doFullSearch);
 
     bool handleSearch(bool forward);
+    bool handleFindAll(void);
     void activateSearch(const QString& searchText, bool caseSensitive = false, bool regExp = false);
     void updateSearchParameters(const QString& searchText, bool caseSensitive = false, bool regExp = false);
 
@@ -277,6 +279,7 @@ private:
     CEditorWidget *m_editor_p = nullptr;
     CTabWidget *m_tabWidget_p = nullptr;
     CSearchWidget *m_searchWidget_p = nullptr;
+    CSearchResultWidget *m_searchResultWidget_p = nullptr;
     QCheckBox *m_checkBox_p = nullptr;
     CPlotPane *m_plotPane_p = nullptr;   /* is a QTabWidget */
     QAction *m_saveFilterAct = nullptr;
@@ -55,6 +55,7 @@ void MW_StartWebPage(const QString& url);
 int64_t MW_GetTick(void);
 
 void MW_Search(bool forward = true);
+void MW_FindAll(void);
 void MW_ActivateSearch(const QString& searchText, bool caseSensitive = false, bool regExp = false);
 void MW_UpdateSearchParameters(const QString& searchText, bool caseSensitive = false, bool regExp = false);
 void MW_ModifyFontSize(int increase);
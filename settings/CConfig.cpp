@@ -108,6 +108,10 @@ CConfig::CConfig(void)
 
     g_cfg_p = this;
 
+    m_memoryBudget = 0; /* Before the settings are loaded the memory pools are already in use */
+    m_filterThreads = 0;
+    m_searchThreads = 0;
+    m_numaPlacement = false;
     m_minNumOfTIs = 1000;
     m_text_RowPadding.left = 0.01;
     m_text_RowPadding.right = 0.01;
@@ -181,12 +185,24 @@ void CConfig::Init(void)
     RegisterSetting(new CSCZ_CfgT<int>("NUM_OF_THREADS", "NUM_OF_THREADS", &m_numOfThreads,
                                        m_numOfThreads, "Number of threads to use (common value)"));
 
+    RegisterSetting(new CSCZ_CfgT<int>("FILTER_THREADS", "FILTER_THREADS", &m_filterThreads,
+                                       0, "Number of threads used when filtering (0 NUM_OF_THREADS)"));
+
+    RegisterSetting(new CSCZ_CfgT<int>("SEARCH_THREADS", "SEARCH_THREADS", &m_searchThreads,
+                                       0, "Number of threads used when searching (0 NUM_OF_THREADS)"));
+
+    RegisterSetting(new CSCZ_CfgT<bool>("NUMA_PLACEMENT", "NUMA_PLACEMENT", &m_numaPlacement,
+                                        false, "Filter threads and their rows placed per NUMA node (Linux)"));
+
     RegisterSetting(new CSCZ_CfgT<int>("THREAD_PRIO", "THREAD_PRIO", &m_threadPriority,
                                        QThread::NormalPriority, "The default thread priority"));
 
     RegisterSetting(new CSCZ_CfgT<int>("WORK_MEM_SIZE", "WORK_MEM_SIZE", &(g_cfg_p->m_workMemSize),
                                        0, "Override max used memory when parsing log and filtering"));
 
+    RegisterSetting(new CSCZ_CfgT<int>("MEMORY_BUDGET", "MEMORY_BUDGET", &(g_cfg_p->m_memoryBudget),
+                                       0, "Memory budget in MB, work memory and caches are kept within (0 none)"));
+
     RegisterSetting(new CSCZ_CfgT<int>("PLOT_LINE_ENDS", "PLOT_LINE_ENDS", &(g_cfg_p->m_plot_lineEnds),
                                        2, "Which line end to use"));
 
@@ -275,6 +291,25 @@ void CConfig::Init(void)
     RegisterSetting(new CSCZ_CfgT<int>("LOG_COL_CLIP_END", "LOG_COL_CLIP_END", &(g_cfg_p->m_Log_colClip_End),
                                        -1, "Clips the end of the row", SettingScope_t::workspace));
 
+    RegisterSetting(new CSCZ_CfgT<int>("LOG_FILE_TRACKING_MAX_LATENCY", "LOG_FILE_TRACKING_MAX_LATENCY",
+                                       &(g_cfg_p->m_logFileTrackingMaxLatency), 100,
+                                       "Max time (ms) from that the log file is appended until it is shown, when tracking"));
+
+    RegisterSetting(new CSCZ_CfgT<bool>("LOG_MERGE_BY_TIMESTAMP", "LOG_MERGE_BY_TIMESTAMP",
+                                        &(g_cfg_p->m_logMergeByTimestamp), false,
+                                        "Several log files opened together are merged by row timestamp, instead of "
+                                        "being concatenated"));
+
+    RegisterSetting(new CSCZ_CfgT<bool>("SEARCH_INDEX", "SEARCH_INDEX",
+                                        &(g_cfg_p->m_searchIndexEnabled), false,
+                                        "Search using a trigram index of the log, the index is built at the first "
+                                        "search and saved next to the TIA file"));
+
+    RegisterSetting(new CSCZ_CfgT<bool>("BLOCK_SUMMARY", "BLOCK_SUMMARY",
+                                        &(g_cfg_p->m_blockSummaryEnabled), true,
+                                        "Summarize the trigrams of each MB of the log when it is indexed, search and "
+                                        "filtering skip the parts that cannot match"));
+
     RegisterSetting(new CSCZ_CfgT<int>("RECENT_FILE_MAX_HISTORY", "RECENT_FILE_MAX_HISTORY",
                                        &(g_cfg_p->m_recentFile_MaxHistory), MAX_NUM_OF_RECENT_FILES,
                                        "Number of recent files used to remeber"));
@@ -505,10 +540,9 @@ void CConfig::ReloadSettings(void)
 ***********************************************************************************************************************/
 void CConfig::LoadSystemSettings(void)
 {
+    /* All the hardware threads, the per thread work data is sized at runtime */
     m_numOfThreads = QThread::idealThreadCount();
-
-    /* Limit number of threads to the define... typically debugging */
-    m_numOfThreads = m_numOfThreads > MAX_NUM_OF_THREADS ? MAX_NUM_OF_THREADS : m_numOfThreads;
+    m_numOfThreads = m_numOfThreads < 1 ? 1 : m_numOfThreads;
 
     m_v_scrollSpeed = 3;      /* xxx QT   set to this temp */
 }
@@ -259,7 +259,6 @@ typedef struct {
 #define SCROLLBAR_SLIDER_COLOR              Q_RGB(0xbb, 0xbb, 0xbb)     /* Light gray */
 #define SCROLLBAR_SLIDER_SELECTED_COLOR     Q_RGB(0xaa, 0xaa, 0xaa)     /* Light gray */
 
-#define MAX_NUM_OF_THREADS               16
 #define LOG_SCRUTINIZER_MAX_SCREEN_ROWS  1024 /* Defines the maximum rows that could be displayed */
 #define CFG_MINIMUM_FILE_SIZE_FOR_MULTI_THREAD_TI_PARSE       (10240 * 1024) /* 10MB file at least */
 #define CFG_MINIMUM_NUM_OF_TIs_FOR_MULTI_THREAD_FILERING      (10000)
@@ -439,6 +438,13 @@ public:
     bool RemoveSetting(QString *identity_p);
     bool WriteSettings(QFile *file_h, SettingScope_t scope, bool onlyChanged = false);
 
+    /* The threads of an operation, its own setting (e.g. FILTER_THREADS) if set, otherwise NUM_OF_THREADS */
+    int GetNumOfThreads(int operationThreads) const
+    {
+        const int numOfThreads = operationThreads > 0 ? operationThreads : m_numOfThreads;
+        return numOfThreads > 0 ? numOfThreads : 1;
+    }
+
     /****/
     QString GetApplicationVersion(void) {
         return m_applicationVersion;
@@ -454,12 +460,16 @@ private:
 
 public:
     int m_threadPriority;
-    int32_t m_numOfThreads; /**< The default number of threads */
+    int32_t m_numOfThreads; /**< The default number of threads, the hardware threads unless set */
+    int m_filterThreads; /**< 0 - m_numOfThreads */
+    int m_searchThreads; /**< 0 - m_numOfThreads */
+    bool m_numaPlacement; /**< Pin the filter threads per NUMA node, and place their rows on the node. See CNuma */
     int m_v_scrollSpeed; /**< The vertical scroll speed */
     int m_v_scrollGraphSpeed; /**< The vertical graph scroll speed */
     int m_pluginDebugBitmask; /**< 0 - disabled */
     int m_workMemSize;
     int m_maxWorkMemSize;
+    int m_memoryBudget; /**< MB, limits the resident memory (see CMemAccounting), 0 no budget */
     int m_plot_lineEnds; /**< Determine with which line end  to use */
     int m_plot_LineEnds_MinPixelDist; /**< Minimal number of pixels that there must be between line ends */
     int m_plot_LineEnds_MaxCombinePixelDist; /**< Maximal number of pixels between lines that are combined, after this
@@ -493,6 +503,10 @@ public:
     int m_Log_colClip_Start;
     int m_Log_colClip_End;
     bool m_logFileTracking = false;
+    int m_logFileTrackingMaxLatency; /**< Max time (ms) from a log file append until it is presented */
+    bool m_logMergeByTimestamp; /**< Several log files opened together are merged by row timestamp */
+    bool m_searchIndexEnabled; /**< Search using a trigram index of the log, built at the first search */
+    bool m_blockSummaryEnabled; /**< Build per-block trigram summaries when indexing, to skip blocks without match */
     int m_recentFile_MaxHistory;
     bool m_keepTIA_File;
     QString m_defaultWorkspace; /**< Where to look for the default workspace */
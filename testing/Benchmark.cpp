@@ -0,0 +1,801 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "Benchmark.h"
+
+#include "CDebug.h"
+#include "CConfig.h"
+#include "CMemPool.h"
+#include "CNuma.h"
+#include "CFileCtrl.h"
+#include "CSearchCtrl.h"
+#include "CFilterProcCtrl.h"
+#include "CRowCache.h"
+#include "CTimeMeas.h"
+#include "filemapping.h"
+#include "cplotctrl.h"
+#include "plugin_api.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLibrary>
+
+#define BENCHMARK_WORK_MEM_SIZE     (1024 * 1024 * 100)
+#define BENCHMARK_WRITE_CHUNK_SIZE  (1024 * 1024 * 4)
+#define BENCHMARK_COMPONENTS        64     /* The rows are tagged compNN, uniformly */
+#define BENCHMARK_MANY_FILTERS      32     /* compNN filter items, in the many filter items benchmark */
+#define BENCHMARK_PLOT_INTERVAL     8      /* Every Nth row has a sample for the plot, "Time:N Value:N" */
+
+#define BENCHMARK_MATCH_TEXT        "BENCH_MATCH"
+#define BENCHMARK_MATCH_REGEXP      "BENCH_MATCH id=[0-9]*7 "
+#define BENCHMARK_NO_MATCH_TEXT     "BENCH_NO_MATCH"
+
+static const char *g_benchmarkWords[] = {
+    "connection", "request", "handler", "timeout", "session", "buffer", "queue", "worker", "received", "completed",
+    "retry", "state", "update", "packet", "client", "server", "config", "value", "0x7f3a", "ok"
+};
+
+/* Per benchmark, the run times and what was processed in each run */
+typedef struct {
+    QString name;
+    int64_t rows;
+    int64_t bytes;
+    int64_t matches;              /* -1 if not applicable */
+    std::vector<int64_t> times;   /* us, one per run */
+    int threads = 0;              /* Set in the filter scaling, 0 the default number of threads */
+} BenchmarkResult_t;
+
+/***********************************************************************************************************************
+*   CBenchmark
+***********************************************************************************************************************/
+class CBenchmark
+{
+public:
+    explicit CBenchmark(const BenchmarkConfig_t& config) : m_config(config) {}
+    ~CBenchmark(void);
+
+    bool Run(const QString& resultFileName);
+
+private:
+    bool GenerateLog(void);
+    bool Open(void);
+    bool IndexTIA(void);
+    bool Filter(const QString& name, std::vector<FilterItemInitializer>& filterInitializers, int64_t expectedMatches,
+                CFilterContainer& container);
+    bool FilterRuns(const QString& name, QList<CFilterItem *>& filterItems, int64_t expectedMatches,
+                    CFilterContainer& container, int numOfThreads);
+    bool FilterScaling(std::vector<FilterItemInitializer>& filterInitializers, int64_t expectedMatches);
+    bool Search(void);
+    bool ScrollRowCache(CFilterContainer& container);
+    bool ReNumerateFIRA(CFilterContainer& container);
+    bool Plot(void);
+    bool WriteResult(const QString& resultFileName);
+
+    /****/
+    BenchmarkResult_t& AddResult(const QString& name, int64_t rows, int64_t bytes, int64_t matches = -1)
+    {
+        m_results.push_back({name, rows, bytes, matches, {}});
+        return m_results.back();
+    }
+
+    BenchmarkConfig_t m_config;
+    QString m_logFileName;
+    QFile m_logFile;
+    QFile m_TIA_File;
+    QFile m_FIRA_File;
+    TIA_t m_TIA = {};
+    FIRA_t m_FIRA = {};
+    int64_t m_fileSize = 0;
+    int64_t m_expectedMatches = 0;         /* Rows with BENCHMARK_MATCH_TEXT */
+    int64_t m_expectedRegExpMatches = 0;   /* Rows matching BENCHMARK_MATCH_REGEXP */
+    int64_t m_expectedComponentMatches = 0;
+    char *m_workMem_p = nullptr;
+    std::vector<BenchmarkResult_t> m_results;
+};
+
+/***********************************************************************************************************************
+*   _median
+***********************************************************************************************************************/
+static int64_t _median(std::vector<int64_t> times)
+{
+    if (times.empty()) {
+        return 0;
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+/***********************************************************************************************************************
+*   ~CBenchmark
+***********************************************************************************************************************/
+CBenchmark::~CBenchmark(void)
+{
+    if (m_FIRA.FIR_Array_p != nullptr) {
+        FileMapping::RemoveFIRA_MemMapped(m_FIRA_File, m_FIRA.FIR_Array_p, true);
+    }
+
+    if (m_TIA.textItemArray_p != nullptr) {
+        FileMapping::RemoveTIA_MemMapped(m_TIA_File, m_TIA.textItemArray_p, true);
+    }
+
+    m_logFile.close();
+
+    if (m_workMem_p != nullptr) {
+        VirtualMem::Free(m_workMem_p);
+    }
+}
+
+/***********************************************************************************************************************
+*   GenerateLog
+*   Rows as "<time> compNN [Time:N Value:N] [BENCH_MATCH id=N] <words>", all random numbers from a seeded mt19937
+*   (whose sequence is defined by the standard) with plain modulo, such that the log is the same on all platforms.
+*   The log is kept, and reused as long as the configuration is the same. It is written to a temporary file renamed
+*   when complete, an existing log is hence always complete.
+***********************************************************************************************************************/
+bool CBenchmark::GenerateLog(void)
+{
+    QDir dir(m_config.workDir.isEmpty() ? QDir::temp().filePath("logscrutinizer_benchmark") : m_config.workDir);
+
+    if (!dir.mkpath(".")) {
+        TRACEX_E("Benchmark  Failed to create %s", dir.absolutePath().toLatin1().constData())
+        return false;
+    }
+
+    m_logFileName = dir.filePath(QString("benchmark_%1_%2_%3_%4_%5.txt")
+                                     .arg(m_config.rows).arg(m_config.lineLengthMin).arg(m_config.lineLengthMax)
+                                     .arg(qRound(m_config.matchDensity * 10000.0)).arg(m_config.seed));
+
+    std::mt19937 rng(m_config.seed);
+    const uint32_t matchThreshold = static_cast<uint32_t>(qRound(m_config.matchDensity * 10000.0)); /* per million */
+    const uint32_t lengthRange = static_cast<uint32_t>(m_config.lineLengthMax - m_config.lineLengthMin) + 1;
+    const int numOfWords = static_cast<int>(sizeof(g_benchmarkWords) / sizeof(g_benchmarkWords[0]));
+    const bool exists = QFileInfo::exists(m_logFileName);
+    QFile logFile(m_logFileName + ".tmp");
+    QByteArray chunk;
+    char row[BENCHMARK_MAX_LINE_LENGTH + 128];
+
+    if (!exists && !logFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        TRACEX_E("Benchmark  Failed to create %s", logFile.fileName().toLatin1().constData())
+        return false;
+    }
+
+    chunk.reserve(BENCHMARK_WRITE_CHUNK_SIZE + static_cast<int>(sizeof(row)));
+
+    /* The expected matches are counted even when the log is reused, the random sequence is the same */
+    for (int index = 0; index < m_config.rows; ++index) {
+        const uint32_t lengthSum = (rng() % lengthRange) + (rng() % lengthRange); /* Triangular distribution */
+        const int length = m_config.lineLengthMin + static_cast<int>(lengthSum / 2);
+        const uint32_t component = rng() % BENCHMARK_COMPONENTS;
+        const bool match = (rng() % 1000000) < matchThreshold;
+        int size = snprintf(row, sizeof(row), "%08d.%03u comp%02u ", index / 1000, rng() % 1000, component);
+
+        if ((index % BENCHMARK_PLOT_INTERVAL) == 0) {
+            size += snprintf(&row[size], sizeof(row) - static_cast<size_t>(size), "Time:%d Value:%u ",
+                             index / BENCHMARK_PLOT_INTERVAL, rng() % 1000);
+        }
+
+        if (match) {
+            const uint32_t id = rng() % 100000;
+            size += snprintf(&row[size], sizeof(row) - static_cast<size_t>(size), BENCHMARK_MATCH_TEXT " id=%u ", id);
+            ++m_expectedMatches;
+            if ((id % 10) == 7) {
+                ++m_expectedRegExpMatches;
+            }
+        }
+
+        if (component < BENCHMARK_MANY_FILTERS - 1) {
+            ++m_expectedComponentMatches;
+        } else if (match) {
+            ++m_expectedComponentMatches; /* The last of the many filter items is BENCHMARK_MATCH_TEXT */
+        }
+
+        /* The row is filled up with words to its length, the tags above are never cut */
+        const int tagsSize = size;
+
+        while (size < length) {
+            const char *word_p = g_benchmarkWords[rng() % static_cast<uint32_t>(numOfWords)];
+            const int wordLength = static_cast<int>(strlen(word_p));
+            memcpy(&row[size], word_p, static_cast<size_t>(wordLength));
+            size += wordLength;
+            row[size++] = ' ';
+        }
+
+        size = std::max(std::min(size, length), tagsSize);
+
+        if (!exists) {
+            chunk.append(row, size);
+            chunk.append("\r\n", 2);
+
+            if ((chunk.size() >= BENCHMARK_WRITE_CHUNK_SIZE) || (index == m_config.rows - 1)) {
+                if (logFile.write(chunk) != chunk.size()) {
+                    TRACEX_E("Benchmark  Failed to write %s", logFile.fileName().toLatin1().constData())
+                    return false;
+                }
+                chunk.clear();
+            }
+        }
+    }
+
+    if (!exists) {
+        logFile.close();
+        if (!logFile.rename(m_logFileName)) {
+            TRACEX_E("Benchmark  Failed to rename %s", logFile.fileName().toLatin1().constData())
+            return false;
+        }
+        TRACEX_I("Benchmark  Generated %s", m_logFileName.toLatin1().constData())
+    }
+
+    m_fileSize = QFileInfo(m_logFileName).size();
+    return true;
+}
+
+/***********************************************************************************************************************
+*   Open
+***********************************************************************************************************************/
+bool CBenchmark::Open(void)
+{
+    m_logFile.setFileName(m_logFileName);
+    m_TIA_File.setFileName(m_logFileName + ".tia");
+    m_FIRA_File.setFileName(m_logFileName + ".fira");
+
+    if (!m_logFile.open(QIODevice::ReadOnly)) {
+        TRACEX_E("Benchmark  Failed to open %s", m_logFileName.toLatin1().constData())
+        return false;
+    }
+
+    m_workMem_p = reinterpret_cast<char *>(VirtualMem::Alloc(BENCHMARK_WORK_MEM_SIZE));
+
+    if (m_workMem_p == nullptr) {
+        TRACEX_E("Benchmark  Virtual Alloc failed")
+        return false;
+    }
+
+    return true;
+}
+
+/***********************************************************************************************************************
+*   IndexTIA
+***********************************************************************************************************************/
+bool CBenchmark::IndexTIA(void)
+{
+    BenchmarkResult_t& result = AddResult("tia_indexing", m_config.rows, m_fileSize);
+
+    for (int run = 0; run < m_config.runs; ++run) {
+        CFileCtrl fileCtrl;
+        CTimeMeas timeMeas;
+        int rows = 0;
+
+        m_TIA_File.remove();
+
+        if (!fileCtrl.Search_TIA(&m_logFile, m_TIA_File.fileName(), m_workMem_p, BENCHMARK_WORK_MEM_SIZE, &rows) ||
+            (rows != m_config.rows)) {
+            TRACEX_E("Benchmark  TIA indexing failed, rows:%d expected:%d", rows, m_config.rows)
+            return false;
+        }
+        result.times.push_back(timeMeas.elapsed(CTimeMeas::micro));
+    }
+
+    m_TIA.rows = -1; /* Have CreateTIA_MemMapped set the rows found in the TIA file */
+
+    int64_t fileSize;
+    if (!FileMapping::CreateTIA_MemMapped(m_logFile, m_TIA_File, &m_TIA.rows, m_TIA.textItemArray_p, &fileSize) ||
+        !FileMapping::CreateFIRA_MemMapped(m_FIRA_File, m_FIRA.FIR_Array_p, m_TIA.rows)) {
+        TRACEX_E("Benchmark  TIA/FIRA mapping failed")
+        return false;
+    }
+
+    return true;
+}
+
+/***********************************************************************************************************************
+*   Filter
+*   The filter item texts are referred to by the container, filterInitializers must live as long as the container
+***********************************************************************************************************************/
+bool CBenchmark::Filter(const QString& name, std::vector<FilterItemInitializer>& filterInitializers,
+                        int64_t expectedMatches, CFilterContainer& container)
+{
+    QList<CFilterItem *> filterItems;
+    container.GenerateFilterItems(filterInitializers.data(), static_cast<int>(filterInitializers.size()));
+    container.GenerateLUT();
+    container.PopulateFilterItemList(filterItems);
+
+    return FilterRuns(name, filterItems, expectedMatches, container, 0);
+}
+
+/***********************************************************************************************************************
+*   FilterRuns
+*   numOfThreads 0 is the default number of threads (FILTER_THREADS, NUM_OF_THREADS)
+***********************************************************************************************************************/
+bool CBenchmark::FilterRuns(const QString& name, QList<CFilterItem *>& filterItems, int64_t expectedMatches,
+                            CFilterContainer& container, int numOfThreads)
+{
+    BenchmarkResult_t& result = AddResult(name, m_TIA.rows, m_fileSize, expectedMatches);
+    result.threads = numOfThreads;
+
+    for (int run = 0; run < m_config.runs; ++run) {
+        CFilterProcCtrl filterCtrl;
+        FilterExecTimes_t execTimes;
+        QList<int> bookmarks;
+        CTimeMeas timeMeas;
+
+        if (numOfThreads > 0) {
+            filterCtrl.SetNumOfThreads(numOfThreads);
+        }
+
+        filterCtrl.StartProcessing(&m_logFile, m_workMem_p, BENCHMARK_WORK_MEM_SIZE, &m_TIA, m_FIRA.FIR_Array_p,
+                                   m_TIA.rows, &filterItems, container.GetFilterLUT(), &execTimes, 0, -1, -1, -1, -1,
+                                   &m_FIRA.filterMatches, &m_FIRA.filterExcludeMatches, &bookmarks);
+        result.times.push_back(timeMeas.elapsed(CTimeMeas::micro));
+
+        if (m_FIRA.filterMatches != expectedMatches) {
+            TRACEX_E("Benchmark  %s failed, matches:%d expected:%lld", name.toLatin1().constData(),
+                     m_FIRA.filterMatches, static_cast<long long>(expectedMatches))
+            return false;
+        }
+
+        /* Each row is matched by one thread only, otherwise the threads repeat each others work and the scaling
+         * measured is not the filtering's. The profile counts each match of the (non compound) items */
+        int64_t profiledMatches = 0;
+        for (auto& filterItem_p : filterItems) {
+            profiledMatches += filterItem_p->m_profile.matches;
+        }
+        if (profiledMatches != m_FIRA.filterMatches + m_FIRA.filterExcludeMatches) {
+            TRACEX_E("Benchmark  %s failed, rows filtered more than once, profiled matches:%lld matches:%d",
+                     name.toLatin1().constData(), static_cast<long long>(profiledMatches),
+                     m_FIRA.filterMatches + m_FIRA.filterExcludeMatches)
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/***********************************************************************************************************************
+*   FilterScaling
+*   The same filtering with each of the thread counts, the speedup is calculated when the result is written
+***********************************************************************************************************************/
+bool CBenchmark::FilterScaling(std::vector<FilterItemInitializer>& filterInitializers, int64_t expectedMatches)
+{
+    CFilterContainer container;
+    QList<CFilterItem *> filterItems;
+    container.GenerateFilterItems(filterInitializers.data(), static_cast<int>(filterInitializers.size()));
+    container.GenerateLUT();
+    container.PopulateFilterItemList(filterItems);
+
+    for (auto threads : m_config.threads) {
+        if (!FilterRuns(QString("filter_scaling_%1").arg(threads), filterItems, expectedMatches, container, threads)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/***********************************************************************************************************************
+*   Search
+*   Searching for a text not in the log, i.e. a search through all the rows
+***********************************************************************************************************************/
+bool CBenchmark::Search(void)
+{
+    BenchmarkResult_t& result = AddResult("search", m_TIA.rows, m_fileSize, 0);
+    QString searchText(BENCHMARK_NO_MATCH_TEXT);
+
+    for (int run = 0; run < m_config.runs; ++run) {
+        CSearchCtrl searchCtrl;
+        CTimeMeas timeMeas;
+        int searchTI;
+
+        searchCtrl.StartProcessing(&m_logFile, m_workMem_p, BENCHMARK_WORK_MEM_SIZE, &m_TIA, nullptr, nullptr, 0,
+                                   &searchText, 0, m_TIA.rows - 1, false, false, false);
+        result.times.push_back(timeMeas.elapsed(CTimeMeas::micro));
+
+        if (searchCtrl.GetSearchResult(&searchTI)) {
+            TRACEX_E("Benchmark  Search failed, unexpected match at row:%d", searchTI)
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/***********************************************************************************************************************
+*   ScrollRowCache
+*   Reading all rows through the row cache from the top, as when scrolling through the log, with a cold cache
+***********************************************************************************************************************/
+bool CBenchmark::ScrollRowCache(CFilterContainer& container)
+{
+    const CMemPool_Config_t rowCacheMemPoolConfig =
+    {
+        5,                                     /* numOfRanges */
+        {CACHE_MEM_MAP_SIZE, 8, 4, 1, 1, 0},   /* startNumPerRange */
+        {CACHE_CMEM_POOL_SIZE_SMALLEST, CACHE_CMEM_POOL_SIZE_1, CACHE_CMEM_POOL_SIZE_2, CACHE_CMEM_POOL_SIZE_3,
+         CACHE_CMEM_POOL_SIZE_MAX, 0}          /* ranges */
+    };
+    BenchmarkResult_t& result = AddResult("row_cache_scroll", m_TIA.rows, m_fileSize);
+
+    for (int run = 0; run < m_config.runs; ++run) {
+        CMemPool memPool(&rowCacheMemPoolConfig);
+        CRowCache rowCache(&m_logFile, &m_TIA, &m_FIRA, container.GetFilterLUT(), memPool);
+        CTimeMeas timeMeas;
+        char *text_p;
+        int size;
+        int props;
+
+        for (int row = 0; row < m_TIA.rows; ++row) {
+            rowCache.Get(row, &text_p, &size, &props);
+
+            if (size != m_TIA.textItemArray_p[row].size) {
+                TRACEX_E("Benchmark  Row cache failed, row:%d size:%d expected:%d", row, size,
+                         m_TIA.textItemArray_p[row].size)
+                return false;
+            }
+        }
+        result.times.push_back(timeMeas.elapsed(CTimeMeas::micro));
+    }
+
+    return true;
+}
+
+/***********************************************************************************************************************
+*   ReNumerateFIRA
+***********************************************************************************************************************/
+bool CBenchmark::ReNumerateFIRA(CFilterContainer& container)
+{
+    const int filterMatches = m_FIRA.filterMatches;
+    BenchmarkResult_t& result = AddResult("fira_renumbering", m_TIA.rows,
+                                          static_cast<int64_t>(sizeof(FIR_t)) * m_TIA.rows, filterMatches);
+
+    for (int run = 0; run < m_config.runs; ++run) {
+        CTimeMeas timeMeas;
+        FilterMgr::ReNumerateFIRA(m_FIRA, m_TIA, container.GetFilterLUT());
+        result.times.push_back(timeMeas.elapsed(CTimeMeas::micro));
+
+        if (m_FIRA.filterMatches != filterMatches) {
+            TRACEX_E("Benchmark  FIRA renumbering failed, matches:%d expected:%d", m_FIRA.filterMatches,
+                     filterMatches)
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/***********************************************************************************************************************
+*   Plot
+*   Plot generation with the plots of the plugin, loaded as when loaded from the GUI
+***********************************************************************************************************************/
+bool CBenchmark::Plot(void)
+{
+    if (m_config.pluginFileName.isEmpty()) {
+        TRACEX_I("Benchmark  No plugin, plot generation skipped")
+        return true;
+    }
+
+    QLibrary library(m_config.pluginFileName);
+    DLL_API_PluginVersion_t version;
+
+    if (!library.load()) {
+        TRACEX_E("Benchmark  Failed to load %s, %s", m_config.pluginFileName.toLatin1().constData(),
+                 library.errorString().toLatin1().constData())
+        return false;
+    }
+
+    auto getVersion = reinterpret_cast<DLL_API_GetPluginAPIVersion_t>(library.resolve(DLL_API_GET_PLUGIN_API_VERSION));
+    auto setAttachConfiguration =
+        reinterpret_cast<DLL_API_SetAttachConfiguration_t>(library.resolve(DLL_API_SET_ATTACH_CONFIGURATION));
+    auto createPlugin = reinterpret_cast<DLL_API_CreatePlugin_t>(library.resolve(DLL_API_CREATE_PLUGIN));
+    auto deletePlugin = reinterpret_cast<DLL_API_DeletePlugin_t>(library.resolve(DLL_API_DELETE_PLUGIN));
+
+    memset(&version, 0, sizeof(version));
+    if (getVersion != nullptr) {
+        getVersion(&version);
+    }
+
+    if ((version.version != DLL_API_VERSION) || (createPlugin == nullptr) || (deletePlugin == nullptr)) {
+        TRACEX_E("Benchmark  %s isn't a plugin of version %d", m_config.pluginFileName.toLatin1().constData(),
+                 DLL_API_VERSION)
+        library.unload();
+        return false;
+    }
+
+    if (setAttachConfiguration != nullptr) {
+        DLL_API_AttachConfiguration_t attachConfiguration;
+        memset(&attachConfiguration, 0, sizeof(attachConfiguration));
+        setAttachConfiguration(&attachConfiguration);
+    }
+
+    CPlugin_DLL_API *plugin_p = createPlugin();
+    CList_LSZ *plotList_p;
+    QList<CPlot *> plots;
+
+    if ((plugin_p != nullptr) && plugin_p->GetPlots(&plotList_p)) {
+        for (auto plot_p = plotList_p->first(); plot_p != nullptr; plot_p = plotList_p->GetNext(plot_p)) {
+            plots.append(static_cast<CPlot *>(plot_p));
+        }
+    }
+
+    if (plots.isEmpty()) {
+        TRACEX_E("Benchmark  %s has no plots", m_config.pluginFileName.toLatin1().constData())
+    } else {
+        BenchmarkResult_t& result = AddResult("plot_generation", m_TIA.rows, m_fileSize);
+
+        for (int run = 0; run < m_config.runs; ++run) {
+            CPlotCtrl plotCtrl;
+            CTimeMeas timeMeas;
+
+            for (auto& plot_p : plots) {
+                plot_p->PlotClean();
+                plot_p->PlotBegin();
+            }
+
+            plotCtrl.Start_PlotProcessing(&m_logFile, m_workMem_p, BENCHMARK_WORK_MEM_SIZE, &m_TIA, 0, &plots, 0,
+                                          m_TIA.rows - 1);
+
+            for (auto& plot_p : plots) {
+                plot_p->PlotEnd();
+            }
+            result.times.push_back(timeMeas.elapsed(CTimeMeas::micro));
+        }
+    }
+
+    if (plugin_p != nullptr) {
+        deletePlugin(plugin_p);
+    }
+    library.unload();
+
+    return !plots.isEmpty();
+}
+
+/***********************************************************************************************************************
+*   WriteResult
+***********************************************************************************************************************/
+bool CBenchmark::WriteResult(const QString& resultFileName)
+{
+    QJsonObject config;
+    config["rows"] = m_config.rows;
+    config["lineLengthMin"] = m_config.lineLengthMin;
+    config["lineLengthMax"] = m_config.lineLengthMax;
+    config["matchDensity"] = m_config.matchDensity;
+    config["runs"] = m_config.runs;
+    config["seed"] = static_cast<qint64>(m_config.seed);
+    config["threads"] = g_cfg_p->m_numOfThreads;
+    config["numaNodes"] = Numa_GetNumOfNodes();
+    config["plugin"] = QFileInfo(m_config.pluginFileName).fileName();
+    config["logBytes"] = static_cast<qint64>(m_fileSize);
+
+    QJsonArray benchmarks;
+    const BenchmarkResult_t *scalingBase_p = nullptr;   /* The first filter scaling result, the speedups relative it */
+
+    for (auto& result : m_results) {
+        const int64_t median = _median(result.times);
+        const double seconds = static_cast<double>(std::max(median, static_cast<int64_t>(1))) / 1000000.0;
+        const int64_t rowsPerSecond = qRound64(static_cast<double>(result.rows) / seconds);
+        const double mbPerSecond = static_cast<double>(result.bytes) / (1024.0 * 1024.0) / seconds;
+        QJsonArray times;
+        QJsonObject benchmark;
+
+        for (auto time : result.times) {
+            times.append(static_cast<qint64>(time));
+        }
+
+        benchmark["name"] = result.name;
+        benchmark["rows"] = static_cast<qint64>(result.rows);
+        benchmark["bytes"] = static_cast<qint64>(result.bytes);
+        if (result.matches >= 0) {
+            benchmark["matches"] = static_cast<qint64>(result.matches);
+        }
+        benchmark["times_us"] = times;
+        benchmark["median_ms"] = static_cast<double>(median) / 1000.0;
+        benchmark["min_ms"] = static_cast<double>(*std::min_element(result.times.begin(), result.times.end())) / 1000.0;
+        benchmark["rows_per_s"] = static_cast<qint64>(rowsPerSecond);
+        benchmark["mb_per_s"] = mbPerSecond;
+
+        if (result.threads > 0) {
+            if (scalingBase_p == nullptr) {
+                scalingBase_p = &result;
+            }
+
+            /* Efficiency, the speedup per added thread relative the first count, 1.0 is ideal */
+            const int64_t baseMedian = std::max(_median(scalingBase_p->times), static_cast<int64_t>(1));
+            const double speedup = static_cast<double>(baseMedian) / 1000000.0 / seconds;
+            const double efficiency = speedup * scalingBase_p->threads / result.threads;
+
+            benchmark["threads"] = result.threads;
+            benchmark["speedup"] = speedup;
+            benchmark["efficiency"] = efficiency;
+
+            qInfo("%-20s %10.1f ms %14lld rows/s %10.1f MB/s  speedup %5.2f  efficiency %4.2f",
+                  result.name.toLatin1().constData(), static_cast<double>(median) / 1000.0,
+                  static_cast<long long>(rowsPerSecond), mbPerSecond, speedup, efficiency);
+        } else {
+            qInfo("%-20s %10.1f ms %14lld rows/s %10.1f MB/s", result.name.toLatin1().constData(),
+                  static_cast<double>(median) / 1000.0, static_cast<long long>(rowsPerSecond), mbPerSecond);
+        }
+
+        benchmarks.append(benchmark);
+    }
+
+    QJsonObject root;
+    root["application"] = QCoreApplication::applicationName();
+    root["version"] = QCoreApplication::applicationVersion();
+    root["config"] = config;
+    root["benchmarks"] = benchmarks;
+
+    QFile file(resultFileName);
+    const QByteArray json = QJsonDocument(root).toJson();
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || (file.write(json) != json.size())) {
+        TRACEX_E("Benchmark  Failed to write %s", resultFileName.toLatin1().constData())
+        return false;
+    }
+
+    TRACEX_I("Benchmark  Result written to %s", resultFileName.toLatin1().constData())
+    return true;
+}
+
+/***********************************************************************************************************************
+*   Run
+***********************************************************************************************************************/
+bool CBenchmark::Run(const QString& resultFileName)
+{
+    if (!GenerateLog() || !Open() || !IndexTIA()) {
+        return false;
+    }
+
+    std::vector<FilterItemInitializer> literalFilters(1);
+    std::vector<FilterItemInitializer> regExpFilters(1);
+    std::vector<FilterItemInitializer> manyFilters(BENCHMARK_MANY_FILTERS);
+    CFilterContainer literalContainer;
+    CFilterContainer regExpContainer;
+    CFilterContainer manyContainer;
+
+    literalFilters[0] = {BENCHMARK_MATCH_TEXT, false, false};
+    regExpFilters[0] = {BENCHMARK_MATCH_REGEXP, true, false};
+
+    for (int index = 0; index < BENCHMARK_MANY_FILTERS - 1; ++index) {
+        snprintf(manyFilters[static_cast<size_t>(index)].text, sizeof(manyFilters[0].text), "comp%02d ", index);
+        manyFilters[static_cast<size_t>(index)].regExp = false;
+        manyFilters[static_cast<size_t>(index)].m_caseSensitive = false;
+    }
+    manyFilters[BENCHMARK_MANY_FILTERS - 1] = {BENCHMARK_MATCH_TEXT, false, false};
+
+    /* The literal filtering is done last, its FIRA is used when scrolling and renumbering */
+    bool success = Filter("filter_regexp", regExpFilters, m_expectedRegExpMatches, regExpContainer) &&
+                   Filter("filter_many", manyFilters, m_expectedComponentMatches, manyContainer) &&
+                   Filter("filter_literal", literalFilters, m_expectedMatches, literalContainer) &&
+                   Search() &&
+                   ScrollRowCache(literalContainer) &&
+                   ReNumerateFIRA(literalContainer) &&
+                   FilterScaling(literalFilters, m_expectedMatches);
+
+    success = Plot() && success;
+
+    return WriteResult(resultFileName) && success;
+}
+
+/***********************************************************************************************************************
+*   Benchmark_Run
+***********************************************************************************************************************/
+bool Benchmark_Run(const BenchmarkConfig_t& config, const QString& resultFileName)
+{
+    TRACEX_I("Benchmark  rows:%d line length:%d-%d match density:%.2f%% runs:%d seed:%u threads:%d", config.rows,
+             config.lineLengthMin, config.lineLengthMax, config.matchDensity, config.runs, config.seed,
+             g_cfg_p->m_numOfThreads)
+
+    if (config.numa) {
+        g_cfg_p->m_numaPlacement = true;
+    }
+
+    CBenchmark benchmark(config);
+    return benchmark.Run(resultFileName);
+}
+
+/***********************************************************************************************************************
+*   Benchmark_AddOptions
+***********************************************************************************************************************/
+void Benchmark_AddOptions(QCommandLineParser& parser)
+{
+    parser.addOption({"benchmark", "Run the performance benchmarks headless (use with -platform offscreen), "
+                                   "write the result to <file> and exit.", "file"});
+    parser.addOption({"benchmark-rows", "Rows of the generated benchmark log.", "rows"});
+    parser.addOption({"benchmark-line-length", "Row length range of the benchmark log, e.g. 40-200.", "min-max"});
+    parser.addOption({"benchmark-match-density", "Percent of the rows matching the filters.", "percent"});
+    parser.addOption({"benchmark-runs", "Runs of each benchmark, the median is reported.", "runs"});
+    parser.addOption({"benchmark-seed", "Seed of the generated benchmark log.", "seed"});
+    parser.addOption({"benchmark-plugin", "Plugin used for the plot generation benchmark.", "file"});
+    parser.addOption({"benchmark-dir", "Where the benchmark log is generated (temp dir by default).", "dir"});
+    parser.addOption({"benchmark-threads", "Filter scaling, the thread counts to filter with, e.g. 1,8,16,32,64.",
+                      "counts"});
+    parser.addOption({"benchmark-numa", "Filter with the NUMA placement (NUMA_PLACEMENT), to compare with."});
+}
+
+/***********************************************************************************************************************
+*   Benchmark_IsRequested
+***********************************************************************************************************************/
+bool Benchmark_IsRequested(const QCommandLineParser& parser)
+{
+    return parser.isSet("benchmark");
+}
+
+/***********************************************************************************************************************
+*   Benchmark_Main
+***********************************************************************************************************************/
+int Benchmark_Main(const QCommandLineParser& parser, const QString& startDir)
+{
+    BenchmarkConfig_t config;
+    const QDir dir(startDir);
+    bool ok = true;
+
+    if (parser.isSet("benchmark-rows")) {
+        config.rows = parser.value("benchmark-rows").toInt(&ok);
+        ok = ok && (config.rows > 0);
+    }
+
+    if (ok && parser.isSet("benchmark-line-length")) {
+        const QStringList range = parser.value("benchmark-line-length").split('-');
+        bool minOk = false;
+        bool maxOk = false;
+        if (range.count() == 2) {
+            config.lineLengthMin = range[0].toInt(&minOk);
+            config.lineLengthMax = range[1].toInt(&maxOk);
+        }
+        ok = minOk && maxOk && (config.lineLengthMin > 0) && (config.lineLengthMin <= config.lineLengthMax) &&
+             (config.lineLengthMax <= BENCHMARK_MAX_LINE_LENGTH);
+    }
+
+    if (ok && parser.isSet("benchmark-match-density")) {
+        config.matchDensity = parser.value("benchmark-match-density").toDouble(&ok);
+        ok = ok && (config.matchDensity >= 0.0) && (config.matchDensity <= 100.0);
+    }
+
+    if (ok && parser.isSet("benchmark-runs")) {
+        config.runs = parser.value("benchmark-runs").toInt(&ok);
+        ok = ok && (config.runs > 0);
+    }
+
+    if (ok && parser.isSet("benchmark-seed")) {
+        config.seed = parser.value("benchmark-seed").toUInt(&ok);
+    }
+
+    if (ok && parser.isSet("benchmark-threads")) {
+        for (auto& count : parser.value("benchmark-threads").split(',')) {
+            const int threads = count.toInt(&ok);
+            if (!ok || (threads <= 0)) {
+                ok = false;
+                break;
+            }
+            config.threads.push_back(threads);
+        }
+    }
+
+    if (!ok) {
+        TRACEX_E("Benchmark  Invalid options")
+        qInfo("Invalid benchmark options, see --help");
+        return 1;
+    }
+
+    config.numa = parser.isSet("benchmark-numa");
+
+    if (parser.isSet("benchmark-plugin")) {
+        config.pluginFileName = dir.absoluteFilePath(parser.value("benchmark-plugin"));
+    }
+
+    if (parser.isSet("benchmark-dir")) {
+        config.workDir = dir.absoluteFilePath(parser.value("benchmark-dir"));
+    }
+
+    return Benchmark_Run(config, dir.absoluteFilePath(parser.value("benchmark"))) ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include <QString>
+
+class QCommandLineParser;
+
+#define BENCHMARK_DEFAULT_ROWS              (2 * 1024 * 1024)
+#define BENCHMARK_DEFAULT_LINE_LENGTH_MIN   40
+#define BENCHMARK_DEFAULT_LINE_LENGTH_MAX   200
+#define BENCHMARK_MAX_LINE_LENGTH           4096
+#define BENCHMARK_DEFAULT_MATCH_DENSITY     1.0     /* Percent of the rows */
+#define BENCHMARK_DEFAULT_RUNS              3
+#define BENCHMARK_DEFAULT_SEED              1
+
+/* Defines the generated log and how the benchmarks are run. The same configuration (and seed) always generates the
+ * same log, byte by byte, on all platforms */
+struct BenchmarkConfig_t {
+    int rows = BENCHMARK_DEFAULT_ROWS;
+    int lineLengthMin = BENCHMARK_DEFAULT_LINE_LENGTH_MIN;  /* The row lengths are distributed triangularly between */
+    int lineLengthMax = BENCHMARK_DEFAULT_LINE_LENGTH_MAX;  /* min and max, with the peak in the middle */
+    double matchDensity = BENCHMARK_DEFAULT_MATCH_DENSITY;  /* Percent of the rows matching the filters and searches */
+    int runs = BENCHMARK_DEFAULT_RUNS;                      /* Each benchmark is run this many times, the median used */
+    uint32_t seed = BENCHMARK_DEFAULT_SEED;
+    QString pluginFileName;  /* Plugin with a plot (e.g. plugin_example_1), the plot benchmark is skipped if empty */
+    QString workDir;         /* Where the log is generated and kept for the next run, the temp dir if empty */
+    std::vector<int> threads; /* Thread counts of the filter scaling benchmark, skipped if empty */
+    bool numa = false;        /* NUMA placement when filtering, else as NUMA_PLACEMENT in the settings */
+};
+
+/***********************************************************************************************************************
+*   Benchmarks
+*
+*   Headless performance benchmarks of the processing pipeline, run on a generated log: TIA indexing, filtering
+*   (literal, regular expression, many filter items), search, row cache scrolling, FIRA renumbering and plot generation
+*   with a plugin. The results are written as JSON, per benchmark the run times and the median throughput in rows/s
+*   and MB/s, such that runs from different builds can be compared.
+*
+*   Optionally the filter scaling, the literal filtering run with each of the given thread counts (--benchmark-threads)
+*   and its speedup compared to the first of them. Run with and without --benchmark-numa to compare the NUMA
+*   placement (CNuma) on multi-socket machines.
+*
+*   Started with "LogScrutinizer -platform offscreen --benchmark <result.json>", or the benchmark build target.
+***********************************************************************************************************************/
+
+/* Run the benchmarks, returns false if any of them failed or the result couldn't be written */
+bool Benchmark_Run(const BenchmarkConfig_t& config, const QString& resultFileName);
+
+/* The --benchmark command line options */
+void Benchmark_AddOptions(QCommandLineParser& parser);
+
+/****/
+bool Benchmark_IsRequested(const QCommandLineParser& parser);
+
+/* Run the benchmarks as configured by the command line, relative file names are relative startDir. Returns the exit
+ * code of the application */
+int Benchmark_Main(const QCommandLineParser& parser, const QString& startDir);
@@ -10,6 +10,9 @@
 #include "CMemPool.h"
 #include "CFileCtrl.h"
 #include "CSearchCtrl.h"
+#include "CSearchIndex.h"
+#include "CBlockSummary.h"
+#include "CFilterExpression.h"
 #include "CFileProcBase.h"
 #include "CFilterProcCtrl.h"
 #include "CRowCache.h"
@@ -24,6 +27,11 @@
 
 #include <QDir>
 #include <QFileDevice>
+#include <QRegularExpression>
+
+#include <vector>
+#include <random>
+#include <functional>
 
 #define TOTAL_NUM_OF_ROWS (1024 * 1024 * 1)
 
@@ -35,6 +43,8 @@ extern bool TestDocument();
 void MultiTestFiltering(void);
 bool TestFiltering(bool useIfExist = true);
 bool TestSearch(bool useIfExist);
+bool TestRequiredLiterals(void);
+bool TestFilterExpression(void);
 bool TestRowCacheAndAutoHighlight(void);
 bool TestWorkspace(void);
 void TestMemory(void);
@@ -143,6 +153,18 @@ void MainTest()
 
     TestSearch(true);
 
+    TRACEX_I("\n\n----------- TestRequiredLiterals ----------\n\n\n")
+
+    if (!TestRequiredLiterals()) {
+        g_DebugLib->ErrorHook("TestRequiredLiterals failed");
+    }
+
+    TRACEX_I("\n\n----------- TestFilterExpression ----------\n\n\n")
+
+    if (!TestFilterExpression()) {
+        g_DebugLib->ErrorHook("TestFilterExpression failed");
+    }
+
     TRACEX_I("\n\n----------- TestFiltering ----------\n\n\n")
 
         (void) TestFiltering();
@@ -480,6 +502,362 @@ bool TestSearch(bool useIfExist)
     return true;
 }
 
+/***********************************************************************************************************************
+*   TestRequiredLiterals_Search
+*   All rows matching the search text, searched forward one match at the time as the user does
+***********************************************************************************************************************/
+static std::vector<int> TestRequiredLiterals_Search(QFile& Log_File, TIA_t& TIA, char *mem_p, QString& searchText,
+                                                    const CBlockSummary *blockSummary_p,
+                                                    const CSearchIndex *searchIndex_p)
+{
+    std::vector<int> rows;
+    std::vector<QByteArray> literals;
+    const bool indexed = searchIndex_p != nullptr &&
+                         CSearchIndex::GetRequiredLiterals(searchText, true, literals);
+
+    for (int startRow = 0; startRow < TIA.rows;) {
+        CSearchCtrl searchCtrl;
+        int matchRow;
+
+        if (indexed) {
+            std::vector<std::pair<int, int>> ranges;
+            searchIndex_p->GetCandidateRows(literals, startRow, TIA.rows - 1, false, ranges);
+            (void)searchCtrl.SearchRowRanges(&Log_File, mem_p, TEST_FILTER_PROC_MEM_SIZE, &TIA, nullptr, nullptr, 0,
+                                             &searchText, ranges, false, true, false);
+        } else {
+            searchCtrl.SetBlockSummary(blockSummary_p);
+            searchCtrl.StartProcessing(&Log_File, mem_p, TEST_FILTER_PROC_MEM_SIZE, &TIA, nullptr, nullptr, 0,
+                                       &searchText, startRow, TIA.rows - 1, false, true, false);
+        }
+
+        if (!searchCtrl.GetSearchResult(&matchRow)) {
+            break;
+        }
+        rows.push_back(matchRow);
+        startRow = matchRow + 1;
+    }
+    return rows;
+}
+
+/***********************************************************************************************************************
+*   TestRequiredLiterals_Filter
+*   All rows matching the filter, the filter guard is made from the required literals
+***********************************************************************************************************************/
+static std::vector<int> TestRequiredLiterals_Filter(QFile& Log_File, TIA_t& TIA, char *mem_p, const QString& text,
+                                                    const CBlockSummary *blockSummary_p)
+{
+    FilterItemInitializer filterInitializer = {{}, true, false};
+    CFilterContainer container;
+    CFilterProcCtrl filterCtrl;
+    QList<CFilterItem *> filterItems;
+    FilterExecTimes_t execTimes;
+    QList<int> bookmarks;
+    FIRA_t FIRA = {nullptr, 0, 0};
+    std::vector<FIR_t> FIR_Array(static_cast<size_t>(TIA.rows));
+    std::vector<int> rows;
+
+    qstrncpy(filterInitializer.text, text.toLatin1().constData(), sizeof(filterInitializer.text));
+    container.GenerateFilterItems(&filterInitializer, 1);
+    container.GenerateLUT();
+    container.PopulateFilterItemList(filterItems);
+    filterItems.first()->m_regexpr = true;  /* GenerateFilterItems makes plain text items */
+
+    filterCtrl.SetBlockSummary(blockSummary_p);
+    filterCtrl.StartProcessing(&Log_File, mem_p, TEST_FILTER_PROC_MEM_SIZE, &TIA, FIR_Array.data(), TIA.rows,
+                               &filterItems, container.GetFilterLUT(), &execTimes, 0, -1, -1, -1, -1,
+                               &FIRA.filterMatches, &FIRA.filterExcludeMatches, &bookmarks);
+
+    for (int row = 0; row < TIA.rows; ++row) {
+        if (FIR_Array[static_cast<size_t>(row)].LUT_index != 0) {
+            rows.push_back(row);
+        }
+    }
+    return rows;
+}
+
+/***********************************************************************************************************************
+*   TestRequiredLiterals
+*   The search index, the block summary and the filter guards only narrow the rows to process with the literals from
+*   CSearchIndex::GetRequiredLiterals. Inline options and {,n} must not be taken as literals, hence the spaced out rows
+*   are in the first half of the log and the rows with the literals in the second half, a literal wrongly taken as
+*   required narrows away the matches. Each way must find the same rows as a plain regular expression match of each row.
+***********************************************************************************************************************/
+bool TestRequiredLiterals(void)
+{
+#define TEST_LITERALS_ROWS  (256 * 1024)   /* About 10 MB, several block summary blocks */
+#define TEST_LITERALS_MODULUS  1009        /* Few matches, each is a search from the previous */
+
+    typedef struct {
+        const char *text;
+        bool hasLiterals;
+    } LiteralCase_t;
+
+    static const LiteralCase_t literalCases[] = {
+        {"(?x)M a t c h", false},
+        {"Mat{,3}ch me now", false},
+        {"Match(?i) me now", false},
+        {"Match me.*now", true},
+        {"(?:Match) me now", true}
+    };
+
+    for (auto& literalCase : literalCases) {
+        std::vector<QByteArray> literals;
+        const bool hasLiterals = CSearchIndex::GetRequiredLiterals(QString(literalCase.text), true, literals);
+
+        if (hasLiterals != literalCase.hasLiterals) {
+            TRACEX_E(QString("TestRequiredLiterals - GetRequiredLiterals %1").arg(literalCase.text))
+            return false;
+        }
+
+        for (auto& literal : literals) {
+            if (!QByteArray("Match me now").toUpper().contains(literal.toUpper())) {
+                TRACEX_E(QString("TestRequiredLiterals - Literal %1 of %2").arg(QString(literal)).arg(literalCase.text))
+                return false;
+            }
+        }
+    }
+
+    QString logFileName = "test_literals.txt";
+    QFile Log_File(logFileName);
+
+    if (!Log_File.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+        TRACEX_E("TestRequiredLiterals - Test file couldn't be generated\n")
+        return false;
+    }
+
+    {
+        QTextStream outStream(&Log_File);
+        for (int row = 0; row < TEST_LITERALS_ROWS; ++row) {
+            if (row % TEST_LITERALS_MODULUS != 0) {
+                outStream << "Row " << row << " Dummy string Dummy string Dummy string\r\n";
+            } else if (row < TEST_LITERALS_ROWS / 2) {
+                outStream << "Row " << row << " M a t c h spaced out\r\n";
+            } else {
+                outStream << "Row " << row << " Match me now\r\n";
+            }
+        }
+        outStream.flush();
+    }
+
+    char *mem_p = reinterpret_cast<char *>(VirtualMem::Alloc(TEST_FILTER_PROC_MEM_SIZE));
+    if (mem_p == nullptr) {
+        TRACEX_E("TestRequiredLiterals - Virtual Alloc failed\n")
+        return false;
+    }
+
+    QString TIA_FileName = logFileName + ".tia";
+    QFile TIA_File(TIA_FileName);
+    CBlockSummary blockSummary;
+    CFileCtrl fileCtrl;
+    CSearchIndex searchIndex;
+    TIA_t TIA = {-1, nullptr};  /* -1, have CreateTIA_MemMapped set the number of rows */
+    int rows = 0;
+    int64_t fileSize;
+
+    fileCtrl.SetBlockSummary(&blockSummary);
+    fileCtrl.Search_TIA(&Log_File, TIA_FileName, mem_p, TEST_FILTER_PROC_MEM_SIZE, &rows);
+
+    bool status = FileMapping::CreateTIA_MemMapped(Log_File, TIA_File, &TIA.rows, TIA.textItemArray_p, &fileSize) &&
+                  TIA.rows == TEST_LITERALS_ROWS &&
+                  searchIndex.Build(&Log_File, mem_p, TEST_FILTER_PROC_MEM_SIZE, &TIA,
+                                    CSearchIndex::GetFileName(TIA_FileName));
+    if (!status) {
+        TRACEX_E("TestRequiredLiterals - TIA or search index\n")
+    }
+
+    /* {,n} isn't compared, the reference and Hyperscan may read it differently */
+    static const char *patterns[] = {"(?x)M a t c h", "Match me.*now"};
+
+    for (int index = 0; status && index < static_cast<int>(sizeof(patterns) / sizeof(patterns[0])); ++index) {
+        QString searchText(patterns[index]);
+        QRegularExpression regExp(searchText, QRegularExpression::CaseInsensitiveOption);
+        std::vector<int> expected;
+
+        (void)Log_File.seek(0);
+        for (int row = 0; !Log_File.atEnd(); ++row) {
+            if (regExp.match(QString::fromLatin1(Log_File.readLine()).trimmed()).hasMatch()) {
+                expected.push_back(row);
+            }
+        }
+
+        if (expected.empty()) {
+            TRACEX_E(QString("TestRequiredLiterals - No reference matches %1").arg(searchText))
+            status = false;
+            break;
+        }
+
+        const std::vector<int> fullScan = TestRequiredLiterals_Search(Log_File, TIA, mem_p, searchText, nullptr,
+                                                                      nullptr);
+        const std::vector<int> blockSkipped = TestRequiredLiterals_Search(Log_File, TIA, mem_p, searchText,
+                                                                          &blockSummary, nullptr);
+        const std::vector<int> indexed = TestRequiredLiterals_Search(Log_File, TIA, mem_p, searchText, nullptr,
+                                                                     &searchIndex);
+        const std::vector<int> filtered = TestRequiredLiterals_Filter(Log_File, TIA, mem_p, searchText, nullptr);
+        const std::vector<int> filteredBlockSkipped = TestRequiredLiterals_Filter(Log_File, TIA, mem_p, searchText,
+                                                                                  &blockSummary);
+
+        if ((fullScan != expected) || (blockSkipped != expected) || (indexed != expected) ||
+            (filtered != expected) || (filteredBlockSkipped != expected)) {
+            TRACEX_E(QString("TestRequiredLiterals - %1 expected:%2 search:%3 block skipped:%4 indexed:%5 "
+                             "filter:%6 filter block skipped:%7")
+                         .arg(searchText).arg(expected.size()).arg(fullScan.size()).arg(blockSkipped.size())
+                         .arg(indexed.size()).arg(filtered.size()).arg(filteredBlockSkipped.size()))
+            status = false;
+        }
+    }
+
+    searchIndex.Close();
+    if (TIA.textItemArray_p != nullptr) {
+        TIA_File.unmap(reinterpret_cast<uchar *>(TIA.textItemArray_p));
+    }
+    TIA_File.close();
+    Log_File.close();
+    VirtualMem::Free(mem_p);
+
+    return status;
+}
+
+/***********************************************************************************************************************
+*   TestFilterExpression
+*   The parser (precedence, escapes and the WITHIN bound), and Evaluate compared with a naive evaluation of each row.
+*   The B rows are sparse and placed at the word borders, such that WITHIN dilates across them.
+***********************************************************************************************************************/
+bool TestFilterExpression(void)
+{
+    CFilterExpression expression;
+
+    /* \" in text and \/ in a regular expression */
+    if (!expression.Parse("\"say \\\"hi\\\"\" AND /a\\/b/", false) || (expression.GetLeaves().size() != 2) ||
+        (expression.GetLeaves()[0].text != QByteArray("say \"hi\"")) || expression.GetLeaves()[0].regExp ||
+        (expression.GetLeaves()[1].text != QByteArray("a/b")) || !expression.GetLeaves()[1].regExp) {
+        TRACEX_E("TestFilterExpression - Escapes\n")
+        return false;
+    }
+
+    const QString withinMax = QString("\"a\" WITHIN %1 \"b\"").arg(FILTER_EXPR_MAX_DISTANCE);
+    const QString withinOver = QString("\"a\" WITHIN %1 \"b\"").arg(FILTER_EXPR_MAX_DISTANCE + 1);
+
+    if (!expression.Parse(withinMax.toLatin1().constData(), false) ||
+        expression.Parse(withinOver.toLatin1().constData(), false) ||
+        expression.Parse("\"a\" WITHIN \"b\"", false)) {
+        TRACEX_E("TestFilterExpression - WITHIN bound\n")
+        return false;
+    }
+
+    /* Precedence, NOT binds hardest, then WITHIN (AND on a single row), AND and OR */
+    typedef struct {
+        const char *expression;
+        const char *row;
+        bool match;
+    } PrecedenceCase_t;
+
+    static const PrecedenceCase_t precedenceCases[] = {
+        {"\"a\" OR \"b\" AND \"c\"", "a", true},
+        {"\"a\" AND \"b\" OR \"c\"", "c", true},
+        {"NOT \"a\" AND \"b\"", "x", false},
+        {"NOT \"a\" OR \"b\"", "a b", true},
+        {"\"a\" WITHIN 1 \"b\" OR \"c\"", "c", true},
+        {"(\"a\" OR \"b\") AND \"c\"", "a", false}
+    };
+
+    for (auto& precedenceCase : precedenceCases) {
+        if (!expression.Parse(precedenceCase.expression, false) ||
+            (expression.MatchRow(precedenceCase.row, static_cast<int>(strlen(precedenceCase.row))) !=
+             precedenceCase.match)) {
+            TRACEX_E(QString("TestFilterExpression - Precedence %1 on \"%2\"")
+                         .arg(precedenceCase.expression).arg(precedenceCase.row))
+            return false;
+        }
+    }
+
+    const int numOfWords = 5;
+    static const int density[] = {4, 40, 3, 20}; /* One row in N matches A, B, C and D */
+    std::vector<uint64_t> bitmaps[4];
+    std::mt19937 random(4711);
+    int firstRow = 0;
+    int lastRow = 0;
+
+    auto bit = [&] (char leaf, int row) {
+        return ((bitmaps[leaf - 'A'][static_cast<size_t>(row >> 6)] >> (row & 63)) & 1) != 0;
+    };
+    auto within = [&] (const std::function<bool(int)>& match, int row, int distance) {
+        for (int near = row - distance; near <= row + distance; ++near) {
+            if ((near >= firstRow) && (near <= lastRow) && match(near)) {
+                return true;
+            }
+        }
+        return false;
+    };
+    auto leafB = [&] (int row) {return bit('B', row);};
+    auto leafC = [&] (int row) {return bit('C', row);};
+
+    typedef struct {
+        QString expression;
+        std::function<bool(int)> match;
+    } EvaluateCase_t;
+
+    std::vector<EvaluateCase_t> evaluateCases = {
+        {"\"A\" WITHIN 3 \"B\" AND NOT \"C\" OR \"D\"",
+         [&] (int row) {return (bit('A', row) && within(leafB, row, 3) && !bit('C', row)) || bit('D', row);}},
+        {"NOT \"A\" WITHIN 2 \"B\"", [&] (int row) {return !bit('A', row) && within(leafB, row, 2);}},
+        {"\"A\" WITHIN 2 NOT \"C\"",
+         [&] (int row) {return bit('A', row) && within([&] (int near) {return !leafC(near);}, row, 2);}},
+        {"(\"A\" OR \"B\") WITHIN 1 \"C\" AND \"D\"",
+         [&] (int row) {return (bit('A', row) || bit('B', row)) && within(leafC, row, 1) && bit('D', row);}}
+    };
+
+    static const int distances[] = {0, 1, 2, 3, 5, 63, 64, 65, 100, 127, 128, 129, 200};
+    for (auto distance : distances) {
+        evaluateCases.push_back({QString("\"A\" WITHIN %1 \"B\"").arg(distance),
+                                 [&, distance] (int row) {return bit('A', row) && within(leafB, row, distance);}});
+    }
+
+    static const int ranges[][2] = {{0, numOfWords * 64 - 1}, {5, 300}, {63, 64}, {64, 191}, {1, 318}};
+
+    for (auto& range : ranges) {
+        firstRow = range[0];
+        lastRow = range[1];
+
+        /* The leaves have no bits outside firstRow..lastRow, as when filtered */
+        for (int leaf = 0; leaf < 4; ++leaf) {
+            bitmaps[leaf].assign(numOfWords, 0);
+            for (int row = firstRow; row <= lastRow; ++row) {
+                const bool border = (leaf == 1) && (((row & 63) == 0) || ((row & 63) == 63));
+                if (border || (random() % static_cast<uint32_t>(density[leaf]) == 0)) {
+                    bitmaps[leaf][static_cast<size_t>(row >> 6)] |= static_cast<uint64_t>(1) << (row & 63);
+                }
+            }
+        }
+
+        for (auto& evaluateCase : evaluateCases) {
+            std::vector<const uint64_t *> leafBitmaps;
+            std::vector<uint64_t> result(numOfWords, 0);
+
+            if (!expression.Parse(evaluateCase.expression.toLatin1().constData(), false)) {
+                TRACEX_E(QString("TestFilterExpression - Parse %1").arg(evaluateCase.expression))
+                return false;
+            }
+
+            for (auto& leaf : expression.GetLeaves()) {
+                leafBitmaps.push_back(bitmaps[leaf.text[0] - 'A'].data());
+            }
+
+            expression.Evaluate(leafBitmaps, firstRow, lastRow, result.data());
+
+            for (int row = 0; row <= lastRow; ++row) {
+                const bool expected = (row >= firstRow) && evaluateCase.match(row);
+                if (((result[static_cast<size_t>(row >> 6)] >> (row & 63)) & 1) != (expected ? 1 : 0)) {
+                    TRACEX_E(QString("TestFilterExpression - Evaluate %1 rows:%2-%3 row:%4")
+                                 .arg(evaluateCase.expression).arg(firstRow).arg(lastRow).arg(row))
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
 /***********************************************************************************************************************
 *   LoadMapTIAandFIRA
 ***********************************************************************************************************************/
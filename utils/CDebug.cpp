@@ -6,9 +6,13 @@
 #include <time.h>
 #include <string.h>
 
+#include <algorithm>
+#include <vector>
+
 #include <QDateTime>
 #include <QDebug>
 #include <QMessageBox>
+#include <QWaitCondition>
 
 #include "CDebug.h"
 #include "quickFix.h"
@@ -23,7 +27,225 @@ CDebug *g_DebugLib = nullptr;
 CRamLog *g_RamLog = nullptr;
 static int g_warnings = 0;
 static int g_errors = 0;
-static QThreadStorage<tls_data_t *> tls_data;
+
+static thread_local ramLogData_t *g_threadRamLog_p = nullptr;
+static thread_local bool g_threadRamLogMissing = false;   /* All RamLogs were in use when the thread registered */
+
+typedef struct {
+    int logLevel;
+    qint64 time_ms;
+    QString message;
+} TraceQueueEntry_t;
+
+/* Single producer, the thread owning it, and single consumer, the drainer. The head is stored by the producer with
+ * release after the entry is written, the tail by the drainer with release after the entry is taken. */
+typedef struct {
+    TraceQueueEntry_t entries[TRACEX_QUEUE_SIZE];
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    std::atomic<int> dropped;
+    std::atomic<bool> orphaned;   /* The thread has exited, the drainer frees the queue */
+} TraceQueue_t;
+
+static QMutex g_traceQueueMutex; /* Protects the queue list, taken when a thread traces the first time */
+static std::vector<TraceQueue_t *> g_traceQueues;
+
+/***********************************************************************************************************************
+*   CTraceQueueOwner
+*   Marks the thread's queue as orphaned at thread exit, the drainer writes what is left in it and frees it
+***********************************************************************************************************************/
+class CTraceQueueOwner
+{
+public:
+    ~CTraceQueueOwner(void)
+    {
+        if (m_queue_p != nullptr) {
+            m_queue_p->orphaned.store(true, std::memory_order_release);
+        }
+    }
+
+    TraceQueue_t *m_queue_p = nullptr;
+};
+
+static thread_local CTraceQueueOwner g_traceQueueOwner;
+
+/***********************************************************************************************************************
+*   TraceQueue_Push
+***********************************************************************************************************************/
+static void TraceQueue_Push(int logLevel, const QString& message)
+{
+    TraceQueue_t *queue_p = g_traceQueueOwner.m_queue_p;
+
+    if (queue_p == nullptr) {
+        queue_p = new TraceQueue_t;
+        queue_p->head = 0;
+        queue_p->tail = 0;
+        queue_p->dropped = 0;
+        queue_p->orphaned = false;
+
+        QMutexLocker locker(&g_traceQueueMutex);
+        g_traceQueues.push_back(queue_p);
+        g_traceQueueOwner.m_queue_p = queue_p;
+    }
+
+    const uint32_t head = queue_p->head.load(std::memory_order_relaxed);
+    if (head - queue_p->tail.load(std::memory_order_acquire) >= TRACEX_QUEUE_SIZE) {
+        /* The drainer is behind, never wait for it */
+        queue_p->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    TraceQueueEntry_t& entry = queue_p->entries[head & (TRACEX_QUEUE_SIZE - 1)];
+    entry.logLevel = logLevel;
+    entry.time_ms = QDateTime::currentMSecsSinceEpoch();
+    entry.message = message;  /* Implicitly shared, no copy of the text */
+    queue_p->head.store(head + 1, std::memory_order_release);
+}
+
+/***********************************************************************************************************************
+*   CTraceDrainer
+*   Writes the queued TRACEX messages, in time order, every TRACEX_DRAIN_INTERVAL_MS or when flushed
+***********************************************************************************************************************/
+class CTraceDrainer : public QThread
+{
+public:
+    explicit CTraceDrainer(CDebug *debug_p) : m_debug_p(debug_p) {setObjectName(QString("TRACEX drainer"));}
+
+    void Flush(void);
+    void Stop(void);
+
+protected:
+    virtual void run(void) override;
+
+private:
+    void Drain(void);
+
+    CDebug *m_debug_p;
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    QWaitCondition m_drained;
+    uint64_t m_started = 0;     /* Drain passes started */
+    uint64_t m_completed = 0;   /* The last drain pass completed */
+    bool m_flushRequested = false;
+    bool m_stop = false;
+};
+
+/***********************************************************************************************************************
+*   run
+***********************************************************************************************************************/
+void CTraceDrainer::run(void)
+{
+    bool stop = false;
+
+    while (!stop) {
+        uint64_t pass;
+
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_stop && !m_flushRequested) {
+                m_wake.wait(&m_mutex, TRACEX_DRAIN_INTERVAL_MS);
+            }
+            m_flushRequested = false;
+            stop = m_stop; /* Still a last pass after stop */
+            pass = ++m_started;
+        }
+
+        Drain();
+
+        QMutexLocker locker(&m_mutex);
+        m_completed = pass;
+        m_drained.wakeAll();
+    }
+}
+
+/***********************************************************************************************************************
+*   Drain
+***********************************************************************************************************************/
+void CTraceDrainer::Drain(void)
+{
+    std::vector<TraceQueueEntry_t> entries;
+    int dropped = 0;
+
+    {
+        QMutexLocker locker(&g_traceQueueMutex);
+        auto iter = g_traceQueues.begin();
+        while (iter != g_traceQueues.end()) {
+            TraceQueue_t *queue_p = *iter;
+            const bool orphaned = queue_p->orphaned.load(std::memory_order_acquire);
+            const uint32_t head = queue_p->head.load(std::memory_order_acquire);
+            uint32_t tail = queue_p->tail.load(std::memory_order_relaxed);
+
+            for ( ; tail != head; ++tail) {
+                entries.push_back(std::move(queue_p->entries[tail & (TRACEX_QUEUE_SIZE - 1)]));
+            }
+            queue_p->tail.store(tail, std::memory_order_release);
+            dropped += queue_p->dropped.exchange(0, std::memory_order_relaxed);
+
+            if (orphaned) {
+                delete queue_p;
+                iter = g_traceQueues.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
+
+    if (entries.empty() && (dropped == 0)) {
+        return;
+    }
+
+    /* Each queue is in order, stable sort keeps it while merging the threads */
+    std::stable_sort(entries.begin(), entries.end(),
+                     [] (const TraceQueueEntry_t& a, const TraceQueueEntry_t& b) {return a.time_ms < b.time_ms;});
+
+    QTextStream fileStream(m_debug_p->m_file_p);
+
+    for (auto& entry : entries) {
+        m_debug_p->WriteMessage(entry.logLevel, entry.time_ms, entry.message, fileStream);
+    }
+
+    if (dropped > 0) {
+        m_debug_p->WriteMessage(LOG_LEVEL_INFO, QDateTime::currentMSecsSinceEpoch(),
+                                QString("TRACEX dropped %1 messages, the trace queue was full (see the RamLog)")
+                                    .arg(dropped), fileStream);
+    }
+
+    fileStream.flush();
+}
+
+/***********************************************************************************************************************
+*   Flush
+***********************************************************************************************************************/
+void CTraceDrainer::Flush(void)
+{
+    if ((QThread::currentThread() == this) || !isRunning()) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    /* A pass started after this point includes everything traced before */
+    const uint64_t target = m_started + 1;
+    m_flushRequested = true;
+    m_wake.wakeOne();
+
+    while ((m_completed < target) && isRunning()) {
+        m_drained.wait(&m_mutex, TRACEX_DRAIN_INTERVAL_MS);
+    }
+}
+
+/***********************************************************************************************************************
+*   Stop
+***********************************************************************************************************************/
+void CTraceDrainer::Stop(void)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stop = true;
+        m_wake.wakeOne();
+    }
+    wait();
+}
 
 CDebug::CDebug(void)
 {
@@ -45,6 +267,7 @@ CDebug::CDebug(void)
     m_mainThread = QThread::currentThreadId();
 
     m_file_p = nullptr;
+    m_drainer_p = nullptr;
     g_DebugLib = this;
 
     /* QT_TODO: m_h_pluginMsgHeap = HeapCreate(0, PLUGIN_MSG_HEAP_SIZE, PLUGIN_MSG_HEAP_SIZE_MAX); */
@@ -55,6 +278,12 @@ CDebug::CDebug(void)
 ***********************************************************************************************************************/
 void CDebug::cleanUp(void)
 {
+    if (m_drainer_p != nullptr) {
+        m_drainer_p->Stop(); /* Writes what is left in the queues */
+        delete m_drainer_p;
+        m_drainer_p = nullptr;
+    }
+
     if (m_file_p != nullptr) {
         m_file_p->flush();
         m_file_p->close();
@@ -134,6 +363,10 @@ void CDebug::Initialize(void)
     QString logString = "";
     QTextStream textStream(&logString);
     m_file_p = new QFile(fileName);
+
+    m_drainer_p = new CTraceDrainer(this);
+    m_drainer_p->start(QThread::LowPriority);
+
     if (!m_file_p->open(openFlags)) {
         QString errorMsg = m_file_p->errorString();
         textStream << "Log file could not be opened: " << fileName << " Error:" << errorMsg << Qt::endl;
@@ -216,11 +449,6 @@ void CDebug::TRACEX(int logLevel, const QString& msgString)
 ***********************************************************************************************************************/
 void CDebug::TRACEX(int logLevel, const QString *msgString_p)
 {
-    time_t localtime;
-    QString logString;
-    QTextStream textStream(&logString);
-    QTextStream fileStream(m_file_p);
-
     if (CSCZ_SystemState == SYSTEM_STATE_SHUTDOWN) {
         return;
     }
@@ -230,7 +458,7 @@ void CDebug::TRACEX(int logLevel, const QString *msgString_p)
     }
 
     if ((g_RamLog != nullptr) && (msgString_p != nullptr)) {
-        g_RamLog->AddBuffer(msgString_p->toLatin1().data());
+        g_RamLog->AddBuffer(*msgString_p);
     }
 
     if (logLevel > m_logLevel) {
@@ -243,48 +471,60 @@ void CDebug::TRACEX(int logLevel, const QString *msgString_p)
         return;
     }
 
-    {
-        /* Locking scope */
-        QMutexLocker ml(&m_mutex);  /* when ml passes its scope the mutex will automatically be freed */
-#ifndef _DEBUG
-        if (logLevel >= LOG_LEVEL_INFO)
-#endif
-        {
-            time(&localtime);
-
-            if (localtime != m_lastlocaltime) {
-                QDateTime now = QDateTime::currentDateTime();
-                now = now.toLocalTime();
+    TraceQueue_Push(logLevel, *msgString_p);
 
-                m_timeString = now.toString("yyyy.MM.dd hh:mm:ss.zzz");
-                m_lastlocaltime = localtime;
-            }
+    if (logLevel == LOG_LEVEL_ERROR) {
+        Flush(); /* The error is in the log file before any dialog or throw */
+        ErrorHook(msgString_p->toLatin1().data());
+    } else if (logLevel == LOG_LEVEL_WARNING) {
+        WarningHook();
+    }
+}
 
-            textStream << m_timeString << " ";
-            textStream << *msgString_p;
+/***********************************************************************************************************************
+*   Flush
+***********************************************************************************************************************/
+void CDebug::Flush(void)
+{
+    if (m_drainer_p != nullptr) {
+        m_drainer_p->Flush();
+    }
+}
 
-            if (m_traceWindowEnabled && (logLevel <= m_logLevel)) {}
+/***********************************************************************************************************************
+*   WriteMessage
+*   Drainer thread only
+***********************************************************************************************************************/
+void CDebug::WriteMessage(int logLevel, qint64 time_ms, const QString& message, QTextStream& fileStream)
+{
+    QString logString;
+    QTextStream textStream(&logString);
 
-            fileStream << logString << Qt::endl;
-        }
+#ifndef _DEBUG
+    if (logLevel >= LOG_LEVEL_INFO)
+#endif
+    {
+        const time_t localtime = static_cast<time_t>(time_ms / 1000);
 
-        extern bool MW_AppendLogMsg(const QString & message);
-        if (logLevel <= m_logLevel) {
-           MW_AppendLogMsg(logString);
+        if (localtime != m_lastlocaltime) {
+            m_timeString = QDateTime::fromMSecsSinceEpoch(time_ms).toLocalTime().toString("yyyy.MM.dd hh:mm:ss");
+            m_lastlocaltime = localtime;
         }
 
-#ifdef _DEBUG
-        qDebug() << logString.simplified();
-#endif
+        textStream << m_timeString << QString(".%1 ").arg(static_cast<int>(time_ms % 1000), 3, 10, QChar('0'));
+        textStream << message;
 
-        fileStream.flush();
-    } /* Locking scope */
+        fileStream << logString << '\n';
+    }
 
-    if (logLevel == LOG_LEVEL_ERROR) {
-        ErrorHook(msgString_p->toLatin1().data());
-    } else if (logLevel == LOG_LEVEL_WARNING) {
-        WarningHook();
+    extern bool MW_AppendLogMsg(const QString & message);
+    if (logLevel <= m_logLevel) {
+        MW_AppendLogMsg(logString);
     }
+
+#ifdef _DEBUG
+    qDebug() << logString.simplified();
+#endif
 }
 
 /* Plugin Dbg message handling  hwnd_traceConsumer window handler to receive message, h_traceHeap is a memory
@@ -305,9 +545,8 @@ void CDebug::FreePluginMsg(char *msg_p)
 }
 #endif
 
-/* Each thread is given their own ramLogData_t, through QThreadStorage. The QThreadStorage is a template of kind
- * tls_data_t which currently only contains a reference to ramLogData_t. Hence, each thread may set its own ramLog
- * reference as local data.
+/* Each thread is given their own ramLogData_t, referenced by a thread_local pointer. Only the thread itself writes to
+ * its ramLog, hence no lock is needed when adding to it.
  *
  *  The ramLogs them selves are stored in a pool (list), and each time a thread is created a ramLog is picked from
  *  that pool
@@ -319,10 +558,12 @@ void CDebug::FreePluginMsg(char *msg_p)
 
 CRamLog::CRamLog()
 {
-    for (int index = 0; index < RAM_LOG_MAX_COUNT; ++index) {
-        ramLogData_t *mem_p = static_cast<ramLogData_t *>(malloc(sizeof(ramLogData_t)));
+    for (int index = 0; index < RAM_LOG_START_COUNT; ++index) {
+        ramLogData_t *mem_p = new ramLogData_t;
 
         if (mem_p != nullptr) {
+            mem_p->used = false;
+            mem_p->count = 0;
             m_ramLogPool.append(mem_p);
             m_ramLogPoolTracking.append(mem_p);
         }
@@ -342,15 +583,16 @@ void CRamLog::cleanUp(void)
 
     m_cleanUpDone = true;
 
-    if (m_ramLogPool.count() != RAM_LOG_MAX_COUNT) {
-        qDebug() << "RamLog not entirely empty ... " << (RAM_LOG_MAX_COUNT - m_ramLogPool.count()) << " items left\n";
+    if (m_ramLogPool.count() != m_ramLogPoolTracking.count()) {
+        qDebug() << "RamLog not entirely empty ... " << (m_ramLogPoolTracking.count() - m_ramLogPool.count())
+                 << " items left\n";
     }
 
     while (!m_ramLogPoolTracking.empty()) {
         ramLogData_t *ramLogData_p = m_ramLogPoolTracking.takeFirst();
         if (ramLogData_p != nullptr) {
-            memset(ramLogData_p, 0, sizeof(*ramLogData_p));
-            free(ramLogData_p);
+            memset(ramLogData_p->ramLog, 0, sizeof(ramLogData_p->ramLog));
+            delete ramLogData_p;
         }
     }
 }
@@ -360,25 +602,66 @@ void CRamLog::cleanUp(void)
 ***********************************************************************************************************************/
 bool CRamLog::AddBuffer(char *buffer_p, size_t size)
 {
-    if (!tls_data.hasLocalData() || (tls_data.localData()->ramLogData_p == nullptr)) {
-        RegisterThread();
+    if ((g_threadRamLog_p == nullptr) && (g_threadRamLogMissing || !RegisterThread())) {
+        return false;
+    }
+
+    ramLogData_t *ramLog_p = g_threadRamLog_p;
+    ramLogEntry_t *entry_p = NewEntry(ramLog_p, size + 1 /*0 termination*/);
+
+    if (entry_p == nullptr) {
+        return false;
+    }
+
+    memcpy(&(entry_p->data[0]), buffer_p, size + 1);  /* copy the print */
+    ramLog_p->count.store(entry_p->seqCount + 1, std::memory_order_release);
+    return true;
+}
+
+/***********************************************************************************************************************
+*   AddBuffer
+***********************************************************************************************************************/
+bool CRamLog::AddBuffer(const QString& string)
+{
+    if ((g_threadRamLog_p == nullptr) && (g_threadRamLogMissing || !RegisterThread())) {
+        return false;
     }
 
-    size++; /*0 termination*/
+    const int length = string.length();
+    ramLogData_t *ramLog_p = g_threadRamLog_p;
+    ramLogEntry_t *entry_p = NewEntry(ramLog_p, static_cast<size_t>(length) + 1 /*0 termination*/);
 
-    tls_data_t *tls_data_p = tls_data.localData();
-    ramLogData_t *ramLog_p = tls_data_p->ramLogData_p;
+    if (entry_p == nullptr) {
+        return false;
+    }
+
+    /* Same as toLatin1(), without the temporary allocation */
+    const QChar *src_p = string.constData();
+    for (int index = 0; index < length; ++index) {
+        const char latin1 = src_p[index].toLatin1();
+        entry_p->data[index] = latin1 != 0 ? latin1 : '?';
+    }
+    entry_p->data[length] = 0;
 
+    ramLog_p->count.store(entry_p->seqCount + 1, std::memory_order_release);
+    return true;
+}
+
+/***********************************************************************************************************************
+*   NewEntry
+***********************************************************************************************************************/
+ramLogEntry_t *CRamLog::NewEntry(ramLogData_t *ramLog_p, size_t size)
+{
 #ifdef _DEBUG
     /* Qualify the RAM Log setup */
-    if (!ramLog_p->used || (ramLog_p->stamp != 0xbeefbeef)) {
-        return false;
+    if (!ramLog_p->used.load(std::memory_order_relaxed) || (ramLog_p->stamp != 0xbeefbeef)) {
+        return nullptr;
     }
 
     /* check pointer ranges as well */
     if ((ramLog_p->nextRamLogEntryStart_p < reinterpret_cast<ramLogEntry_t *>(&(ramLog_p->ramLog[0])))) {
         g_DebugLib->ErrorHook("RamLog corrupt, entryStart_p is wrong\n");
-        return false;
+        return nullptr;
     }
 #endif
 
@@ -393,19 +676,18 @@ bool CRamLog::AddBuffer(char *buffer_p, size_t size)
     /* Make an extra check such that if the text is longer than the total size of the RAM log then the
      * print will not be added to the buffer at all */
     if (&ramLog_p->nextRamLogEntryStart_p->data[size] >= &ramLog_p->ramLog[RAM_LOG_SIZE - 1]) {
-        return false;
+        return nullptr;
     }
 
-    ramLog_p->nextRamLogEntryStart_p->startMarker = RAM_LOG_ENTRY_START_MARKER;
-    ramLog_p->nextRamLogEntryStart_p->size = size;
-    ramLog_p->nextRamLogEntryStart_p->seqCount = ramLog_p->count;
-    ++ramLog_p->count;
+    ramLogEntry_t *entry_p = ramLog_p->nextRamLogEntryStart_p;
+    entry_p->startMarker = RAM_LOG_ENTRY_START_MARKER;
+    entry_p->size = size;
+    entry_p->seqCount = ramLog_p->count.load(std::memory_order_relaxed); /* Only this thread writes it */
 
-    memcpy(&(ramLog_p->nextRamLogEntryStart_p->data[0]), buffer_p, size);  /* copy the print */
-    ramLog_p->lastRamLogEntryStart_p = ramLog_p->nextRamLogEntryStart_p;
-    ramLog_p->nextRamLogEntryStart_p = reinterpret_cast<ramLogEntry_t *>(&ramLog_p->nextRamLogEntryStart_p->data[size]);
+    ramLog_p->lastRamLogEntryStart_p = entry_p;
+    ramLog_p->nextRamLogEntryStart_p = reinterpret_cast<ramLogEntry_t *>(&entry_p->data[size]);
 
-    return true;
+    return entry_p;
 }
 
 /***********************************************************************************************************************
@@ -413,29 +695,44 @@ bool CRamLog::AddBuffer(char *buffer_p, size_t size)
 ***********************************************************************************************************************/
 bool CRamLog::RegisterThread(void)
 {
-    if (tls_data.hasLocalData()) {
+    if (g_threadRamLog_p != nullptr) {
         g_DebugLib->ErrorHook("Thread has already registered RamLog\n");
         return false;  /* allready registered */
     }
 
-    tls_data_t *tls_data_p = static_cast<tls_data_t *>(malloc(sizeof(tls_data_t)));
-    tls_data.setLocalData(tls_data_p);
-
     QMutexLocker ml(&m_mutex);  /* when ml passes its scope the mutex will automatically be freed */
-    ramLogData_t *ramLogData_p = m_ramLogPool.takeFirst();
 
-    tls_data_p->ramLogData_p = ramLogData_p;
+    if (m_ramLogPool.isEmpty() && !m_cleanUpDone) {
+        /* More threads than ever before, e.g. NUM_OF_THREADS processing threads on a many-core machine */
+        ramLogData_t *mem_p = new ramLogData_t;
+        if (mem_p != nullptr) {
+            mem_p->used = false;
+            mem_p->count = 0;
+            m_ramLogPool.append(mem_p);
+            m_ramLogPoolTracking.append(mem_p);
+        }
+    }
+
+    if (m_ramLogPool.isEmpty()) {
+        /* The thread runs without RamLog, not retried at each print */
+        g_threadRamLogMissing = true;
+        return false;
+    }
 
-    memset(ramLogData_p, 0, sizeof(*ramLogData_p));
+    ramLogData_t *ramLogData_p = m_ramLogPool.takeFirst();
+
+    memset(ramLogData_p->ramLog, 0, sizeof(ramLogData_p->ramLog));
 
     /*uint32_t *endMarker = reinterpret_cast<char*>(ramLogData) + sizeof(rmLogData_t) + RAM_LOG_SIZE */
 
     ramLogData_p->threadID = QThread::currentThreadId();
-    ramLogData_p->used = true;
+    ramLogData_p->count.store(0, std::memory_order_relaxed);
     ramLogData_p->stamp = 0xbeefbeef;
     ramLogData_p->nextRamLogEntryStart_p = reinterpret_cast<ramLogEntry_t *>(&ramLogData_p->ramLog[0]);
     ramLogData_p->lastRamLogEntryStart_p = nullptr;
+    ramLogData_p->used.store(true, std::memory_order_release);
 
+    g_threadRamLog_p = ramLogData_p;
     return true;
 }
 
@@ -444,19 +741,20 @@ bool CRamLog::RegisterThread(void)
 ***********************************************************************************************************************/
 void CRamLog::UnregisterThread(void)
 {
-    tls_data_t *tls_data_p = static_cast<tls_data_t *>(tls_data.localData());
-    ramLogData_t *ramLog_p = tls_data_p->ramLogData_p;
+    ramLogData_t *ramLog_p = g_threadRamLog_p;
 
     if (m_cleanUpDone) {
         return;
     }
 
+    g_threadRamLogMissing = false;
+
     if (ramLog_p != nullptr) {
         QMutexLocker ml(&m_mutex);  /* when ml passes its scope the mutex will automatically be freed */
-        ramLog_p->used = false;
+        ramLog_p->used.store(false, std::memory_order_release);
         m_ramLogPool.append(ramLog_p);  /* return the ramLog to the pool */
         ramLog_p->stamp = 0;
-        tls_data.setLocalData(nullptr);  /* remove the tls_data */
+        g_threadRamLog_p = nullptr;
     }
 }
 
@@ -469,12 +767,14 @@ void CRamLog::CheckRamLogs(void)
     const quint32 totalSize = sizeof(ramLogData_t) + RAM_LOG_SIZE;
     QMutexLocker ml(&m_mutex);  /* when ml passes its scope the mutex will automatically be freed */
 
-    for (int index = 0; index < RAM_LOG_MAX_COUNT; ++index) {
+    for (int index = 0; index < m_ramLogPoolTracking.count(); ++index) {
         ramLogEntry_t *entry_p;
 
         /* Must use m_ramLogPoolDebug since that keeps all ramLogData references, the other is just a pool */
-        if (m_ramLogPoolTracking[index]->used && (m_ramLogPoolTracking[index]->stamp == 0xbeefbeef)) {
+        if (m_ramLogPoolTracking[index]->used.load(std::memory_order_acquire) &&
+            (m_ramLogPoolTracking[index]->stamp == 0xbeefbeef)) {
             ramLog_p = m_ramLogPoolTracking[index];
+            const int ramLogCount = ramLog_p->count.load(std::memory_order_acquire);
 
             const ramLogEntry_t *endEntry_p = reinterpret_cast<ramLogEntry_t *>(&ramLog_p->ramLog[0] + totalSize);
             entry_p = reinterpret_cast<ramLogEntry_t *>(&ramLog_p->ramLog[0]);
@@ -490,7 +790,7 @@ void CRamLog::CheckRamLogs(void)
                 ++count;
 
                 /* this will occur if the ramLog hasn't wrapped, otherwise the ramLog will end at wrap point */
-                if (count == ramLog_p->count) {
+                if (count == ramLogCount) {
                     stop = true;
                 }
 
@@ -561,7 +861,7 @@ int CRamLog::GetRamLog(int index, char **pointerArray_pp, int pointerArrayMaxSiz
     ramLogData_t *ramLog_p;
     ramLogEntry_t *entry_p;
 
-    if (!m_ramLogPoolTracking[index]->used) {
+    if (!m_ramLogPoolTracking[index]->used.load(std::memory_order_acquire)) {
         return 0;
     }
 
@@ -655,11 +955,13 @@ void CRamLog::fileDump(bool updateTimeStamp)
     QMutexLocker ml(&m_mutex);  /* when ml passes its scope the mutex will automatically be freed */
 
     for (auto& ramLog_p : m_ramLogPoolTracking) {
-        if (ramLog_p->used) {
+        if (ramLog_p->used.load(std::memory_order_acquire)) {
+            /* The other threads keep adding while dumping, the entries up to the count are complete */
+            const int ramLogCount = ramLog_p->count.load(std::memory_order_acquire);
             const ramLogEntry_t *endEntry_p = reinterpret_cast<ramLogEntry_t *>(&(ramLog_p->ramLog[RAM_LOG_SIZE]));
             auto entry_p = reinterpret_cast<ramLogEntry_t *>(&ramLog_p->ramLog[0]);
             out << QString("\n\nRAM LOG START thread:%1 count:%2\n\n")
-                .arg(reinterpret_cast<uint64_t>(ramLog_p->threadID)).arg(ramLog_p->count);
+                .arg(reinterpret_cast<uint64_t>(ramLog_p->threadID)).arg(ramLogCount);
 
             int entryIndex = 0;
             bool found = false;
@@ -10,10 +10,15 @@
 #include <QMutex>
 #include <QTextStream>
 #include <QDebug>
-#include <QThreadStorage>
+
+#include <atomic>
 
 #define DBG_CFG_TEMP_STRING_MAX_SIZE 2048
 
+#define TRACEX_QUEUE_SIZE         4096  /* Messages per thread waiting to be written, power of 2. Beyond it they are
+                                         * dropped (still in the RamLog) and counted */
+#define TRACEX_DRAIN_INTERVAL_MS  20    /* How often the drainer writes the queued messages to the log file */
+
 #define LOG_LEVEL_ERROR           0    /* Detected errors */
 #define LOG_LEVEL_WARNING         1    /* Things that might be wrong */
 #define LOG_LEVEL_INFO            2    /* Mem sizes, loaded files, w */
@@ -104,14 +109,22 @@
  #define PRINT_PROGRESS_DBG(...)
 #endif
 
+class CTraceDrainer;
+
 /***********************************************************************************************************************
 *   CDebug
+*
+*   TRACEX only puts the message in the RamLog and in the calling thread's trace queue, both single producer and without
+*   any lock. The time stamping, the log file, the log window and qDebug are handled by the drainer thread, such that
+*   tracing from the processing threads doesn't serialize them. Errors are flushed before the ErrorHook.
 ***********************************************************************************************************************/
 class CDebug
 {
+    friend class CTraceDrainer;
+
 public:
     CDebug(void);
-    ~CDebug(void) {}
+    ~CDebug(void) {cleanUp();}
     void cleanUp(void);
 
     void ErrorHook(const char *hookText);
@@ -125,6 +138,9 @@ public:
     void TRACEX(int logLevel, const QString *msgString_p);
     void TRACEX_with_QFile(int logLevel, const char *msgString_p, QFile *qfile_p);
 
+    /* Wait until the messages traced so far are written to the log file */
+    void Flush(void);
+
     inline bool isTraceEnabled(int logLevel) {return (logLevel <= m_logLevel ? true : false);}
 
     void DisableTraceWindow(void) {m_traceWindowEnabled = false;}
@@ -136,21 +152,21 @@ public:
     bool m_traceWindowEnabled;
     int m_traceCategory; /**< Enable specific tracing of some areas */
     time_t m_lastlocaltime = 0;
-    QString m_timeString;
+    QString m_timeString; /**< Date and time down to the second of m_lastlocaltime, drainer thread only */
 
 private:
+    void WriteMessage(int logLevel, qint64 time_ms, const QString& message, QTextStream& fileStream);
+
     QFile *m_file_p;
     Qt::HANDLE m_mainThread;
-    QMutex m_mutex;
+    CTraceDrainer *m_drainer_p;
 };
 
 extern CDebug *g_DebugLib;
 
 /*   RAM LOG */
 
-#define RAM_LOG_MAX_COUNT  (MAX_NUM_OF_THREADS * 2) /**< Should be enough with MAX_NUM_OF_THREADS + 1, but
-                                                     * there is competing thread hanling, CFileProcControl and
-                                                     * thread manager in cthread.cpp */
+#define RAM_LOG_START_COUNT  32 /**< Allocated at start, the pool grows when more threads register */
 #define RAM_LOG_SIZE                  (10 * 1024)  /* 10kB */
 #define RAM_LOG_ENTRY_START_MARKER    (0xBEEFBEEF)
 #define RAM_LOG_ENTRY_END_MARKER      (0xDEADBEEF)
@@ -162,20 +178,18 @@ typedef struct {
     char data[1]; /**< MUST BE LAST MEMBER */
 } ramLogEntry_t;
 
+/* Written only by the thread owning it. The count is stored with release after each entry, the readers (dumps) load
+ * it with acquire before reading the entries. */
 typedef struct {
     Qt::HANDLE threadID; /**< Which thread that registered to use this ramLog */
     ramLogEntry_t *nextRamLogEntryStart_p; /**< this will wrap around to the beginning */
     ramLogEntry_t *lastRamLogEntryStart_p; /**< this always points to the currently last entry, set at wrap */
-    int count; /**< total number of entries */
-    bool used; /**< True if the ramLog is being used */
+    std::atomic<int> count; /**< total number of entries */
+    std::atomic<bool> used; /**< True if the ramLog is being used */
     uint32_t stamp; /**< Extra check for valid */
     char ramLog[RAM_LOG_SIZE]; /**< Contains ramLogEntries */
 } ramLogData_t;
 
-typedef struct {
-    ramLogData_t *ramLogData_p;
-}tls_data_t;
-
 /***********************************************************************************************************************
    CRamLog
 ***********************************************************************************************************************/
@@ -188,6 +202,7 @@ public:
     void cleanUp(void);
 
     bool AddBuffer(char *buffer_p, size_t size);
+    bool AddBuffer(const QString& string); /* Latin1, converted directly into the RamLog */
 
     /***********************************************************************************************************************
        AddBuffer
@@ -211,8 +226,11 @@ public:
 private:
     void CheckRamLogs(void);
 
+    /* The current thread's next entry, size including the 0 termination. nullptr if it doesn't fit */
+    ramLogEntry_t *NewEntry(ramLogData_t *ramLog_p, size_t size);
+
     bool m_cleanUpDone = false;
-    QMutex m_mutex; /**< Protect the lists */
+    QMutex m_mutex; /**< Protect the lists, only taken at register, unregister and dump */
     QList<ramLogData_t *> m_ramLogPool;
     QList<ramLogData_t *> m_ramLogPoolTracking;  /**< m_ramLogPool keeps only unused,
                                                       m_ramLogPoolTracking keeps all */
@@ -0,0 +1,250 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "CMemAccounting.h"
+#include "CConfig.h"
+#include "CTrace.h"
+
+#include <atomic>
+
+#include <QHash>
+#include <QMutex>
+
+typedef struct {
+    std::atomic<int64_t> current;
+    std::atomic<int64_t> peak;
+    std::atomic<int64_t> traced;    /* The value last recorded in the trace */
+} MemAccCounter_t;
+
+static MemAccCounter_t g_resident[MEM_ACC_COUNT_e];
+static MemAccCounter_t g_mapped[MEM_ACC_COUNT_e];
+static MemAccRefresh_t g_refresh[MEM_ACC_COUNT_e];
+
+static QMutex g_mappingsMutex;
+static QHash<const void *, int64_t> g_mappings;   /* Mapped address -> bytes */
+
+/* The trace stores the name pointers, hence literals */
+static const char *g_names[MEM_ACC_COUNT_e] = {
+    "Memory pool", "Work memory", "TIA", "FIRA", "Plot byte streams", "Autohighlight", "Rock scroll", "Block summary",
+    "Search results", "Search index", "Merge tables", "Incremental load"
+};
+static const char *g_residentTraceNames[MEM_ACC_COUNT_e] = {
+    "Resident memory: Memory pool", "Resident memory: Work memory", "Resident memory: TIA", "Resident memory: FIRA",
+    "Resident memory: Plot byte streams", "Resident memory: Autohighlight", "Resident memory: Rock scroll",
+    "Resident memory: Block summary", "Resident memory: Search results", "Resident memory: Search index",
+    "Resident memory: Merge tables", "Resident memory: Incremental load"
+};
+static const char *g_mappedTraceNames[MEM_ACC_COUNT_e] = {
+    "Mapped memory: Memory pool", "Mapped memory: Work memory", "Mapped memory: TIA", "Mapped memory: FIRA",
+    "Mapped memory: Plot byte streams", "Mapped memory: Autohighlight", "Mapped memory: Rock scroll",
+    "Mapped memory: Block summary", "Mapped memory: Search results", "Mapped memory: Search index",
+    "Mapped memory: Merge tables", "Mapped memory: Incremental load"
+};
+
+/***********************************************************************************************************************
+*   _update
+***********************************************************************************************************************/
+static void _update(MemAccCounter_t& counter, int64_t value, const char *traceName_p, bool forceTrace = false)
+{
+    int64_t peak = counter.peak.load(std::memory_order_relaxed);
+    while ((value > peak) && !counter.peak.compare_exchange_weak(peak, value, std::memory_order_relaxed)) {}
+
+    if (!Trace_IsEnabled()) {
+        return;
+    }
+
+    if (forceTrace) {
+        counter.traced.store(value, std::memory_order_relaxed);
+        Trace_AddCounter(traceName_p, value);
+        return;
+    }
+
+    int64_t traced = counter.traced.load(std::memory_order_relaxed);
+    if ((value >= traced - MEM_ACC_TRACE_GRANULARITY) && (value <= traced + MEM_ACC_TRACE_GRANULARITY)) {
+        return;
+    }
+
+    /* Only the thread winning the exchange records the sample, the others changed it concurrently */
+    if (counter.traced.compare_exchange_strong(traced, value, std::memory_order_relaxed)) {
+        Trace_AddCounter(traceName_p, value);
+    }
+}
+
+/***********************************************************************************************************************
+*   MemAcc_Add
+***********************************************************************************************************************/
+void MemAcc_Add(MemAccSubsystem_e subsystem, int64_t residentBytes)
+{
+    MemAccCounter_t& counter = g_resident[subsystem];
+    const int64_t value = counter.current.fetch_add(residentBytes, std::memory_order_relaxed) + residentBytes;
+    _update(counter, value, g_residentTraceNames[subsystem]);
+}
+
+/***********************************************************************************************************************
+*   MemAcc_Set
+***********************************************************************************************************************/
+void MemAcc_Set(MemAccSubsystem_e subsystem, int64_t residentBytes)
+{
+    MemAccCounter_t& counter = g_resident[subsystem];
+    counter.current.store(residentBytes, std::memory_order_relaxed);
+    _update(counter, residentBytes, g_residentTraceNames[subsystem]);
+}
+
+/***********************************************************************************************************************
+*   MemAcc_Map
+***********************************************************************************************************************/
+void MemAcc_Map(MemAccSubsystem_e subsystem, const void *address_p, int64_t bytes)
+{
+    if (address_p == nullptr) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&g_mappingsMutex);
+        g_mappings.insert(address_p, bytes);
+    }
+
+    MemAccCounter_t& counter = g_mapped[subsystem];
+    const int64_t value = counter.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    _update(counter, value, g_mappedTraceNames[subsystem]);
+}
+
+/***********************************************************************************************************************
+*   MemAcc_Unmap
+***********************************************************************************************************************/
+void MemAcc_Unmap(MemAccSubsystem_e subsystem, const void *address_p)
+{
+    int64_t bytes;
+
+    {
+        QMutexLocker locker(&g_mappingsMutex);
+        auto iter = g_mappings.find(address_p);
+        if (iter == g_mappings.end()) {
+            return;
+        }
+        bytes = iter.value();
+        g_mappings.erase(iter);
+    }
+
+    MemAccCounter_t& counter = g_mapped[subsystem];
+    const int64_t value = counter.current.fetch_sub(bytes, std::memory_order_relaxed) - bytes;
+    _update(counter, value, g_mappedTraceNames[subsystem]);
+}
+
+/***********************************************************************************************************************
+*   MemAcc_SetRefresh
+***********************************************************************************************************************/
+void MemAcc_SetRefresh(MemAccSubsystem_e subsystem, MemAccRefresh_t refresh)
+{
+    g_refresh[subsystem] = refresh;
+}
+
+/***********************************************************************************************************************
+*   MemAcc_Refresh
+***********************************************************************************************************************/
+void MemAcc_Refresh(void)
+{
+    for (int subsystem = 0; subsystem < MEM_ACC_COUNT_e; ++subsystem) {
+        if (g_refresh[subsystem] != nullptr) {
+            MemAcc_Set(static_cast<MemAccSubsystem_e>(subsystem), g_refresh[subsystem]());
+        }
+    }
+}
+
+/***********************************************************************************************************************
+*   MemAcc_Get
+***********************************************************************************************************************/
+MemAccCounters_t MemAcc_Get(MemAccSubsystem_e subsystem)
+{
+    MemAccCounters_t counters;
+    counters.resident = g_resident[subsystem].current.load(std::memory_order_relaxed);
+    counters.mapped = g_mapped[subsystem].current.load(std::memory_order_relaxed);
+    counters.peakResident = g_resident[subsystem].peak.load(std::memory_order_relaxed);
+    counters.peakMapped = g_mapped[subsystem].peak.load(std::memory_order_relaxed);
+    return counters;
+}
+
+/***********************************************************************************************************************
+*   MemAcc_TotalResident
+***********************************************************************************************************************/
+int64_t MemAcc_TotalResident(void)
+{
+    int64_t total = 0;
+    for (int subsystem = 0; subsystem < MEM_ACC_COUNT_e; ++subsystem) {
+        total += g_resident[subsystem].current.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+/***********************************************************************************************************************
+*   MemAcc_TotalMapped
+***********************************************************************************************************************/
+int64_t MemAcc_TotalMapped(void)
+{
+    int64_t total = 0;
+    for (int subsystem = 0; subsystem < MEM_ACC_COUNT_e; ++subsystem) {
+        total += g_mapped[subsystem].current.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+/***********************************************************************************************************************
+*   MemAcc_GetName
+***********************************************************************************************************************/
+const char *MemAcc_GetName(MemAccSubsystem_e subsystem)
+{
+    return g_names[subsystem];
+}
+
+/***********************************************************************************************************************
+*   MemAcc_GetBudget
+***********************************************************************************************************************/
+int64_t MemAcc_GetBudget(void)
+{
+    /* The memory pool is setup before the settings are loaded */
+    if ((g_cfg_p == nullptr) || (g_cfg_p->m_memoryBudget <= 0)) {
+        return 0;
+    }
+    return static_cast<int64_t>(g_cfg_p->m_memoryBudget) * 1024 * 1024;
+}
+
+/***********************************************************************************************************************
+*   MemAcc_Available
+***********************************************************************************************************************/
+int64_t MemAcc_Available(MemAccSubsystem_e subsystem)
+{
+    const int64_t budget = MemAcc_GetBudget();
+
+    if (budget == 0) {
+        return INT64_MAX;
+    }
+
+    const int64_t others = MemAcc_TotalResident() - g_resident[subsystem].current.load(std::memory_order_relaxed);
+    return budget > others ? budget - others : 0;
+}
+
+/***********************************************************************************************************************
+*   MemAcc_TraceCounters
+***********************************************************************************************************************/
+void MemAcc_TraceCounters(void)
+{
+    if (!Trace_IsEnabled()) {
+        return;
+    }
+
+    MemAcc_Refresh();
+
+    /* The counters never used, e.g. the mapped memory of the most subsystems, are left out */
+    for (int subsystem = 0; subsystem < MEM_ACC_COUNT_e; ++subsystem) {
+        if (g_resident[subsystem].peak.load(std::memory_order_relaxed) != 0) {
+            _update(g_resident[subsystem], g_resident[subsystem].current.load(std::memory_order_relaxed),
+                    g_residentTraceNames[subsystem], true);
+        }
+        if (g_mapped[subsystem].peak.load(std::memory_order_relaxed) != 0) {
+            _update(g_mapped[subsystem], g_mapped[subsystem].current.load(std::memory_order_relaxed),
+                    g_mappedTraceNames[subsystem], true);
+        }
+    }
+}
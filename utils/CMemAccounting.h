@@ -0,0 +1,87 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+#define MEM_ACC_TRACE_GRANULARITY   (1024 * 1024)  /* A counter change smaller than this isn't traced */
+
+typedef enum {
+    MEM_ACC_POOL_e,             /* CMemPool items, e.g. the row cache text */
+    MEM_ACC_WORK_MEM_e,         /* CWorkMem, the file processing chunks */
+    MEM_ACC_TIA_e,              /* Memory mapped */
+    MEM_ACC_FIRA_e,             /* Memory mapped */
+    MEM_ACC_PLOT_e,             /* The byte streams of the plot graphs */
+    MEM_ACC_AUTOHIGHLIGHT_e,    /* Autohighlight and font modification elements, including the pools */
+    MEM_ACC_ROCK_SCROLL_e,      /* Rock scroll image, raster items and the summaries */
+    MEM_ACC_BLOCK_SUMMARY_e,    /* The Bloom filters of the log blocks */
+    MEM_ACC_SEARCH_RESULTS_e,   /* The hit blocks of the find-all searches */
+    MEM_ACC_SEARCH_INDEX_e,     /* Index file is memory mapped, the posting lists while building are resident */
+    MEM_ACC_MERGE_e,            /* Merged log runs and the per source row tables, the sources are memory mapped */
+    MEM_ACC_INCREMENTAL_e,      /* The TI chunks of an incremental load batch */
+    MEM_ACC_COUNT_e
+} MemAccSubsystem_e;
+
+typedef struct {
+    int64_t resident;
+    int64_t mapped;
+    int64_t peakResident;
+    int64_t peakMapped;
+} MemAccCounters_t;
+
+/* Returns the current resident size of a subsystem that is measured as a whole, see MemAcc_SetRefresh */
+typedef int64_t (*MemAccRefresh_t)(void);
+
+/***********************************************************************************************************************
+*   Memory accounting
+*
+*   Resident (heap and anonymous mappings) and mapped (file backed) memory per subsystem. The subsystems count their
+*   large allocations as they are made, thread safe, or are measured as a whole when refreshed (GUI thread).
+*
+*   The memory budget (MEMORY_BUDGET in the settings, MB, 0 is no budget) limits the resident memory, the mapped memory
+*   is backed by the files and is not part of it. The work memory is sized to what is left of the budget and the caches
+*   release memory instead of keeping it while over the budget, such that large logs degrade instead of swapping.
+*
+*   While tracing (CTrace) the counters are recorded as trace counters at start, stop and at each change of
+*   MEM_ACC_TRACE_GRANULARITY.
+***********************************************************************************************************************/
+
+/* Count an allocation, negative when released */
+void MemAcc_Add(MemAccSubsystem_e subsystem, int64_t residentBytes);
+
+/* Count a file mapping, MemAcc_Unmap with the same address releases it */
+void MemAcc_Map(MemAccSubsystem_e subsystem, const void *address_p, int64_t bytes);
+void MemAcc_Unmap(MemAccSubsystem_e subsystem, const void *address_p);
+
+/* Set the resident size of a subsystem measured as a whole */
+void MemAcc_Set(MemAccSubsystem_e subsystem, int64_t residentBytes);
+
+/* Register the function measuring a subsystem, nullptr to unregister */
+void MemAcc_SetRefresh(MemAccSubsystem_e subsystem, MemAccRefresh_t refresh);
+
+/* Measure the subsystems with a refresh function, GUI thread only */
+void MemAcc_Refresh(void);
+
+MemAccCounters_t MemAcc_Get(MemAccSubsystem_e subsystem);
+int64_t MemAcc_TotalResident(void);
+int64_t MemAcc_TotalMapped(void);
+const char *MemAcc_GetName(MemAccSubsystem_e subsystem);
+
+/* The budget in bytes, 0 if there is no budget */
+int64_t MemAcc_GetBudget(void);
+
+/* What is left of the budget for a subsystem, not counting its own current use. INT64_MAX if there is no budget */
+int64_t MemAcc_Available(MemAccSubsystem_e subsystem);
+
+/****/
+inline bool MemAcc_IsOverBudget(void)
+{
+    const int64_t budget = MemAcc_GetBudget();
+    return (budget != 0) && (MemAcc_TotalResident() > budget);
+}
+
+/* Record all counters in the trace, called by CTrace when the trace starts and stops */
+void MemAcc_TraceCounters(void);
@@ -0,0 +1,185 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "CNuma.h"
+#include "CConfig.h"
+#include "CDebug.h"
+
+#include <vector>
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+
+#ifdef __linux__
+ #include <sched.h>
+ #include <unistd.h>
+ #include <sys/syscall.h>
+ #include <errno.h>
+
+ #define NUMA_MPOL_PREFERRED   1          /* linux/mempolicy.h, the system call is used directly */
+ #define NUMA_MPOL_MF_MOVE     (1 << 1)
+ #define NUMA_MAX_NODES        1024
+ #define NUMA_BITS_PER_LONG    (sizeof(unsigned long) * 8)
+#endif
+
+typedef struct {
+    int id;                 /* The node number of the kernel */
+    std::vector<int> cpus;  /* The CPUs of the node the process may run on */
+} NumaNode_t;
+
+#ifdef __linux__
+
+/***********************************************************************************************************************
+*   _readList
+*   Kernel list format, e.g. "0-15,32-47"
+***********************************************************************************************************************/
+static std::vector<int> _readList(const QString& fileName)
+{
+    std::vector<int> list;
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return list;
+    }
+
+    for (auto& range : QString(file.readAll()).trimmed().split(',', Qt::SkipEmptyParts)) {
+        const QStringList limits = range.split('-');
+        bool firstOk = false;
+        bool lastOk = true;
+        const int first = limits[0].toInt(&firstOk);
+        const int last = limits.count() > 1 ? limits[1].toInt(&lastOk) : first;
+
+        if (firstOk && lastOk) {
+            for (int value = first; value <= last; ++value) {
+                list.push_back(value);
+            }
+        }
+    }
+    return list;
+}
+
+/***********************************************************************************************************************
+*   _detect
+***********************************************************************************************************************/
+static std::vector<NumaNode_t> _detect(void)
+{
+    std::vector<NumaNode_t> nodes;
+    cpu_set_t allowed;
+
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return nodes;
+    }
+
+    for (auto id : _readList("/sys/devices/system/node/online")) {
+        NumaNode_t node = {id, {}};
+
+        for (auto cpu : _readList(QString("/sys/devices/system/node/node%1/cpulist").arg(id))) {
+            if ((cpu < CPU_SETSIZE) && CPU_ISSET(cpu, &allowed)) {
+                node.cpus.push_back(cpu);
+            }
+        }
+
+        /* Memory only nodes, and nodes the process may not run on, aren't used */
+        if (!node.cpus.empty() && (id < NUMA_MAX_NODES)) {
+            nodes.push_back(node);
+        }
+    }
+
+    TRACEX_I(QString("NUMA  %1 nodes with CPUs").arg(static_cast<int>(nodes.size())))
+    return nodes;
+}
+
+/***********************************************************************************************************************
+*   _nodes
+***********************************************************************************************************************/
+static const std::vector<NumaNode_t>& _nodes(void)
+{
+    static const std::vector<NumaNode_t> nodes = _detect(); /* Thread safe, at the first use */
+    return nodes;
+}
+#endif
+
+/***********************************************************************************************************************
+*   Numa_GetNumOfNodes
+***********************************************************************************************************************/
+int Numa_GetNumOfNodes(void)
+{
+#ifdef __linux__
+    if ((g_cfg_p == nullptr) || !g_cfg_p->m_numaPlacement) {
+        return 1;
+    }
+
+    const int numOfNodes = static_cast<int>(_nodes().size());
+    return numOfNodes > 1 ? numOfNodes : 1;
+#else
+    return 1;
+#endif
+}
+
+/***********************************************************************************************************************
+*   Numa_PinThread
+***********************************************************************************************************************/
+bool Numa_PinThread(int node)
+{
+#ifdef __linux__
+    if ((node < 0) || (node >= static_cast<int>(_nodes().size()))) {
+        return false;
+    }
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (auto cpu : _nodes()[static_cast<size_t>(node)].cpus) {
+        CPU_SET(cpu, &cpus);
+    }
+
+    if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+        TRACEX_W(QString("%1 failed, node:%2 errno:%3").arg(__FUNCTION__).arg(node).arg(errno))
+        return false;
+    }
+    return true;
+#else
+    Q_UNUSED(node)
+    return false;
+#endif
+}
+
+/***********************************************************************************************************************
+*   Numa_PlaceMemory
+***********************************************************************************************************************/
+bool Numa_PlaceMemory(void *address_p, int64_t size, int node)
+{
+#ifdef __linux__
+    if ((node < 0) || (node >= static_cast<int>(_nodes().size())) || (size <= 0)) {
+        return false;
+    }
+
+    static const uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t start = reinterpret_cast<uintptr_t>(address_p) & ~(pageSize - 1);
+    const uintptr_t end = (reinterpret_cast<uintptr_t>(address_p) + static_cast<uintptr_t>(size)) & ~(pageSize - 1);
+
+    if (end <= start) {
+        return false;
+    }
+
+    const int id = _nodes()[static_cast<size_t>(node)].id;
+    unsigned long nodeMask[NUMA_MAX_NODES / NUMA_BITS_PER_LONG] = {};
+    nodeMask[static_cast<size_t>(id) / NUMA_BITS_PER_LONG] |= 1UL << (static_cast<size_t>(id) % NUMA_BITS_PER_LONG);
+
+    /* The kernel expects the number of bits + 1 */
+    if (syscall(SYS_mbind, start, end - start, NUMA_MPOL_PREFERRED, nodeMask, NUMA_MAX_NODES + 1,
+                NUMA_MPOL_MF_MOVE) != 0) {
+        TRACEX_W(QString("%1 failed, node:%2 errno:%3").arg(__FUNCTION__).arg(node).arg(errno))
+        return false;
+    }
+    return true;
+#else
+    Q_UNUSED(address_p)
+    Q_UNUSED(size)
+    Q_UNUSED(node)
+    return false;
+#endif
+}
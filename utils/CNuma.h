@@ -0,0 +1,36 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+/***********************************************************************************************************************
+*   NUMA placement
+*
+*   On multi-socket machines the processing threads are pinned per NUMA node, consecutive threads on the same node,
+*   and the part of each chunk that a node's threads process is placed in memory local to that node (see
+*   CFileProcBase). The nodes are detected at runtime from sysfs (Linux only), no NUMA library is needed. Only the nodes
+*   with CPUs the process is allowed to run on are used.
+*
+*   Off by default, NUMA_PLACEMENT in the settings turns it on (compare with the benchmark, --benchmark-numa). It is
+*   off when there is only one node.
+***********************************************************************************************************************/
+
+/* The nodes used for the placement, 1 when NUMA placement isn't available or turned off */
+int Numa_GetNumOfNodes(void);
+
+/****/
+inline int Numa_ThreadNode(int threadIndex, int numOfThreads, int numOfNodes)
+{
+    return static_cast<int>((static_cast<int64_t>(threadIndex) * numOfNodes) / numOfThreads);
+}
+
+/* Run the calling thread only on the CPUs of node (0 - Numa_GetNumOfNodes() - 1) */
+bool Numa_PinThread(int node);
+
+/* Prefer node for the pages of [address_p, address_p + size), the pages already in memory are moved. The range is
+ * rounded down to whole pages, such that ranges placed one after the other don't overlap */
+bool Numa_PlaceMemory(void *address_p, int64_t size, int node);
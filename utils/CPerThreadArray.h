@@ -0,0 +1,55 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+#define CACHE_LINE_SIZE   64  /* x86-64 and most ARM64, hardware_destructive_interference_size isn't in all compilers */
+
+/* A value alone on its cache line(s) */
+template <typename T>
+struct alignas(CACHE_LINE_SIZE) CacheLineAligned_t {
+    T value;
+};
+
+/***********************************************************************************************************************
+*   CPerThreadArray
+*
+*   One item per thread, each on its own cache line such that the threads writing their items don't invalidate each
+*   others cache lines (false sharing). Sized at runtime to the number of threads. The items are value initialized,
+*   i.e. zeroed for plain structs, and move when the array is resized, hence only resize while the threads are idle.
+***********************************************************************************************************************/
+template <typename T>
+class CPerThreadArray
+{
+public:
+    CPerThreadArray() = default;
+    explicit CPerThreadArray(int count) {Resize(count);}
+
+    /****/
+    void Resize(int count) {m_items.resize(static_cast<size_t>(count > 0 ? count : 0));}
+
+    /* Resize only if the array has less than count items */
+    void Grow(int count)
+    {
+        if (count > Count()) {
+            Resize(count);
+        }
+    }
+
+    /****/
+    int Count(void) const {return static_cast<int>(m_items.size());}
+
+    /****/
+    T& operator[](int index) {return m_items[static_cast<size_t>(index)].value;}
+
+    /****/
+    const T& operator[](int index) const {return m_items[static_cast<size_t>(index)].value;}
+
+private:
+    std::vector<CacheLineAligned_t<T>> m_items;
+};
@@ -0,0 +1,95 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "CDebug.h"
+#include "CRegExpHybrid.h"
+
+/* The row confirmed is converted to UTF-16 for PCRE. The buffer is kept per (filter/search) thread and re-used, not to
+ * allocate for each row confirmed. The match referencing it is released before the next row. */
+static thread_local QString g_confirmText;
+
+/***********************************************************************************************************************
+*   RegExpHybrid_Compile
+***********************************************************************************************************************/
+bool RegExpHybrid_Compile(const char *pattern_p, unsigned int flags, hs_database_t **database_pp,
+                          QRegularExpression **confirm_pp, QString *error_p)
+{
+    hs_compile_error_t *compile_err;
+
+    *database_pp = nullptr;
+    *confirm_pp = nullptr;
+
+    if (hs_compile(pattern_p, flags, HS_MODE_BLOCK, nullptr, database_pp, &compile_err) == HS_SUCCESS) {
+        return true;
+    }
+
+    const QString error = QString(compile_err->message);
+    hs_free_compile_error(compile_err);
+    *database_pp = nullptr;
+
+    /* The Hyperscan flags used are HS_FLAG_DOTALL and HS_FLAG_CASELESS, the rest only affects the reporting */
+    QRegularExpression::PatternOptions options = QRegularExpression::NoPatternOption;
+    if (flags & HS_FLAG_DOTALL) {
+        options |= QRegularExpression::DotMatchesEverythingOption;
+    }
+    if (flags & HS_FLAG_CASELESS) {
+        options |= QRegularExpression::CaseInsensitiveOption;
+    }
+
+    auto confirm_p = new QRegularExpression(QString::fromLatin1(pattern_p), options);
+    if (!confirm_p->isValid()) {
+        /* Not a valid pattern at all, report the Hyperscan reason as before */
+        TRACEX_I(QString("RegExp failed %1").arg(error))
+        if (error_p != nullptr) {
+            *error_p = error;
+        }
+        delete confirm_p;
+        return false;
+    }
+
+    /* Start of match isn't supported in prefilter mode, and not needed since the position is taken from the confirm */
+    const unsigned int prefilterFlags = (flags & ~HS_FLAG_SOM_LEFTMOST) | HS_FLAG_PREFILTER;
+    if (hs_compile(pattern_p, prefilterFlags, HS_MODE_BLOCK, nullptr, database_pp, &compile_err) != HS_SUCCESS) {
+        TRACEX_I(QString("RegExp prefilter failed %1").arg(compile_err->message))
+        if (error_p != nullptr) {
+            *error_p = QString(compile_err->message);
+        }
+        hs_free_compile_error(compile_err);
+        *database_pp = nullptr;
+        delete confirm_p;
+        return false;
+    }
+
+    TRACEX_I(QString("RegExp %1 not supported by Hyperscan (%2), prefiltered and confirmed by PCRE")
+                 .arg(pattern_p).arg(error))
+
+    confirm_p->optimize(); /* JIT compile it now, not at the first match */
+    *confirm_pp = confirm_p;
+    return true;
+}
+
+/***********************************************************************************************************************
+*   RegExpHybrid_Confirm
+***********************************************************************************************************************/
+bool RegExpHybrid_Confirm(const QRegularExpression *confirm_p, const char *text_p, int textLength, int *offset_p,
+                          int *length_p)
+{
+    g_confirmText.resize(textLength); /* Keeps the capacity when shrinking */
+
+    QChar *dest_p = g_confirmText.data();
+    for (int index = 0; index < textLength; ++index) {
+        dest_p[index] = QChar(static_cast<uchar>(text_p[index])); /* Latin1 */
+    }
+
+    const QRegularExpressionMatch match = confirm_p->match(g_confirmText);
+
+    if (!match.hasMatch()) {
+        return false;
+    }
+
+    *offset_p = static_cast<int>(match.capturedStart(0));
+    *length_p = static_cast<int>(match.capturedLength(0));
+    return true;
+}
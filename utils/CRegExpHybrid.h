@@ -0,0 +1,24 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QRegularExpression>
+
+#include <hs/hs.h>
+
+/* Compiles a regular expression to a Hyperscan database with flags. Patterns that Hyperscan doesn't support
+ * (e.g. back references and lookaround) are instead compiled in prefilter mode (HS_FLAG_PREFILTER), the database then
+ * matches a superset of the rows and *confirm_pp is set to the full pattern, compiled with PCRE2 (JIT) through
+ * QRegularExpression, to confirm the candidate rows with. *confirm_pp is nullptr when not needed, else it is owned by
+ * the caller. Each thread shall have its own confirm pattern. Returns false, with the reason in error_p, if the pattern
+ * isn't valid */
+bool RegExpHybrid_Compile(const char *pattern_p, unsigned int flags, hs_database_t **database_pp,
+                          QRegularExpression **confirm_pp, QString *error_p = nullptr);
+
+/* Match the text with the confirm pattern, at match the position is returned in offset_p and length_p */
+bool RegExpHybrid_Confirm(const QRegularExpression *confirm_p, const char *text_p, int textLength, int *offset_p,
+                          int *length_p);
@@ -0,0 +1,170 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "CDebug.h"
+#include "CRegExpSpans.h"
+
+#include <algorithm>
+#include <memory>
+
+/***********************************************************************************************************************
+*   spanEventHandler
+***********************************************************************************************************************/
+static int spanEventHandler(unsigned int id, unsigned long long from, unsigned long long to, unsigned int flags,
+                            void *ctx)
+{
+    Q_UNUSED(id)
+    Q_UNUSED(flags)
+
+    auto spans_p = reinterpret_cast<std::vector<MatchSpan_t> *>(ctx);
+    int start = static_cast<int>(from);
+    const int end = static_cast<int>(to);
+
+    /* The matches are reported in order of their end, the spans overlapping the match are merged with it */
+    while (!spans_p->empty() && (spans_p->back().end > start)) {
+        start = std::min(start, spans_p->back().start);
+        spans_p->pop_back();
+    }
+
+    spans_p->push_back(MatchSpan_t {start, end});
+    return 0;
+}
+
+/***********************************************************************************************************************
+*   Compile
+***********************************************************************************************************************/
+bool CRegExpSpans::Compile(const char *pattern_p)
+{
+    if ((pattern_p != nullptr) && (m_pattern == pattern_p) && (IsValid() || m_failed)) {
+        return IsValid();
+    }
+
+    Clear();
+
+    if (pattern_p == nullptr) {
+        return false;
+    }
+
+    m_pattern = pattern_p;
+
+    hs_compile_error_t *compile_err;
+    if (hs_compile(pattern_p, REGEXP_HYPERSCAN_SOM_FLAGS, HS_MODE_BLOCK, nullptr, &m_database_p,
+                   &compile_err) != HS_SUCCESS) {
+        hs_free_compile_error(compile_err);
+        m_database_p = nullptr;
+
+        /* Not supported by Hyperscan (e.g. back references), the spans are found with PCRE instead */
+        auto confirm_p = new QRegularExpression(QString::fromLatin1(pattern_p),
+                                                QRegularExpression::DotMatchesEverythingOption);
+        if (!confirm_p->isValid()) {
+            TRACEX_W(QString("RegExp failed %1").arg(confirm_p->errorString()))
+            delete confirm_p;
+            m_failed = true;
+            return false;
+        }
+
+        confirm_p->optimize();
+        m_confirm_p = confirm_p;
+        return true;
+    }
+
+    if (hs_alloc_scratch(m_database_p, &m_scratch_p) != HS_SUCCESS) {
+        TRACEX_W(QString("ERROR: Unable to allocate scratch space"))
+        hs_free_database(m_database_p);
+        m_database_p = nullptr;
+        m_scratch_p = nullptr;
+        m_failed = true;
+        return false;
+    }
+
+    return true;
+}
+
+/***********************************************************************************************************************
+*   Clear
+***********************************************************************************************************************/
+void CRegExpSpans::Clear(void)
+{
+    if (m_scratch_p != nullptr) {
+        hs_free_scratch(m_scratch_p);
+        m_scratch_p = nullptr;
+    }
+
+    if (m_database_p != nullptr) {
+        hs_free_database(m_database_p);
+        m_database_p = nullptr;
+    }
+
+    delete m_confirm_p;
+    m_confirm_p = nullptr;
+
+    m_pattern.clear();
+    m_failed = false;
+}
+
+/***********************************************************************************************************************
+*   FindSpans
+***********************************************************************************************************************/
+int CRegExpSpans::FindSpans(const char *text_p, int textSize, std::vector<MatchSpan_t>& spans)
+{
+    spans.clear();
+
+    if (!IsValid() || (text_p == nullptr) || (textSize <= 0)) {
+        return 0;
+    }
+
+    if (m_confirm_p != nullptr) {
+        /* The matches are found from left to right and don't overlap */
+        auto iter = m_confirm_p->globalMatch(QString::fromLatin1(text_p, textSize));
+        while (iter.hasNext()) {
+            const QRegularExpressionMatch match = iter.next();
+            if (match.capturedLength(0) > 0) {
+                spans.push_back(MatchSpan_t {static_cast<int>(match.capturedStart(0)),
+                                             static_cast<int>(match.capturedEnd(0))});
+            }
+        }
+        return static_cast<int>(spans.size());
+    }
+
+    if (hs_scan(m_database_p, text_p, static_cast<unsigned int>(textSize), 0, m_scratch_p, spanEventHandler,
+                &spans) != HS_SUCCESS) {
+        TRACEX_W(QString("ERROR: Unable to scan input buffer"))
+        spans.clear();
+        return 0;
+    }
+
+    return static_cast<int>(spans.size());
+}
+
+/***********************************************************************************************************************
+*   RegExpSpans_Get
+***********************************************************************************************************************/
+CRegExpSpans *RegExpSpans_Get(const char *pattern_p)
+{
+    /* Most recently used first */
+    static std::vector<std::unique_ptr<CRegExpSpans>> cache;
+
+    if (pattern_p == nullptr) {
+        return nullptr;
+    }
+
+    for (size_t index = 0; index < cache.size(); ++index) {
+        if (cache[index]->GetPattern() == pattern_p) {
+            if (index > 0) {
+                std::unique_ptr<CRegExpSpans> entry = std::move(cache[index]);
+                cache.erase(cache.begin() + static_cast<std::ptrdiff_t>(index));
+                cache.insert(cache.begin(), std::move(entry));
+            }
+            return cache.front()->IsValid() ? cache.front().get() : nullptr;
+        }
+    }
+
+    if (cache.size() >= REGEXP_SPANS_CACHE_SIZE) {
+        cache.pop_back();
+    }
+
+    cache.insert(cache.begin(), std::unique_ptr<CRegExpSpans>(new CRegExpSpans()));
+    return cache.front()->Compile(pattern_p) ? cache.front().get() : nullptr;
+}
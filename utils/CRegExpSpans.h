@@ -0,0 +1,66 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include <QByteArray>
+#include <QRegularExpression>
+
+#include <hs/hs.h>
+
+/* Start of match mode, each match is reported with its start, used when the match position is needed */
+const unsigned int REGEXP_HYPERSCAN_SOM_FLAGS = (HS_FLAG_DOTALL | HS_FLAG_SOM_LEFTMOST);
+
+#define REGEXP_SPANS_CACHE_SIZE   16  /* Number of compiled patterns kept by RegExpSpans_Get */
+
+typedef struct {
+    int start;
+    int end; /* The first character after the match */
+} MatchSpan_t;
+
+/***********************************************************************************************************************
+*   CRegExpSpans
+*
+*   A regular expression compiled once in start of match mode, giving the spans of all matches in a row with a single
+*   scan. The spans are sorted and overlapping matches are merged into one span. An instance may only be used by one
+*   thread at the time (the scratch is not shared).
+***********************************************************************************************************************/
+class CRegExpSpans
+{
+public:
+    CRegExpSpans(void) = default;
+    ~CRegExpSpans(void) {Clear();}
+
+    CRegExpSpans(const CRegExpSpans&) = delete;
+    CRegExpSpans& operator=(const CRegExpSpans&) = delete;
+
+    /* Compiles the pattern, nothing is done if it is the same pattern as before. Returns false if the pattern
+     * couldn't be compiled */
+    bool Compile(const char *pattern_p);
+    void Clear(void);
+
+    /****/
+    bool IsValid(void) const {return (m_scratch_p != nullptr) || (m_confirm_p != nullptr);}
+
+    /****/
+    const QByteArray& GetPattern(void) const {return m_pattern;}
+
+    /* Returns the number of spans found in the text, the spans are replacing the content of spans */
+    int FindSpans(const char *text_p, int textSize, std::vector<MatchSpan_t>& spans);
+
+private:
+    QByteArray m_pattern;
+    bool m_failed = false; /* The pattern didn't compile, not tried again */
+    hs_database_t *m_database_p = nullptr;
+    hs_scratch_t *m_scratch_p = nullptr;
+    QRegularExpression *m_confirm_p = nullptr; /* Used instead of Hyperscan for patterns it doesn't support */
+};
+
+/* The compiled pattern, from a small cache of the most recently used patterns. GUI thread only (the editor
+ * highlighting, font modifications and search result presentation). nullptr if the pattern doesn't compile */
+CRegExpSpans *RegExpSpans_Get(const char *pattern_p);
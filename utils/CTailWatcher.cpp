@@ -0,0 +1,157 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "CTailWatcher.h"
+#include "CDebug.h"
+
+#include <QSocketNotifier>
+
+#ifdef __linux__
+ #include <sys/inotify.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+ #include <errno.h>
+#endif
+
+/***********************************************************************************************************************
+*   Start
+***********************************************************************************************************************/
+bool CTailWatcher::Start(const QString& fileName)
+{
+    Stop();
+
+#ifdef __linux__
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0) {
+        TRACEX_W(QString("%1 inotify_init1 failed, errno:%2").arg(__FUNCTION__).arg(errno))
+        return false;
+    }
+
+    m_wd = inotify_add_watch(m_fd, fileName.toLocal8Bit().constData(),
+                             IN_MODIFY | IN_MOVE_SELF | IN_DELETE_SELF);
+    if (m_wd < 0) {
+        TRACEX_W(QString("%1 inotify_add_watch failed, file:%2 errno:%3").arg(__FUNCTION__).arg(fileName).arg(errno))
+        Stop();
+        return false;
+    }
+
+    m_notifier_p = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier_p, &QSocketNotifier::activated, this, &CTailWatcher::onActivated);
+
+    PRINT_FILE_TRACKING(QString("Tail watcher (inotify) started: %1").arg(fileName))
+    return true;
+#else
+    Q_UNUSED(fileName)
+    return false;
+#endif
+}
+
+/***********************************************************************************************************************
+*   Stop
+***********************************************************************************************************************/
+void CTailWatcher::Stop(void)
+{
+    if (m_notifier_p != nullptr) {
+        m_notifier_p->setEnabled(false);
+        delete m_notifier_p;
+        m_notifier_p = nullptr;
+    }
+
+#ifdef __linux__
+    if (m_fd >= 0) {
+        if (m_wd >= 0) {
+            (void)inotify_rm_watch(m_fd, m_wd);
+        }
+        close(m_fd);
+    }
+#endif
+    m_fd = -1;
+    m_wd = -1;
+}
+
+/***********************************************************************************************************************
+*   onActivated
+***********************************************************************************************************************/
+void CTailWatcher::onActivated(void)
+{
+#ifdef __linux__
+    /* Drain all pending events, many modifications are collapsed into one notification as the receiver anyhow reads
+     * all appended data up to the end of the file */
+    alignas(struct inotify_event) char buffer[4096];
+    bool appended = false;
+    bool replaced = false;
+    ssize_t length;
+
+    while ((length = read(m_fd, buffer, sizeof(buffer))) > 0) {
+        for (char *ptr = buffer; ptr < buffer + length;) {
+            auto event_p = reinterpret_cast<struct inotify_event *>(ptr);
+            if (event_p->mask & IN_MODIFY) {
+                appended = true;
+            }
+            if (event_p->mask & (IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED)) {
+                replaced = true;
+            }
+            ptr += sizeof(struct inotify_event) + event_p->len;
+        }
+    }
+
+    if (replaced) {
+        emit fileReplaced();
+    } else if (appended) {
+        emit fileAppended();
+    }
+#endif
+}
+
+/***********************************************************************************************************************
+*   BlockChecksum
+***********************************************************************************************************************/
+bool CTailWatcher::BlockChecksum(QFile& file, int64_t start, int64_t size, uint32_t *checksum_p)
+{
+    const uint32_t MOD_ADLER = 65521;
+    uint32_t a = 1;
+    uint32_t b = 0;
+    char buffer[TAIL_CHECKSUM_BLOCK_SIZE];
+
+    if ((start < 0) || (size < 0) || !file.isOpen() || !file.seek(start)) {
+        return false;
+    }
+
+    while (size > 0) {
+        const int64_t chunk = size > static_cast<int64_t>(sizeof(buffer)) ? static_cast<int64_t>(sizeof(buffer)) : size;
+        if (file.read(buffer, chunk) != chunk) {
+            return false;
+        }
+        for (int64_t index = 0; index < chunk; ++index) {
+            a = (a + static_cast<uint8_t>(buffer[index])) % MOD_ADLER;
+            b = (b + a) % MOD_ADLER;
+        }
+        size -= chunk;
+    }
+
+    *checksum_p = (b << 16) | a;
+    return true;
+}
+
+/***********************************************************************************************************************
+*   FileId
+***********************************************************************************************************************/
+bool CTailWatcher::FileId(const QString& fileName, uint64_t *id_p)
+{
+#ifdef __linux__
+    struct stat status;
+    if (stat(QFile::encodeName(fileName).constData(), &status) != 0) {
+        return false;
+    }
+
+    /* The device numbers are small, the inode numbers are below 2^48 in practice */
+    *id_p = (static_cast<uint64_t>(status.st_dev) << 48) ^ static_cast<uint64_t>(status.st_ino);
+    return true;
+#else
+    Q_UNUSED(fileName)
+    Q_UNUSED(id_p)
+    return false;
+#endif
+}
@@ -0,0 +1,55 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <QObject>
+#include <QFile>
+#include <QString>
+
+class QSocketNotifier;
+
+/* Size of the block, ending at the last indexed (complete) row, that is check-summed to verify that an incremental
+ * load can be made, i.e. that the already indexed part of the log file hasn't been modified. */
+#define TAIL_CHECKSUM_BLOCK_SIZE  (4096)
+
+/***********************************************************************************************************************
+*   CTailWatcher
+*
+*   Low latency notification of a log file being appended to. On Linux the log file is watched with inotify directly,
+*   the events are delivered in the thread owning the watcher through a QSocketNotifier. On other platforms Start
+*   returns false and the QFileSystemWatcher/timer based tracking is used.
+***********************************************************************************************************************/
+class CTailWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CTailWatcher(QObject *parent = nullptr) : QObject(parent) {}
+    virtual ~CTailWatcher() override {Stop();}
+
+    bool Start(const QString& fileName);
+    void Stop(void);
+    bool isActive(void) {return m_fd >= 0;}
+
+    /* Adler-32 of the size bytes from start in file, false if the bytes couldn't be read */
+    static bool BlockChecksum(QFile& file, int64_t start, int64_t size, uint32_t *checksum_p);
+
+    /* Identity of the file (device and inode), kept when the file is renamed. False on platforms without it */
+    static bool FileId(const QString& fileName, uint64_t *id_p);
+
+signals:
+    void fileAppended(void); /* also when truncated, the receiver compares the size */
+    void fileReplaced(void); /* moved or removed. Attribute changes (touch, chmod) aren't watched */
+
+private slots:
+    void onActivated(void);
+
+private:
+    int m_fd = -1;
+    int m_wd = -1;
+    QSocketNotifier *m_notifier_p = nullptr;
+};
@@ -0,0 +1,288 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#include "CTrace.h"
+#include "CDebug.h"
+#include "CMemAccounting.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+
+std::atomic<bool> g_traceEnabled {false};
+
+typedef struct {
+    const char *name_p;
+    int64_t start;   /* ns */
+    int64_t end;     /* ns, or the value of a counter */
+    bool counter;
+} TraceEvent_t;
+
+/* Written only by its thread. The count is stored with release, the exporter reads it with acquire before reading
+ * the events below it. */
+typedef struct {
+    TraceEvent_t events[TRACE_EVENTS_PER_THREAD];
+    std::atomic<int> count;
+    std::atomic<int> lost;
+    std::atomic<bool> orphaned;   /* The thread has exited, the buffer is kept for export */
+    int generation;               /* The events belong to this trace, a new trace is reset by the thread itself */
+    int tid;
+    QString threadName;
+} TraceBuffer_t;
+
+static QMutex g_traceMutex; /* Protects the buffer list */
+static std::vector<TraceBuffer_t *> g_traceBuffers;
+static std::atomic<int> g_traceGeneration {0};
+static int g_traceNextTid = 1;
+
+/***********************************************************************************************************************
+*   CTraceBufferOwner
+*   Marks the thread's buffer as orphaned at thread exit, it is freed at the next Trace_Start
+***********************************************************************************************************************/
+class CTraceBufferOwner
+{
+public:
+    ~CTraceBufferOwner(void)
+    {
+        if (m_buffer_p != nullptr) {
+            m_buffer_p->orphaned.store(true, std::memory_order_release);
+        }
+    }
+
+    TraceBuffer_t *m_buffer_p = nullptr;
+};
+
+static thread_local CTraceBufferOwner g_traceBufferOwner;
+
+/***********************************************************************************************************************
+*   Trace_Now
+***********************************************************************************************************************/
+int64_t Trace_Now(void)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/***********************************************************************************************************************
+*   Trace_RegisterThread
+***********************************************************************************************************************/
+static TraceBuffer_t *Trace_RegisterThread(void)
+{
+    auto *buffer_p = new TraceBuffer_t;
+    QThread *thread_p = QThread::currentThread();
+
+    buffer_p->count = 0;
+    buffer_p->lost = 0;
+    buffer_p->orphaned = false;
+    buffer_p->generation = g_traceGeneration.load(std::memory_order_acquire);
+
+    if ((QCoreApplication::instance() != nullptr) && (thread_p == QCoreApplication::instance()->thread())) {
+        buffer_p->threadName = QString("GUI");
+    } else if ((thread_p != nullptr) && !thread_p->objectName().isEmpty()) {
+        buffer_p->threadName = thread_p->objectName();
+    }
+
+    QMutexLocker locker(&g_traceMutex);
+    buffer_p->tid = g_traceNextTid++;
+    if (buffer_p->threadName.isEmpty()) {
+        buffer_p->threadName = QString("Thread %1").arg(buffer_p->tid);
+    }
+    g_traceBuffers.push_back(buffer_p);
+    return buffer_p;
+}
+
+/***********************************************************************************************************************
+*   Trace_Record
+***********************************************************************************************************************/
+static void Trace_Record(const char *name_p, int64_t start, int64_t end, bool counter)
+{
+    TraceBuffer_t *buffer_p = g_traceBufferOwner.m_buffer_p;
+
+    if (buffer_p == nullptr) {
+        buffer_p = Trace_RegisterThread();
+        g_traceBufferOwner.m_buffer_p = buffer_p;
+    }
+
+    const int generation = g_traceGeneration.load(std::memory_order_acquire);
+    if (buffer_p->generation != generation) {
+        buffer_p->generation = generation;
+        buffer_p->lost.store(0, std::memory_order_relaxed);
+        buffer_p->count.store(0, std::memory_order_release);
+    }
+
+    const int count = buffer_p->count.load(std::memory_order_relaxed);
+    if (count >= TRACE_EVENTS_PER_THREAD) {
+        buffer_p->lost.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    TraceEvent_t *event_p = &buffer_p->events[count];
+    event_p->name_p = name_p;
+    event_p->start = start;
+    event_p->end = end;
+    event_p->counter = counter;
+    buffer_p->count.store(count + 1, std::memory_order_release);
+}
+
+/***********************************************************************************************************************
+*   Trace_AddEvent
+***********************************************************************************************************************/
+void Trace_AddEvent(const char *name_p, int64_t start, int64_t end)
+{
+    Trace_Record(name_p, start, end, false);
+}
+
+/***********************************************************************************************************************
+*   Trace_AddCounter
+***********************************************************************************************************************/
+void Trace_AddCounter(const char *name_p, int64_t bytes)
+{
+    Trace_Record(name_p, Trace_Now(), bytes, true);
+}
+
+/***********************************************************************************************************************
+*   Trace_Start
+***********************************************************************************************************************/
+void Trace_Start(void)
+{
+    {
+        QMutexLocker locker(&g_traceMutex);
+
+        /* Free the buffers of the threads that has exited, the other buffers are reset by their own threads as the
+         * generation is changed */
+        for (auto iter = g_traceBuffers.begin(); iter != g_traceBuffers.end();) {
+            if ((*iter)->orphaned.load(std::memory_order_acquire)) {
+                delete *iter;
+                iter = g_traceBuffers.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+
+        g_traceGeneration.fetch_add(1, std::memory_order_release);
+        g_traceEnabled.store(true, std::memory_order_relaxed);
+    }
+
+    /* Recording may register this thread, which takes the lock */
+    MemAcc_TraceCounters();
+    TRACEX_I("Trace started")
+}
+
+/***********************************************************************************************************************
+*   Trace_Stop
+***********************************************************************************************************************/
+void Trace_Stop(void)
+{
+    MemAcc_TraceCounters();
+    g_traceEnabled.store(false, std::memory_order_relaxed);
+    TRACEX_I("Trace stopped")
+}
+
+/***********************************************************************************************************************
+*   Trace_JsonEscape
+***********************************************************************************************************************/
+static QString Trace_JsonEscape(const QString& text)
+{
+    QString escaped;
+
+    escaped.reserve(text.size());
+    for (auto ch : text) {
+        if ((ch == '"') || (ch == '\\')) {
+            escaped.append('\\').append(ch);
+        } else if (ch.unicode() < 0x20) {
+            escaped.append(QString("\\u%1").arg(static_cast<int>(ch.unicode()), 4, 16, QChar('0')));
+        } else {
+            escaped.append(ch);
+        }
+    }
+    return escaped;
+}
+
+/***********************************************************************************************************************
+*   Trace_ExportChromeJson
+*   Complete events ("ph":"X") and counter events ("ph":"C") with the time stamps in micro seconds, relative the
+*   earliest event, and a thread_name meta data event per thread. Should be called when stopped, spans still being
+*   recorded may otherwise be missing.
+***********************************************************************************************************************/
+bool Trace_ExportChromeJson(const QString& fileName)
+{
+    QMutexLocker locker(&g_traceMutex);
+    const int generation = g_traceGeneration.load(std::memory_order_acquire);
+    int64_t origin = INT64_MAX;
+    int lost = 0;
+    int total = 0;
+
+    /* The events are recorded when they end, the first event in a buffer isn't necessarily the one starting first */
+    for (auto buffer_p : g_traceBuffers) {
+        const int count = buffer_p->generation == generation ? buffer_p->count.load(std::memory_order_acquire) : 0;
+        for (int index = 0; index < count; ++index) {
+            if (buffer_p->events[index].start < origin) {
+                origin = buffer_p->events[index].start;
+            }
+        }
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        TRACEX_W("Trace_ExportChromeJson  Failed to open %s", fileName.toLatin1().constData())
+        return false;
+    }
+
+    QByteArray json;
+    json.reserve(1024 * 1024);
+    json.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    bool first = true;
+    for (auto buffer_p : g_traceBuffers) {
+        const int count = buffer_p->generation == generation ? buffer_p->count.load(std::memory_order_acquire) : 0;
+        if (count == 0) {
+            continue;
+        }
+
+        json.append(QString("%1{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%2,\"args\":{\"name\":\"%3\"}}")
+                        .arg(first ? "" : ",\n").arg(buffer_p->tid).arg(Trace_JsonEscape(buffer_p->threadName))
+                        .toUtf8());
+        first = false;
+
+        for (int index = 0; index < count; ++index) {
+            const TraceEvent_t& event = buffer_p->events[index];
+            if (event.counter) {
+                json.append(QString(",\n{\"name\":\"%1\",\"ph\":\"C\",\"pid\":1,\"tid\":%2,\"ts\":%3,"
+                                    "\"args\":{\"MB\":%4}}")
+                                .arg(event.name_p).arg(buffer_p->tid)
+                                .arg(static_cast<double>(event.start - origin) / 1000.0, 0, 'f', 3)
+                                .arg(static_cast<double>(event.end) / (1024.0 * 1024.0), 0, 'f', 1).toUtf8());
+                continue;
+            }
+            json.append(QString(",\n{\"name\":\"%1\",\"ph\":\"X\",\"pid\":1,\"tid\":%2,\"ts\":%3,\"dur\":%4}")
+                            .arg(event.name_p).arg(buffer_p->tid)
+                            .arg(static_cast<double>(event.start - origin) / 1000.0, 0, 'f', 3)
+                            .arg(static_cast<double>(event.end - event.start) / 1000.0, 0, 'f', 3).toUtf8());
+        }
+
+        total += count;
+        lost += buffer_p->lost.load(std::memory_order_relaxed);
+
+        if (json.size() > 512 * 1024) {
+            file.write(json);
+            json.clear();
+        }
+    }
+
+    json.append(QString("\n],\"otherData\":{\"lostEvents\":%1}}\n").arg(lost).toUtf8());
+
+    if ((file.write(json) != json.size()) || !file.flush()) {
+        TRACEX_W("Trace_ExportChromeJson  Failed to write %s", fileName.toLatin1().constData())
+        return false;
+    }
+
+    TRACEX_I("Trace exported to %s, %d events, %d lost", fileName.toLatin1().constData(), total, lost)
+    return true;
+}
@@ -0,0 +1,79 @@
+/***********************************************************************************************************************
+** Copyright (C) 2019 Robert Klang
+** Contact: https://www.logscrutinizer.com
+***********************************************************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+#include <QString>
+
+#define TRACE_EVENTS_PER_THREAD   (64 * 1024)  /* Events beyond this are dropped, counted as lost */
+#define TRACE_ENV_VARIABLE        "LOGSCRUTINIZER_TRACE"  /* Trace from start up, exported to this file at exit */
+
+/***********************************************************************************************************************
+*   Pipeline tracing
+*
+*   Spans of the processing pipeline (chunk load, per thread processing, thread rally, wrap up, parsing, plotting,
+*   painting) are recorded into per thread event buffers, and exported in the Chrome trace format (JSON), which can be
+*   opened in chrome://tracing or in Perfetto. The memory accounting counters (CMemAccounting) are recorded as well.
+*
+*   Each thread owns its buffer and is the only writer, the events are published with a release store of the event
+*   count, hence no locking when recording. When tracing is disabled a span costs one relaxed atomic load.
+***********************************************************************************************************************/
+
+extern std::atomic<bool> g_traceEnabled;
+
+/* Clear the buffers and start recording */
+void Trace_Start(void);
+
+/* Stop recording, the events are kept until exported or the next start */
+void Trace_Stop(void);
+
+/****/
+inline bool Trace_IsEnabled(void) {return g_traceEnabled.load(std::memory_order_relaxed);}
+
+/* Record a span, name_p must be a string literal (the pointer is stored) */
+void Trace_AddEvent(const char *name_p, int64_t start, int64_t end);
+
+/* Record a counter sample in bytes, exported in MB. name_p must be a string literal */
+void Trace_AddCounter(const char *name_p, int64_t bytes);
+
+/* Nanoseconds, monotonic */
+int64_t Trace_Now(void);
+
+/* Write the recorded events in the Chrome trace format, returns false if the file couldn't be written */
+bool Trace_ExportChromeJson(const QString& fileName);
+
+/***********************************************************************************************************************
+*   CTraceSpan
+***********************************************************************************************************************/
+class CTraceSpan
+{
+public:
+    explicit CTraceSpan(const char *name_p) : m_name_p(Trace_IsEnabled() ? name_p : nullptr)
+    {
+        if (m_name_p != nullptr) {
+            m_start = Trace_Now();
+        }
+    }
+
+    ~CTraceSpan(void)
+    {
+        if (m_name_p != nullptr) {
+            Trace_AddEvent(m_name_p, m_start, Trace_Now());
+        }
+    }
+
+private:
+    const char *m_name_p;
+    int64_t m_start = 0;
+};
+
+#define TRACE_SPAN_CONCAT_(a, b) a ## b
+#define TRACE_SPAN_CONCAT(a, b)  TRACE_SPAN_CONCAT_(a, b)
+
+/* Trace the rest of the enclosing scope */
+#define TRACE_SPAN(name) CTraceSpan TRACE_SPAN_CONCAT(traceSpan_, __LINE__)(name);
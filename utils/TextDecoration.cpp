@@ -6,19 +6,14 @@
 #include "CDebug.h"
 #include "CMemPool.h"
 #include "CRowCache.h"
+#include "CRegExpSpans.h"
 #include "TextDecoration.h"
 #include "mainwindow_cb_if.h"
 #include "utils.h"
 
-#include <hs/hs.h>
+#include <vector>
 
 int debug_numOfRowsForHighLight = 0;
-struct regExpEventHandlerData {
-    int unused_SuppressAlignmentWarning; /* or use -wpadded */
-    int matchCount;
-    QList<TextRectElement_t *> *elementRefs_p;
-    CTextRectElementFactory *elementFactory_p;
-};
 
 /***********************************************************************************************************************
 *   create
@@ -26,6 +21,7 @@ struct regExpEventHandlerData {
 TextRectElement_t *CTextRectElementFactory::create(void)
 {
     if (m_autoHighlight_Pool_p->isEmpty()) {
+        MemAcc_Add(MEM_ACC_AUTOHIGHLIGHT_e, sizeof(TextRectElement_t));
         return static_cast<TextRectElement_t *>(malloc(sizeof(TextRectElement_t)));
     } else {
         return m_autoHighlight_Pool_p->takeLast();
@@ -38,47 +34,13 @@ TextRectElement_t *CTextRectElementFactory::create(void)
 TextRectElement_t *CFontModElementFactory::create(void)
 {
     if (m_fontModification_Pool_p->isEmpty()) {
+        MemAcc_Add(MEM_ACC_AUTOHIGHLIGHT_e, sizeof(FontModification_Element_t));
         return static_cast<TextRectElement_t *>(malloc(sizeof(FontModification_Element_t)));
     } else {
         return reinterpret_cast<TextRectElement_t *>(m_fontModification_Pool_p->takeLast());
     }
 }
 
-/***********************************************************************************************************************
-*   eventHandler
-***********************************************************************************************************************/
-static int eventHandler(unsigned int id, unsigned long long from,
-                        unsigned long long to, unsigned int flags, void *ctx) {
-    Q_UNUSED(id)
-    Q_UNUSED(flags)
-
-    auto data = reinterpret_cast<struct regExpEventHandlerData *>(ctx);
-
-    /* MATCH!!! Create element, or merge */
-
-    to = to > 0 ? to - 1 : 0;
-
-    /* check overlap, if overlap merge elements */
-    if (data->elementRefs_p->count() > 0) {
-        for (auto& elem : *data->elementRefs_p) {
-            if (((elem->endCol >= static_cast<int>(from)) && (elem->endCol < static_cast<int>(to))) ||
-                (elem->startCol == static_cast<int>(from))) {
-                /* merge elements */
-                elem->endCol = static_cast<int>(to);
-                return 0;
-            }
-        }
-    }
-
-    TextRectElement_t *element_p = data->elementFactory_p->create();
-    element_p->startCol = static_cast<int>(from);
-    element_p->endCol = static_cast<int>(to);
-
-    data->elementRefs_p->append(element_p);
-    ++data->matchCount;
-    return 0;
-}
-
 /***********************************************************************************************************************
 *   FindTextElements
 ***********************************************************************************************************************/
@@ -92,44 +54,23 @@ int FindTextElements(QList<TextRectElement_t *> *elementRefs_p, const char *text
 
     if ((text_p != nullptr) && (textSize > 0)) {
         if (regExp) {
-            struct regExpEventHandlerData data;
-            data.elementFactory_p = elementFactory_p;
-            data.elementRefs_p = elementRefs_p;
-            data.matchCount = 0;
-
-            hs_database_t *database;
-            hs_compile_error_t *compile_err;
-            if (hs_compile(textMatch_p,
-                           HS_FLAG_DOTALL | HS_FLAG_SOM_LEFTMOST,
-                           HS_MODE_BLOCK,
-                           nullptr,
-                           &database,
-                           &compile_err) != HS_SUCCESS) {
-                TRACEX_W(QString("RegExp failed %1").arg(compile_err->message))
-                hs_free_compile_error(compile_err);
-                return 0;
-            }
+            /* The pattern is compiled once (not for each row), and all the match spans of the row are found with
+             * one scan */
+            CRegExpSpans *regExpSpans_p = RegExpSpans_Get(textMatch_p);
+            std::vector<MatchSpan_t> spans;
 
-            hs_scratch_t *scratch = nullptr;
-            if (hs_alloc_scratch(database, &scratch) != HS_SUCCESS) {
-                TRACEX_W(QString("ERROR: Unable to allocate scratch space"))
-                hs_free_database(database);
+            if ((regExpSpans_p == nullptr) || (regExpSpans_p->FindSpans(text_p, textSize, spans) == 0)) {
                 return 0;
             }
 
-            if (hs_scan(database, text_p, static_cast<unsigned int>(textSize), 0, scratch, eventHandler,
-                        &data) != HS_SUCCESS) {
-                TRACEX_W(QString("ERROR: Unable to scan input buffer"))
-                hs_free_scratch(scratch);
-                hs_free_database(database);
-                return 0;
+            for (auto& span : spans) {
+                TextRectElement_t *element_p = elementFactory_p->create();
+                element_p->startCol = span.start;
+                element_p->endCol = span.end > span.start ? span.end - 1 : span.start;
+                elementRefs_p->append(element_p);
             }
 
-            /* Scanning is complete, any matches have been handled, so now we just * clean up and exit. */
-            hs_free_scratch(scratch);
-            hs_free_database(database);
-
-            return data.matchCount;
+            return static_cast<int>(spans.size());
         } else {
             /* Loop through the text against the match
              *  - originalStart, the entire row text start
@@ -190,9 +131,16 @@ void CAutoHighLight::CleanAutoHighlight(TIA_Cache_MemMap_t *cacheRow_p)
 {
     cacheRow_p->autoHighligth.matchStamp = 0;
 
-    /* Move all autoHighlight elements from the row to the pool */
+    /* Move all autoHighlight elements from the row to the pool. While over the memory budget the pool isn't grown
+     * beyond its initial size, the elements are released instead */
+    const bool release = MemAcc_IsOverBudget();
     while (!cacheRow_p->autoHighligth.elementRefs.isEmpty()) {
-        m_autoHighlight_Pool.append(cacheRow_p->autoHighligth.elementRefs.takeLast());
+        if (release && (m_autoHighlight_Pool.count() >= 100)) {
+            free(cacheRow_p->autoHighligth.elementRefs.takeLast());
+            MemAcc_Add(MEM_ACC_AUTOHIGHLIGHT_e, -static_cast<int64_t>(sizeof(TextRectElement_t)));
+        } else {
+            m_autoHighlight_Pool.append(cacheRow_p->autoHighligth.elementRefs.takeLast());
+        }
     }
 }
 
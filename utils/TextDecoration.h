@@ -87,9 +87,12 @@ public:
             TextRectElement_t *element_p = static_cast<TextRectElement_t *>(malloc(sizeof(TextRectElement_t)));
             m_autoHighlight_Pool.append(element_p);
         }
+        MemAcc_Add(MEM_ACC_AUTOHIGHLIGHT_e, 100 * static_cast<int64_t>(sizeof(TextRectElement_t)));
     }
 
     ~CAutoHighLight() {
+        MemAcc_Add(MEM_ACC_AUTOHIGHLIGHT_e,
+                   -m_autoHighlight_Pool.count() * static_cast<int64_t>(sizeof(TextRectElement_t)));
         while (!m_autoHighlight_Pool.isEmpty()) {
             free(m_autoHighlight_Pool.takeFirst());
         }
@@ -150,8 +153,11 @@ public:
             auto element_p = static_cast<FontModification_Element_t *>(malloc(sizeof(FontModification_Element_t)));
             m_fontModification_Pool.append(element_p);
         }
+        MemAcc_Add(MEM_ACC_AUTOHIGHLIGHT_e, 100 * static_cast<int64_t>(sizeof(FontModification_Element_t)));
     }
     ~CFontModification() {
+        MemAcc_Add(MEM_ACC_AUTOHIGHLIGHT_e,
+                   -m_fontModification_Pool.count() * static_cast<int64_t>(sizeof(FontModification_Element_t)));
         while (!m_fontModification_Pool.isEmpty()) {
             free(m_fontModification_Pool.takeFirst());
         }
@@ -7,6 +7,7 @@
 #include "CConfig.h"
 #include "filemapping.h"
 #include "CFilter.h"
+#include "CMemAccounting.h"
 
 #include <QRgb>
 #include <QFileDevice>
@@ -56,6 +57,8 @@ namespace FileMapping
             return false;
         }
 
+        MemAcc_Map(MEM_ACC_TIA_e, header_p, TIA_fileInfo.size());
+
         /* Check the header */
         bool headerOK = true;
         *rows_p = header_p->numOfRows;
@@ -75,7 +78,9 @@ namespace FileMapping
             }
         }
 
-        *fileSize_p = fileSize;
+        /* The indexed part of the log file, which might be less than the current file size when the log file is
+         * being appended to (or a virtual size of several segments, see CLogFile) */
+        *fileSize_p = header_p->fileSize;
 
         if (headerOK) {
             /* Check the last changed file date, must be the same */
@@ -93,6 +98,7 @@ namespace FileMapping
         }
 
         if (!headerOK) {
+            MemAcc_Unmap(MEM_ACC_TIA_e, header_p);
             TIA_File.unmap(reinterpret_cast<uint8_t *>(header_p));
             TIA_mem_p = nullptr;
 
@@ -134,6 +140,7 @@ namespace FileMapping
         /* stepping back the header */
         uint8_t *temp_p = (reinterpret_cast<uint8_t *>(TIA_mem_p) - sizeof(TIA_FileHeader_t));
 
+        MemAcc_Unmap(MEM_ACC_TIA_e, temp_p);
         TIA_File.unmap(temp_p);
         TIA_File.close();
 
@@ -178,6 +185,8 @@ namespace FileMapping
             return false;
         }
 
+        MemAcc_Map(MEM_ACC_FIRA_e, FIRA_mem_p, static_cast<int64_t>(sizeof(FIR_t)) * rows);
+
         TRACEX_I("FIRA file memory mapped: %s", FIRA_File.fileName().toLatin1().constData())
 
         memset(FIRA_mem_p, 0, sizeof(FIR_t) * static_cast<size_t>(rows));    /* FIRA Use OK */
@@ -200,6 +209,7 @@ namespace FileMapping
                 return false;
             }
         } else {
+            MemAcc_Unmap(MEM_ACC_FIRA_e, FIRA_mem_p);
             if (!FIRA_File.unmap(reinterpret_cast<uchar *>(FIRA_mem_p))) {
                 TRACEX_I(QString("%1 Failed to unmap %2")
                              .arg(__FUNCTION__).arg(FIRA_File.fileName().toLatin1().constData()))
@@ -220,6 +230,8 @@ namespace FileMapping
             return false;
         }
 
+        MemAcc_Map(MEM_ACC_FIRA_e, FIRA_mem_p, static_cast<int64_t>(sizeof(FIR_t)) * totalRows);
+
         TRACEX_D("FIRA file memory mapped: %s", FIRA_File.fileName().toLatin1().constData())
 
         return true;
@@ -243,6 +255,7 @@ namespace FileMapping
             return false;
         }
 
+        MemAcc_Unmap(MEM_ACC_FIRA_e, FIRA_mem_p);
         FIRA_File.unmap(reinterpret_cast<uchar *>(FIRA_mem_p));
         FIRA_File.close();
 